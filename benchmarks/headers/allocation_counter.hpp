@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstddef>
+
+namespace benchmark
+{
+    /**
+     * @brief Get the number of calls to the global operator new made by this process so far
+     *
+     * @return std::size_t The allocation count
+     */
+    std::size_t heap_allocations() noexcept;
+} // namespace benchmark
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <initializer_list>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace benchmark
+{
+    /**
+     * @brief Measurement context handed to a benchmark function
+     *
+     */
+    class State
+    {
+    private:
+        std::size_t _size;
+        std::size_t _iterations;
+        double _nanoseconds;
+        std::map<std::string, double> _counters;
+
+    protected:
+    public:
+        /**
+         * @brief Construct a new State for one problem size
+         *
+         * @param size The problem size, e.g. a node count
+         */
+        explicit State(std::size_t size) : _size(size), _iterations(0), _nanoseconds(0) {}
+
+        std::size_t size() const { return _size; }
+        std::size_t iterations() const { return _iterations; }
+        double nanoseconds_per_iteration() const { return _iterations ? _nanoseconds / _iterations : 0; }
+        const std::map<std::string, double> &counters() const { return _counters; }
+
+        /**
+         * @brief Attach an extra figure to the result, e.g. a patch count
+         *
+         * @param name The counter name
+         * @param value Its value
+         */
+        void set_counter(const std::string &name, double value) { _counters[name] = value; }
+
+        /**
+         * @brief Time body, repeating it until the measurement is long enough
+         *
+         * Body runs once untimed to warm caches, then in doubling batches until
+         * a batch lasts at least the minimum duration.
+         *
+         * @param body The code to time, run with no argument
+         */
+        template <typename Body>
+        void measure(Body &&body)
+        {
+            using clock = std::chrono::steady_clock;
+            constexpr auto minimum_duration = std::chrono::milliseconds(200);
+
+            body();
+            for (std::size_t batch = 1;; batch *= 2)
+            {
+                auto start = clock::now();
+                for (std::size_t iteration = 0; iteration < batch; ++iteration)
+                    body();
+                auto elapsed = clock::now() - start;
+                if (elapsed >= minimum_duration || batch >= (std::size_t(1) << 24))
+                {
+                    _iterations = batch;
+                    _nanoseconds = std::chrono::duration<double, std::nano>(elapsed).count();
+                    return;
+                }
+            }
+        }
+    };
+
+    /**
+     * @brief Make a value observable, so that the code computing it is not optimized away
+     *
+     * @param value The value, forced into a register or memory
+     */
+    template <typename T>
+    inline void do_not_optimize(const T &value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        static const void *volatile escaped;
+        escaped = &value;
+#endif
+    }
+
+    using Function = void (*)(State &);
+
+    struct Benchmark
+    {
+        std::string name;
+        Function function;
+        std::vector<std::size_t> sizes;
+    };
+
+    /**
+     * @brief Get every benchmark registered with BENCHMARK
+     *
+     * @return std::vector<Benchmark>& The registered benchmarks, in registration order per file
+     */
+    inline std::vector<Benchmark> &registry()
+    {
+        static std::vector<Benchmark> benchmarks;
+        return benchmarks;
+    }
+
+    struct Registration
+    {
+        Registration(const std::string &name, Function function, std::initializer_list<std::size_t> sizes)
+        {
+            registry().push_back({name, function, sizes});
+        }
+    };
+} // namespace benchmark
+
+/**
+ * @brief Register a benchmark function to run at each of the given sizes
+ *
+ */
+#define BENCHMARK(function, ...) \
+    static const benchmark::Registration function##_registration(#function, function, {__VA_ARGS__})
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "trace/tracer.hpp"
+#include "vdom/patch.hpp"
+
+namespace benchmark
+{
+    /**
+     * @brief Minimal retained-mode document standing in for a renderer backend
+     *
+     * Nodes are kept in a hash map by handle and linked to their siblings, as
+     * in a DOM, so that every patch applies in constant time apart from the
+     * removal of a whole subtree. Strings are copied out of the patches.
+     */
+    class Document
+    {
+    private:
+        struct Node
+        {
+            vdom::NodeKind kind;
+            vdom::Atom tag;
+            std::string text;
+            std::vector<std::pair<vdom::Atom, std::string>> properties;
+            vdom::Handle parent = vdom::null_handle;
+            vdom::Handle first_child = vdom::null_handle;
+            vdom::Handle last_child = vdom::null_handle;
+            vdom::Handle previous_sibling = vdom::null_handle;
+            vdom::Handle next_sibling = vdom::null_handle;
+        };
+
+        std::unordered_map<vdom::Handle, Node> _nodes;
+        vdom::Handle _root = vdom::null_handle;
+
+        static std::string to_string(const vdom::Value &value)
+        {
+            switch (value.type())
+            {
+            case vdom::Value::Type::None:
+            case vdom::Value::Type::Map:
+            case vdom::Value::Type::Vector:
+                return {};
+            case vdom::Value::Type::Bool:
+                return value.as_bool() ? "true" : "false";
+            case vdom::Value::Type::Integer:
+                return std::to_string(value.as_integer());
+            case vdom::Value::Type::Float:
+                return std::to_string(value.as_float());
+            case vdom::Value::Type::String:
+                break;
+            }
+            return std::string(value.as_string());
+        }
+
+        void detach(vdom::Handle handle, Node &node)
+        {
+            if (node.parent == vdom::null_handle)
+            {
+                if (_root == handle)
+                    _root = vdom::null_handle;
+                return;
+            }
+
+            Node &parent = _nodes.at(node.parent);
+            (node.previous_sibling != vdom::null_handle ? _nodes.at(node.previous_sibling).next_sibling : parent.first_child) = node.next_sibling;
+            (node.next_sibling != vdom::null_handle ? _nodes.at(node.next_sibling).previous_sibling : parent.last_child) = node.previous_sibling;
+            node.parent = vdom::null_handle;
+            node.previous_sibling = vdom::null_handle;
+            node.next_sibling = vdom::null_handle;
+        }
+
+        void attach(vdom::Handle handle, Node &node, vdom::Handle parent_handle, vdom::Handle before)
+        {
+            if (parent_handle == vdom::null_handle)
+            {
+                _root = handle;
+                return;
+            }
+
+            Node &parent = _nodes.at(parent_handle);
+            node.parent = parent_handle;
+            node.next_sibling = before;
+            node.previous_sibling = before != vdom::null_handle ? _nodes.at(before).previous_sibling : parent.last_child;
+            (node.previous_sibling != vdom::null_handle ? _nodes.at(node.previous_sibling).next_sibling : parent.first_child) = handle;
+            (before != vdom::null_handle ? _nodes.at(before).previous_sibling : parent.last_child) = handle;
+        }
+
+        void erase(vdom::Handle handle)
+        {
+            std::vector<vdom::Handle> pending{handle};
+            while (!pending.empty())
+            {
+                auto it = _nodes.find(pending.back());
+                pending.pop_back();
+                for (vdom::Handle child = it->second.first_child; child != vdom::null_handle; child = _nodes.at(child).next_sibling)
+                    pending.push_back(child);
+                _nodes.erase(it);
+            }
+        }
+
+    protected:
+    public:
+        /**
+         * @brief Apply a patch list, front to back
+         *
+         * @param patches Patches computed against the current content of the document
+         * @throw std::out_of_range If a patch designates an unknown node
+         */
+        void apply(const vdom::PatchList &patches)
+        {
+            trace::Span span("apply patches");
+            for (const vdom::Patch &patch : patches)
+            {
+                switch (patch.type)
+                {
+                case vdom::PatchType::Create:
+                {
+                    Node &node = _nodes[patch.node];
+                    node.kind = patch.kind;
+                    node.tag = patch.name;
+                    if (patch.kind == vdom::NodeKind::Text)
+                        node.text = to_string(patch.value);
+                    attach(patch.node, node, patch.parent, patch.before);
+                    break;
+                }
+                case vdom::PatchType::Remove:
+                {
+                    Node &node = _nodes.at(patch.node);
+                    detach(patch.node, node);
+                    erase(patch.node);
+                    break;
+                }
+                case vdom::PatchType::Move:
+                {
+                    Node &node = _nodes.at(patch.node);
+                    detach(patch.node, node);
+                    attach(patch.node, node, patch.parent, patch.before);
+                    break;
+                }
+                case vdom::PatchType::SetProperty:
+                {
+                    Node &node = _nodes.at(patch.node);
+                    auto it = node.properties.begin();
+                    while (it != node.properties.end() && it->first != patch.name)
+                        ++it;
+                    if (it == node.properties.end())
+                        node.properties.emplace_back(patch.name, to_string(patch.value));
+                    else
+                        it->second = to_string(patch.value);
+                    break;
+                }
+                case vdom::PatchType::RemoveProperty:
+                {
+                    Node &node = _nodes.at(patch.node);
+                    std::erase_if(node.properties, [&](const auto &property)
+                                  { return property.first == patch.name; });
+                    break;
+                }
+                case vdom::PatchType::SetText:
+                    _nodes.at(patch.node).text = to_string(patch.value);
+                    break;
+                }
+            }
+        }
+
+        /**
+         * @brief Remove every node
+         *
+         */
+        void clear()
+        {
+            _nodes.clear();
+            _root = vdom::null_handle;
+        }
+
+        std::size_t size() const noexcept { return _nodes.size(); }
+        vdom::Handle root() const noexcept { return _root; }
+    };
+} // namespace benchmark
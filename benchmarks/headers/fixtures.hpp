@@ -0,0 +1,81 @@
+#pragma once
+
+#include <charconv>
+#include <cstdint>
+#include <vector>
+
+#include "vdom/tree.hpp"
+
+namespace benchmark
+{
+    /**
+     * @brief Append a row to a node: a keyed element with a class property and a text child
+     *
+     * The text is "row <key>.<revision>", so successive revisions change every text.
+     *
+     * @param tree The tree
+     * @param parent The node receiving the row
+     * @param key The row key
+     * @param revision A number appended to the row text
+     */
+    inline void append_row(vdom::Tree &tree, vdom::NodeId parent, std::int64_t key, std::int64_t revision)
+    {
+        static const vdom::Atom item_tag = vdom::AtomTable::global().intern("li");
+        static const vdom::Atom class_name = vdom::AtomTable::global().intern("class");
+        const vdom::Property properties[] = {{class_name, vdom::Value::string("row")}};
+
+        char text[64] = "row ";
+        char *end = std::to_chars(text + 4, text + 30, key).ptr;
+        *end++ = '.';
+        end = std::to_chars(end, text + sizeof(text), revision).ptr;
+
+        vdom::NodeId item = tree.create_element(item_tag, vdom::Value::integer(key), properties);
+        tree.append_child(parent, item);
+        tree.append_child(item, tree.create_text({text, static_cast<std::size_t>(end - text)}));
+    }
+
+    /**
+     * @brief Fill a tree with a list whose rows carry the given keys, see append_row()
+     *
+     * @param tree The tree to fill, cleared first
+     * @param keys The row keys, in order
+     * @param revision A number appended to every row text
+     */
+    inline void build_list(vdom::Tree &tree, const std::vector<std::int64_t> &keys, std::int64_t revision = 0)
+    {
+        static const vdom::Atom list_tag = vdom::AtomTable::global().intern("ul");
+
+        tree.clear();
+        tree.reserve(keys.size() * 2 + 1, keys.size());
+        vdom::NodeId list = tree.create_element(list_tag);
+        tree.set_root(list);
+        for (std::int64_t key : keys)
+            append_row(tree, list, key, revision);
+    }
+
+    /**
+     * @brief Fill a tree with a list of sections splitting rows keyed 0 to rows - 1
+     *
+     * @param tree The tree to fill, cleared first
+     * @param rows The total row count
+     * @param sections The section count
+     * @param revision A number appended to every row text
+     */
+    inline void build_sections(vdom::Tree &tree, std::size_t rows, std::size_t sections, std::int64_t revision = 0)
+    {
+        static const vdom::Atom root_tag = vdom::AtomTable::global().intern("main");
+        static const vdom::Atom section_tag = vdom::AtomTable::global().intern("section");
+
+        tree.clear();
+        tree.reserve(rows * 2 + sections + 1, rows);
+        vdom::NodeId root = tree.create_element(root_tag);
+        tree.set_root(root);
+        for (std::size_t section = 0; section < sections; ++section)
+        {
+            vdom::NodeId list = tree.create_element(section_tag, vdom::Value::integer(static_cast<std::int64_t>(section)));
+            tree.append_child(root, list);
+            for (std::size_t row = rows * section / sections; row < rows * (section + 1) / sections; ++row)
+                append_row(tree, list, static_cast<std::int64_t>(row), revision);
+        }
+    }
+} // namespace benchmark
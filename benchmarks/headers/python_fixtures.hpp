@@ -0,0 +1,41 @@
+#pragma once
+
+#include <Python.h>
+
+#include "python/object.hpp"
+#include "python/runtime.hpp"
+
+namespace benchmark
+{
+    /**
+     * @brief Start the embedded interpreter on first use
+     *
+     * Benchmarks touching Python then hold a python::GIL for their whole run.
+     */
+    inline void initialize_python()
+    {
+        python::RuntimeConfig config;
+        config.program_name = "benchmarks";
+        config.isolated = true;
+        config.write_bytecode = false;
+        python::Runtime::initialize(config);
+    }
+
+    /**
+     * @brief Run Python source in a fresh namespace; the GIL must be held
+     *
+     * @param source The statements to run
+     * @param names A dict of names to define before running, nullptr for none
+     * @return python::Object The namespace dict holding what the source defined
+     * @throw std::runtime_error If the source raises
+     */
+    inline python::Object run_python(const char *source, PyObject *names = nullptr)
+    {
+        python::Object globals(PyDict_New());
+        if (PyDict_SetItemString(globals.get(), "__builtins__", PyEval_GetBuiltins()) < 0 ||
+            (names && PyDict_Update(globals.get(), names) < 0))
+            python::Object::throw_error_occurred();
+        python::Object result(PyRun_String(source, Py_file_input, globals.get(), globals.get()));
+        return globals;
+    }
+} // namespace benchmark
@@ -0,0 +1,119 @@
+#include <numeric>
+#include <optional>
+
+#include "allocation_counter.hpp"
+#include "benchmark.hpp"
+#include "fixtures.hpp"
+#include "memory/arena.hpp"
+#include "vdom/reconciler.hpp"
+
+namespace
+{
+    /**
+     * @brief Run render frames of state.size() rows whose texts all change every frame
+     *
+     * A frame builds the next tree, diffs it against the mounted one and
+     * collects the patches, then drops the mounted tree. The counters report
+     * the heap allocations per frame once the frame loop is warm.
+     *
+     * @param frame Builds, diffs and swaps one frame, given its revision
+     */
+    template <typename Frame>
+    void render_frames(benchmark::State &state, Frame &&frame)
+    {
+        std::int64_t revision = 0;
+
+        // Let every buffer reach its steady-state capacity before counting
+        for (int warmup = 0; warmup < 4; ++warmup)
+            frame(revision++);
+
+        std::size_t heap_allocations = benchmark::heap_allocations();
+        std::size_t frames = 0;
+        state.measure([&]
+                      {
+                          frame(revision++);
+                          frames++; });
+        state.set_counter("heap_allocs/frame",
+                          static_cast<double>(benchmark::heap_allocations() - heap_allocations) / static_cast<double>(frames));
+    }
+
+    /**
+     * @brief Frames allocating from the global heap
+     *
+     */
+    void frame_heap(benchmark::State &state)
+    {
+        std::vector<std::int64_t> keys(state.size());
+        std::iota(keys.begin(), keys.end(), 0);
+
+        vdom::Tree mounted;
+        vdom::Tree next;
+        vdom::PatchList patches;
+        benchmark::build_list(mounted, keys);
+
+        render_frames(state, [&](std::int64_t revision)
+                      {
+                          benchmark::build_list(next, keys, revision);
+                          vdom::Reconciler reconciler;
+                          patches.clear();
+                          reconciler.diff(mounted, next, patches);
+                          std::swap(mounted, next); });
+        state.set_counter("patches", static_cast<double>(patches.size()));
+    }
+
+    /**
+     * @brief Frames allocating every tree, patch and scratch buffer from arenas
+     *
+     * Each tree lives in its own arena, reset when the tree is dropped; patches
+     * and reconciler scratch live in a frame arena reset after every frame.
+     */
+    void frame_arena(benchmark::State &state)
+    {
+        std::vector<std::int64_t> keys(state.size());
+        std::iota(keys.begin(), keys.end(), 0);
+
+        memory::Arena tree_arenas[2];
+        memory::Arena frame_arena;
+        std::optional<vdom::Tree> trees[2];
+        std::size_t mounted = 0;
+        std::size_t patch_count = 0;
+
+        trees[mounted].emplace(&tree_arenas[mounted]);
+        benchmark::build_list(*trees[mounted], keys);
+
+        auto upstream_allocations = [&]
+        {
+            return tree_arenas[0].statistics().upstream_allocations + tree_arenas[1].statistics().upstream_allocations +
+                   frame_arena.statistics().upstream_allocations;
+        };
+
+        std::size_t warm_upstream_allocations = 0;
+        render_frames(state, [&](std::int64_t revision)
+                      {
+                          if (revision == 4)
+                              warm_upstream_allocations = upstream_allocations();
+
+                          std::size_t next = 1 - mounted;
+                          trees[next].emplace(&tree_arenas[next]);
+                          benchmark::build_list(*trees[next], keys, revision);
+
+                          {
+                              vdom::Reconciler reconciler(&frame_arena);
+                              vdom::PatchList patches(&frame_arena);
+                              reconciler.diff(*trees[mounted], *trees[next], patches);
+                              patch_count = patches.size();
+                          }
+                          frame_arena.reset();
+
+                          trees[mounted].reset();
+                          tree_arenas[mounted].reset();
+                          mounted = next; });
+
+        state.set_counter("patches", static_cast<double>(patch_count));
+        state.set_counter("arena_upstream_allocs", static_cast<double>(upstream_allocations() - warm_upstream_allocations));
+        state.set_counter("frame_arena_peak_bytes", static_cast<double>(frame_arena.statistics().peak_bytes_allocated));
+    }
+} // namespace
+
+BENCHMARK(frame_heap, 1000, 10000, 100000);
+BENCHMARK(frame_arena, 1000, 10000, 100000);
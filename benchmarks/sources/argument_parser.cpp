@@ -0,0 +1,108 @@
+#include <string>
+#include <vector>
+
+#include "allocation_counter.hpp"
+#include "argument_parser.hpp"
+#include "benchmark.hpp"
+
+namespace
+{
+    // The command line of a short-lived worker process
+    const char *const command_line[] = {"worker", "--input", "frames.bin", "-j", "4", "--verbose", "--mode", "fast", "output.bin"};
+    constexpr int command_line_size = static_cast<int>(std::size(command_line));
+
+    /**
+     * @brief Build a parser with add_argument and parse a command line, state.size() times
+     *
+     */
+    void argument_parser_runtime(benchmark::State &state)
+    {
+        std::size_t parses = 0;
+        long jobs = 0;
+        const std::size_t heap_allocations = benchmark::heap_allocations();
+        state.measure([&]
+                      {
+                          for (std::size_t index = 0; index < state.size(); ++index)
+                          {
+                              argument_parser::ArgumentParser parser(command_line_size, command_line, "", "", false);
+                              parser.add_argument(std::vector<std::string>{"-i", "--input"}, "store");
+                              parser.add_argument(std::vector<std::string>{"-j", "--jobs"}, "store");
+                              parser.add_argument(std::vector<std::string>{"-m", "--mode"}, "store");
+                              parser.add_argument(std::vector<std::string>{"-v", "--verbose"}, "store_true");
+                              parser.add_argument("output");
+                              argument_parser::Namespace arguments = parser.parse_args();
+                              jobs += arguments.get<int>("jobs");
+                          }
+                          parses += state.size(); });
+        state.set_counter("heap_allocs/parse",
+                          static_cast<double>(benchmark::heap_allocations() - heap_allocations) / static_cast<double>(parses));
+        state.set_counter("jobs", static_cast<double>(jobs / static_cast<long>(parses)));
+    }
+
+    /**
+     * @brief Parse the same command line against a compile-time schema, state.size() times
+     *
+     */
+    void argument_parser_schema(benchmark::State &state)
+    {
+        static constexpr auto schema = argument_parser::make_schema(
+            argument_parser::option("-i", "--input"),
+            argument_parser::option("-j", "--jobs"),
+            argument_parser::option("-m", "--mode"),
+            argument_parser::flag("-v", "--verbose"),
+            argument_parser::positional("output"));
+
+        std::size_t parses = 0;
+        long jobs = 0;
+        const std::size_t heap_allocations = benchmark::heap_allocations();
+        state.measure([&]
+                      {
+                          for (std::size_t index = 0; index < state.size(); ++index)
+                          {
+                              auto arguments = argument_parser::parse(schema, command_line_size, command_line);
+                              jobs += arguments.get<int>("jobs");
+                          }
+                          parses += state.size(); });
+        state.set_counter("heap_allocs/parse",
+                          static_cast<double>(benchmark::heap_allocations() - heap_allocations) / static_cast<double>(parses));
+        state.set_counter("jobs", static_cast<double>(jobs / static_cast<long>(parses)));
+    }
+
+    /**
+     * @brief Read typed values of a parsed Namespace through handles, state.size() times
+     *
+     */
+    void argument_parser_lookup(benchmark::State &state)
+    {
+        argument_parser::ArgumentParser parser(command_line_size, command_line, "", "", false);
+        parser.add_argument(std::vector<std::string>{"-i", "--input"}, "store");
+        parser.add_argument(std::vector<std::string>{"-j", "--jobs"}, "store", "", "", "", "", "", false, {}, argument_parser::ValueType::Integer);
+        parser.add_argument(std::vector<std::string>{"-m", "--mode"}, "store");
+        parser.add_argument(std::vector<std::string>{"-v", "--verbose"}, "store_true");
+        parser.add_argument("output");
+        const argument_parser::Namespace arguments = parser.parse_args();
+        const auto jobs_handle = parser.handle("jobs");
+        const auto verbose_handle = parser.handle("verbose");
+        const auto mode_handle = parser.handle("mode");
+
+        std::size_t reads = 0;
+        long jobs = 0;
+        const std::size_t heap_allocations = benchmark::heap_allocations();
+        state.measure([&]
+                      {
+                          for (std::size_t index = 0; index < state.size(); ++index)
+                          {
+                              jobs += arguments.get<int>(jobs_handle);
+                              jobs += arguments.get<bool>(verbose_handle);
+                              jobs += static_cast<long>(arguments.get<std::string_view>(mode_handle).size());
+                          }
+                          reads += state.size(); });
+        state.set_counter("heap_allocs/read",
+                          static_cast<double>(benchmark::heap_allocations() - heap_allocations) / static_cast<double>(reads));
+        state.set_counter("jobs", static_cast<double>(jobs / static_cast<long>(reads)));
+    }
+} // namespace
+
+BENCHMARK(argument_parser_runtime, 1, 100);
+BENCHMARK(argument_parser_schema, 1, 100);
+BENCHMARK(argument_parser_lookup, 1000);
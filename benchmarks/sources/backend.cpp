@@ -0,0 +1,81 @@
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+#include "backend/memory_backend.hpp"
+#include "backend/renderer.hpp"
+#include "benchmark.hpp"
+#include "fixtures.hpp"
+#include "vdom/reconciler.hpp"
+
+namespace
+{
+    /**
+     * @brief Mount a list of state.size() rows into the in-memory backend, through the C interface
+     *
+     * The counterpart of patch_apply_mount: the difference is the cost of
+     * converting the batch and crossing the interface once per frame.
+     */
+    void backend_apply_mount(benchmark::State &state)
+    {
+        std::vector<std::int64_t> keys(state.size());
+        std::iota(keys.begin(), keys.end(), 0);
+
+        vdom::Tree empty;
+        vdom::Tree tree;
+        vdom::Reconciler reconciler;
+        vdom::PatchList patches;
+        benchmark::build_list(tree, keys);
+        reconciler.diff(empty, tree, patches);
+
+        backend::Renderer renderer(backend::memory_backend_api());
+        backend::MemoryBackend &document = backend::MemoryBackend::of(renderer.instance());
+        state.measure([&]
+                      {
+                          document.clear();
+                          renderer.apply(patches); });
+        state.set_counter("patches", static_cast<double>(patches.size()));
+        state.set_counter("nodes", static_cast<double>(document.size()));
+    }
+
+    /**
+     * @brief Apply a shuffle of state.size() rows with new texts, then its inverse, through the C interface
+     *
+     * The counterpart of patch_apply_shuffle.
+     */
+    void backend_apply_shuffle(benchmark::State &state)
+    {
+        std::vector<std::int64_t> keys(state.size());
+        std::iota(keys.begin(), keys.end(), 0);
+        std::vector<std::int64_t> shuffled = keys;
+        std::mt19937_64 random(state.size());
+        std::shuffle(shuffled.begin(), shuffled.end(), random);
+
+        vdom::Tree empty;
+        vdom::Tree mounted;
+        vdom::Tree forward;
+        vdom::Tree backward;
+        vdom::Reconciler reconciler;
+        vdom::PatchList mount;
+        vdom::PatchList forward_patches;
+        vdom::PatchList backward_patches;
+
+        benchmark::build_list(mounted, keys);
+        benchmark::build_list(forward, shuffled, 1);
+        benchmark::build_list(backward, keys);
+        reconciler.diff(empty, mounted, mount);
+        reconciler.diff(mounted, forward, forward_patches);
+        reconciler.diff(forward, backward, backward_patches);
+
+        backend::Renderer renderer(backend::memory_backend_api());
+        renderer.apply(mount);
+        state.measure([&]
+                      {
+                          renderer.apply(forward_patches);
+                          renderer.apply(backward_patches); });
+        state.set_counter("patches", static_cast<double>(forward_patches.size() + backward_patches.size()));
+    }
+} // namespace
+
+BENCHMARK(backend_apply_mount, 1000, 10000, 100000);
+BENCHMARK(backend_apply_shuffle, 1000, 10000, 100000);
@@ -0,0 +1,40 @@
+#include <thread>
+#include <vector>
+
+#include "benchmark.hpp"
+#include "engine/event_queue.hpp"
+
+namespace
+{
+    /**
+     * @brief Push state.size() pointermove events over 16 targets from 4 threads, then drain them coalesced
+     *
+     */
+    void events_pointer_flood(benchmark::State &state)
+    {
+        constexpr std::size_t producers = 4;
+        vdom::AtomTable atoms;
+        const vdom::Atom pointer_move = atoms.intern("pointermove");
+        engine::EventQueue queue(state.size());
+        queue.coalesce(pointer_move);
+
+        std::vector<engine::Event> events;
+        state.measure([&]
+                      {
+                          std::vector<std::thread> threads;
+                          for (std::size_t producer = 0; producer < producers; ++producer)
+                          {
+                              threads.emplace_back([&, producer]
+                                                   {
+                                                       for (std::size_t index = producer; index < state.size(); index += producers)
+                                                           queue.push({pointer_move, index % 16 + 1, static_cast<double>(index), 0.0, 0});
+                                                   });
+                          }
+                          for (std::thread &thread : threads)
+                              thread.join();
+                          queue.drain(events); });
+        state.set_counter("drained", static_cast<double>(events.size()));
+    }
+} // namespace
+
+BENCHMARK(events_pointer_flood, 1000, 10000, 100000);
@@ -0,0 +1,108 @@
+#include <cstdint>
+#include <utility>
+
+#include "benchmark.hpp"
+#include "fixtures.hpp"
+#include "vdom/hoister.hpp"
+#include "vdom/reconciler.hpp"
+
+namespace
+{
+    /**
+     * @brief Fill a tree with 10 sections of rows keyed 0 to rows - 1, only the first changing with revision
+     *
+     * A page where a tenth of the content is live and the rest, e.g. headers,
+     * navigation and footers, renders the same every frame.
+     */
+    void build_page(vdom::Tree &tree, std::size_t rows, std::int64_t revision)
+    {
+        static const vdom::Atom root_tag = vdom::AtomTable::global().intern("main");
+        static const vdom::Atom section_tag = vdom::AtomTable::global().intern("section");
+        constexpr std::size_t sections = 10;
+
+        tree.clear();
+        tree.reserve(rows * 2 + sections + 1, rows);
+        vdom::NodeId root = tree.create_element(root_tag);
+        tree.set_root(root);
+        for (std::size_t section = 0; section < sections; ++section)
+        {
+            vdom::NodeId list = tree.create_element(section_tag, vdom::Value::integer(static_cast<std::int64_t>(section)));
+            tree.append_child(root, list);
+            for (std::size_t row = rows * section / sections; row < rows * (section + 1) / sections; ++row)
+                benchmark::append_row(tree, list, static_cast<std::int64_t>(row), section == 0 ? revision : 0);
+        }
+    }
+
+    /**
+     * @brief Time frames of a page of state.size() rows, optionally hoisted
+     *
+     * @param frames true to time 100 whole frames: build, hoist, diff; false to time the diff of one frame alone
+     */
+    void page(benchmark::State &state, bool hoist, bool frames)
+    {
+        vdom::Tree old_tree;
+        vdom::Tree new_tree;
+        vdom::Reconciler reconciler;
+        vdom::Hoister hoister;
+        vdom::PatchList patches;
+        std::int64_t revision = 0;
+
+        auto frame = [&]
+        {
+            build_page(new_tree, state.size(), revision++);
+            if (hoist)
+                hoister.hoist(new_tree);
+            patches.clear();
+            reconciler.diff(old_tree, new_tree, patches);
+            std::swap(old_tree, new_tree);
+        };
+
+        // Past the frames a subtree must stay unchanged before it is hoisted
+        for (int warmup = 0; warmup < 4; ++warmup)
+            frame();
+        if (frames)
+        {
+            state.measure([&]
+                          {
+                              for (int index = 0; index < 100; ++index)
+                                  frame(); });
+        }
+        else
+        {
+            build_page(new_tree, state.size(), revision);
+            if (hoist)
+                hoister.hoist(new_tree);
+            state.measure([&]
+                          {
+                              patches.clear();
+                              reconciler.diff(old_tree, new_tree, patches); });
+        }
+        state.set_counter("patches/frame", static_cast<double>(patches.size()));
+        state.set_counter("hoisted_nodes", static_cast<double>(hoister.statistics().hoisted_nodes));
+    }
+
+    void page_diff(benchmark::State &state)
+    {
+        page(state, false, false);
+    }
+
+    void page_diff_hoisted(benchmark::State &state)
+    {
+        page(state, true, false);
+    }
+
+    void page_frames(benchmark::State &state)
+    {
+        page(state, false, true);
+    }
+
+    void page_frames_hoisted(benchmark::State &state)
+    {
+        page(state, true, true);
+    }
+} // namespace
+
+BENCHMARK(page_diff, 1000, 10000, 100000);
+BENCHMARK(page_diff_hoisted, 1000, 10000, 100000);
+BENCHMARK(page_frames, 1000, 10000, 100000);
+BENCHMARK(page_frames_hoisted, 1000, 10000, 100000);
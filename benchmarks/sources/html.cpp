@@ -0,0 +1,30 @@
+#include <cmath>
+
+#include "benchmark.hpp"
+#include "fixtures.hpp"
+#include "ssr/html_writer.hpp"
+
+namespace
+{
+    /**
+     * @brief Serialize a built tree of sections of rows, about state.size() nodes, to HTML
+     *
+     */
+    void html_write_tree(benchmark::State &state)
+    {
+        vdom::Tree tree;
+        benchmark::build_sections(tree, state.size() / 2, std::sqrt(state.size() / 2));
+
+        std::size_t bytes = 0;
+        ssr::HtmlWriter writer([&](std::string_view chunk)
+                               { bytes += chunk.size(); });
+        state.measure([&]
+                      {
+                          bytes = 0;
+                          writer.write(tree); });
+        state.set_counter("bytes", static_cast<double>(bytes));
+        state.set_counter("MB/s", static_cast<double>(bytes) * 1e3 / state.nanoseconds_per_iteration());
+    }
+} // namespace
+
+BENCHMARK(html_write_tree, 1000, 10000, 100000);
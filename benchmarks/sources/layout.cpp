@@ -0,0 +1,72 @@
+#include <cmath>
+#include <string>
+
+#include "benchmark.hpp"
+#include "fixtures.hpp"
+#include "layout/layout_tree.hpp"
+#include "vdom/reconciler.hpp"
+
+namespace
+{
+    /**
+     * @brief Mount sections of rows, about state.size() nodes, and lay them out from scratch
+     *
+     */
+    void layout_mount(benchmark::State &state)
+    {
+        vdom::Tree empty;
+        vdom::Tree tree;
+        vdom::Reconciler reconciler;
+        vdom::PatchList patches;
+        benchmark::build_sections(tree, state.size() / 2, std::sqrt(state.size() / 2));
+        reconciler.diff(empty, tree, patches);
+
+        layout::LayoutTree layout;
+        state.measure([&]
+                      {
+                          layout.clear();
+                          layout.apply(patches);
+                          layout.compute(1280, 720); });
+        state.set_counter("nodes", static_cast<double>(layout.size()));
+    }
+
+    /**
+     * @brief Change the text of one row of about state.size() nodes and lay out again, as a keystroke does
+     *
+     */
+    void layout_edit_text(benchmark::State &state)
+    {
+        vdom::Tree empty;
+        vdom::Tree tree;
+        vdom::Reconciler reconciler;
+        vdom::PatchList patches;
+        benchmark::build_sections(tree, state.size() / 2, std::sqrt(state.size() / 2));
+        reconciler.diff(empty, tree, patches);
+
+        layout::LayoutTree layout;
+        layout.apply(patches);
+        layout.compute(1280, 720);
+
+        // The text of the middle row
+        vdom::NodeId text = vdom::null_node;
+        for (vdom::NodeId node = static_cast<vdom::NodeId>(tree.size() / 2); node < tree.size() && text == vdom::null_node; ++node)
+        {
+            if (tree.kind(node) == vdom::NodeKind::Text)
+                text = node;
+        }
+
+        const std::string texts[] = {"short", "a much longer text that wraps in narrow sections"};
+        std::size_t edits = 0;
+        const std::uint64_t layouts = layout.statistics().layouts;
+        state.measure([&]
+                      {
+                          vdom::PatchList edit{{vdom::PatchType::SetText, vdom::NodeKind::Text, vdom::null_atom, tree.handle(text),
+                                                vdom::null_handle, vdom::null_handle, vdom::Value::string(texts[edits++ % 2])}};
+                          layout.apply(edit);
+                          layout.compute(1280, 720); });
+        state.set_counter("layouts/edit", static_cast<double>(layout.statistics().layouts - layouts) / static_cast<double>(edits));
+    }
+} // namespace
+
+BENCHMARK(layout_mount, 1000, 10000, 100000);
+BENCHMARK(layout_edit_text, 1000, 10000, 100000);
@@ -0,0 +1,169 @@
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#include "argument_parser.hpp"
+#include "benchmark.hpp"
+#include "trace/tracer.hpp"
+
+namespace
+{
+    struct Result
+    {
+        std::string name;
+        std::size_t size;
+        std::size_t iterations;
+        double nanoseconds_per_iteration;
+        std::map<std::string, double> counters;
+    };
+
+    std::string json_string(const std::string &text)
+    {
+        std::ostringstream stream;
+        stream << '"';
+        for (char character : text)
+        {
+            if (character == '"' || character == '\\')
+                stream << '\\' << character;
+            else if (static_cast<unsigned char>(character) < 0x20)
+                stream << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(character) << std::dec;
+            else
+                stream << character;
+        }
+        stream << '"';
+        return stream.str();
+    }
+
+    /**
+     * @brief Write the results with enough context to compare runs across releases
+     *
+     */
+    void write_json(std::ostream &stream, const std::vector<Result> &results)
+    {
+        std::time_t now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+        char date[32];
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+#ifdef NDEBUG
+        const char *build_type = "release";
+#else
+        const char *build_type = "debug";
+#endif
+#ifdef __VERSION__
+        const char *compiler = __VERSION__;
+#else
+        const char *compiler = "unknown";
+#endif
+
+        stream << std::setprecision(17);
+        stream << "{\n  \"context\": {\n"
+               << "    \"date\": " << json_string(date) << ",\n"
+               << "    \"compiler\": " << json_string(compiler) << ",\n"
+               << "    \"build_type\": " << json_string(build_type) << ",\n"
+               << "    \"hardware_concurrency\": " << std::thread::hardware_concurrency() << "\n"
+               << "  },\n  \"benchmarks\": [";
+        for (std::size_t index = 0; index < results.size(); ++index)
+        {
+            const Result &result = results[index];
+            stream << (index ? ",\n" : "\n") << "    {\"name\": " << json_string(result.name)
+                   << ", \"size\": " << result.size
+                   << ", \"iterations\": " << result.iterations
+                   << ", \"ns_per_iteration\": " << result.nanoseconds_per_iteration
+                   << ", \"ns_per_item\": " << result.nanoseconds_per_iteration / static_cast<double>(result.size)
+                   << ", \"counters\": {";
+            bool first = true;
+            for (const auto &[name, value] : result.counters)
+            {
+                stream << (first ? "" : ", ") << json_string(name) << ": " << value;
+                first = false;
+            }
+            stream << "}}";
+        }
+        stream << "\n  ]\n}\n";
+    }
+} // namespace
+
+int main(int argc, const char *const argv[])
+{
+    argument_parser::ArgumentParser argument_parser(argc, argv, "Measure the hot paths of the component-engine core");
+    argument_parser.add_argument(std::vector<std::string>{"-f", "--filter"}, "store", "", "", "", "only run benchmarks whose name contains FILTER", "FILTER");
+    argument_parser.add_argument(std::vector<std::string>{"-j", "--json"}, "store", "", "", "", "also write the results as JSON to FILE", "FILE");
+    argument_parser.add_argument(std::vector<std::string>{"-t", "--trace"}, "store", "", "", "", "record pipeline spans and write them as Chrome trace JSON to FILE", "FILE");
+
+    argument_parser::Namespace arguments;
+    try
+    {
+        arguments = argument_parser.parse_args();
+    }
+    catch (const std::exception &exception)
+    {
+        std::cerr << "Error: " << exception.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::string filter = arguments.has("filter") ? arguments.get<std::string>("filter") : "";
+    std::string json_path = arguments.has("json") ? arguments.get<std::string>("json") : "";
+    std::string trace_path = arguments.has("trace") ? arguments.get<std::string>("trace") : "";
+    std::vector<Result> results;
+    trace::Tracer::enable(!trace_path.empty());
+
+    std::cout << std::left << std::setw(32) << "benchmark" << std::right << std::setw(10) << "size"
+              << std::setw(14) << "ns/iter" << std::setw(12) << "ns/item" << "  counters" << std::endl;
+
+    for (const auto &benchmark : benchmark::registry())
+    {
+        if (benchmark.name.find(filter) == std::string::npos)
+            continue;
+
+        for (std::size_t size : benchmark.sizes)
+        {
+            benchmark::State state(size);
+            try
+            {
+                benchmark.function(state);
+            }
+            catch (const std::exception &exception)
+            {
+                std::cerr << "Error: " << benchmark.name << " at size " << size << ": " << exception.what() << std::endl;
+                return EXIT_FAILURE;
+            }
+            results.push_back({benchmark.name, size, state.iterations(), state.nanoseconds_per_iteration(), state.counters()});
+
+            std::cout << std::left << std::setw(32) << benchmark.name << std::right << std::setw(10) << size
+                      << std::setw(14) << std::fixed << std::setprecision(0) << state.nanoseconds_per_iteration()
+                      << std::setw(12) << std::setprecision(2) << state.nanoseconds_per_iteration() / size << " ";
+            for (const auto &[name, value] : state.counters())
+                std::cout << " " << name << "=" << std::setprecision(0) << value;
+            std::cout << std::endl;
+        }
+    }
+
+    if (!trace_path.empty())
+    {
+        std::ofstream file(trace_path);
+        trace::Tracer::write_chrome_trace(file);
+        if (!file)
+        {
+            std::cerr << "Error: cannot write " << trace_path << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (!json_path.empty())
+    {
+        std::ofstream file(json_path);
+        write_json(file, results);
+        if (!file)
+        {
+            std::cerr << "Error: cannot write " << json_path << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,43 @@
+#include "benchmark.hpp"
+#include "engine/parallel_reconciler.hpp"
+#include "fixtures.hpp"
+
+namespace
+{
+    /**
+     * @brief Time the diff of state.size() rows in 64 sections, every text changed, on a number of threads
+     *
+     */
+    void parallel_diff(benchmark::State &state, std::size_t threads)
+    {
+        vdom::Tree empty;
+        vdom::Tree old_tree;
+        vdom::Tree new_tree;
+        vdom::PatchList patches;
+        engine::ThreadPool pool(threads - 1);
+        engine::ParallelReconciler reconciler;
+
+        benchmark::build_sections(old_tree, state.size(), 64);
+        reconciler.diff(empty, old_tree, patches, &pool);
+        benchmark::build_sections(new_tree, state.size(), 64, 1);
+
+        state.measure([&]
+                      {
+                          patches.clear();
+                          reconciler.diff(old_tree, new_tree, patches, &pool); });
+        state.set_counter("patches", static_cast<double>(patches.size()));
+        state.set_counter("threads", static_cast<double>(threads));
+    }
+
+    void parallel_diff_1_thread(benchmark::State &state) { parallel_diff(state, 1); }
+    void parallel_diff_2_threads(benchmark::State &state) { parallel_diff(state, 2); }
+    void parallel_diff_4_threads(benchmark::State &state) { parallel_diff(state, 4); }
+    void parallel_diff_8_threads(benchmark::State &state) { parallel_diff(state, 8); }
+    void parallel_diff_16_threads(benchmark::State &state) { parallel_diff(state, 16); }
+} // namespace
+
+BENCHMARK(parallel_diff_1_thread, 100000, 1000000);
+BENCHMARK(parallel_diff_2_threads, 100000, 1000000);
+BENCHMARK(parallel_diff_4_threads, 100000, 1000000);
+BENCHMARK(parallel_diff_8_threads, 100000, 1000000);
+BENCHMARK(parallel_diff_16_threads, 100000, 1000000);
@@ -0,0 +1,77 @@
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+#include "benchmark.hpp"
+#include "document.hpp"
+#include "fixtures.hpp"
+#include "vdom/reconciler.hpp"
+
+namespace
+{
+    /**
+     * @brief Mount a list of state.size() rows into an empty document
+     *
+     */
+    void patch_apply_mount(benchmark::State &state)
+    {
+        std::vector<std::int64_t> keys(state.size());
+        std::iota(keys.begin(), keys.end(), 0);
+
+        vdom::Tree empty;
+        vdom::Tree tree;
+        vdom::Reconciler reconciler;
+        vdom::PatchList patches;
+        benchmark::build_list(tree, keys);
+        reconciler.diff(empty, tree, patches);
+
+        benchmark::Document document;
+        state.measure([&]
+                      {
+                          document.clear();
+                          document.apply(patches); });
+        state.set_counter("patches", static_cast<double>(patches.size()));
+    }
+
+    /**
+     * @brief Apply a shuffle of state.size() rows with new texts, then its inverse
+     *
+     * Both patch lists are computed once; applying one after the other brings
+     * the document back to where it started, so they can be repeated.
+     */
+    void patch_apply_shuffle(benchmark::State &state)
+    {
+        std::vector<std::int64_t> keys(state.size());
+        std::iota(keys.begin(), keys.end(), 0);
+        std::vector<std::int64_t> shuffled = keys;
+        std::mt19937_64 random(state.size());
+        std::shuffle(shuffled.begin(), shuffled.end(), random);
+
+        vdom::Tree empty;
+        vdom::Tree mounted;
+        vdom::Tree forward;
+        vdom::Tree backward;
+        vdom::Reconciler reconciler;
+        vdom::PatchList mount;
+        vdom::PatchList forward_patches;
+        vdom::PatchList backward_patches;
+
+        benchmark::build_list(mounted, keys);
+        benchmark::build_list(forward, shuffled, 1);
+        benchmark::build_list(backward, keys);
+        reconciler.diff(empty, mounted, mount);
+        reconciler.diff(mounted, forward, forward_patches);
+        reconciler.diff(forward, backward, backward_patches);
+
+        benchmark::Document document;
+        document.apply(mount);
+        state.measure([&]
+                      {
+                          document.apply(forward_patches);
+                          document.apply(backward_patches); });
+        state.set_counter("patches", static_cast<double>(forward_patches.size() + backward_patches.size()));
+    }
+} // namespace
+
+BENCHMARK(patch_apply_mount, 1000, 10000, 100000);
+BENCHMARK(patch_apply_shuffle, 1000, 10000, 100000);
@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "benchmark.hpp"
+#include "document.hpp"
+#include "fixtures.hpp"
+#include "stream/patch_stream.hpp"
+#include "stream/shared_memory.hpp"
+#include "vdom/reconciler.hpp"
+
+namespace
+{
+    /**
+     * @brief Applies the patches read from a stream to a Document, as a renderer process does
+     *
+     */
+    struct DocumentSink
+    {
+        benchmark::Document document;
+        std::uint64_t frames = 0;
+
+        void apply(const vdom::PatchList &patches) { document.apply(patches); }
+        void commit(std::uint32_t) { frames++; }
+    };
+
+    /**
+     * @brief Read a stream until the writer closes it
+     *
+     */
+    void consume(const std::string &name)
+    {
+        stream::SharedMemory memory(name);
+        stream::PatchReader reader(memory.bytes());
+        DocumentSink sink;
+        while (!reader.finished())
+        {
+            if (!reader.read(sink))
+                std::this_thread::yield();
+        }
+    }
+
+    /**
+     * @brief Stream a shuffle of state.size() rows with new texts, then its inverse, to another process
+     *
+     * The consumer process applies them to a Document. Each iteration waits
+     * until it has read both frames, so the time covers encoding, the
+     * transfer through shared memory and applying.
+     */
+    void patch_stream_process(benchmark::State &state)
+    {
+        std::vector<std::int64_t> keys(state.size());
+        std::iota(keys.begin(), keys.end(), 0);
+        std::vector<std::int64_t> shuffled = keys;
+        std::mt19937_64 random(state.size());
+        std::shuffle(shuffled.begin(), shuffled.end(), random);
+
+        vdom::Tree empty;
+        vdom::Tree mounted;
+        vdom::Tree forward;
+        vdom::Tree backward;
+        vdom::Reconciler reconciler;
+        vdom::PatchList mount;
+        vdom::PatchList forward_patches;
+        vdom::PatchList backward_patches;
+
+        benchmark::build_list(mounted, keys);
+        benchmark::build_list(forward, shuffled, 1);
+        benchmark::build_list(backward, keys);
+        reconciler.diff(empty, mounted, mount);
+        reconciler.diff(mounted, forward, forward_patches);
+        reconciler.diff(forward, backward, backward_patches);
+
+#ifdef _WIN32
+        const std::string name = "component-engine-benchmark-" + std::to_string(_getpid()) + "-" + std::to_string(state.size());
+#else
+        const std::string name = "component-engine-benchmark-" + std::to_string(::getpid()) + "-" + std::to_string(state.size());
+#endif
+        stream::SharedMemory memory(name, stream::PatchWriter::memory_size(1 << 20));
+        std::uint64_t patches = 0;
+        {
+            stream::PatchWriter writer(memory.bytes());
+
+#ifdef _WIN32
+            std::thread consumer(consume, name);
+#else
+            const pid_t consumer = ::fork();
+            if (consumer == 0)
+            {
+                try
+                {
+                    consume(name);
+                }
+                catch (...)
+                {
+                    ::_exit(1);
+                }
+                ::_exit(0);
+            }
+#endif
+
+            writer.write(mount, 1);
+            state.measure([&]
+                          {
+                              writer.write(forward_patches, 2);
+                              writer.write(backward_patches, 3);
+                              while (!writer.drained())
+                                  std::this_thread::yield(); });
+            patches = forward_patches.size() + backward_patches.size();
+            state.set_counter("bytes/patch", static_cast<double>(writer.statistics().bytes) / static_cast<double>(writer.statistics().patches));
+            state.set_counter("writer_waits", static_cast<double>(writer.statistics().waits));
+            writer.close();
+
+#ifdef _WIN32
+            consumer.join();
+#else
+            int status = 0;
+            ::waitpid(consumer, &status, 0);
+#endif
+        }
+        state.set_counter("patches", static_cast<double>(patches));
+        state.set_counter("patches/s", static_cast<double>(patches) * 1e9 / state.nanoseconds_per_iteration());
+    }
+} // namespace
+
+BENCHMARK(patch_stream_process, 1000, 10000, 100000);
@@ -0,0 +1,119 @@
+#include <random>
+#include <string>
+#include <vector>
+
+#include "allocation_counter.hpp"
+#include "benchmark.hpp"
+#include "vdom/persistent.hpp"
+#include "vdom/properties.hpp"
+
+namespace
+{
+    /**
+     * @brief Build a map of state.size() int keys to string values
+     *
+     */
+    vdom::Ref<const vdom::PersistentMap> build_map(std::size_t size)
+    {
+        vdom::Ref<const vdom::PersistentMap> map = vdom::PersistentMap::empty();
+        for (std::size_t key = 0; key < size; ++key)
+        {
+            const std::string value = "row " + std::to_string(key);
+            map = map->set(vdom::Value::integer(static_cast<std::int64_t>(key)), vdom::Value::string(value));
+        }
+        return map;
+    }
+
+    /**
+     * @brief Set 1000 random keys of a map of state.size() entries, keeping every version alive
+     *
+     */
+    void persistent_map_update(benchmark::State &state)
+    {
+        const vdom::Ref<const vdom::PersistentMap> base = build_map(state.size());
+        std::mt19937_64 random(state.size());
+        std::uniform_int_distribution<std::int64_t> key(0, static_cast<std::int64_t>(state.size()) - 1);
+
+        std::vector<vdom::Ref<const vdom::PersistentMap>> versions(1000);
+        std::size_t updates = 0;
+        const std::size_t heap_allocations = benchmark::heap_allocations();
+        state.measure([&]
+                      {
+                          vdom::Ref<const vdom::PersistentMap> map = base;
+                          for (vdom::Ref<const vdom::PersistentMap> &version : versions)
+                          {
+                              map = map->set(vdom::Value::integer(key(random)), vdom::Value::integer(static_cast<std::int64_t>(updates)));
+                              version = map;
+                              updates++;
+                          } });
+        state.set_counter("heap_allocs/update",
+                          static_cast<double>(benchmark::heap_allocations() - heap_allocations) / static_cast<double>(updates));
+        state.set_counter("entries", static_cast<double>(versions.back()->size()));
+    }
+
+    /**
+     * @brief Compare the properties of a memoized component holding the same map of state.size() entries, 1000 times
+     *
+     * As the parent passes the map on unchanged, the comparison is by identity.
+     */
+    void persistent_map_memo_compare(benchmark::State &state)
+    {
+        const vdom::Ref<const vdom::PersistentMap> map = build_map(state.size());
+        const vdom::Atom key = vdom::AtomTable::global().intern("rows");
+        vdom::Properties previous;
+        previous.set(key, vdom::Value::map(map.get()));
+
+        std::size_t equal = 0;
+        state.measure([&]
+                      {
+                          for (std::size_t index = 0; index < 1000; ++index)
+                          {
+                              vdom::Properties next;
+                              next.set(key, vdom::Value::map(map.get()));
+                              equal += next.hash() == previous.hash() && next == previous;
+                          } });
+        state.set_counter("equal", static_cast<double>(equal > 0));
+    }
+
+    /**
+     * @brief Compare the contents of two maps of state.size() entries built separately
+     *
+     * What comparing the properties would cost without identity, e.g. with dicts deep-compared in Python.
+     */
+    void persistent_map_deep_compare(benchmark::State &state)
+    {
+        const vdom::Ref<const vdom::PersistentMap> first = build_map(state.size());
+        const vdom::Ref<const vdom::PersistentMap> second = build_map(state.size());
+
+        bool equal = false;
+        state.measure([&]
+                      { equal = first->equals(*second); });
+        state.set_counter("equal", equal);
+    }
+
+    /**
+     * @brief Append state.size() integers to an empty vector, one version at a time
+     *
+     */
+    void persistent_vector_append(benchmark::State &state)
+    {
+        std::size_t appends = 0;
+        std::size_t size = 0;
+        const std::size_t heap_allocations = benchmark::heap_allocations();
+        state.measure([&]
+                      {
+                          vdom::Ref<const vdom::PersistentVector> vector = vdom::PersistentVector::empty();
+                          for (std::size_t index = 0; index < state.size(); ++index)
+                              vector = vector->push_back(vdom::Value::integer(static_cast<std::int64_t>(index)));
+                          size = vector->size();
+                          appends += state.size(); });
+        state.set_counter("heap_allocs/append",
+                          static_cast<double>(benchmark::heap_allocations() - heap_allocations) / static_cast<double>(appends));
+        state.set_counter("size", static_cast<double>(size));
+    }
+} // namespace
+
+BENCHMARK(persistent_map_update, 1000, 100000, 1000000);
+BENCHMARK(persistent_map_memo_compare, 1000, 100000, 1000000);
+BENCHMARK(persistent_map_deep_compare, 1000, 100000, 1000000);
+BENCHMARK(persistent_vector_append, 1000, 100000, 1000000);
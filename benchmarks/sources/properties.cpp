@@ -0,0 +1,134 @@
+#include <string>
+#include <vector>
+
+#include "benchmark.hpp"
+#include "vdom/properties.hpp"
+
+namespace
+{
+    constexpr std::size_t property_count = 8;
+
+    /**
+     * @brief Intern the names of the properties every set carries
+     *
+     */
+    const std::vector<vdom::Atom> &property_names()
+    {
+        static const std::vector<vdom::Atom> names = []
+        {
+            std::vector<vdom::Atom> atoms;
+            for (std::size_t index = 0; index < property_count; ++index)
+                atoms.push_back(vdom::AtomTable::global().intern("property-" + std::to_string(index)));
+            return atoms;
+        }();
+        return names;
+    }
+
+    /**
+     * @brief Fill a set with integer, string and boolean properties set in reverse key order
+     *
+     */
+    void fill(vdom::Properties &properties, std::size_t seed)
+    {
+        const std::vector<vdom::Atom> &names = property_names();
+        for (std::size_t index = property_count; index-- > 0;)
+        {
+            if (index % 3 == 0)
+                properties.set(names[index], vdom::Value::string("a property value"));
+            else if (index % 3 == 1)
+                properties.set(names[index], vdom::Value::integer(static_cast<std::int64_t>(seed + index)));
+            else
+                properties.set(names[index], vdom::Value::boolean((seed + index) % 2 == 0));
+        }
+    }
+
+    /**
+     * @brief Build state.size() sets of eight properties
+     *
+     */
+    void properties_set(benchmark::State &state)
+    {
+        std::vector<vdom::Properties> sets(state.size());
+
+        state.measure([&]
+                      {
+                          for (std::size_t index = 0; index < sets.size(); ++index)
+                          {
+                              sets[index].clear();
+                              fill(sets[index], index);
+                          } });
+    }
+
+    /**
+     * @brief Look up every property of state.size() sets
+     *
+     */
+    void properties_get(benchmark::State &state)
+    {
+        const std::vector<vdom::Atom> &names = property_names();
+        std::vector<vdom::Properties> sets(state.size());
+        for (std::size_t index = 0; index < sets.size(); ++index)
+            fill(sets[index], index);
+
+        std::size_t found = 0;
+        state.measure([&]
+                      {
+                          found = 0;
+                          for (const vdom::Properties &properties : sets)
+                              for (vdom::Atom name : names)
+                                  found += properties.get(name) != nullptr; });
+        state.set_counter("found", static_cast<double>(found));
+    }
+
+    /**
+     * @brief Compare state.size() pairs of equal sets in full, the worst case
+     *
+     */
+    void properties_compare(benchmark::State &state)
+    {
+        std::vector<vdom::Properties> sets(state.size());
+        std::vector<vdom::Properties> copies(state.size());
+        for (std::size_t index = 0; index < sets.size(); ++index)
+        {
+            fill(sets[index], index);
+            fill(copies[index], index);
+        }
+
+        std::size_t equal = 0;
+        state.measure([&]
+                      {
+                          equal = 0;
+                          for (std::size_t index = 0; index < sets.size(); ++index)
+                              equal += sets[index] == copies[index]; });
+        state.set_counter("equal", static_cast<double>(equal));
+    }
+
+    /**
+     * @brief Hash state.size() freshly mutated sets, as memoization does after an update
+     *
+     */
+    void properties_hash(benchmark::State &state)
+    {
+        const vdom::Atom name = property_names().front();
+        std::vector<vdom::Properties> sets(state.size());
+        for (std::size_t index = 0; index < sets.size(); ++index)
+            fill(sets[index], index);
+
+        std::uint64_t hashes = 0;
+        std::int64_t revision = 0;
+        state.measure([&]
+                      {
+                          revision++;
+                          for (vdom::Properties &properties : sets)
+                          {
+                              properties.set(name, vdom::Value::integer(revision));
+                              hashes ^= properties.hash();
+                          }
+                          benchmark::do_not_optimize(hashes); });
+    }
+} // namespace
+
+BENCHMARK(properties_set, 1000, 10000, 100000);
+BENCHMARK(properties_get, 1000, 10000, 100000);
+BENCHMARK(properties_compare, 1000, 10000, 100000);
+BENCHMARK(properties_hash, 1000, 10000, 100000);
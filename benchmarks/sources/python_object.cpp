@@ -0,0 +1,64 @@
+#include <vector>
+
+#include "benchmark.hpp"
+#include "python/gil.hpp"
+#include "python/object.hpp"
+#include "python_fixtures.hpp"
+
+namespace
+{
+    /**
+     * @brief Acquire and release the GIL state.size() times, as a thread entering Python would
+     *
+     */
+    void python_gil_acquire(benchmark::State &state)
+    {
+        benchmark::initialize_python();
+
+        state.measure([&]
+                      {
+                          for (std::size_t index = 0; index < state.size(); ++index)
+                              python::GIL gil; });
+    }
+
+    /**
+     * @brief Wrap state.size() new Python ints into handles, then drop them
+     *
+     */
+    void python_object_create(benchmark::State &state)
+    {
+        benchmark::initialize_python();
+        python::GIL gil;
+        std::vector<python::Object> handles;
+        handles.reserve(state.size());
+
+        state.measure([&]
+                      {
+                          for (std::size_t index = 0; index < state.size(); ++index)
+                              handles.emplace_back(PyLong_FromSize_t(index + 1024));
+                          handles.clear(); });
+    }
+
+    /**
+     * @brief Share one Python object into state.size() handles, then drop them
+     *
+     */
+    void python_object_share(benchmark::State &state)
+    {
+        benchmark::initialize_python();
+        python::GIL gil;
+        python::Object object(PyUnicode_FromString("component-engine"));
+        std::vector<python::Object> handles;
+        handles.reserve(state.size());
+
+        state.measure([&]
+                      {
+                          for (std::size_t index = 0; index < state.size(); ++index)
+                              handles.push_back(object.share());
+                          handles.clear(); });
+    }
+} // namespace
+
+BENCHMARK(python_gil_acquire, 1000, 10000, 100000);
+BENCHMARK(python_object_create, 1000, 10000, 100000);
+BENCHMARK(python_object_share, 1000, 10000, 100000);
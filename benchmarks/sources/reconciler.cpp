@@ -0,0 +1,82 @@
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+#include "benchmark.hpp"
+#include "fixtures.hpp"
+#include "vdom/reconciler.hpp"
+
+namespace
+{
+    /**
+     * @brief Time the diff of a mounted list of state.size() rows against a rearranged one
+     *
+     */
+    template <typename Rearrange>
+    void diff_list(benchmark::State &state, Rearrange rearrange)
+    {
+        std::vector<std::int64_t> keys(state.size());
+        std::iota(keys.begin(), keys.end(), 0);
+
+        vdom::Tree empty;
+        vdom::Tree old_tree;
+        vdom::Tree new_tree;
+        vdom::Reconciler reconciler;
+        vdom::PatchList patches;
+
+        benchmark::build_list(old_tree, keys);
+        reconciler.diff(empty, old_tree, patches);
+
+        std::mt19937_64 random(state.size());
+        rearrange(keys, random);
+        benchmark::build_list(new_tree, keys);
+
+        state.measure([&]
+                      {
+                          patches.clear();
+                          reconciler.diff(old_tree, new_tree, patches); });
+        state.set_counter("patches", static_cast<double>(patches.size()));
+    }
+
+    void reconcile_unchanged(benchmark::State &state)
+    {
+        diff_list(state, [](std::vector<std::int64_t> &, std::mt19937_64 &) {});
+    }
+
+    void reconcile_reverse(benchmark::State &state)
+    {
+        diff_list(state, [](std::vector<std::int64_t> &keys, std::mt19937_64 &)
+                  { std::reverse(keys.begin(), keys.end()); });
+    }
+
+    void reconcile_shuffle(benchmark::State &state)
+    {
+        diff_list(state, [](std::vector<std::int64_t> &keys, std::mt19937_64 &random)
+                  { std::shuffle(keys.begin(), keys.end(), random); });
+    }
+
+    /**
+     * @brief Swap 10% of the rows, drop 1% and insert 1% new ones
+     *
+     */
+    void reconcile_partial_reorder(benchmark::State &state)
+    {
+        diff_list(state, [](std::vector<std::int64_t> &keys, std::mt19937_64 &random)
+                  {
+                      const std::size_t size = keys.size();
+                      std::uniform_int_distribution<std::size_t> position(0, size - 1);
+
+                      for (std::size_t swap = 0; swap < size / 20; ++swap)
+                          std::swap(keys[position(random)], keys[position(random)]);
+                      for (std::size_t removal = 0; removal < size / 100; ++removal)
+                          keys.erase(keys.begin() + static_cast<std::ptrdiff_t>(position(random) % keys.size()));
+                      for (std::size_t insertion = 0; insertion < size / 100; ++insertion)
+                          keys.insert(keys.begin() + static_cast<std::ptrdiff_t>(position(random) % keys.size()),
+                                      static_cast<std::int64_t>(size + insertion)); });
+    }
+} // namespace
+
+BENCHMARK(reconcile_unchanged, 1000, 10000, 100000);
+BENCHMARK(reconcile_partial_reorder, 1000, 10000, 100000);
+BENCHMARK(reconcile_shuffle, 1000, 10000, 100000);
+BENCHMARK(reconcile_reverse, 1000, 10000, 100000);
@@ -0,0 +1,436 @@
+#include <chrono>
+#include <future>
+#include <memory>
+#include <vector>
+
+#include "benchmark.hpp"
+#include "python/gil.hpp"
+#include "python/properties_type.hpp"
+#include "python/render_cache.hpp"
+#include "python/subinterpreter.hpp"
+#include "python/tree_builder.hpp"
+#include "python_fixtures.hpp"
+#include "ssr/html_writer.hpp"
+#include "vdom/reconciler.hpp"
+
+namespace
+{
+    /**
+     * @brief Synthetic application: a table of rows of two cells, five nodes per row
+     *
+     * Elements and components are duck-typed like those of the Python
+     * package, which the benchmarks do not import; component properties are
+     * native Properties. Every hundredth row shows the table revision, so
+     * successive frames change one row in a hundred. A Board keeps its rows
+     * instead, and updates every hundredth one in place.
+     */
+    constexpr const char *application_source = R"(
+def properties(**values):
+    result = Properties()
+    for name, value in values.items():
+        result.set_property(name, value)
+    return result
+
+
+class Element:
+    __slots__ = ("tag", "key", "properties", "children")
+
+    def __init__(self, tag, properties=None, children=None, key=None):
+        self.tag = tag
+        self.key = key
+        self.properties = properties
+        self.children = children
+
+
+class Cell:
+    pure = True
+
+    def __init__(self, properties):
+        self.properties = properties
+
+    def render(self):
+        return Element("td", {"class": "cell"}, [self.properties.get_property("text")])
+
+
+class Row:
+    pure = True
+
+    def __init__(self, properties):
+        self.properties = properties
+
+    def render(self):
+        index = self.properties.get_property("index")
+        revision = self.properties.get_property("revision")
+        cells = [Cell(properties(text=f"row {index}")), Cell(properties(text=f"revision {revision}"))]
+        return Element("tr", {"class": "row"}, cells, key=index)
+
+
+class Table:
+    def __init__(self, rows):
+        self.rows = rows
+        self.revision = 0
+
+    def render(self):
+        rows = [Row(properties(index=index, revision=self.revision if index % 100 == 0 else 0)) for index in range(self.rows)]
+        return Element("table", None, rows)
+
+
+class Board:
+    def __init__(self, rows):
+        self.rows = [Row(properties(index=index, revision=0)) for index in range(rows)]
+
+    def render(self):
+        return Element("table", None, self.rows)
+
+    def update(self, revision):
+        changed = self.rows[::100]
+        for row in changed:
+            row.properties.set_property("revision", revision)
+        return changed
+)";
+
+    /**
+     * @brief Pure Python stand-in for Properties, for interpreters that cannot share the native type
+     *
+     */
+    constexpr const char *dict_properties_source = R"(
+class Properties(dict):
+    def set_property(self, name, value):
+        self[name] = value
+
+    def get_property(self, name):
+        return self[name]
+)";
+
+    constexpr std::size_t nodes_per_row = 5;
+
+    python::Object make_table(std::size_t nodes, bool native_properties = true, const char *type = "Table")
+    {
+        python::Object names(PyDict_New());
+        if (native_properties)
+        {
+            PyTypeObject *properties_type = python::properties_type();
+            if (!properties_type || PyDict_SetItemString(names.get(), "Properties", reinterpret_cast<PyObject *>(properties_type)) < 0)
+                python::Object::throw_error_occurred();
+        }
+        else
+        {
+            python::Object definitions = benchmark::run_python(dict_properties_source);
+            if (PyDict_SetItemString(names.get(), "Properties", PyDict_GetItemString(definitions.get(), "Properties")) < 0)
+                python::Object::throw_error_occurred();
+        }
+
+        python::Object application = benchmark::run_python(application_source, names.get());
+        python::Object rows(PyLong_FromSize_t(nodes / nodes_per_row));
+        return python::Object(PyObject_CallOneArg(PyDict_GetItemString(application.get(), type), rows.get()));
+    }
+
+    void next_revision(PyObject *table, std::int64_t revision)
+    {
+        python::Object value(PyLong_FromLongLong(revision));
+        if (PyObject_SetAttrString(table, "revision", value.get()) < 0)
+            python::Object::throw_error_occurred();
+    }
+
+    /**
+     * @brief Render a component tree of about state.size() nodes from scratch, as the module's render() does
+     *
+     */
+    void render_components(benchmark::State &state)
+    {
+        benchmark::initialize_python();
+        python::GIL gil;
+        python::Object table = make_table(state.size());
+        vdom::Tree tree;
+        python::TreeBuilder builder(tree, vdom::AtomTable::global());
+
+        state.measure([&]
+                      { builder.build(table.get()); });
+        state.set_counter("nodes", static_cast<double>(tree.size()));
+    }
+
+    /**
+     * @brief Render state.size() leaf components rendering nothing, so that the cost of calling render() dominates
+     *
+     */
+    void render_calls(benchmark::State &state)
+    {
+        constexpr const char *source = R"(
+class Element:
+    __slots__ = ("tag", "key", "properties", "children")
+
+    def __init__(self, tag, children):
+        self.tag = tag
+        self.key = None
+        self.properties = None
+        self.children = children
+
+
+class Leaf:
+    def render(self):
+        return None
+
+
+def make_list(size):
+    return Element("div", [Leaf() for _ in range(size)])
+)";
+
+        benchmark::initialize_python();
+        python::GIL gil;
+        python::Object definitions = benchmark::run_python(source);
+        python::Object size(PyLong_FromSize_t(state.size()));
+        python::Object list(PyObject_CallOneArg(PyDict_GetItemString(definitions.get(), "make_list"), size.get()));
+        vdom::Tree tree;
+        python::TreeBuilder builder(tree, vdom::AtomTable::global());
+
+        state.measure([&]
+                      { builder.build(list.get()); });
+        state.set_counter("nodes", static_cast<double>(tree.size()));
+    }
+
+    /**
+     * @brief Render and diff successive frames of about state.size() nodes, one row in a hundred changing
+     *
+     */
+    void render_frame(benchmark::State &state)
+    {
+        benchmark::initialize_python();
+        python::GIL gil;
+        python::Object table = make_table(state.size());
+        vdom::Tree mounted;
+        vdom::Tree next;
+        vdom::Reconciler reconciler;
+        vdom::PatchList patches;
+        std::int64_t revision = 0;
+
+        python::TreeBuilder(mounted, vdom::AtomTable::global()).build(table.get());
+        state.measure([&]
+                      {
+                          next_revision(table.get(), ++revision);
+                          python::TreeBuilder(next, vdom::AtomTable::global()).build(table.get());
+                          patches.clear();
+                          reconciler.diff(mounted, next, patches);
+                          std::swap(mounted, next); });
+        state.set_counter("patches", static_cast<double>(patches.size()));
+    }
+
+    /**
+     * @brief Same frames as render_frame, memoized by a RenderCache
+     *
+     * Rows are recreated by every render(); they are pure, so those whose
+     * properties compare equal to their predecessor at the same position are
+     * not rendered again, and their nodes are copied from the mounted tree.
+     */
+    void render_frame_memoized(benchmark::State &state)
+    {
+        benchmark::initialize_python();
+        python::GIL gil;
+        python::Object table = make_table(state.size());
+        python::RenderCache cache;
+        vdom::Tree mounted;
+        vdom::Tree next;
+        vdom::Reconciler reconciler;
+        vdom::PatchList patches;
+        std::int64_t revision = 0;
+
+        auto build = [&](vdom::Tree &tree, const vdom::Tree *previous)
+        {
+            cache.invalidate(table.get());
+            cache.begin_frame();
+            python::TreeBuilder(tree, vdom::AtomTable::global(), &cache, nullptr, previous).build(table.get());
+            cache.end_frame([](PyObject *) {});
+        };
+
+        build(mounted, nullptr);
+        const std::uint64_t skipped_renders = cache.statistics().skipped_renders;
+        std::size_t frames = 0;
+        state.measure([&]
+                      {
+                          next_revision(table.get(), ++revision);
+                          build(next, &mounted);
+                          patches.clear();
+                          reconciler.diff(mounted, next, patches);
+                          std::swap(mounted, next);
+                          frames++; });
+        state.set_counter("patches", static_cast<double>(patches.size()));
+        state.set_counter("skipped_renders/frame",
+                          static_cast<double>(cache.statistics().skipped_renders - skipped_renders) / static_cast<double>(frames));
+    }
+
+    /**
+     * @brief Same changes as render_frame, made to the mounted rows of a Board and built from the dirty rows alone
+     *
+     * The updated rows are handed to the builder as dirty: only they render,
+     * and the rest of the mounted tree is copied around their new nodes.
+     */
+    void render_frame_dirty(benchmark::State &state)
+    {
+        benchmark::initialize_python();
+        python::GIL gil;
+        python::Object board = make_table(state.size(), true, "Board");
+        python::Object update(PyObject_GetAttrString(board.get(), "update"));
+        python::RenderCache cache;
+        vdom::Tree mounted;
+        vdom::Tree next;
+        vdom::Reconciler reconciler;
+        vdom::PatchList patches;
+        std::vector<PyObject *> dirty;
+        std::int64_t revision = 0;
+
+        auto build = [&](vdom::Tree &tree, const vdom::Tree *previous)
+        {
+            cache.begin_frame();
+            python::TreeBuilder(tree, vdom::AtomTable::global(), &cache, nullptr, previous).build(board.get(), dirty);
+            cache.end_frame([](PyObject *) {});
+        };
+
+        build(mounted, nullptr);
+        const std::uint64_t renders = cache.statistics().renders;
+        std::size_t frames = 0;
+        state.measure([&]
+                      {
+                          python::Object value(PyLong_FromLongLong(++revision));
+                          python::Object changed = update.call(value.get());
+                          dirty.clear();
+                          for (Py_ssize_t index = 0; index < PyList_GET_SIZE(changed.get()); ++index)
+                          {
+                              dirty.push_back(PyList_GET_ITEM(changed.get(), index));
+                              cache.invalidate(dirty.back());
+                          }
+                          build(next, &mounted);
+                          patches.clear();
+                          reconciler.diff(mounted, next, patches);
+                          std::swap(mounted, next);
+                          frames++; });
+        state.set_counter("patches", static_cast<double>(patches.size()));
+        state.set_counter("renders/frame", static_cast<double>(cache.statistics().renders - renders) / static_cast<double>(frames));
+    }
+
+    /**
+     * @brief Render a component tree of about state.size() nodes straight to HTML, streamed in chunks
+     *
+     * The first_chunk_us counter is the delay before the first chunk reaches
+     * the sink, the time to first byte of a server.
+     */
+    void render_html_stream(benchmark::State &state)
+    {
+        using clock = std::chrono::steady_clock;
+
+        benchmark::initialize_python();
+        python::GIL gil;
+        python::Object table = make_table(state.size());
+        vdom::Tree tree;
+        std::size_t bytes = 0;
+        clock::time_point first_chunk;
+        ssr::HtmlWriter writer([&](std::string_view chunk)
+                               {
+                                   if (bytes == 0)
+                                       first_chunk = clock::now();
+                                   bytes += chunk.size(); });
+        python::TreeBuilder builder(tree, vdom::AtomTable::global(), nullptr, &writer);
+
+        state.measure([&]
+                      {
+                          bytes = 0;
+                          builder.build(table.get());
+                          writer.flush(); });
+
+        bytes = 0;
+        const clock::time_point start = clock::now();
+        builder.build(table.get());
+        writer.flush();
+        state.set_counter("MB/s", static_cast<double>(bytes) * 1e3 / state.nanoseconds_per_iteration());
+        state.set_counter("first_chunk_us", std::chrono::duration<double, std::micro>(first_chunk - start).count());
+        state.set_counter("tree_nodes", static_cast<double>(tree.size()));
+    }
+
+    /**
+     * @brief One independent root of render_roots, built and diffed where it lives
+     *
+     */
+    struct Root
+    {
+        python::Object table;
+        vdom::Tree mounted;
+        vdom::Tree next;
+        vdom::Reconciler reconciler;
+        vdom::PatchList patches;
+        std::int64_t revision = 0;
+
+        explicit Root(std::size_t nodes) : table(make_table(nodes, false))
+        {
+            python::TreeBuilder(mounted, vdom::AtomTable::global()).build(table.get());
+        }
+
+        void frame()
+        {
+            next_revision(table.get(), ++revision);
+            python::TreeBuilder(next, vdom::AtomTable::global()).build(table.get());
+            patches.clear();
+            reconciler.diff(mounted, next, patches);
+            std::swap(mounted, next);
+        }
+    };
+
+    /**
+     * @brief Render a frame of four independent roots of state.size() / 4 nodes each
+     *
+     * Each root lives in its own subinterpreter when the engine is built
+     * against Python 3.12 or later, so that frames render in parallel;
+     * otherwise the roots share the main interpreter and render one after
+     * the other. The "subinterpreters" counter tells which one was measured.
+     */
+    void render_roots(benchmark::State &state)
+    {
+        constexpr std::size_t root_count = 4;
+        benchmark::initialize_python();
+        const std::size_t nodes = state.size() / root_count;
+
+        if constexpr (!python::Subinterpreter::supported())
+        {
+            python::GIL gil;
+            std::vector<std::unique_ptr<Root>> roots;
+            for (std::size_t index = 0; index < root_count; ++index)
+                roots.push_back(std::make_unique<Root>(nodes));
+            state.measure([&]
+                          {
+                              for (auto &root : roots)
+                                  root->frame(); });
+            state.set_counter("subinterpreters", 0);
+            return;
+        }
+
+        // Every Python object of a root is created and released by its own interpreter
+        std::vector<std::unique_ptr<python::Subinterpreter>> interpreters;
+        std::vector<std::unique_ptr<Root>> roots(root_count);
+        for (std::size_t index = 0; index < root_count; ++index)
+        {
+            interpreters.push_back(std::make_unique<python::Subinterpreter>());
+            interpreters[index]->submit([&, index]
+                                        { roots[index] = std::make_unique<Root>(nodes); })
+                .get();
+        }
+
+        std::vector<std::future<void>> frames(root_count);
+        state.measure([&]
+                      {
+                          for (std::size_t index = 0; index < root_count; ++index)
+                              frames[index] = interpreters[index]->submit([&, index]
+                                                                          { roots[index]->frame(); });
+                          for (auto &frame : frames)
+                              frame.get(); });
+        for (std::size_t index = 0; index < root_count; ++index)
+            interpreters[index]->submit([&, index]
+                                        { roots[index].reset(); })
+                .get();
+        state.set_counter("subinterpreters", root_count);
+    }
+} // namespace
+
+BENCHMARK(render_components, 1000, 10000, 100000);
+BENCHMARK(render_calls, 1000, 10000, 100000);
+BENCHMARK(render_frame, 1000, 10000, 100000);
+BENCHMARK(render_frame_memoized, 1000, 10000, 100000);
+BENCHMARK(render_frame_dirty, 1000, 10000, 100000);
+BENCHMARK(render_html_stream, 1000, 10000, 100000);
+BENCHMARK(render_roots, 4000, 40000, 400000);
@@ -0,0 +1,47 @@
+#include <random>
+
+#include "benchmark.hpp"
+#include "layout/row_index.hpp"
+
+namespace
+{
+    /**
+     * @brief Build a RowIndex of state.size() rows of the estimated height
+     *
+     */
+    void row_index_build(benchmark::State &state)
+    {
+        double total = 0;
+        state.measure([&]
+                      {
+                          layout::RowIndex rows(state.size(), 20);
+                          total = rows.total(); });
+        state.set_counter("total", total);
+    }
+
+    /**
+     * @brief Scroll a list of state.size() rows: measure a row, then find the rows in view, 1000 times
+     *
+     */
+    void row_index_scroll(benchmark::State &state)
+    {
+        layout::RowIndex rows(state.size(), 20);
+        std::mt19937_64 random(state.size());
+        std::uniform_int_distribution<std::size_t> row(0, state.size() - 1);
+        std::uniform_real_distribution<float> height(12, 60);
+
+        layout::RowIndex::Window window;
+        state.measure([&]
+                      {
+                          for (std::size_t index = 0; index < 1000; ++index)
+                          {
+                              const std::size_t measured = row(random);
+                              rows.set_height(measured, height(random));
+                              window = rows.window(rows.offset(measured), 800, 8);
+                          } });
+        state.set_counter("rows/window", static_cast<double>(window.last - window.first));
+    }
+} // namespace
+
+BENCHMARK(row_index_build, 1000, 100000, 1000000);
+BENCHMARK(row_index_scroll, 1000, 100000, 1000000);
@@ -0,0 +1,65 @@
+#include <cmath>
+#include <filesystem>
+
+#include "benchmark.hpp"
+#include "fixtures.hpp"
+#include "snapshot/snapshot.hpp"
+#include "vdom/reconciler.hpp"
+
+namespace
+{
+    /**
+     * @brief A mounted tree of sections of rows, about state.size() nodes, and a snapshot file path
+     *
+     */
+    struct Fixture
+    {
+        vdom::Tree tree;
+        std::filesystem::path path;
+
+        explicit Fixture(std::size_t nodes)
+            : path(std::filesystem::temp_directory_path() / ("benchmark-" + std::to_string(nodes) + ".snapshot"))
+        {
+            vdom::Tree empty;
+            vdom::Reconciler reconciler;
+            vdom::PatchList patches;
+            benchmark::build_sections(tree, nodes / 2, std::sqrt(nodes / 2));
+            reconciler.diff(empty, tree, patches);
+        }
+
+        ~Fixture()
+        {
+            std::error_code error;
+            std::filesystem::remove(path, error);
+        }
+    };
+
+    /**
+     * @brief Save a tree of about state.size() nodes to a snapshot file
+     *
+     */
+    void snapshot_save(benchmark::State &state)
+    {
+        Fixture fixture(state.size());
+        state.measure([&]
+                      { snapshot::write(fixture.tree, fixture.path); });
+        state.set_counter("bytes", static_cast<double>(std::filesystem::file_size(fixture.path)));
+    }
+
+    /**
+     * @brief Map a snapshot of about state.size() nodes and mount its tree, as a warm start does
+     *
+     */
+    void snapshot_mount(benchmark::State &state)
+    {
+        Fixture fixture(state.size());
+        snapshot::write(fixture.tree, fixture.path);
+        vdom::Tree mounted;
+        state.measure([&]
+                      { snapshot::Snapshot(fixture.path).mount(mounted); });
+        state.set_counter("nodes", static_cast<double>(mounted.size()));
+    }
+} // namespace
+
+BENCHMARK(snapshot_save, 1000, 10000, 100000);
+BENCHMARK(snapshot_mount, 1000, 10000, 100000);
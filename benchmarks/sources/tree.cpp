@@ -0,0 +1,38 @@
+#include <numeric>
+
+#include "benchmark.hpp"
+#include "fixtures.hpp"
+
+namespace
+{
+    /**
+     * @brief Build a list of state.size() rows into a reused tree
+     *
+     */
+    void tree_build_list(benchmark::State &state)
+    {
+        std::vector<std::int64_t> keys(state.size());
+        std::iota(keys.begin(), keys.end(), 0);
+        vdom::Tree tree;
+
+        state.measure([&]
+                      { benchmark::build_list(tree, keys); });
+        state.set_counter("nodes", static_cast<double>(tree.size()));
+    }
+
+    /**
+     * @brief Build state.size() rows split into 64 sections into a reused tree
+     *
+     */
+    void tree_build_sections(benchmark::State &state)
+    {
+        vdom::Tree tree;
+
+        state.measure([&]
+                      { benchmark::build_sections(tree, state.size(), 64); });
+        state.set_counter("nodes", static_cast<double>(tree.size()));
+    }
+} // namespace
+
+BENCHMARK(tree_build_list, 1000, 10000, 100000);
+BENCHMARK(tree_build_sections, 1000, 10000, 100000);
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <Python.h>
+
+#include "vdom/patch.hpp"
+
+namespace bindings
+{
+    /**
+     * @brief Instance layout of the PatchList Python type
+     *
+     * The list keeps the tree it was computed for alive, since string values
+     * of the patches point into that tree.
+     */
+    struct PatchListObject
+    {
+        PyObject_HEAD
+        vdom::PatchList patches;
+        PyObject *tree;
+    };
+
+    /**
+     * @brief Get the PatchList Python type, of the calling interpreter, see python::interpreter_type()
+     *
+     * Items are tuples (type, node, parent, before, name, value), where type is
+     * one of the module's CREATE, REMOVE, MOVE, SET_PROPERTY, REMOVE_PROPERTY and
+     * SET_TEXT constants, nodes are integer handles (0 for none), name is the
+     * tag or property name or None, and value is the text or property value.
+     *
+     * @return PyTypeObject* The type, or nullptr with a Python error set
+     */
+    PyTypeObject *patch_list_type();
+
+    /**
+     * @brief Create an empty PatchList bound to a Tree object
+     *
+     * @param tree The Tree object the patches will point into
+     * @return PyObject* A new reference, or nullptr with a Python error set
+     */
+    PyObject *new_patch_list(PyObject *tree);
+
+    /**
+     * @brief Get the vdom::PatchList of a PatchList object
+     *
+     */
+    inline vdom::PatchList &patches_of(PyObject *object)
+    {
+        return reinterpret_cast<PatchListObject *>(object)->patches;
+    }
+} // namespace bindings
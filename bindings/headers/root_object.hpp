@@ -0,0 +1,115 @@
+#pragma once
+
+#include <Python.h>
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "engine/job.hpp"
+#include "engine/parallel_reconciler.hpp"
+#include "engine/scheduler.hpp"
+#include "layout/layout_tree.hpp"
+#include "memory/arena.hpp"
+#include "python/event_table.hpp"
+#include "python/object.hpp"
+#include "python/render_cache.hpp"
+#include "python/tree_builder.hpp"
+#include "tree_object.hpp"
+#include "vdom/hoister.hpp"
+
+namespace bindings
+{
+    /**
+     * @brief A frame being rendered in time slices
+     *
+     * The job builds the new tree, then diffs it, suspending whenever the
+     * deadline of the current slice has passed. Dropping the frame abandons
+     * it: the mounted tree stays untouched.
+     */
+    struct RootFrame
+    {
+        python::Object tree;
+        python::Object old_tree;
+        TreeUse old_tree_use; ///< Read across the yields of a sliced frame
+        python::Object patch_list;
+        python::TreeBuilder builder;
+        std::vector<engine::Scheduler::Update> updates;
+        engine::Lane lane;
+        engine::Deadline deadline;
+        engine::Job job;
+
+        RootFrame(python::Object new_tree, python::Object mounted_tree, python::RenderCache &cache,
+                  std::span<const python::TreeBuilder::Handler> mounted_handlers);
+    };
+
+    /**
+     * @brief Instance layout of the Root Python type
+     *
+     * A root mounts one component and turns the updates scheduled on its
+     * descendants into one patch list per frame. Between frames, `tree` is
+     * the mounted Tree object, nullptr before the first flush, and `frame`
+     * the unfinished frame of render_slice(), if any. `events` delegates the
+     * input events of the mounted tree to the handlers its elements declare,
+     * and `hoister` marks the subtrees that stay unchanged across frames, so
+     * that the diff skips them.
+     *
+     * Each frame builds its tree and patch list in a memory::Arena of
+     * `arenas`. Frames alternate between two of them, since the mounted tree
+     * is still read while the next one is built; an arena still used by a
+     * Tree or PatchList kept from an earlier frame is left to them and
+     * replaced. `reconciler` keeps its scratch buffers across frames instead.
+     * Once frames stop growing, building and diffing them takes no memory
+     * from the heap.
+     *
+     * A frame only renders the components scheduled for it: each outermost
+     * dirty component is built again in place of its nodes in a copy of the
+     * mounted tree, see python::TreeBuilder::start(), and every other
+     * subtree is copied with its handles, so that the diff skips it;
+     * `handlers` are the event handlers of the mounted tree, copied along.
+     * The first frame, and any frame updating the root component, builds
+     * the whole tree from `component` instead, copying the nodes of the
+     * clean components found on the way from the mounted tree.
+     *
+     * Once compute_layout() was called, `layout` mirrors the mounted tree
+     * through the patch list of every frame, so that backends can ask for
+     * the boxes of its nodes; until then frames skip it.
+     *
+     * The Python object header and the weak reference list live in the
+     * standard-layout RootHead base, since tp_weaklistoffset is taken with
+     * offsetof(); Py_TPFLAGS_MANAGED_WEAKREF needs Python 3.12.
+     */
+    struct RootHead
+    {
+        PyObject_HEAD
+        PyObject *component;
+        PyObject *tree;
+        PyObject *weak_references;
+    };
+
+    struct RootObject : RootHead
+    {
+        bool flushing;
+        engine::Scheduler scheduler;
+        python::RenderCache cache;
+        engine::ParallelReconciler reconciler;
+        vdom::Hoister hoister;
+        std::unique_ptr<RootFrame> frame;
+        std::vector<python::TreeBuilder::Handler> handlers;
+        python::EventTable events;
+        std::uint64_t abandoned_frames;
+        std::vector<std::shared_ptr<memory::Arena>> arenas;
+        std::uint64_t retired_arena_chunks; ///< Chunks allocated by the arenas left to older frames
+        std::uint64_t detached_arenas;
+        layout::LayoutTree layout;
+        bool laying_out; ///< Whether `layout` follows the frames, from the first compute_layout() on
+    };
+
+    /**
+     * @brief Get the Root Python type, of the calling interpreter, see python::interpreter_type()
+     *
+     * @return PyTypeObject* The type, or nullptr with a Python error set
+     */
+    PyTypeObject *root_type();
+} // namespace bindings
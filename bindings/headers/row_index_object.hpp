@@ -0,0 +1,25 @@
+#pragma once
+
+#include <Python.h>
+
+#include "layout/row_index.hpp"
+
+namespace bindings
+{
+    /**
+     * @brief Instance layout of the RowIndex Python type, a layout::RowIndex
+     *
+     */
+    struct RowIndexObject
+    {
+        PyObject_HEAD
+        layout::RowIndex rows;
+    };
+
+    /**
+     * @brief Get the RowIndex Python type, of the calling interpreter, see python::interpreter_type()
+     *
+     * @return PyTypeObject* The type, or nullptr with a Python error set
+     */
+    PyTypeObject *row_index_type();
+} // namespace bindings
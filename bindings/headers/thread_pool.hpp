@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+#include "engine/thread_pool.hpp"
+
+namespace bindings
+{
+    /**
+     * @brief Get the pool diffs run on
+     *
+     * Hold the returned pointer while diffing, the pool may be replaced meanwhile.
+     * The pool is shared by every interpreter of the process.
+     *
+     * @return std::shared_ptr<engine::ThreadPool> The pool, null when diffing on the calling thread only
+     */
+    std::shared_ptr<engine::ThreadPool> diff_pool();
+
+    /**
+     * @brief Replace the pool diffs run on, from any thread
+     *
+     * @param threads The number of threads per diff, counting the calling thread; 1 for no pool
+     */
+    void set_diff_threads(std::size_t threads);
+
+    /**
+     * @brief Get the number of threads per diff
+     *
+     * @return std::size_t The thread count, counting the calling thread
+     */
+    std::size_t diff_threads();
+} // namespace bindings
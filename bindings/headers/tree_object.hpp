@@ -0,0 +1,124 @@
+#pragma once
+
+#include <Python.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "memory/arena.hpp"
+#include "snapshot/snapshot.hpp"
+#include "vdom/tree.hpp"
+
+namespace bindings
+{
+    /**
+     * @brief Instance layout of the Tree Python type, a rendered vdom::Tree
+     *
+     * `arena` is the memory::Arena the tree allocates from, if any, which the
+     * tree keeps alive; `readers` and `writing` count the TreeUse in progress.
+     * A tree loaded from a snapshot keeps the `components` that rendered it,
+     * for Root.hydrate().
+     */
+    struct TreeObject
+    {
+        PyObject_HEAD
+        std::shared_ptr<memory::Arena> arena;
+        vdom::Tree tree;
+        std::vector<snapshot::Component> components;
+        std::uint32_t readers;
+        bool writing;
+    };
+
+    enum class TreeAccess
+    {
+        Read,
+        Write
+    };
+
+    /**
+     * @brief Marks a Tree object as read or written by code running without the GIL
+     *
+     * diff(), save_snapshot() and Root frames work on trees with the GIL
+     * released, while other Python threads may reach the same Tree objects,
+     * e.g. through Root.tree. A TreeUse is taken with the GIL held before
+     * releasing it, and dropped once the GIL is taken back. Taking one that
+     * conflicts with a use in progress, i.e. writing a tree in use or reading
+     * a tree being written, throws rather than racing.
+     */
+    class TreeUse
+    {
+    private:
+        TreeObject *_tree;
+        TreeAccess _access;
+
+    protected:
+    public:
+        /**
+         * @brief Start using a tree; the GIL must be held
+         *
+         * @param tree A Tree object, or nullptr for none
+         * @param access Whether the tree is only read, or also written
+         * @throw std::runtime_error If another thread is writing the tree, or reading it when access is Write
+         */
+        TreeUse(PyObject *tree, TreeAccess access);
+
+        TreeUse(const TreeUse &) = delete;
+        TreeUse &operator=(const TreeUse &) = delete;
+
+        /**
+         * @brief Stop using the tree; the GIL must be held
+         *
+         */
+        ~TreeUse();
+    };
+
+    /**
+     * @brief Get the Tree Python type, of the calling interpreter, see python::interpreter_type()
+     *
+     * @return PyTypeObject* The type, or nullptr with a Python error set
+     */
+    PyTypeObject *tree_type();
+
+    /**
+     * @brief Create an empty Tree object
+     *
+     * @param arena The arena to allocate the tree from, nullptr for the default resource
+     * @return PyObject* A new reference, or nullptr with a Python error set
+     */
+    PyObject *new_tree(std::shared_ptr<memory::Arena> arena = nullptr);
+
+    /**
+     * @brief Tell whether an object is a Tree
+     *
+     */
+    bool is_tree(PyObject *object);
+
+    /**
+     * @brief Get the vdom::Tree of a Tree object
+     *
+     */
+    inline vdom::Tree &tree_of(PyObject *object)
+    {
+        return reinterpret_cast<TreeObject *>(object)->tree;
+    }
+
+    /**
+     * @brief Get the arena a Tree object allocates from
+     *
+     * @return memory::Arena* The arena, nullptr for the default resource
+     */
+    inline memory::Arena *arena_of(PyObject *object)
+    {
+        return reinterpret_cast<TreeObject *>(object)->arena.get();
+    }
+
+    /**
+     * @brief Get the components that rendered the tree of a Tree object, empty unless it was loaded from a snapshot
+     *
+     */
+    inline std::vector<snapshot::Component> &components_of(PyObject *object)
+    {
+        return reinterpret_cast<TreeObject *>(object)->components;
+    }
+} // namespace bindings
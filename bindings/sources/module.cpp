@@ -0,0 +1,403 @@
+#include <Python.h>
+
+#include <cerrno>
+#include <climits>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <system_error>
+
+#include "engine/parallel_reconciler.hpp"
+#include "patch_list_object.hpp"
+#include "python/errors.hpp"
+#include "python/gil.hpp"
+#include "python/object.hpp"
+#include "python/event_table.hpp"
+#include "python/persistent_type.hpp"
+#include "python/properties_type.hpp"
+#include "python/tree_builder.hpp"
+#include "root_object.hpp"
+#include "row_index_object.hpp"
+#include "snapshot/snapshot.hpp"
+#include "ssr/html_writer.hpp"
+#include "thread_pool.hpp"
+#include "trace/tracer.hpp"
+#include "tree_object.hpp"
+
+namespace
+{
+    PyObject *render(PyObject *, PyObject *const *args, Py_ssize_t nargs)
+    {
+        if (nargs != 1)
+            return PyErr_Format(PyExc_TypeError, "render() takes exactly 1 argument (%zd given)", nargs);
+
+        auto body = [&]() -> PyObject *
+        {
+            python::Object tree(bindings::new_tree());
+            python::TreeBuilder builder(bindings::tree_of(tree.get()));
+            builder.build(args[0]);
+            return tree.release();
+        };
+        return python::guarded(body);
+    }
+
+    PyObject *render_html(PyObject *, PyObject *const *args, Py_ssize_t nargs)
+    {
+        if (nargs < 2 || nargs > 3)
+            return PyErr_Format(PyExc_TypeError, "render_html() takes 2 or 3 arguments (%zd given)", nargs);
+        if (!PyLong_Check(args[1]) && !PyCallable_Check(args[1]))
+            return PyErr_Format(PyExc_TypeError, "render_html() output must be a file descriptor or a callable, not '%s'",
+                                Py_TYPE(args[1])->tp_name);
+
+        Py_ssize_t chunk_size = ssr::HtmlWriter::default_chunk_size;
+        if (nargs == 3)
+        {
+            chunk_size = PyLong_AsSsize_t(args[2]);
+            if (chunk_size == -1 && PyErr_Occurred())
+                return nullptr;
+            if (chunk_size < 1)
+                return PyErr_Format(PyExc_ValueError, "chunk size must be at least 1, not %zd", chunk_size);
+        }
+
+        auto body = [&]() -> PyObject *
+        {
+            ssr::Sink sink;
+            if (PyLong_Check(args[1]))
+            {
+                long descriptor = PyLong_AsLong(args[1]);
+                if (descriptor == -1 && PyErr_Occurred())
+                    return nullptr;
+                if (descriptor < 0 || descriptor > INT_MAX)
+                    return PyErr_Format(PyExc_ValueError, "invalid file descriptor %ld", descriptor);
+                sink = ssr::descriptor_sink(static_cast<int>(descriptor));
+            }
+            else
+            {
+                PyObject *write = args[1];
+                sink = [write](std::string_view chunk)
+                {
+                    python::Object text(PyUnicode_DecodeUTF8(chunk.data(), static_cast<Py_ssize_t>(chunk.size()), "strict"));
+                    python::Object result(PyObject_CallOneArg(write, text.get()));
+                };
+            }
+
+            // The tree only ever holds the elements still open
+            vdom::Tree tree;
+            ssr::HtmlWriter writer(std::move(sink), static_cast<std::size_t>(chunk_size));
+            python::TreeBuilder builder(tree, vdom::AtomTable::global(), nullptr, &writer);
+            try
+            {
+                builder.build(args[0]);
+                writer.flush();
+            }
+            catch (const std::system_error &error)
+            {
+                errno = error.code().value();
+                return PyErr_SetFromErrno(PyExc_OSError);
+            }
+            return PyLong_FromUnsignedLongLong(writer.written());
+        };
+        return python::guarded(body);
+    }
+
+    PyObject *diff(PyObject *, PyObject *const *args, Py_ssize_t nargs)
+    {
+        if (nargs != 2)
+            return PyErr_Format(PyExc_TypeError, "diff() takes exactly 2 arguments (%zd given)", nargs);
+        if (args[0] != Py_None && !bindings::is_tree(args[0]))
+            return PyErr_Format(PyExc_TypeError, "diff() old tree must be a Tree or None, not '%s'", Py_TYPE(args[0])->tp_name);
+        if (!bindings::is_tree(args[1]) || args[1] == args[0])
+            return PyErr_Format(PyExc_TypeError, "diff() new tree must be a Tree distinct from the old one");
+
+        auto body = [&]() -> PyObject *
+        {
+            static const vdom::Tree empty;
+            const vdom::Tree &old = args[0] == Py_None ? empty : bindings::tree_of(args[0]);
+            vdom::Tree &next = bindings::tree_of(args[1]);
+            python::Object patch_list(bindings::new_patch_list(args[1]));
+            vdom::PatchList &patches = bindings::patches_of(patch_list.get());
+
+            // Both trees are plain C++ data, other Python threads may run meanwhile but not use them
+            std::shared_ptr<engine::ThreadPool> pool = bindings::diff_pool();
+            bindings::TreeUse reading(args[0] == Py_None ? nullptr : args[0], bindings::TreeAccess::Read);
+            bindings::TreeUse writing(args[1], bindings::TreeAccess::Write);
+            python::GILRelease release;
+            engine::ParallelReconciler reconciler;
+            reconciler.diff(old, next, patches, pool.get());
+            return patch_list.release();
+        };
+        return python::guarded(body);
+    }
+
+    PyObject *set_diff_threads(PyObject *, PyObject *count)
+    {
+        Py_ssize_t threads = PyLong_AsSsize_t(count);
+        if (threads == -1 && PyErr_Occurred())
+            return nullptr;
+        if (threads < 1)
+            return PyErr_Format(PyExc_ValueError, "thread count must be at least 1, not %zd", threads);
+
+        auto body = [&]() -> PyObject *
+        {
+            bindings::set_diff_threads(static_cast<std::size_t>(threads));
+            Py_RETURN_NONE;
+        };
+        return python::guarded(body);
+    }
+
+    PyObject *diff_threads(PyObject *, PyObject *)
+    {
+        return PyLong_FromSize_t(bindings::diff_threads());
+    }
+
+    PyObject *save_snapshot(PyObject *, PyObject *const *args, Py_ssize_t nargs)
+    {
+        if (nargs != 2)
+            return PyErr_Format(PyExc_TypeError, "save_snapshot() takes exactly 2 arguments (%zd given)", nargs);
+        if (!bindings::is_tree(args[0]))
+            return PyErr_Format(PyExc_TypeError, "save_snapshot() tree must be a Tree, not '%s'", Py_TYPE(args[0])->tp_name);
+
+        PyObject *bytes = nullptr;
+        if (!PyUnicode_FSConverter(args[1], &bytes))
+            return nullptr;
+        python::Object encoded = python::Object::steal(bytes);
+
+        auto body = [&]() -> PyObject *
+        {
+            const char *filename = PyBytes_AS_STRING(encoded.get());
+            try
+            {
+                bindings::TreeUse reading(args[0], bindings::TreeAccess::Read);
+                python::GILRelease release;
+                snapshot::write(bindings::tree_of(args[0]), filename);
+            }
+            catch (const std::system_error &error)
+            {
+                errno = error.code().value();
+                return PyErr_SetFromErrnoWithFilename(PyExc_OSError, filename);
+            }
+            Py_RETURN_NONE;
+        };
+        return python::guarded(body);
+    }
+
+    PyObject *load_snapshot(PyObject *, PyObject *path)
+    {
+        PyObject *bytes = nullptr;
+        if (!PyUnicode_FSConverter(path, &bytes))
+            return nullptr;
+        python::Object encoded = python::Object::steal(bytes);
+
+        auto body = [&]() -> PyObject *
+        {
+            const char *filename = PyBytes_AS_STRING(encoded.get());
+            python::Object tree(bindings::new_tree());
+            try
+            {
+                python::GILRelease release;
+                snapshot::Snapshot loaded(filename);
+                loaded.mount(bindings::tree_of(tree.get()));
+                bindings::components_of(tree.get()) = loaded.components();
+            }
+            catch (const std::system_error &error)
+            {
+                errno = error.code().value();
+                return PyErr_SetFromErrnoWithFilename(PyExc_OSError, filename);
+            }
+            return tree.release();
+        };
+        return python::guarded(body, PyExc_ValueError);
+    }
+
+    PyObject *set_tracing(PyObject *, PyObject *enabled)
+    {
+        int value = PyObject_IsTrue(enabled);
+        if (value < 0)
+            return nullptr;
+        trace::Tracer::enable(value);
+        Py_RETURN_NONE;
+    }
+
+    PyObject *tracing(PyObject *, PyObject *)
+    {
+        return PyBool_FromLong(trace::Tracer::enabled());
+    }
+
+    PyObject *write_trace(PyObject *, PyObject *path)
+    {
+        PyObject *bytes = nullptr;
+        if (!PyUnicode_FSConverter(path, &bytes))
+            return nullptr;
+        python::Object encoded = python::Object::steal(bytes);
+
+        auto body = [&]() -> PyObject *
+        {
+            const char *filename = PyBytes_AS_STRING(encoded.get());
+            std::ofstream file(filename);
+            trace::Tracer::write_chrome_trace(file);
+            file.close();
+            if (!file)
+                return PyErr_SetFromErrnoWithFilename(PyExc_OSError, filename);
+            Py_RETURN_NONE;
+        };
+        return python::guarded(body);
+    }
+
+    PyObject *clear_trace(PyObject *, PyObject *)
+    {
+        trace::Tracer::clear();
+        Py_RETURN_NONE;
+    }
+
+    PyMethodDef module_methods[] = {
+        {"render", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)()>(render)), METH_FASTCALL,
+         "render(component)\n--\n\nRender a component, or an element, into a new Tree."},
+        {"render_html", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)()>(render_html)), METH_FASTCALL,
+         "render_html(component, output, chunk_size=16384)\n--\n\nRender a component, or an element, as HTML written while it renders.\n"
+         "output is a file descriptor or a callable taking str chunks of about chunk_size bytes.\n"
+         "Return the number of bytes written."},
+        {"diff", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)()>(diff)), METH_FASTCALL,
+         "diff(old, new)\n--\n\nCompute the PatchList turning the mounted tree old (None for the first mount) into new.\n"
+         "Handles of new are assigned, so new must be mounted next. Other threads run meanwhile;\n"
+         "RuntimeError is raised if new is in use by another thread, or old is being diffed into."},
+        {"save_snapshot", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)()>(save_snapshot)), METH_FASTCALL,
+         "save_snapshot(tree, path)\n--\n\nSave a Tree to a binary snapshot file, replacing it at once.\n"
+         "Root.save_snapshot() saves the components that rendered it too."},
+        {"load_snapshot", load_snapshot, METH_O,
+         "load_snapshot(path)\n--\n\nMap a snapshot file and return the Tree it holds, with its handles, read in place.\n"
+         "Mount it with Root.hydrate() so that the first flush only patches what changed since."},
+        {"set_diff_threads", set_diff_threads, METH_O,
+         "set_diff_threads(count)\n--\n\nDiff large trees on count threads, counting the calling thread; 1 disables the pool."},
+        {"diff_threads", diff_threads, METH_NOARGS,
+         "diff_threads()\n--\n\nReturn the number of threads diffs run on."},
+        {"set_tracing", set_tracing, METH_O,
+         "set_tracing(enabled)\n--\n\nStart or stop recording spans around the render pipeline stages of every thread."},
+        {"tracing", tracing, METH_NOARGS,
+         "tracing()\n--\n\nReturn whether spans are being recorded."},
+        {"write_trace", write_trace, METH_O,
+         "write_trace(path)\n--\n\nWrite the recorded spans as Chrome trace-event JSON, for chrome://tracing or Perfetto.\n"
+         "Each thread keeps its most recent spans only."},
+        {"clear_trace", clear_trace, METH_NOARGS,
+         "clear_trace()\n--\n\nDrop the recorded spans."},
+        {nullptr, nullptr, 0, nullptr}};
+
+    int add_constants(PyObject *module)
+    {
+        const struct
+        {
+            const char *name;
+            vdom::PatchType type;
+        } constants[] = {
+            {"CREATE", vdom::PatchType::Create},
+            {"REMOVE", vdom::PatchType::Remove},
+            {"MOVE", vdom::PatchType::Move},
+            {"SET_PROPERTY", vdom::PatchType::SetProperty},
+            {"REMOVE_PROPERTY", vdom::PatchType::RemoveProperty},
+            {"SET_TEXT", vdom::PatchType::SetText},
+        };
+
+        for (const auto &constant : constants)
+        {
+            if (PyModule_AddIntConstant(module, constant.name, static_cast<long>(constant.type)) < 0)
+                return -1;
+        }
+
+        const struct
+        {
+            const char *name;
+            engine::Lane lane;
+        } lanes[] = {
+            {"INPUT", engine::Lane::Input},
+            {"BACKGROUND", engine::Lane::Background},
+        };
+
+        for (const auto &lane : lanes)
+        {
+            if (PyModule_AddIntConstant(module, lane.name, static_cast<long>(lane.lane)) < 0)
+                return -1;
+        }
+        return 0;
+    }
+
+    /**
+     * @brief Per-module state: the types the module exposes, kept alive as long as it is
+     *
+     * The types themselves belong to the interpreter, see python::interpreter_type(),
+     * so every module object of one interpreter shares them.
+     */
+    struct ModuleState
+    {
+        PyTypeObject *types[8];
+    };
+
+    ModuleState &state_of(PyObject *module)
+    {
+        return *static_cast<ModuleState *>(PyModule_GetState(module));
+    }
+
+    int exec_module(PyObject *module)
+    {
+        PyTypeObject *(*const types[])() = {python::properties_type, bindings::tree_type, bindings::patch_list_type,
+                                             bindings::root_type, python::event_type, bindings::row_index_type,
+                                             python::persistent_map_type, python::persistent_vector_type};
+        static_assert(std::size(types) == std::size(ModuleState{}.types), "Every exposed type must be held by the module state");
+
+        ModuleState &state = state_of(module);
+        for (std::size_t index = 0; index < std::size(types); ++index)
+        {
+            PyTypeObject *type = types[index]();
+            if (!type)
+                return -1;
+            Py_INCREF(type);
+            state.types[index] = type;
+            if (PyModule_AddType(module, type) < 0)
+                return -1;
+        }
+        return add_constants(module);
+    }
+
+    int traverse_module(PyObject *module, visitproc visit, void *arg)
+    {
+        for (PyTypeObject *type : state_of(module).types)
+            Py_VISIT(type);
+        return 0;
+    }
+
+    int clear_module(PyObject *module)
+    {
+        for (PyTypeObject *&type : state_of(module).types)
+            Py_CLEAR(type);
+        return 0;
+    }
+
+    void free_module(void *module)
+    {
+        clear_module(static_cast<PyObject *>(module));
+    }
+
+    PyModuleDef_Slot module_slots[] = {
+        {Py_mod_exec, reinterpret_cast<void *>(exec_module)},
+#if PY_VERSION_HEX >= 0x030C0000
+        // Nothing is shared between interpreters but plain C++ state behind locks: the atom table, the diff pool and the tracer
+        {Py_mod_multiple_interpreters, Py_MOD_PER_INTERPRETER_GIL_SUPPORTED},
+#endif
+        {0, nullptr}};
+
+    PyModuleDef module_definition = {
+        PyModuleDef_HEAD_INIT,
+        "_core",
+        "Native core of the component engine.",
+        sizeof(ModuleState),
+        module_methods,
+        module_slots,
+        traverse_module,
+        clear_module,
+        free_module,
+    };
+} // namespace
+
+PyMODINIT_FUNC PyInit__core()
+{
+    return PyModuleDef_Init(&module_definition);
+}
+
@@ -0,0 +1,100 @@
+#include <memory>
+#include <new>
+
+#include "patch_list_object.hpp"
+#include "python/interpreter_types.hpp"
+#include "python/object.hpp"
+#include "python/value.hpp"
+#include "tree_object.hpp"
+
+namespace
+{
+    void patch_list_dealloc(PyObject *self)
+    {
+        bindings::PatchListObject *patch_list = reinterpret_cast<bindings::PatchListObject *>(self);
+        PyTypeObject *type = Py_TYPE(self);
+
+        std::destroy_at(&patch_list->patches);
+        Py_XDECREF(patch_list->tree);
+        type->tp_free(self);
+        Py_DECREF(type);
+    }
+
+    Py_ssize_t patch_list_length(PyObject *self)
+    {
+        return static_cast<Py_ssize_t>(bindings::patches_of(self).size());
+    }
+
+    PyObject *patch_list_item(PyObject *self, Py_ssize_t index)
+    {
+        const vdom::PatchList &patches = bindings::patches_of(self);
+
+        if (index < 0 || static_cast<std::size_t>(index) >= patches.size())
+        {
+            PyErr_SetString(PyExc_IndexError, "patch index out of range");
+            return nullptr;
+        }
+
+        const vdom::Patch &patch = patches[static_cast<std::size_t>(index)];
+        python::Object name;
+        if (patch.name == vdom::null_atom)
+        {
+            name = python::Object::borrow(Py_None);
+        }
+        else
+        {
+            std::string_view text = vdom::AtomTable::global().name(patch.name);
+            name = python::Object::steal(PyUnicode_FromStringAndSize(text.data(), static_cast<Py_ssize_t>(text.size())));
+            if (!name)
+                return nullptr;
+        }
+
+        python::Object value = python::Object::steal(python::from_value(patch.value));
+        if (!value)
+            return nullptr;
+
+        return Py_BuildValue("(iKKKOO)", static_cast<int>(patch.type),
+                             static_cast<unsigned long long>(patch.node),
+                             static_cast<unsigned long long>(patch.parent),
+                             static_cast<unsigned long long>(patch.before),
+                             name.get(), value.get());
+    }
+
+    PyType_Slot patch_list_slots[] = {
+        {Py_tp_doc, const_cast<char *>("Patches turning the mounted tree into the next one, as (type, node, parent, before, name, value) tuples.")},
+        {Py_tp_dealloc, reinterpret_cast<void *>(patch_list_dealloc)},
+        {Py_sq_length, reinterpret_cast<void *>(patch_list_length)},
+        {Py_sq_item, reinterpret_cast<void *>(patch_list_item)},
+        {0, nullptr}};
+
+    PyType_Spec patch_list_spec = {"component_engine.PatchList", sizeof(bindings::PatchListObject), 0,
+                                   Py_TPFLAGS_DEFAULT | Py_TPFLAGS_SEQUENCE | Py_TPFLAGS_IMMUTABLETYPE |
+                                       Py_TPFLAGS_DISALLOW_INSTANTIATION,
+                                   patch_list_slots};
+
+    PyObject *create_patch_list_type()
+    {
+        return PyType_FromSpec(&patch_list_spec);
+    }
+} // namespace
+
+PyTypeObject *bindings::patch_list_type()
+{
+    return python::interpreter_type(create_patch_list_type);
+}
+
+PyObject *bindings::new_patch_list(PyObject *tree)
+{
+    PyTypeObject *type = patch_list_type();
+    PyObject *self = type ? type->tp_alloc(type, 0) : nullptr;
+
+    if (!self)
+        return nullptr;
+
+    PatchListObject *patch_list = reinterpret_cast<PatchListObject *>(self);
+    // Patches live as long as the tree they point into, so they share its storage
+    new (&patch_list->patches) vdom::PatchList(tree_of(tree).resource());
+    Py_INCREF(tree);
+    patch_list->tree = tree;
+    return self;
+}
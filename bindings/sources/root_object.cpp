@@ -0,0 +1,767 @@
+#include <Python.h>
+#include <structmember.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <new>
+#include <system_error>
+#include <vector>
+
+#include "patch_list_object.hpp"
+#include "python/errors.hpp"
+#include "python/gil.hpp"
+#include "python/interpreter_types.hpp"
+#include "python/object.hpp"
+#include "python/tree_builder.hpp"
+#include "python/value.hpp"
+#include "root_object.hpp"
+#include "thread_pool.hpp"
+#include "trace/tracer.hpp"
+#include "tree_object.hpp"
+
+namespace
+{
+    bindings::RootObject *root_of(PyObject *self)
+    {
+        return reinterpret_cast<bindings::RootObject *>(self);
+    }
+
+    engine::Scheduler::Id id_of(PyObject *component)
+    {
+        return reinterpret_cast<engine::Scheduler::Id>(component);
+    }
+
+    bool parse_lane(PyObject *const *args, Py_ssize_t nargs, Py_ssize_t index, engine::Lane &lane)
+    {
+        if (nargs <= index)
+        {
+            lane = engine::Lane::Background;
+            return true;
+        }
+
+        long value = PyLong_AsLong(args[index]);
+        if (value == -1 && PyErr_Occurred())
+            return false;
+        if (value != static_cast<long>(engine::Lane::Input) && value != static_cast<long>(engine::Lane::Background))
+        {
+            PyErr_Format(PyExc_ValueError, "lane must be INPUT or BACKGROUND, not %ld", value);
+            return false;
+        }
+        lane = static_cast<engine::Lane>(value);
+        return true;
+    }
+
+    PyObject *root_new(PyTypeObject *type, PyObject *args, PyObject *kwargs)
+    {
+        static const char *keywords[] = {"component", nullptr};
+        PyObject *component = nullptr;
+        if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O:Root", const_cast<char **>(keywords), &component))
+            return nullptr;
+
+        PyObject *self = type->tp_alloc(type, 0);
+        if (!self)
+            return nullptr;
+
+        bindings::RootObject *root = root_of(self);
+        Py_INCREF(component);
+        root->component = component;
+        root->tree = nullptr;
+        root->weak_references = nullptr;
+        root->flushing = false;
+        new (&root->scheduler) engine::Scheduler();
+        new (&root->cache) python::RenderCache(self);
+        new (&root->reconciler) engine::ParallelReconciler();
+        new (&root->hoister) vdom::Hoister();
+        new (&root->frame) std::unique_ptr<bindings::RootFrame>();
+        new (&root->handlers) std::vector<python::TreeBuilder::Handler>();
+        new (&root->events) python::EventTable();
+        root->abandoned_frames = 0;
+        new (&root->arenas) std::vector<std::shared_ptr<memory::Arena>>();
+        root->retired_arena_chunks = 0;
+        root->detached_arenas = 0;
+        new (&root->layout) layout::LayoutTree();
+        root->laying_out = false;
+        return self;
+    }
+
+    int root_traverse(PyObject *self, visitproc visit, void *arg)
+    {
+        bindings::RootObject *root = root_of(self);
+
+        Py_VISIT(Py_TYPE(self));
+        Py_VISIT(root->component);
+        Py_VISIT(root->tree);
+        if (root->frame)
+        {
+            Py_VISIT(root->frame->tree.get());
+            Py_VISIT(root->frame->old_tree.get());
+            Py_VISIT(root->frame->patch_list.get());
+            if (int result = root->frame->builder.traverse(visit, arg))
+                return result;
+        }
+        for (python::TreeBuilder::Handler &handler : root->handlers)
+            Py_VISIT(handler.callback.get());
+        if (int result = root->events.traverse(visit, arg))
+            return result;
+        return root->cache.traverse(visit, arg);
+    }
+
+    int root_clear(PyObject *self)
+    {
+        bindings::RootObject *root = root_of(self);
+
+        Py_CLEAR(root->component);
+        Py_CLEAR(root->tree);
+        root->frame.reset();
+        std::vector<python::TreeBuilder::Handler> handlers;
+        handlers.swap(root->handlers);
+        root->events.clear();
+        root->cache.clear();
+        root->layout.clear();
+        return 0;
+    }
+
+    void root_dealloc(PyObject *self)
+    {
+        bindings::RootObject *root = root_of(self);
+
+        PyObject_GC_UnTrack(self);
+        if (root->weak_references)
+            PyObject_ClearWeakRefs(self);
+        root_clear(self);
+        std::destroy_at(&root->events);
+        std::destroy_at(&root->frame);
+        std::destroy_at(&root->handlers);
+        std::destroy_at(&root->arenas);
+        std::destroy_at(&root->layout);
+        std::destroy_at(&root->hoister);
+        std::destroy_at(&root->reconciler);
+        std::destroy_at(&root->cache);
+        std::destroy_at(&root->scheduler);
+        PyTypeObject *type = Py_TYPE(self);
+        type->tp_free(self);
+        Py_DECREF(type);
+    }
+
+    PyObject *schedule(PyObject *self, PyObject *const *args, Py_ssize_t nargs)
+    {
+        if (nargs < 1 || nargs > 2)
+            return PyErr_Format(PyExc_TypeError, "schedule() takes 1 or 2 arguments (%zd given)", nargs);
+
+        engine::Lane lane;
+        if (!parse_lane(args, nargs, 1, lane))
+            return nullptr;
+
+        auto body = [&]() -> PyObject *
+        {
+            bindings::RootObject *root = root_of(self);
+            const python::RenderCache::Entry *entry = root->cache.find(args[0]);
+            if (!entry)
+                Py_RETURN_FALSE;
+            return PyBool_FromLong(root->scheduler.schedule(id_of(args[0]), entry->depth, lane));
+        };
+        return python::guarded(body);
+    }
+
+    engine::Job run_frame(bindings::RootObject *root, bindings::RootFrame &frame)
+    {
+        std::vector<PyObject *> dirty;
+        dirty.reserve(frame.updates.size());
+        for (const engine::Scheduler::Update &update : frame.updates)
+            dirty.push_back(reinterpret_cast<PyObject *>(update.component));
+        frame.builder.start(root->component, dirty);
+        while (frame.builder.advance())
+            co_await engine::Yield{frame.deadline};
+        frame.builder.finish();
+
+        static const vdom::Tree empty;
+        const vdom::Tree &old = frame.old_tree ? bindings::tree_of(frame.old_tree.get()) : empty;
+        vdom::Tree &next = bindings::tree_of(frame.tree.get());
+        vdom::PatchList &patches = bindings::patches_of(frame.patch_list.get());
+        {
+            python::GILRelease release;
+            root->hoister.hoist(next);
+        }
+        if (frame.deadline.unbounded())
+        {
+            std::shared_ptr<engine::ThreadPool> pool = bindings::diff_pool();
+            python::GILRelease release;
+            root->reconciler.diff(old, next, patches, pool.get());
+        }
+        else
+        {
+            // Groups of about one grain each, diffed one at a time between deadline checks
+            std::size_t groups = 0;
+            {
+                python::GILRelease release;
+                groups = root->reconciler.split(old, next, std::numeric_limits<std::size_t>::max());
+            }
+            for (std::size_t index = 0; index < groups; ++index)
+            {
+                co_await engine::Yield{frame.deadline};
+                python::GILRelease release;
+                root->reconciler.diff_group(index);
+            }
+            python::GILRelease release;
+            root->reconciler.merge(patches);
+        }
+
+        // Unmount last, so that the frame can be abandoned until it is complete
+        root->cache.end_frame([root](PyObject *component)
+                              { root->scheduler.cancel(id_of(component)); });
+    }
+
+    void restore_updates(bindings::RootObject *root, const std::vector<engine::Scheduler::Update> &updates)
+    {
+        // Keep the frame's updates pending so that the next frame retries them
+        for (const engine::Scheduler::Update &update : updates)
+            root->scheduler.schedule(update.component, update.depth, update.lane);
+    }
+
+    void abandon_frame(bindings::RootObject *root)
+    {
+        if (!root->frame)
+            return;
+        restore_updates(root, root->frame->updates);
+        root->frame.reset();
+        root->abandoned_frames++;
+    }
+
+    void mount_patches(const vdom::Tree &tree, vdom::NodeId node, vdom::Handle parent, vdom::PatchList &patches)
+    {
+        // The patches a diff from nothing would emit, keeping the handles the tree already has
+        const vdom::Handle handle = tree.handle(node);
+        if (tree.kind(node) == vdom::NodeKind::Text)
+        {
+            patches.push_back({vdom::PatchType::Create, vdom::NodeKind::Text, vdom::null_atom, handle, parent,
+                               vdom::null_handle, vdom::Value::string(tree.text(node))});
+            return;
+        }
+
+        patches.push_back({vdom::PatchType::Create, vdom::NodeKind::Element, tree.tag(node), handle, parent,
+                           vdom::null_handle, vdom::Value()});
+        for (const vdom::Property &property : tree.properties(node))
+            patches.push_back({vdom::PatchType::SetProperty, vdom::NodeKind::Element, property.key, handle,
+                               vdom::null_handle, vdom::null_handle, property.value});
+        for (vdom::NodeId child : tree.children(node))
+            mount_patches(tree, child, handle, patches);
+    }
+
+    void follow_tree(bindings::RootObject *root)
+    {
+        root->layout.clear();
+        if (!root->tree)
+            return;
+        const vdom::Tree &tree = bindings::tree_of(root->tree);
+        if (tree.empty() || tree.root() == vdom::null_node)
+            return;
+        vdom::PatchList patches;
+        mount_patches(tree, tree.root(), vdom::null_handle, patches);
+        root->layout.apply(patches);
+    }
+
+    std::shared_ptr<memory::Arena> frame_arena(bindings::RootObject *root)
+    {
+        // Reuse an arena nothing points into any more: not the mounted tree, nor a Tree or PatchList kept by Python
+        for (std::shared_ptr<memory::Arena> &arena : root->arenas)
+        {
+            if (arena.use_count() == 1)
+            {
+                arena->reset();
+                return arena;
+            }
+        }
+
+        const memory::Arena *mounted = root->tree ? bindings::arena_of(root->tree) : nullptr;
+        for (std::shared_ptr<memory::Arena> &arena : root->arenas)
+        {
+            if (arena.get() != mounted)
+            {
+                root->retired_arena_chunks += arena->statistics().upstream_allocations;
+                root->detached_arenas++;
+                arena = std::make_shared<memory::Arena>();
+                return arena;
+            }
+        }
+        return root->arenas.emplace_back(std::make_shared<memory::Arena>());
+    }
+
+    bool start_frame(bindings::RootObject *root, engine::Lane lane)
+    {
+        std::span<const engine::Scheduler::Update> updates = root->scheduler.begin_frame(lane);
+        if (root->tree && updates.empty())
+            return false;
+
+        std::unique_ptr<bindings::RootFrame> frame;
+        try
+        {
+            frame = std::make_unique<bindings::RootFrame>(python::Object(bindings::new_tree(frame_arena(root))),
+                                                          python::Object::borrow(root->tree), root->cache, root->handlers);
+            frame->updates.assign(updates.begin(), updates.end());
+        }
+        catch (...)
+        {
+            restore_updates(root, {updates.begin(), updates.end()});
+            throw;
+        }
+
+        frame->lane = lane;
+        for (const engine::Scheduler::Update &update : frame->updates)
+            root->cache.invalidate(reinterpret_cast<PyObject *>(update.component));
+        root->cache.begin_frame();
+        frame->job = run_frame(root, *frame);
+        root->frame = std::move(frame);
+        return true;
+    }
+
+    PyObject *resume_frame(bindings::RootObject *root)
+    {
+        bool done = false;
+        root->flushing = true;
+        try
+        {
+            trace::Span span("frame", root->frame->lane == engine::Lane::Input ? "input" : "background");
+            done = root->frame->job.resume();
+        }
+        catch (...)
+        {
+            restore_updates(root, root->frame->updates);
+            root->frame.reset();
+            root->flushing = false;
+            throw;
+        }
+        root->flushing = false;
+
+        if (!done)
+            Py_RETURN_NONE;
+
+        std::unique_ptr<bindings::RootFrame> frame = std::move(root->frame);
+        const vdom::Tree &mounted = bindings::tree_of(frame->tree.get());
+        root->events.apply(bindings::patches_of(frame->patch_list.get()), mounted);
+        if (root->laying_out)
+            root->layout.apply(bindings::patches_of(frame->patch_list.get()));
+        root->events.bind(mounted, frame->builder.handlers());
+        std::vector<python::TreeBuilder::Handler> handlers = frame->builder.take_handlers();
+        root->handlers.swap(handlers);
+        Py_XSETREF(root->tree, frame->tree.release());
+        return frame->patch_list.release();
+    }
+
+    PyObject *flush(PyObject *self, PyObject *const *args, Py_ssize_t nargs)
+    {
+        if (nargs > 1)
+            return PyErr_Format(PyExc_TypeError, "flush() takes at most 1 argument (%zd given)", nargs);
+
+        engine::Lane lane;
+        if (!parse_lane(args, nargs, 0, lane))
+            return nullptr;
+
+        bindings::RootObject *root = root_of(self);
+        if (!root->component)
+            return PyErr_Format(PyExc_RuntimeError, "Root has been cleared");
+        if (root->flushing)
+            return PyErr_Format(PyExc_RuntimeError, "flush() is already running on this root");
+
+        auto body = [&]() -> PyObject *
+        {
+            root->events.dispatch();
+            abandon_frame(root);
+            if (!start_frame(root, lane))
+                return bindings::new_patch_list(root->tree);
+            return resume_frame(root);
+        };
+        return python::guarded(body);
+    }
+
+    PyObject *render_slice(PyObject *self, PyObject *const *args, Py_ssize_t nargs)
+    {
+        if (nargs > 2)
+            return PyErr_Format(PyExc_TypeError, "render_slice() takes at most 2 arguments (%zd given)", nargs);
+
+        double budget = 0.004;
+        if (nargs > 0)
+        {
+            budget = PyFloat_AsDouble(args[0]);
+            if (budget == -1.0 && PyErr_Occurred())
+                return nullptr;
+            if (!(budget > 0.0))
+                return PyErr_Format(PyExc_ValueError, "budget must be positive, not %R", args[0]);
+        }
+
+        engine::Lane lane;
+        if (!parse_lane(args, nargs, 1, lane))
+            return nullptr;
+
+        bindings::RootObject *root = root_of(self);
+        if (!root->component)
+            return PyErr_Format(PyExc_RuntimeError, "Root has been cleared");
+        if (root->flushing)
+            return PyErr_Format(PyExc_RuntimeError, "flush() is already running on this root");
+
+        auto body = [&]() -> PyObject *
+        {
+            root->events.dispatch();
+
+            // Input preempts background work: restart with the input updates alone
+            const bool input_pending = root->scheduler.pending(engine::Lane::Input) > 0;
+            if (root->frame && root->frame->lane == engine::Lane::Background && input_pending)
+                abandon_frame(root);
+            if (!root->frame && !start_frame(root, input_pending ? engine::Lane::Input : lane))
+                return bindings::new_patch_list(root->tree);
+
+            root->frame->deadline.arm(std::chrono::duration_cast<engine::Deadline::Clock::duration>(
+                std::chrono::duration<double>(budget)));
+            return resume_frame(root);
+        };
+        return python::guarded(body);
+    }
+
+    PyObject *hydrate(PyObject *self, PyObject *tree)
+    {
+        if (!bindings::is_tree(tree))
+            return PyErr_Format(PyExc_TypeError, "hydrate() argument must be a Tree, not '%s'", Py_TYPE(tree)->tp_name);
+
+        bindings::RootObject *root = root_of(self);
+        if (!root->component)
+            return PyErr_Format(PyExc_RuntimeError, "Root has been cleared");
+        if (root->tree || root->frame)
+            return PyErr_Format(PyExc_RuntimeError, "hydrate() must be called before the first frame");
+
+        // The first frame builds the component tree against the hydrated one, skipping the recorded components it can
+        auto body = [&]() -> PyObject *
+        {
+            bindings::TreeUse reading(tree, bindings::TreeAccess::Read);
+            root->cache.hydrate(bindings::components_of(tree), bindings::tree_of(tree));
+            root->scheduler.schedule(id_of(root->component), 0, engine::Lane::Background);
+            root->events.reset(bindings::tree_of(tree));
+            root->tree = Py_NewRef(tree);
+            if (root->laying_out)
+                follow_tree(root);
+            Py_RETURN_NONE;
+        };
+        return python::guarded(body);
+    }
+
+    PyObject *save_snapshot(PyObject *self, PyObject *path)
+    {
+        bindings::RootObject *root = root_of(self);
+        if (!root->component)
+            return PyErr_Format(PyExc_RuntimeError, "Root has been cleared");
+        if (!root->tree || root->frame)
+            return PyErr_Format(PyExc_RuntimeError, "save_snapshot() needs a mounted tree and no frame in progress");
+
+        PyObject *bytes = nullptr;
+        if (!PyUnicode_FSConverter(path, &bytes))
+            return nullptr;
+        python::Object encoded = python::Object::steal(bytes);
+
+        auto body = [&]() -> PyObject *
+        {
+            const char *filename = PyBytes_AS_STRING(encoded.get());
+            std::vector<snapshot::Component> components = root->cache.components(root->component);
+
+            // The handlers of a skipped component's nodes are not saved: it must render to declare them again
+            for (snapshot::Component &component : components)
+            {
+                auto handler = std::lower_bound(root->handlers.begin(), root->handlers.end(), component.first,
+                                                [](const python::TreeBuilder::Handler &handler, vdom::NodeId node)
+                                                { return handler.node < node; });
+                if (component.properties && handler != root->handlers.end() && handler->node - component.first < component.count)
+                    component.properties.reset();
+            }
+
+            try
+            {
+                bindings::TreeUse reading(root->tree, bindings::TreeAccess::Read);
+                python::GILRelease release;
+                snapshot::write(bindings::tree_of(root->tree), filename, nullptr, components);
+            }
+            catch (const std::system_error &error)
+            {
+                errno = error.code().value();
+                return PyErr_SetFromErrnoWithFilename(PyExc_OSError, filename);
+            }
+            Py_RETURN_NONE;
+        };
+        return python::guarded(body);
+    }
+
+    PyObject *compute_layout(PyObject *self, PyObject *const *args, Py_ssize_t nargs)
+    {
+        if (nargs != 2)
+            return PyErr_Format(PyExc_TypeError, "compute_layout() takes exactly 2 arguments (%zd given)", nargs);
+
+        const double width = PyFloat_AsDouble(args[0]);
+        if (width == -1.0 && PyErr_Occurred())
+            return nullptr;
+        const double height = PyFloat_AsDouble(args[1]);
+        if (height == -1.0 && PyErr_Occurred())
+            return nullptr;
+
+        bindings::RootObject *root = root_of(self);
+        auto body = [&]() -> PyObject *
+        {
+            if (!root->laying_out)
+            {
+                follow_tree(root);
+                root->laying_out = true;
+            }
+            root->layout.compute(static_cast<float>(width), static_cast<float>(height));
+            Py_RETURN_NONE;
+        };
+        return python::guarded(body);
+    }
+
+    PyObject *box(PyObject *self, PyObject *handle)
+    {
+        const vdom::Handle target = PyLong_AsUnsignedLongLong(handle);
+        if (target == static_cast<vdom::Handle>(-1) && PyErr_Occurred())
+            return nullptr;
+
+        const layout::LayoutTree &layout = root_of(self)->layout;
+        if (!layout.box(target))
+            Py_RETURN_NONE;
+        auto body = [&]() -> PyObject *
+        {
+            const layout::Box box = layout.absolute_box(target);
+            return Py_BuildValue("(dddd)", box.x, box.y, box.width, box.height);
+        };
+        return python::guarded(body);
+    }
+
+    PyObject *post(PyObject *self, PyObject *const *args, Py_ssize_t nargs)
+    {
+        if (nargs < 2 || nargs > 5)
+            return PyErr_Format(PyExc_TypeError, "post() takes from 2 to 5 arguments (%zd given)", nargs);
+        if (!PyUnicode_Check(args[0]))
+            return PyErr_Format(PyExc_TypeError, "post() type must be a str, not '%s'", Py_TYPE(args[0])->tp_name);
+
+        engine::Event event{vdom::null_atom, PyLong_AsUnsignedLongLong(args[1]), 0.0, 0.0, 0};
+        if (event.target == static_cast<vdom::Handle>(-1) && PyErr_Occurred())
+            return nullptr;
+        if (nargs > 2 && (event.x = PyFloat_AsDouble(args[2])) == -1.0 && PyErr_Occurred())
+            return nullptr;
+        if (nargs > 3 && (event.y = PyFloat_AsDouble(args[3])) == -1.0 && PyErr_Occurred())
+            return nullptr;
+        if (nargs > 4 && (event.detail = PyLong_AsLongLong(args[4])) == -1 && PyErr_Occurred())
+            return nullptr;
+
+        auto body = [&]() -> PyObject *
+        {
+            event.type = vdom::AtomTable::global().intern(python::utf8_view(args[0]));
+            return PyBool_FromLong(root_of(self)->events.queue().push(event));
+        };
+        return python::guarded(body);
+    }
+
+    PyObject *dispatch(PyObject *self, PyObject *)
+    {
+        bindings::RootObject *root = root_of(self);
+        if (!root->component)
+            return PyErr_Format(PyExc_RuntimeError, "Root has been cleared");
+
+        auto body = [&]() -> PyObject *
+        { return PyLong_FromSize_t(root->events.dispatch()); };
+        return python::guarded(body);
+    }
+
+    PyObject *root_tree(PyObject *self, void *)
+    {
+        PyObject *tree = root_of(self)->tree;
+        return Py_NewRef(tree ? tree : Py_None);
+    }
+
+    PyObject *root_component(PyObject *self, void *)
+    {
+        PyObject *component = root_of(self)->component;
+        return Py_NewRef(component ? component : Py_None);
+    }
+
+    PyObject *root_pending(PyObject *self, void *)
+    {
+        return PyLong_FromSize_t(root_of(self)->scheduler.pending());
+    }
+
+    PyObject *root_mounted(PyObject *self, void *)
+    {
+        return PyLong_FromSize_t(root_of(self)->cache.size());
+    }
+
+    PyObject *root_renders(PyObject *self, void *)
+    {
+        return PyLong_FromUnsignedLongLong(root_of(self)->cache.statistics().renders);
+    }
+
+    PyObject *root_skipped_renders(PyObject *self, void *)
+    {
+        return PyLong_FromUnsignedLongLong(root_of(self)->cache.statistics().skipped_renders);
+    }
+
+    PyObject *root_hoisted_nodes(PyObject *self, void *)
+    {
+        return PyLong_FromSize_t(root_of(self)->hoister.statistics().hoisted_nodes);
+    }
+
+    PyObject *root_static_blocks(PyObject *self, void *)
+    {
+        return PyLong_FromSize_t(root_of(self)->hoister.blocks());
+    }
+
+    PyObject *root_arena_bytes(PyObject *self, void *)
+    {
+        const bindings::RootObject *root = root_of(self);
+        const memory::Arena *arena = root->tree ? bindings::arena_of(root->tree) : nullptr;
+        return PyLong_FromSize_t(arena ? arena->statistics().bytes_allocated : 0);
+    }
+
+    PyObject *root_arena_chunks(PyObject *self, void *)
+    {
+        const bindings::RootObject *root = root_of(self);
+        std::uint64_t chunks = root->retired_arena_chunks;
+        for (const std::shared_ptr<memory::Arena> &arena : root->arenas)
+            chunks += arena->statistics().upstream_allocations;
+        return PyLong_FromUnsignedLongLong(chunks);
+    }
+
+    PyObject *root_detached_arenas(PyObject *self, void *)
+    {
+        return PyLong_FromUnsignedLongLong(root_of(self)->detached_arenas);
+    }
+
+    PyObject *root_layouts(PyObject *self, void *)
+    {
+        return PyLong_FromUnsignedLongLong(root_of(self)->layout.statistics().layouts);
+    }
+
+    PyObject *root_rendering(PyObject *self, void *)
+    {
+        return PyBool_FromLong(root_of(self)->frame != nullptr);
+    }
+
+    PyObject *root_abandoned_frames(PyObject *self, void *)
+    {
+        return PyLong_FromUnsignedLongLong(root_of(self)->abandoned_frames);
+    }
+
+    PyObject *root_dispatched_events(PyObject *self, void *)
+    {
+        return PyLong_FromUnsignedLongLong(root_of(self)->events.statistics().events);
+    }
+
+    PyObject *root_coalesced_events(PyObject *self, void *)
+    {
+        return PyLong_FromUnsignedLongLong(root_of(self)->events.queue().statistics().coalesced);
+    }
+
+    PyObject *root_dropped_events(PyObject *self, void *)
+    {
+        return PyLong_FromUnsignedLongLong(root_of(self)->events.queue().statistics().dropped);
+    }
+
+    PyMethodDef root_methods[] = {
+        {"schedule", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)()>(schedule)), METH_FASTCALL,
+         "schedule(component, lane=BACKGROUND)\n--\n\nMark a mounted component dirty for the next frame taking lane.\n"
+         "Return False if the component is not mounted by this root or already pending."},
+        {"flush", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)()>(flush)), METH_FASTCALL,
+         "flush(lane=BACKGROUND)\n--\n\nRender one frame: re-render the dirty components of lane and higher priority\n"
+         "lanes, each once and top-down, and return the PatchList from the mounted tree.\n"
+         "The first flush mounts the root component. An unfinished render_slice() frame is abandoned."},
+        {"render_slice", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)()>(render_slice)), METH_FASTCALL,
+         "render_slice(budget=0.004, lane=BACKGROUND)\n--\n\nRender the current frame for about budget seconds, starting one\n"
+         "for lane if none is running. Return its PatchList once complete, None while work remains.\n"
+         "Pending INPUT updates abandon an unfinished BACKGROUND frame and are rendered first;\n"
+         "the abandoned updates stay pending. The mounted tree only changes when a frame completes."},
+        {"save_snapshot", save_snapshot, METH_O,
+         "save_snapshot(path)\n--\n\nSave the mounted tree to a binary snapshot file, replacing it at once, along with the\n"
+         "components that rendered it and the properties of those a new instance may skip."},
+        {"hydrate", hydrate, METH_O,
+         "hydrate(tree)\n--\n\nMount a tree loaded from a snapshot, already shown by the backend, before the first frame.\n"
+         "The first BACKGROUND frame returns only the patches from that tree. If the snapshot was saved by\n"
+         "Root.save_snapshot(), it copies the nodes of each pure component matching a saved one of the same\n"
+         "class, at the same place and with equal properties, without calling its render()."},
+        {"compute_layout", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)()>(compute_layout)), METH_FASTCALL,
+         "compute_layout(width, height)\n--\n\nLay the mounted tree out in a viewport, again only where frames changed it.\n"
+         "From the first call on, every frame keeps the layout in step with the mounted tree."},
+        {"box", box, METH_O,
+         "box(handle)\n--\n\nGet the (x, y, width, height) box of a node relative to the viewport, as of the last\n"
+         "compute_layout(), or None for a node it did not lay out."},
+        {"post", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)()>(post)), METH_FASTCALL,
+         "post(type, target, x=0.0, y=0.0, detail=0)\n--\n\nQueue an input event on the node with handle target.\n"
+         "Return False if the queue is full and the event was dropped. Successive pointermove, mousemove\n"
+         "and scroll events on the same target are coalesced into the last one."},
+        {"dispatch", dispatch, METH_NOARGS,
+         "dispatch()\n--\n\nCall the handlers of the queued events, bubbling from each target up to the root\n"
+         "until a handler returns True, and return the number of calls. flush() and render_slice()\n"
+         "dispatch first, so that the updates handlers schedule are rendered by the same frame."},
+        {nullptr, nullptr, 0, nullptr}};
+
+    PyGetSetDef root_getset[] = {
+        {"tree", root_tree, nullptr, "The mounted Tree, None before the first flush.", nullptr},
+        {"component", root_component, nullptr, "The root component.", nullptr},
+        {"pending", root_pending, nullptr, "Number of dirty components waiting for a frame.", nullptr},
+        {"mounted", root_mounted, nullptr, "Number of mounted components.", nullptr},
+        {"renders", root_renders, nullptr, "Number of render() calls made by all frames.", nullptr},
+        {"skipped_renders", root_skipped_renders, nullptr,
+         "Number of components rebuilt from a previous output instead of rendering.", nullptr},
+        {"arena_bytes", root_arena_bytes, nullptr,
+         "Bytes the frame of the mounted tree allocated from its arena, for the tree and the patches.", nullptr},
+        {"arena_chunks", root_arena_chunks, nullptr,
+         "Number of chunks the frame arenas took from the heap; constant once frames stop growing.", nullptr},
+        {"detached_arenas", root_detached_arenas, nullptr,
+         "Number of arenas left to a Tree or PatchList kept from an earlier frame, then replaced.", nullptr},
+        {"layouts", root_layouts, nullptr,
+         "Number of nodes compute_layout() laid out or measured instead of reusing their cached layout.", nullptr},
+        {"hoisted_nodes", root_hoisted_nodes, nullptr,
+         "Number of nodes of the last frame inside static subtrees, which the diff skipped.", nullptr},
+        {"static_blocks", root_static_blocks, nullptr,
+         "Number of static blocks frozen from subtrees that stayed unchanged across frames.", nullptr},
+        {"rendering", root_rendering, nullptr, "Whether a frame started by render_slice() is unfinished.", nullptr},
+        {"abandoned_frames", root_abandoned_frames, nullptr,
+         "Number of frames abandoned before completion, their updates kept pending.", nullptr},
+        {"dispatched_events", root_dispatched_events, nullptr, "Number of events dispatched, after coalescing.", nullptr},
+        {"coalesced_events", root_coalesced_events, nullptr,
+         "Number of events replaced by a later event of the same type and target.", nullptr},
+        {"dropped_events", root_dropped_events, nullptr, "Number of events posted while the queue was full.", nullptr},
+        {nullptr, nullptr, nullptr, nullptr, nullptr}};
+
+    PyMemberDef root_members[] = {
+        {"__weaklistoffset__", T_PYSSIZET, offsetof(bindings::RootHead, weak_references), READONLY, nullptr},
+        {nullptr, 0, 0, 0, nullptr}};
+
+    PyType_Slot root_slots[] = {
+        {Py_tp_doc, const_cast<char *>("Root(component)\n--\n\nMounts a component and batches the updates of its descendants into frames.")},
+        {Py_tp_new, reinterpret_cast<void *>(root_new)},
+        {Py_tp_dealloc, reinterpret_cast<void *>(root_dealloc)},
+        {Py_tp_traverse, reinterpret_cast<void *>(root_traverse)},
+        {Py_tp_clear, reinterpret_cast<void *>(root_clear)},
+        {Py_tp_methods, root_methods},
+        {Py_tp_getset, root_getset},
+        {Py_tp_members, root_members},
+        {0, nullptr}};
+
+    PyType_Spec root_spec = {"component_engine.Root", sizeof(bindings::RootObject), 0,
+                             Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC | Py_TPFLAGS_IMMUTABLETYPE, root_slots};
+
+    PyObject *create_root_type()
+    {
+        return PyType_FromSpec(&root_spec);
+    }
+} // namespace
+
+bindings::RootFrame::RootFrame(python::Object new_tree, python::Object mounted_tree, python::RenderCache &cache,
+                               std::span<const python::TreeBuilder::Handler> mounted_handlers)
+    : tree(std::move(new_tree)), old_tree(std::move(mounted_tree)), old_tree_use(old_tree.get(), TreeAccess::Read),
+      patch_list(new_patch_list(tree.get())),
+      builder(tree_of(tree.get()), vdom::AtomTable::global(), &cache, nullptr,
+              old_tree ? &tree_of(old_tree.get()) : nullptr, mounted_handlers),
+      lane(engine::Lane::Background)
+{
+}
+
+PyTypeObject *bindings::root_type()
+{
+    return python::interpreter_type(create_root_type);
+}
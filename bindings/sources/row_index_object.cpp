@@ -0,0 +1,200 @@
+#include <new>
+
+#include "python/errors.hpp"
+#include "python/interpreter_types.hpp"
+#include "row_index_object.hpp"
+
+namespace
+{
+    layout::RowIndex &rows_of(PyObject *self)
+    {
+        return reinterpret_cast<bindings::RowIndexObject *>(self)->rows;
+    }
+
+    /**
+     * @brief Convert a row number, up to the row count when past_end is set
+     *
+     */
+    bool parse_row(PyObject *self, PyObject *argument, bool past_end, std::size_t &row)
+    {
+        row = PyLong_AsSize_t(argument);
+        if (row == static_cast<std::size_t>(-1) && PyErr_Occurred())
+            return false;
+        if (row > rows_of(self).size() || (row == rows_of(self).size() && !past_end))
+        {
+            PyErr_Format(PyExc_IndexError, "row %zu out of range for %zu rows", row, rows_of(self).size());
+            return false;
+        }
+        return true;
+    }
+
+    PyObject *row_index_new(PyTypeObject *type, PyObject *args, PyObject *kwargs)
+    {
+        static const char *keywords[] = {"count", "estimated_height", nullptr};
+        Py_ssize_t count = 0;
+        float estimated_height = 20;
+        if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|nf:RowIndex", const_cast<char **>(keywords), &count, &estimated_height))
+            return nullptr;
+        if (count < 0)
+            return PyErr_Format(PyExc_ValueError, "count must not be negative, not %zd", count);
+
+        PyObject *self = type->tp_alloc(type, 0);
+        if (!self)
+            return nullptr;
+        try
+        {
+            new (&rows_of(self)) layout::RowIndex(static_cast<std::size_t>(count), estimated_height);
+        }
+        catch (const std::bad_alloc &)
+        {
+            // Nothing to destroy yet: free the bare object, and drop the reference to its type it held
+            type->tp_free(self);
+            Py_DECREF(type);
+            return PyErr_NoMemory();
+        }
+        return self;
+    }
+
+    void row_index_dealloc(PyObject *self)
+    {
+        PyTypeObject *type = Py_TYPE(self);
+        rows_of(self).~RowIndex();
+        type->tp_free(self);
+        Py_DECREF(type);
+    }
+
+    Py_ssize_t row_index_length(PyObject *self)
+    {
+        return static_cast<Py_ssize_t>(rows_of(self).size());
+    }
+
+    PyObject *resize(PyObject *self, PyObject *argument)
+    {
+        const std::size_t count = PyLong_AsSize_t(argument);
+        if (count == static_cast<std::size_t>(-1) && PyErr_Occurred())
+            return nullptr;
+
+        auto body = [&]() -> PyObject *
+        {
+            rows_of(self).resize(count);
+            Py_RETURN_NONE;
+        };
+        return python::guarded(body);
+    }
+
+    PyObject *set_height(PyObject *self, PyObject *const *args, Py_ssize_t nargs)
+    {
+        if (nargs != 2)
+            return PyErr_Format(PyExc_TypeError, "set_height() takes exactly 2 arguments (%zd given)", nargs);
+
+        std::size_t row = 0;
+        if (!parse_row(self, args[0], false, row))
+            return nullptr;
+        const double height = PyFloat_AsDouble(args[1]);
+        if (height == -1.0 && PyErr_Occurred())
+            return nullptr;
+        if (!(height >= 0.0))
+            return PyErr_Format(PyExc_ValueError, "height must not be negative, not %R", args[1]);
+
+        rows_of(self).set_height(row, static_cast<float>(height));
+        Py_RETURN_NONE;
+    }
+
+    PyObject *height(PyObject *self, PyObject *argument)
+    {
+        std::size_t row = 0;
+        if (!parse_row(self, argument, false, row))
+            return nullptr;
+        return PyFloat_FromDouble(rows_of(self).height(row));
+    }
+
+    PyObject *offset(PyObject *self, PyObject *argument)
+    {
+        std::size_t row = 0;
+        if (!parse_row(self, argument, true, row))
+            return nullptr;
+        return PyFloat_FromDouble(rows_of(self).offset(row));
+    }
+
+    PyObject *row_at(PyObject *self, PyObject *argument)
+    {
+        const double offset = PyFloat_AsDouble(argument);
+        if (offset == -1.0 && PyErr_Occurred())
+            return nullptr;
+        return PyLong_FromSize_t(rows_of(self).row_at(offset));
+    }
+
+    PyObject *window(PyObject *self, PyObject *const *args, Py_ssize_t nargs)
+    {
+        if (nargs < 2 || nargs > 3)
+            return PyErr_Format(PyExc_TypeError, "window() takes from 2 to 3 arguments (%zd given)", nargs);
+
+        const double scroll = PyFloat_AsDouble(args[0]);
+        if (scroll == -1.0 && PyErr_Occurred())
+            return nullptr;
+        const double viewport = PyFloat_AsDouble(args[1]);
+        if (viewport == -1.0 && PyErr_Occurred())
+            return nullptr;
+        std::size_t overscan = 0;
+        if (nargs > 2 && (overscan = PyLong_AsSize_t(args[2])) == static_cast<std::size_t>(-1) && PyErr_Occurred())
+            return nullptr;
+
+        const layout::RowIndex::Window window = rows_of(self).window(scroll, viewport, overscan);
+        return Py_BuildValue("(nn)", static_cast<Py_ssize_t>(window.first), static_cast<Py_ssize_t>(window.last));
+    }
+
+    PyObject *row_index_total(PyObject *self, void *)
+    {
+        return PyFloat_FromDouble(rows_of(self).total());
+    }
+
+    PyObject *row_index_estimated_height(PyObject *self, void *)
+    {
+        return PyFloat_FromDouble(rows_of(self).estimated_height());
+    }
+
+    PyMethodDef row_index_methods[] = {
+        {"resize", resize, METH_O,
+         "resize(count)\n--\n\nAdd rows of the estimated height at the end, or remove the last ones."},
+        {"set_height", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)()>(set_height)), METH_FASTCALL,
+         "set_height(row, height)\n--\n\nRecord the measured height of a row."},
+        {"height", height, METH_O,
+         "height(row)\n--\n\nGet the height of a row, measured or estimated."},
+        {"offset", offset, METH_O,
+         "offset(row)\n--\n\nGet the offset of the top of a row, up to len() for the total height."},
+        {"row_at", row_at, METH_O,
+         "row_at(offset)\n--\n\nGet the row an offset falls in, clamped to the last row."},
+        {"window", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)()>(window)), METH_FASTCALL,
+         "window(scroll, viewport, overscan=0)\n--\n\nGet the rows (first, last) intersecting a viewport, last "
+         "excluded, with overscan extra rows on each side."},
+        {nullptr, nullptr, 0, nullptr}};
+
+    PyGetSetDef row_index_getset[] = {
+        {"total", row_index_total, nullptr, "Sum of the heights of the rows.", nullptr},
+        {"estimated_height", row_index_estimated_height, nullptr, "Height of the rows not measured yet.", nullptr},
+        {nullptr, nullptr, nullptr, nullptr, nullptr}};
+
+    PyType_Slot row_index_slots[] = {
+        {Py_tp_doc, const_cast<char *>("RowIndex(count=0, estimated_height=20.0)\n--\n\n"
+                                       "Heights of the rows of a virtualized list, with offsets found in O(log n). "
+                                       "len() is its row count.")},
+        {Py_tp_new, reinterpret_cast<void *>(row_index_new)},
+        {Py_tp_dealloc, reinterpret_cast<void *>(row_index_dealloc)},
+        {Py_sq_length, reinterpret_cast<void *>(row_index_length)},
+        {Py_tp_methods, row_index_methods},
+        {Py_tp_getset, row_index_getset},
+        {0, nullptr}};
+
+    PyType_Spec row_index_spec = {"component_engine.RowIndex", sizeof(bindings::RowIndexObject), 0,
+                                  Py_TPFLAGS_DEFAULT | Py_TPFLAGS_IMMUTABLETYPE, row_index_slots};
+
+    PyObject *create_row_index_type()
+    {
+        return PyType_FromSpec(&row_index_spec);
+    }
+} // namespace
+
+PyTypeObject *bindings::row_index_type()
+{
+    return python::interpreter_type(create_row_index_type);
+}
@@ -0,0 +1,35 @@
+#include <mutex>
+
+#include "thread_pool.hpp"
+
+namespace
+{
+    // One pool for the process: interpreters with their own GIL may replace it concurrently
+    std::mutex pool_mutex;
+    std::shared_ptr<engine::ThreadPool> pool;
+} // namespace
+
+std::shared_ptr<engine::ThreadPool> bindings::diff_pool()
+{
+    std::lock_guard lock(pool_mutex);
+    return pool;
+}
+
+void bindings::set_diff_threads(std::size_t threads)
+{
+    std::shared_ptr<engine::ThreadPool> previous;
+    {
+        std::lock_guard lock(pool_mutex);
+        if (threads == (pool ? pool->workers() + 1 : 1))
+            return;
+        previous = std::move(pool);
+        pool = threads > 1 ? std::make_shared<engine::ThreadPool>(threads - 1) : nullptr;
+    }
+    // Joined outside the lock, once the diffs holding it are done
+}
+
+std::size_t bindings::diff_threads()
+{
+    std::lock_guard lock(pool_mutex);
+    return pool ? pool->workers() + 1 : 1;
+}
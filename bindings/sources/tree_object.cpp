@@ -0,0 +1,124 @@
+#include <memory>
+#include <new>
+#include <stdexcept>
+
+#include "python/interpreter_types.hpp"
+#include "tree_object.hpp"
+
+namespace
+{
+    void tree_dealloc(PyObject *self)
+    {
+        // The tree goes first, the arena holding its storage last
+        PyTypeObject *type = Py_TYPE(self);
+        bindings::tree_of(self).~Tree();
+        std::destroy_at(&bindings::components_of(self));
+        std::destroy_at(&reinterpret_cast<bindings::TreeObject *>(self)->arena);
+        type->tp_free(self);
+        Py_DECREF(type);
+    }
+
+    bool check_readable(PyObject *self)
+    {
+        if (!reinterpret_cast<bindings::TreeObject *>(self)->writing)
+            return true;
+        PyErr_SetString(PyExc_RuntimeError, "Tree is being diffed by another thread");
+        return false;
+    }
+
+    Py_ssize_t tree_length(PyObject *self)
+    {
+        if (!check_readable(self))
+            return -1;
+        return static_cast<Py_ssize_t>(bindings::tree_of(self).size());
+    }
+
+    PyObject *tree_root(PyObject *self, void *)
+    {
+        if (!check_readable(self))
+            return nullptr;
+        const vdom::Tree &tree = bindings::tree_of(self);
+
+        if (tree.root() == vdom::null_node || tree.handle(tree.root()) == vdom::null_handle)
+            Py_RETURN_NONE;
+        return PyLong_FromUnsignedLongLong(tree.handle(tree.root()));
+    }
+
+    PyObject *tree_generation(PyObject *self, void *)
+    {
+        if (!check_readable(self))
+            return nullptr;
+        return PyLong_FromUnsignedLong(bindings::tree_of(self).generation());
+    }
+
+    PyGetSetDef tree_getset[] = {
+        {"root", tree_root, nullptr, "Handle of the root node, None until the tree is diffed.", nullptr},
+        {"generation", tree_generation, nullptr, "Number of diffs this tree descends from.", nullptr},
+        {nullptr, nullptr, nullptr, nullptr, nullptr}};
+
+    PyType_Slot tree_slots[] = {
+        {Py_tp_doc, const_cast<char *>("A rendered virtual DOM tree. len() is its node count.")},
+        {Py_tp_dealloc, reinterpret_cast<void *>(tree_dealloc)},
+        {Py_sq_length, reinterpret_cast<void *>(tree_length)},
+        {Py_tp_getset, tree_getset},
+        {0, nullptr}};
+
+    PyType_Spec tree_spec = {"component_engine.Tree", sizeof(bindings::TreeObject), 0,
+                             Py_TPFLAGS_DEFAULT | Py_TPFLAGS_IMMUTABLETYPE | Py_TPFLAGS_DISALLOW_INSTANTIATION, tree_slots};
+
+    PyObject *create_tree_type()
+    {
+        return PyType_FromSpec(&tree_spec);
+    }
+} // namespace
+
+PyTypeObject *bindings::tree_type()
+{
+    return python::interpreter_type(create_tree_type);
+}
+
+PyObject *bindings::new_tree(std::shared_ptr<memory::Arena> arena)
+{
+    PyTypeObject *type = tree_type();
+    PyObject *self = type ? type->tp_alloc(type, 0) : nullptr;
+
+    if (self)
+    {
+        std::pmr::memory_resource *resource = arena ? arena.get() : std::pmr::get_default_resource();
+        new (&reinterpret_cast<TreeObject *>(self)->arena) std::shared_ptr<memory::Arena>(std::move(arena));
+        new (&tree_of(self)) vdom::Tree(resource);
+        new (&components_of(self)) std::vector<snapshot::Component>();
+        reinterpret_cast<TreeObject *>(self)->readers = 0;
+        reinterpret_cast<TreeObject *>(self)->writing = false;
+    }
+    return self;
+}
+
+bool bindings::is_tree(PyObject *object)
+{
+    return Py_IS_TYPE(object, python::existing_interpreter_type(create_tree_type));
+}
+
+bindings::TreeUse::TreeUse(PyObject *tree, TreeAccess access)
+    : _tree(reinterpret_cast<TreeObject *>(tree)), _access(access)
+{
+    if (!_tree)
+        return;
+    if (_tree->writing || (access == TreeAccess::Write && _tree->readers != 0))
+        throw std::runtime_error("Tree is being diffed by another thread");
+
+    if (access == TreeAccess::Write)
+        _tree->writing = true;
+    else
+        _tree->readers++;
+}
+
+bindings::TreeUse::~TreeUse()
+{
+    if (!_tree)
+        return;
+    if (_access == TreeAccess::Write)
+        _tree->writing = false;
+    else
+        _tree->readers--;
+}
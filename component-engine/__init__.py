@@ -5,7 +5,69 @@ A declarative UI component engine for Python, inspired by React but built with a
 
 __version__ = "0.1.0"
 
+from ._core import (
+    BACKGROUND,
+    CREATE,
+    INPUT,
+    MOVE,
+    REMOVE,
+    REMOVE_PROPERTY,
+    SET_PROPERTY,
+    SET_TEXT,
+    Event,
+    PatchList,
+    PersistentMap,
+    PersistentVector,
+    Root,
+    RowIndex,
+    Tree,
+    clear_trace,
+    diff,
+    diff_threads,
+    load_snapshot,
+    render,
+    render_html,
+    save_snapshot,
+    set_diff_threads,
+    set_tracing,
+    tracing,
+    write_trace,
+)
 from .component import Component
+from .element import Element, Node
 from .properties import Properties
+from .virtual_list import VirtualList
 
-__all__ = ["Component", "Properties"]
+__all__ = [
+    "BACKGROUND",
+    "CREATE",
+    "INPUT",
+    "MOVE",
+    "REMOVE",
+    "REMOVE_PROPERTY",
+    "SET_PROPERTY",
+    "SET_TEXT",
+    "Component",
+    "Element",
+    "Event",
+    "Node",
+    "PatchList",
+    "PersistentMap",
+    "PersistentVector",
+    "Properties",
+    "Root",
+    "RowIndex",
+    "Tree",
+    "VirtualList",
+    "clear_trace",
+    "diff",
+    "diff_threads",
+    "load_snapshot",
+    "render",
+    "render_html",
+    "save_snapshot",
+    "set_diff_threads",
+    "set_tracing",
+    "tracing",
+    "write_trace",
+]
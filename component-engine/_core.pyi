@@ -0,0 +1,144 @@
+import os
+from typing import Callable, Iterable, Iterator, List, Mapping, MutableMapping, NamedTuple, Optional, Tuple
+
+from .component import Component
+from .element import Node
+
+Key = Optional[str | int | float | bool]
+Value = Key | PersistentMap | PersistentVector
+Patch = Tuple[int, int, int, int, Optional[str], Value]
+
+CREATE: int
+REMOVE: int
+MOVE: int
+SET_PROPERTY: int
+REMOVE_PROPERTY: int
+SET_TEXT: int
+INPUT: int
+BACKGROUND: int
+
+class Properties:
+    def __init__(self) -> None: ...
+    @property
+    def properties(self) -> MutableMapping[str, Value]: ...
+    def set_property(self, key: str, value: Value) -> None: ...
+    def get_property(self, key: str) -> Value: ...
+    def remove_property(self, key: str) -> None: ...
+    def clear_properties(self) -> None: ...
+    def __len__(self) -> int: ...
+    def __contains__(self, key: str) -> bool: ...
+
+class PersistentMap:
+    def __init__(self, items: Optional[Mapping[Key, Value]] = ...) -> None: ...
+    def set(self, key: Key, value: Value) -> PersistentMap: ...
+    def remove(self, key: Key) -> PersistentMap: ...
+    def update(self, items: Mapping[Key, Value]) -> PersistentMap: ...
+    def get(self, key: Key, default: Value = ...) -> Value: ...
+    def keys(self) -> List[Key]: ...
+    def values(self) -> List[Value]: ...
+    def items(self) -> List[Tuple[Key, Value]]: ...
+    def __getitem__(self, key: Key) -> Value: ...
+    def __contains__(self, key: Key) -> bool: ...
+    def __iter__(self) -> Iterator[Key]: ...
+    def __len__(self) -> int: ...
+
+class PersistentVector:
+    def __init__(self, items: Optional[Iterable[Value]] = ...) -> None: ...
+    def append(self, value: Value) -> PersistentVector: ...
+    def set(self, index: int, value: Value) -> PersistentVector: ...
+    def pop(self) -> PersistentVector: ...
+    def extend(self, items: Iterable[Value]) -> PersistentVector: ...
+    def __getitem__(self, index: int) -> Value: ...
+    def __iter__(self) -> Iterator[Value]: ...
+    def __len__(self) -> int: ...
+
+class Tree:
+    @property
+    def root(self) -> Optional[int]: ...
+    @property
+    def generation(self) -> int: ...
+    def __len__(self) -> int: ...
+
+class PatchList:
+    def __len__(self) -> int: ...
+    def __getitem__(self, index: int) -> Patch: ...
+
+class RowIndex:
+    def __init__(self, count: int = ..., estimated_height: float = ...) -> None: ...
+    @property
+    def total(self) -> float: ...
+    @property
+    def estimated_height(self) -> float: ...
+    def resize(self, count: int) -> None: ...
+    def set_height(self, row: int, height: float) -> None: ...
+    def height(self, row: int) -> float: ...
+    def offset(self, row: int) -> float: ...
+    def row_at(self, offset: float) -> int: ...
+    def window(self, scroll: float, viewport: float, overscan: int = ...) -> Tuple[int, int]: ...
+    def __len__(self) -> int: ...
+
+class Event(NamedTuple):
+    type: str
+    target: int
+    current_target: int
+    x: float
+    y: float
+    detail: int
+
+class Root:
+    def __init__(self, component: Component) -> None: ...
+    @property
+    def tree(self) -> Optional[Tree]: ...
+    @property
+    def component(self) -> Optional[Component]: ...
+    @property
+    def pending(self) -> int: ...
+    @property
+    def mounted(self) -> int: ...
+    @property
+    def renders(self) -> int: ...
+    @property
+    def skipped_renders(self) -> int: ...
+    @property
+    def arena_bytes(self) -> int: ...
+    @property
+    def arena_chunks(self) -> int: ...
+    @property
+    def detached_arenas(self) -> int: ...
+    @property
+    def layouts(self) -> int: ...
+    @property
+    def hoisted_nodes(self) -> int: ...
+    @property
+    def static_blocks(self) -> int: ...
+    @property
+    def rendering(self) -> bool: ...
+    @property
+    def abandoned_frames(self) -> int: ...
+    @property
+    def dispatched_events(self) -> int: ...
+    @property
+    def coalesced_events(self) -> int: ...
+    @property
+    def dropped_events(self) -> int: ...
+    def schedule(self, component: Component, lane: int = ...) -> bool: ...
+    def flush(self, lane: int = ...) -> PatchList: ...
+    def render_slice(self, budget: float = ..., lane: int = ...) -> Optional[PatchList]: ...
+    def save_snapshot(self, path: str | os.PathLike[str]) -> None: ...
+    def hydrate(self, tree: Tree) -> None: ...
+    def compute_layout(self, width: float, height: float) -> None: ...
+    def box(self, handle: int) -> Optional[Tuple[float, float, float, float]]: ...
+    def post(self, type: str, target: int, x: float = ..., y: float = ..., detail: int = ...) -> bool: ...
+    def dispatch(self) -> int: ...
+
+def render(component: Node) -> Tree: ...
+def render_html(component: Node, output: int | Callable[[str], object], chunk_size: int = ...) -> int: ...
+def diff(old: Optional[Tree], new: Tree) -> PatchList: ...
+def save_snapshot(tree: Tree, path: str | os.PathLike[str]) -> None: ...
+def load_snapshot(path: str | os.PathLike[str]) -> Tree: ...
+def set_diff_threads(count: int) -> None: ...
+def diff_threads() -> int: ...
+def set_tracing(enabled: bool) -> None: ...
+def tracing() -> bool: ...
+def write_trace(path: str | os.PathLike[str]) -> None: ...
+def clear_trace() -> None: ...
@@ -1,13 +1,63 @@
+from typing import Any, Dict, Optional
+
+from ._core import BACKGROUND
+from .element import Node
 from .properties import Properties
 
 
 class Component:
     """
     Base class for all UI components.
+
+    Components are memoized: render() is skipped while the properties and the
+    state are unchanged. Set memoize = False on a class whose render() reads
+    anything else.
+
+    Set pure = True on a class whose render() reads nothing but its
+    properties: a new instance replacing one of the same class at the same
+    place then reuses its output when their properties are equal, instead of
+    rendering. Leave it unset when instances carry anything else, such as
+    constructor arguments or state set in __init__.
+
+    Set static = True on a class whose render() always returns the same single
+    node, whatever the instance: it renders once, and every later instance
+    reuses a frozen copy of that output, which diffs skip entirely.
     """
 
+    memoize: bool = True
+    pure: bool = False
+    static: bool = False
+
     def __init__(self, properties: Properties) -> None:
         self.properties = properties
+        self.state: Dict[str, Any] = {}
+        # Weak reference to the Root mounting this component, set by the Root
+        self._root: Optional[Any] = None
 
-    def render(self) -> None:
+    def render(self) -> Node:
         raise NotImplementedError("Render method must be implemented by subclasses.")
+
+    def set_state(self, changes: Dict[str, Any], lane: int = BACKGROUND) -> None:
+        """
+        Merge changes into the state and schedule a re-render.
+        Successive changes before the next frame are rendered once.
+        """
+        self.state.update(changes)
+        self.invalidate(lane)
+
+    def set_properties(self, changes: Dict[str, Any], lane: int = BACKGROUND) -> None:
+        """
+        Set properties and schedule a re-render.
+        """
+        for name, value in changes.items():
+            self.properties.set_property(name, value)
+        self.invalidate(lane)
+
+    def invalidate(self, lane: int = BACKGROUND) -> bool:
+        """
+        Schedule a re-render on the next frame taking lane (INPUT or BACKGROUND).
+        Return False if the component is not mounted or already pending.
+        """
+        reference = getattr(self, "_root", None)
+        root = reference() if reference is not None else None
+        return root.schedule(self, lane) if root is not None else False
@@ -0,0 +1,29 @@
+from typing import TYPE_CHECKING, Optional, Sequence, Union
+
+from .properties import Properties
+
+if TYPE_CHECKING:
+    from .component import Component
+
+
+class Element:
+    """
+    A node of the virtual DOM, as returned by Component.render().
+    """
+
+    __slots__ = ("tag", "properties", "children", "key")
+
+    def __init__(
+        self,
+        tag: str,
+        properties: Optional[Properties] = None,
+        children: Optional[Sequence["Node"]] = None,
+        key: Optional[str | int] = None,
+    ) -> None:
+        self.tag = tag
+        self.properties = properties
+        self.children = children
+        self.key = key
+
+
+Node = Union[Element, "Component", str, int, float, bool, None, Sequence["Node"]]
@@ -1,22 +1,8 @@
-from typing import Dict, Optional
+from collections.abc import MutableMapping
 
+from ._core import Properties
 
-class Properties:
-    """
-    Class to manage properties for a UI component.
-    """
+# Properties.properties is a live view writing through to the properties
+MutableMapping.register(type(Properties().properties))
 
-    def __init__(self) -> None:
-        self.properties: Dict[str, Optional[str | int | float | bool]] = {}
-
-    def set_property(self, key: str, value: Optional[str | int | float | bool]) -> None:
-        self.properties[key] = value
-
-    def get_property(self, key: str) -> Optional[str | int | float | bool]:
-        return self.properties.get(key)
-
-    def remove_property(self, key: str) -> None:
-        self.properties.pop(key, None)
-
-    def clear_properties(self) -> None:
-        self.properties.clear()
\ No newline at end of file
+__all__ = ["Properties"]
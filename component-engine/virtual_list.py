@@ -0,0 +1,99 @@
+from typing import Any, Tuple
+
+from ._core import BACKGROUND, INPUT, Event, RowIndex
+from .component import Component
+from .element import Element, Node
+from .properties import Properties
+
+
+class VirtualList(Component):
+    """
+    A list of row_count() rows that renders only the rows in its viewport.
+
+    render() asks render_row() for the rows intersecting the viewport plus
+    `overscan` rows on each side, between two spacers standing for the rows
+    above and below, so that a list of millions of rows costs a few dozen
+    nodes. Offsets come from a RowIndex of the row heights: rows start at the
+    `row_height` estimate until measure() records their actual height.
+    Scrolling the container, or scroll_to(), renders again only when the
+    window of rows changes. Call invalidate() when row_count() changes.
+
+    Rows are wrapped in elements keyed by slot, the row number modulo the
+    largest window rendered so far, so that a row scrolling in takes over the
+    slot and the nodes of the row scrolling out: scrolling emits a move and
+    updates rather than removals and creations. Rows must therefore not keep
+    state in their nodes. Each wrapper carries its row number in its "row"
+    property, for backends reporting measured heights.
+
+    The slot is not what memoizes rows: a component returned by render_row()
+    is a new instance, rendered again unless its class is pure and its
+    properties equal those of the row that held the slot before. Pure rows
+    must thus carry everything they show, the row number included if they
+    show it, in their properties.
+
+    Properties: height (of the viewport, default 400), row_height (default
+    20), overscan (default 8) and tag (of the container, default "div").
+    """
+
+    def __init__(self, properties: Properties) -> None:
+        super().__init__(properties)
+        self.rows = RowIndex(0, self._property("row_height", 20.0))
+        self.state = {"scroll": 0.0}
+        self._window: Tuple[int, int] = (0, 0)
+        self._slots = 1
+
+    def row_count(self) -> int:
+        raise NotImplementedError("row_count method must be implemented by subclasses.")
+
+    def render_row(self, index: int) -> Node:
+        raise NotImplementedError("render_row method must be implemented by subclasses.")
+
+    def _property(self, name: str, default: Any) -> Any:
+        value = self.properties.get_property(name) if self.properties is not None else None
+        return default if value is None else value
+
+    def window(self) -> Tuple[int, int]:
+        """
+        Get the rows (first, last) to render at the current scroll offset, last excluded.
+        """
+        return self.rows.window(self.state["scroll"], self._property("height", 400.0), self._property("overscan", 8))
+
+    def scroll_to(self, offset: float, lane: int = INPUT) -> bool:
+        """
+        Scroll the viewport to an offset from the top of the first row.
+        Return True if a render was scheduled to show other rows.
+        """
+        self.state["scroll"] = max(0.0, float(offset))
+        return self.window() != self._window and self.invalidate(lane)
+
+    def measure(self, index: int, height: float, lane: int = BACKGROUND) -> bool:
+        """
+        Record the measured height of a row.
+        Return True if a render was scheduled to move the rows after it.
+        """
+        if self.rows.height(index) == height:
+            return False
+        self.rows.set_height(index, height)
+        return self.invalidate(lane)
+
+    def scrolled(self, event: Event) -> bool:
+        """
+        Handle the scroll events of the container, whose y is the scroll offset.
+        """
+        self.scroll_to(event.y)
+        return True
+
+    def render(self) -> Node:
+        count = self.row_count()
+        if len(self.rows) != count:
+            self.rows.resize(count)
+
+        first, last = self._window = self.window()
+        self._slots = max(self._slots, last - first)
+        children = [Element("div", {"height": self.rows.offset(first)}, key="before")]
+        for row in range(first, last):
+            children.append(Element("div", {"row": row}, [self.render_row(row)], key=row % self._slots))
+        children.append(Element("div", {"height": self.rows.total - self.rows.offset(last)}, key="after"))
+
+        container = {"height": self._property("height", 400.0), "on_scroll": self.scrolled}
+        return Element(self._property("tag", "div"), container, children)
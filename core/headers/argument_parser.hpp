@@ -1,6 +1,15 @@
 #pragma once
 
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <map>
 #include <memory>
@@ -10,6 +19,8 @@
 #include <stdexcept>
 #include <typeinfo>
 #include <type_traits>
+#include <utility>
+#include <variant>
 #include <algorithm>
 #include <cctype>
 
@@ -29,78 +40,455 @@ namespace argument_parser
         explicit ArgumentTypeError(const std::string &message) : std::runtime_error(message) {}
     };
 
+    // Number of values an argument consumes, parsed once from the argparse strings
+    enum class Nargs : std::uint8_t
+    {
+        Single,     // "" or "1"
+        Zero,       // "0", and every action storing a constant
+        Optional,   // "?"
+        ZeroOrMore, // "*"
+        OneOrMore   // "+"
+    };
+
+    // What an argument does when it is met, so that dispatch needs no RTTI
+    enum class ActionKind : std::uint8_t
+    {
+        Store,
+        StoreConst,
+        Help,
+        Version
+    };
+
+    // Convert an argparse nargs string; throws ArgumentError for unsupported ones
+    Nargs parse_nargs(const std::string &nargs);
+
     // Forward declarations
     class Action;
     class ArgumentParser;
 
-    // Namespace to hold parsed arguments
+    namespace detail
+    {
+        constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+        constexpr std::uint16_t empty_slot = 0xFFFF;
+
+        constexpr bool is_option(std::string_view argument) noexcept
+        {
+            return !argument.empty() && argument[0] == '-';
+        }
+
+        // "-2", "-2.5" or "-.5", as argparse matches negative numbers
+        constexpr bool is_negative_number(std::string_view argument) noexcept
+        {
+            if (argument.size() < 2 || argument[0] != '-')
+                return false;
+            auto digits = [](std::string_view text)
+            {
+                return std::all_of(text.begin(), text.end(), [](char character)
+                                   { return character >= '0' && character <= '9'; });
+            };
+            const std::string_view number = argument.substr(1);
+            const std::size_t point = number.find('.');
+            if (point == std::string_view::npos)
+                return digits(number);
+            return point + 1 < number.size() && digits(number.substr(0, point)) && digits(number.substr(point + 1));
+        }
+
+        // Seeded FNV-1a, evaluated at compile time for schemas
+        constexpr std::uint64_t hash(std::string_view text, std::uint64_t seed) noexcept
+        {
+            std::uint64_t result = 0xCBF29CE484222325ull ^ (seed * 0x9E3779B97F4A7C15ull);
+            for (char character : text)
+            {
+                result ^= static_cast<unsigned char>(character);
+                result *= 0x100000001B3ull;
+            }
+            return result ^ (result >> 29);
+        }
+
+        // Slots for a perfect hash of keys: a power of two, sparse enough for a seed to be found in a few tries
+        constexpr std::size_t table_size(std::size_t keys) noexcept
+        {
+            return std::bit_ceil(std::max<std::size_t>({keys * 2, keys * keys / 2, 2}));
+        }
+
+        // Find a seed mapping every non-empty key to its own slot, and fill slots with the key indices
+        constexpr std::uint64_t build_perfect_hash(std::span<const std::string_view> keys, std::span<std::uint16_t> slots)
+        {
+            for (std::size_t index = 0; index < keys.size(); ++index)
+            {
+                for (std::size_t other = 0; other < index; ++other)
+                {
+                    if (!keys[index].empty() && keys[index] == keys[other])
+                        throw ArgumentError("Duplicate option string: " + std::string(keys[index]));
+                }
+            }
+
+            const std::size_t mask = slots.size() - 1;
+            for (std::uint64_t seed = 0;; ++seed)
+            {
+                for (std::uint16_t &slot : slots)
+                    slot = empty_slot;
+
+                bool collision = false;
+                for (std::size_t index = 0; index < keys.size() && !collision; ++index)
+                {
+                    if (keys[index].empty())
+                        continue;
+                    std::uint16_t &slot = slots[hash(keys[index], seed) & mask];
+                    collision = slot != empty_slot;
+                    slot = static_cast<std::uint16_t>(index);
+                }
+                if (!collision)
+                    return seed;
+            }
+        }
+
+        // Index of key in keys, or npos: one hash and one comparison
+        constexpr std::size_t find_perfect_hash(std::span<const std::string_view> keys, std::span<const std::uint16_t> slots,
+                                                std::uint64_t seed, std::string_view key) noexcept
+        {
+            const std::uint16_t slot = slots[hash(key, seed) & (slots.size() - 1)];
+            return slot != empty_slot && keys[slot] == key ? slot : npos;
+        }
+
+        // The parse loop shared by ArgumentParser and schemas. Table provides
+        // find(option) and positional(position), returning an argument index or
+        // npos, and nargs(argument); Sink receives store(argument, first, count,
+        // option) for the values arguments[first, first + count), and error(message),
+        // which must not return. Returns the number of positional arguments met.
+        template <typename Table, typename Arguments, typename Sink>
+        std::size_t parse_arguments(const Table &table, const Arguments &arguments, Sink &sink)
+        {
+            // Negative numbers are values, unless the table has an option spelled that way
+            auto is_flag = [&](std::string_view argument)
+            { return is_option(argument) && !(is_negative_number(argument) && table.find(argument) == npos); };
+
+            std::size_t positional = 0;
+            for (std::size_t index = 0; index < arguments.size(); ++index)
+            {
+                const std::string_view argument = arguments[index];
+                if (!is_flag(argument))
+                {
+                    const std::size_t action = table.positional(positional++);
+                    if (action == npos)
+                        sink.error("Too many positional arguments: " + std::string(argument));
+                    sink.store(action, index, 1, std::string_view());
+                    continue;
+                }
+
+                const std::size_t action = table.find(argument);
+                if (action == npos)
+                    sink.error("Unrecognized argument: " + std::string(argument));
+
+                const std::size_t first = index + 1;
+                std::size_t count = 0;
+                auto available = [&]
+                { return first + count < arguments.size() && !is_flag(arguments[first + count]); };
+
+                switch (table.nargs(action))
+                {
+                case Nargs::Zero:
+                    break;
+                case Nargs::Single:
+                case Nargs::Optional:
+                    count = available() ? 1 : 0;
+                    break;
+                case Nargs::OneOrMore:
+                    if (!available())
+                        sink.error("Argument " + std::string(argument) + " expected at least one argument");
+                    [[fallthrough]];
+                case Nargs::ZeroOrMore:
+                    while (available())
+                        ++count;
+                    break;
+                }
+
+                index += count;
+                sink.store(action, first, count, argument);
+            }
+            return positional;
+        }
+
+        // Strict conversion of a whole value, without allocating
+        template <typename T>
+        T convert(std::string_view value)
+        {
+            if constexpr (std::is_same_v<T, std::string_view>)
+            {
+                return value;
+            }
+            else if constexpr (std::is_same_v<T, std::string>)
+            {
+                return std::string(value);
+            }
+            else if constexpr (std::is_same_v<T, bool>)
+            {
+                auto equals = [value](std::string_view word)
+                {
+                    return std::equal(value.begin(), value.end(), word.begin(), word.end(), [](char left, char right)
+                                      { return std::tolower(static_cast<unsigned char>(left)) == right; });
+                };
+                return equals("true") || equals("1") || equals("yes") || equals("on");
+            }
+            else if constexpr (std::is_integral_v<T>)
+            {
+                T result{};
+                auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), result);
+                if (error != std::errc() || end != value.data() + value.size())
+                    throw ArgumentTypeError("Invalid integer value: '" + std::string(value) + "'");
+                return result;
+            }
+            else if constexpr (std::is_floating_point_v<T>)
+            {
+                // strtod needs a terminator, which a view into a larger string lacks
+                char buffer[64];
+                if (value.empty() || value.size() >= sizeof(buffer))
+                    throw ArgumentTypeError("Invalid number value: '" + std::string(value) + "'");
+                std::copy(value.begin(), value.end(), buffer);
+                buffer[value.size()] = '\0';
+                char *end = nullptr;
+                const double result = std::strtod(buffer, &end);
+                if (end != buffer + value.size())
+                    throw ArgumentTypeError("Invalid number value: '" + std::string(value) + "'");
+                return static_cast<T>(result);
+            }
+            else
+            {
+                static_assert(std::is_same_v<T, void>, "Unsupported type for argument conversion");
+            }
+        }
+    } // namespace detail
+
+    // Type a store argument's values are converted to, once, when they are parsed
+    enum class ValueType : std::uint8_t
+    {
+        String,
+        Integer, // std::int64_t
+        Float,   // double
+        Bool     // "true", "1", "yes" or "on", in any case
+    };
+
+    // Namespace to hold parsed arguments, one typed slot per destination.
+    // Slots are addressed by a Handle, which stays valid for every Namespace
+    // parsed by the same parser, so that code reading a value repeatedly can
+    // look its name up once, e.g.
+    //
+    //     const auto jobs = parser.handle("jobs");
+    //     auto arguments = parser.parse_args();
+    //     int count = arguments.get<int>(jobs);
+    //
+    // Values of arguments taking "*" or "+" are kept as a vector of the
+    // argument's type rather than joined into a string.
     class Namespace
     {
+    public:
+        using Handle = std::size_t;
+        using Strings = std::vector<std::string>;
+        using Integers = std::vector<std::int64_t>;
+        using Floats = std::vector<double>;
+        using Value = std::variant<std::string, std::int64_t, double, bool, Strings, Integers, Floats>;
+
     private:
-        std::map<std::string, std::string> values_;
+        struct Slot
+        {
+            std::string key;
+            Value value;
+            bool present = false;
+        };
+
+        std::vector<Slot> slots_;
+
+        const Slot &checked(Handle handle) const
+        {
+            if (handle >= slots_.size() || !slots_[handle].present)
+            {
+                throw ArgumentError("Argument '" + (handle < slots_.size() ? slots_[handle].key : std::to_string(handle)) + "' not found");
+            }
+            return slots_[handle];
+        }
+
+        [[noreturn]] static void mismatch(const Slot &slot, const char *type)
+        {
+            throw ArgumentTypeError("Argument '" + slot.key + "' does not hold " + type);
+        }
+
+        [[noreturn]] static void out_of_range(const Slot &slot)
+        {
+            throw ArgumentTypeError("Argument '" + slot.key + "' holds " + format(slot.value) + ", out of range for the requested type");
+        }
+
+        static std::string format(const Value &value);
 
     public:
-        void set(const std::string &key, const std::string &value)
+        Namespace() = default;
+
+        // Reserve a slot per key, in order, so that handles match the parser's
+        explicit Namespace(const std::vector<std::string> &keys)
         {
-            values_[key] = value;
+            slots_.reserve(keys.size());
+            for (const auto &key : keys)
+            {
+                slots_.push_back({key, {}, false});
+            }
         }
 
-        template <typename T>
-        T get(const std::string &key) const
+        // Find a slot; throws ArgumentError for an unknown key
+        Handle handle(const std::string &key) const
         {
-            auto it = values_.find(key);
-            if (it == values_.end())
+            for (Handle index = 0; index < slots_.size(); ++index)
             {
-                throw ArgumentError("Argument '" + key + "' not found");
+                if (slots_[index].key == key)
+                    return index;
             }
-            return convert_to<T>(it->second);
+            throw ArgumentError("Argument '" + key + "' not found");
         }
 
-        bool has(const std::string &key) const
+        // Find a slot, adding one for an unknown key
+        Handle slot(const std::string &key)
         {
-            return values_.find(key) != values_.end();
+            for (Handle index = 0; index < slots_.size(); ++index)
+            {
+                if (slots_[index].key == key)
+                    return index;
+            }
+            slots_.push_back({key, {}, false});
+            return slots_.size() - 1;
         }
 
-        const std::map<std::string, std::string> &get_all() const
+        void store(Handle handle, Value value)
         {
-            return values_;
+            slots_.at(handle).value = std::move(value);
+            slots_[handle].present = true;
         }
 
-    private:
+        void store(const std::string &key, Value value)
+        {
+            store(slot(key), std::move(value));
+        }
+
+        void set(const std::string &key, const std::string &value)
+        {
+            store(slot(key), value);
+        }
+
+        // Read a value as T. Strings, integers, doubles, bools and the vectors
+        // are returned as stored, std::string_view and std::span view them in
+        // place, and arithmetic types convert between each other, throwing
+        // ArgumentTypeError for values out of range of T. An argument added
+        // without a type holds a string, converted on every call.
+        // std::string formats any value, joining vectors with spaces.
         template <typename T>
-        T convert_to(const std::string &value) const
+        T get(Handle handle) const
         {
+            const Slot &slot = checked(handle);
+            const Value &value = slot.value;
+            const std::string *string = std::get_if<std::string>(&value);
+
             if constexpr (std::is_same_v<T, std::string>)
             {
-                return value;
+                return string ? *string : format(value);
             }
-            else if constexpr (std::is_same_v<T, int>)
+            else if constexpr (std::is_same_v<T, std::string_view>)
             {
-                return std::stoi(value);
+                if (!string)
+                    mismatch(slot, "a string");
+                return *string;
             }
-            else if constexpr (std::is_same_v<T, long>)
+            else if constexpr (std::is_same_v<T, bool>)
             {
-                return std::stol(value);
+                if (const bool *flag = std::get_if<bool>(&value))
+                    return *flag;
+                if (!string)
+                    mismatch(slot, "a bool");
+                return detail::convert<bool>(*string);
             }
-            else if constexpr (std::is_same_v<T, float>)
+            else if constexpr (std::is_arithmetic_v<T>)
             {
-                return std::stof(value);
+                // Values that do not fit T are refused rather than narrowed
+                if (const std::int64_t *integer = std::get_if<std::int64_t>(&value))
+                {
+                    if constexpr (std::is_integral_v<T>)
+                    {
+                        if (!std::in_range<T>(*integer))
+                            out_of_range(slot);
+                    }
+                    return static_cast<T>(*integer);
+                }
+                if (const double *number = std::get_if<double>(&value))
+                {
+                    if constexpr (std::is_integral_v<T>)
+                        mismatch(slot, "an integer");
+                    else if constexpr (sizeof(T) < sizeof(double))
+                    {
+                        if (std::isfinite(*number) && std::abs(*number) > static_cast<double>(std::numeric_limits<T>::max()))
+                            out_of_range(slot);
+                    }
+                    return static_cast<T>(*number);
+                }
+                if (!string)
+                    mismatch(slot, "a number");
+                return detail::convert<T>(*string);
             }
-            else if constexpr (std::is_same_v<T, double>)
+            else if constexpr (std::is_same_v<T, Strings> || std::is_same_v<T, Integers> || std::is_same_v<T, Floats>)
             {
-                return std::stod(value);
+                const T *values = std::get_if<T>(&value);
+                if (!values)
+                    mismatch(slot, "a list of that type");
+                return *values;
             }
-            else if constexpr (std::is_same_v<T, bool>)
+            else if constexpr (std::is_same_v<T, std::span<const std::string>> ||
+                               std::is_same_v<T, std::span<const std::int64_t>> ||
+                               std::is_same_v<T, std::span<const double>>)
             {
-                std::string lower = value;
-                std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
-                return lower == "true" || lower == "1" || lower == "yes" || lower == "on";
+                using Vector = std::vector<std::remove_const_t<typename T::element_type>>;
+                const Vector *values = std::get_if<Vector>(&value);
+                if (!values)
+                    mismatch(slot, "a list of that type");
+                return T(*values);
             }
             else
             {
                 static_assert(std::is_same_v<T, void>, "Unsupported type for argument conversion");
             }
         }
+
+        template <typename T>
+        T get(const std::string &key) const
+        {
+            return get<T>(handle(key));
+        }
+
+        const Value &value(Handle handle) const
+        {
+            return checked(handle).value;
+        }
+
+        bool has(Handle handle) const
+        {
+            return handle < slots_.size() && slots_[handle].present;
+        }
+
+        bool has(const std::string &key) const
+        {
+            for (const auto &slot : slots_)
+            {
+                if (slot.key == key)
+                    return slot.present;
+            }
+            return false;
+        }
+
+        // Every present value, formatted as by get<std::string>
+        std::map<std::string, std::string> get_all() const
+        {
+            std::map<std::string, std::string> values;
+            for (const auto &slot : slots_)
+            {
+                if (slot.present)
+                    values.emplace(slot.key, format(slot.value));
+            }
+            return values;
+        }
     };
 
     // Base Action class
@@ -109,26 +497,30 @@ namespace argument_parser
     public:
         std::vector<std::string> option_strings;
         std::string dest;
-        std::string nargs;
+        ActionKind kind;
+        Nargs nargs;
         std::string const_value;
         std::string default_value;
         std::string help;
         std::string metavar;
         bool required;
         std::vector<std::string> choices;
+        ValueType type;
 
-        Action(const std::vector<std::string> &option_strings,
+        Action(ActionKind kind,
+               const std::vector<std::string> &option_strings,
                const std::string &dest,
-               const std::string &nargs = "",
+               Nargs nargs = Nargs::Single,
                const std::string &const_value = "",
                const std::string &default_value = "",
                const std::string &help = "",
                const std::string &metavar = "",
                bool required = false,
-               const std::vector<std::string> &choices = {})
-            : option_strings(option_strings), dest(dest), nargs(nargs),
+               const std::vector<std::string> &choices = {},
+               ValueType type = ValueType::String)
+            : option_strings(option_strings), dest(dest), kind(kind), nargs(nargs),
               const_value(const_value), default_value(default_value),
-              help(help), metavar(metavar), required(required), choices(choices) {}
+              help(help), metavar(metavar), required(required), choices(choices), type(type) {}
 
         virtual ~Action() = default;
 
@@ -137,6 +529,13 @@ namespace argument_parser
                           const std::string &option_string = "") = 0;
 
         virtual std::string format_usage() const;
+
+        // Convert values to the slot stored for them: a single value for
+        // every nargs but "*" and "+", which take a vector of them.
+        // Throws ArgumentTypeError for a value that is not of the type.
+        Namespace::Value convert(const std::vector<std::string> &values) const;
+        Namespace::Value convert(const std::string &value) const;
+
         bool is_optional() const { return !option_strings.empty() && option_strings[0][0] == '-'; }
         bool is_positional() const { return !is_optional(); }
     };
@@ -153,8 +552,9 @@ namespace argument_parser
                     const std::string &help = "",
                     const std::string &metavar = "",
                     bool required = false,
-                    const std::vector<std::string> &choices = {})
-            : Action(option_strings, dest, nargs, const_value, default_value, help, metavar, required, choices) {}
+                    const std::vector<std::string> &choices = {},
+                    ValueType type = ValueType::String)
+            : Action(ActionKind::Store, option_strings, dest, parse_nargs(nargs), const_value, default_value, help, metavar, required, choices, type) {}
 
         void call(ArgumentParser &parser, Namespace &namespace_obj,
                   const std::vector<std::string> &values,
@@ -169,8 +569,9 @@ namespace argument_parser
                          const std::string &const_value,
                          const std::string &default_value = "",
                          const std::string &help = "",
-                         bool required = false)
-            : Action(option_strings, dest, "", const_value, default_value, help, "", required) {}
+                         bool required = false,
+                         ValueType type = ValueType::String)
+            : Action(ActionKind::StoreConst, option_strings, dest, Nargs::Zero, const_value, default_value, help, "", required, {}, type) {}
 
         void call(ArgumentParser &parser, Namespace &namespace_obj,
                   const std::vector<std::string> &values,
@@ -183,7 +584,7 @@ namespace argument_parser
         StoreTrueAction(const std::vector<std::string> &option_strings,
                         const std::string &dest,
                         const std::string &help = "")
-            : StoreConstAction(option_strings, dest, "true", "false", help) {}
+            : StoreConstAction(option_strings, dest, "true", "false", help, false, ValueType::Bool) {}
     };
 
     class StoreFalseAction : public StoreConstAction
@@ -192,14 +593,14 @@ namespace argument_parser
         StoreFalseAction(const std::vector<std::string> &option_strings,
                          const std::string &dest,
                          const std::string &help = "")
-            : StoreConstAction(option_strings, dest, "false", "true", help) {}
+            : StoreConstAction(option_strings, dest, "false", "true", help, false, ValueType::Bool) {}
     };
 
     class HelpAction : public Action
     {
     public:
         HelpAction(const std::vector<std::string> &option_strings = {"-h", "--help"})
-            : Action(option_strings, "help", "", "", "", "show this help message and exit") {}
+            : Action(ActionKind::Help, option_strings, "help", Nargs::Zero, "", "", "show this help message and exit") {}
 
         void call(ArgumentParser &parser, Namespace &namespace_obj,
                   const std::vector<std::string> &values,
@@ -215,7 +616,7 @@ namespace argument_parser
         VersionAction(const std::vector<std::string> &option_strings,
                       const std::string &version,
                       const std::string &help = "show program's version number and exit")
-            : Action(option_strings, "version", "", "", "", help), version_(version) {}
+            : Action(ActionKind::Version, option_strings, "version", Nargs::Zero, "", "", help), version_(version) {}
 
         void call(ArgumentParser &parser, Namespace &namespace_obj,
                   const std::vector<std::string> &values,
@@ -230,8 +631,15 @@ namespace argument_parser
         std::string description_;
         std::string epilog_;
         std::vector<std::unique_ptr<Action>> actions_;
-        std::map<std::string, Action *> option_string_actions_;
+        // Option strings, the action of each, and their perfect hash, rebuilt after add_argument
+        std::vector<std::string_view> option_strings_;
+        std::vector<Action *> option_actions_;
+        std::vector<std::uint16_t> option_slots_;
+        std::uint64_t option_seed_;
+        bool option_table_stale_;
         std::vector<Action *> positional_actions_;
+        // Destinations in the order of their Namespace slots
+        std::vector<std::string> dests_;
         std::vector<std::string> args_;
         bool add_help_;
 
@@ -255,7 +663,8 @@ namespace argument_parser
                              const std::string &help = "",
                              const std::string &metavar = "",
                              bool required = false,
-                             const std::vector<std::string> &choices = {});
+                             const std::vector<std::string> &choices = {},
+                             ValueType type = ValueType::String);
 
         Action &add_argument(const std::vector<std::string> &name_or_flags,
                              const std::string &action = "store",
@@ -265,18 +674,23 @@ namespace argument_parser
                              const std::string &help = "",
                              const std::string &metavar = "",
                              bool required = false,
-                             const std::vector<std::string> &choices = {});
+                             const std::vector<std::string> &choices = {},
+                             ValueType type = ValueType::String);
 
         // Parse methods
         Namespace parse_args(const std::vector<std::string> &args = {});
         Namespace parse_known_args(const std::vector<std::string> &args = {});
 
+        // Handle of a destination's slot in every Namespace this parser returns;
+        // throws ArgumentError for an unknown destination
+        Namespace::Handle handle(const std::string &dest) const;
+
         // Help and usage
         std::string format_usage() const;
         std::string format_help() const;
         void print_usage() const;
         void print_help() const;
-        void error(const std::string &message);
+        [[noreturn]] void error(const std::string &message);
 
         // Getters
         const std::string &get_prog() const { return prog_; }
@@ -286,6 +700,12 @@ namespace argument_parser
         void validate_choices(const std::string &value, const std::vector<std::string> &choices);
 
     private:
+        struct Table;
+        struct Sink;
+
+        void register_option(const std::string &option_string, Action *action);
+        void build_option_table();
+
         std::unique_ptr<Action> create_action(const std::string &action_type,
                                               const std::vector<std::string> &option_strings,
                                               const std::string &dest,
@@ -295,11 +715,266 @@ namespace argument_parser
                                               const std::string &help,
                                               const std::string &metavar,
                                               bool required,
-                                              const std::vector<std::string> &choices);
+                                              const std::vector<std::string> &choices,
+                                              ValueType type);
 
         std::string get_dest(const std::vector<std::string> &option_strings);
         std::vector<std::string> split_args(const std::string &args_string);
         bool is_optional_string(const std::string &arg);
     };
 
+    // Compile-time front end: a schema declared as a constant, whose option
+    // lookup is a perfect hash computed by the compiler, parsed into Results
+    // that view argv and allocate nothing, e.g.
+    //
+    //     constexpr auto schema = argument_parser::make_schema(
+    //         argument_parser::option("-f", "--filter", "only run matching benchmarks", "FILTER"),
+    //         argument_parser::flag("-v", "--verbose", "print more"),
+    //         argument_parser::positional("input"));
+    //     auto arguments = argument_parser::parse(schema, argc, argv);
+    //     std::string_view filter = arguments.get<std::string_view>("filter");
+    //
+    // Destinations are looked up with '-' and '_' as the same character.
+
+    struct Argument
+    {
+        std::string_view short_flag;
+        std::string_view long_flag;
+        std::string_view dest;
+        ActionKind kind = ActionKind::Store;
+        Nargs nargs = Nargs::Single;
+        std::string_view const_value;
+        std::string_view default_value;
+        std::string_view help;
+        std::string_view metavar;
+        bool required = false;
+
+        constexpr bool is_optional() const noexcept
+        {
+            return detail::is_option(short_flag) || detail::is_option(long_flag);
+        }
+    };
+
+    namespace detail
+    {
+        constexpr std::string_view dest_of(std::string_view short_flag, std::string_view long_flag) noexcept
+        {
+            if (long_flag.starts_with("--"))
+                return long_flag.substr(2);
+            return short_flag.substr(std::min<std::size_t>(1, short_flag.size()));
+        }
+
+        constexpr bool same_dest(std::string_view left, std::string_view right) noexcept
+        {
+            return std::equal(left.begin(), left.end(), right.begin(), right.end(), [](char a, char b)
+                              { return a == b || ((a == '-' || a == '_') && (b == '-' || b == '_')); });
+        }
+
+        // The arguments after the program name, viewed as strings
+        struct Argv
+        {
+            const char *const *values;
+            std::size_t count;
+
+            std::size_t size() const noexcept { return count; }
+            std::string_view operator[](std::size_t index) const noexcept { return values[index]; }
+        };
+    } // namespace detail
+
+    // An option storing the value that follows it
+    constexpr Argument option(std::string_view short_flag, std::string_view long_flag,
+                              std::string_view help = {}, std::string_view metavar = {},
+                              std::string_view default_value = {}, Nargs nargs = Nargs::Single)
+    {
+        return {short_flag, long_flag, detail::dest_of(short_flag, long_flag), ActionKind::Store, nargs,
+                {}, default_value, help, metavar, false};
+    }
+
+    // An option storing "true" when present, "false" otherwise
+    constexpr Argument flag(std::string_view short_flag, std::string_view long_flag, std::string_view help = {})
+    {
+        return {short_flag, long_flag, detail::dest_of(short_flag, long_flag), ActionKind::StoreConst, Nargs::Zero,
+                "true", "false", help, {}, false};
+    }
+
+    // A required positional argument
+    constexpr Argument positional(std::string_view name, std::string_view help = {}, std::string_view metavar = {})
+    {
+        return {{}, {}, name, ActionKind::Store, Nargs::Single, {}, {}, help, metavar, true};
+    }
+
+    // -h/--help, reported by Results::has("help") rather than printed
+    constexpr Argument help_option()
+    {
+        return {"-h", "--help", "help", ActionKind::Help, Nargs::Zero, {}, {}, "show this help message and exit", {}, false};
+    }
+
+    template <std::size_t N>
+    class Schema
+    {
+    private:
+        static constexpr std::size_t key_count = 2 * N;
+
+        std::array<Argument, N> arguments_;
+        std::array<std::string_view, key_count> keys_; // Short then long flag of each argument, empty if none
+        std::array<std::uint16_t, detail::table_size(key_count)> slots_;
+        std::uint64_t seed_;
+        std::array<std::uint16_t, N> positionals_;
+        std::size_t positional_count_;
+
+    public:
+        constexpr explicit Schema(const std::array<Argument, N> &arguments)
+            : arguments_(arguments), keys_(), slots_(), seed_(0), positionals_(), positional_count_(0)
+        {
+            static_assert(N < detail::empty_slot / 2, "Too many arguments in schema");
+            for (std::size_t index = 0; index < N; ++index)
+            {
+                if (arguments_[index].is_optional())
+                {
+                    keys_[2 * index] = arguments_[index].short_flag;
+                    keys_[2 * index + 1] = arguments_[index].long_flag;
+                }
+                else
+                {
+                    positionals_[positional_count_++] = static_cast<std::uint16_t>(index);
+                }
+            }
+            seed_ = detail::build_perfect_hash(keys_, slots_);
+        }
+
+        constexpr std::size_t size() const noexcept { return N; }
+        constexpr const Argument &operator[](std::size_t index) const noexcept { return arguments_[index]; }
+        constexpr Nargs nargs(std::size_t index) const noexcept { return arguments_[index].nargs; }
+
+        // Index of the argument with an option string, or npos
+        constexpr std::size_t find(std::string_view option_string) const noexcept
+        {
+            const std::size_t key = detail::find_perfect_hash(keys_, slots_, seed_, option_string);
+            return key == detail::npos ? detail::npos : key / 2;
+        }
+
+        // Index of the argument receiving the position-th positional value, or npos
+        constexpr std::size_t positional(std::size_t position) const noexcept
+        {
+            return position < positional_count_ ? positionals_[position] : detail::npos;
+        }
+
+        // Index of the argument with a destination, or npos
+        constexpr std::size_t index(std::string_view dest) const noexcept
+        {
+            for (std::size_t index = 0; index < N; ++index)
+            {
+                if (detail::same_dest(arguments_[index].dest, dest))
+                    return index;
+            }
+            return detail::npos;
+        }
+    };
+
+    template <typename... Arguments>
+    constexpr Schema<sizeof...(Arguments)> make_schema(const Arguments &...arguments)
+    {
+        return Schema<sizeof...(Arguments)>(std::array<Argument, sizeof...(Arguments)>{arguments...});
+    }
+
+    // Parsed values of a schema, viewing the argv they came from
+    template <std::size_t N>
+    class Results
+    {
+    private:
+        struct Slot
+        {
+            std::uint32_t first = 0;
+            std::uint32_t count = 0;
+            bool present = false;
+        };
+
+        const Schema<N> *schema_;
+        const char *const *arguments_;
+        std::array<Slot, N> slots_;
+
+        std::size_t index_of(std::string_view dest) const
+        {
+            const std::size_t index = schema_->index(dest);
+            if (index == detail::npos)
+                throw ArgumentError("Argument '" + std::string(dest) + "' not found");
+            return index;
+        }
+
+    public:
+        Results(const Schema<N> &schema, const char *const *arguments)
+            : schema_(&schema), arguments_(arguments), slots_() {}
+
+        // Record the values arguments[first, first + count) of an argument, for parse()
+        void store(std::size_t argument, std::size_t first, std::size_t count)
+        {
+            slots_[argument] = {static_cast<std::uint32_t>(first), static_cast<std::uint32_t>(count), true};
+        }
+
+        bool present(std::size_t argument) const noexcept { return slots_[argument].present; }
+
+        // Whether the argument was given or has a default
+        bool has(std::string_view dest) const
+        {
+            const std::size_t index = index_of(dest);
+            return slots_[index].present || !(*schema_)[index].default_value.empty();
+        }
+
+        // The first value of the argument, its constant, or its default
+        template <typename T>
+        T get(std::string_view dest) const
+        {
+            const std::size_t index = index_of(dest);
+            const Argument &argument = (*schema_)[index];
+            const Slot &slot = slots_[index];
+
+            std::string_view value = argument.default_value;
+            if (slot.present && slot.count > 0)
+                value = arguments_[slot.first];
+            else if (slot.present && !argument.const_value.empty())
+                value = argument.const_value;
+            else if (!slot.present && value.empty())
+                throw ArgumentError("Argument '" + std::string(dest) + "' not found");
+            return detail::convert<T>(value);
+        }
+
+        // Every value of the argument, for nargs "*" and "+"
+        std::span<const char *const> values(std::string_view dest) const
+        {
+            const Slot &slot = slots_[index_of(dest)];
+            return {arguments_ + slot.first, slot.count};
+        }
+    };
+
+    // Parse argv against a schema; throws ArgumentError, and allocates only to report one
+    template <std::size_t N>
+    Results<N> parse(const Schema<N> &schema, int argc, const char *const argv[])
+    {
+        const detail::Argv arguments{argc > 1 ? argv + 1 : argv, argc > 1 ? static_cast<std::size_t>(argc - 1) : 0};
+        Results<N> results(schema, arguments.values);
+
+        struct Sink
+        {
+            Results<N> &results;
+
+            void store(std::size_t argument, std::size_t first, std::size_t count, std::string_view)
+            {
+                results.store(argument, first, count);
+            }
+
+            [[noreturn]] void error(const std::string &message) { throw ArgumentError(message); }
+        } sink{results};
+
+        const std::size_t positionals = detail::parse_arguments(schema, arguments, sink);
+        for (std::size_t index = 0; index < N; ++index)
+        {
+            const Argument &argument = schema[index];
+            if (argument.is_optional() && argument.required && !results.present(index))
+                throw ArgumentError("Argument " + std::string(argument.dest) + " is required");
+        }
+        if (schema.positional(positionals) != detail::npos)
+            throw ArgumentError("The following arguments are required: " + std::string(schema[schema.positional(positionals)].dest));
+        return results;
+    }
+
 } // namespace argument_parser
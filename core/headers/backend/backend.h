@@ -0,0 +1,152 @@
+/*
+ * Stable C interface of renderer backends
+ *
+ * A backend is a shared library exporting ce_backend_entry(), which returns
+ * a table of functions. The engine creates backend instances through it, and
+ * hands each instance the patches of a frame in a single apply() call: one
+ * contiguous array of ce_patch, plus the table of interned names the patches
+ * refer to by atom. Nothing is called per node, so a backend is free to apply
+ * a batch however suits its platform, e.g. all creations first.
+ *
+ * Only plain C types cross the interface; it does not change within an ABI
+ * version, and later versions only append to the end of the structures.
+ * Backends written in C++ must not let exceptions escape their functions.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#if defined(_WIN32)
+#define CE_BACKEND_EXPORT __declspec(dllexport)
+#else
+#define CE_BACKEND_EXPORT __attribute__((visibility("default")))
+#endif
+
+/* Version of this interface; a backend built for another version is refused */
+#define CE_BACKEND_ABI_VERSION 1
+
+/* Name of the function every backend library exports, see ce_backend_entry_function */
+#define CE_BACKEND_ENTRY "ce_backend_entry"
+
+    /* Identity of a node across frames, 0 for none */
+    typedef uint64_t ce_handle;
+
+    /* Index of an interned tag or property name in ce_frame.atoms, 0 for none */
+    typedef uint32_t ce_atom;
+
+    typedef enum ce_patch_type
+    {
+        CE_PATCH_CREATE = 0,          /* Create node (kind, name = tag, value = text) under parent, before sibling */
+        CE_PATCH_REMOVE = 1,          /* Remove node and its whole subtree */
+        CE_PATCH_MOVE = 2,            /* Move node under parent, before sibling */
+        CE_PATCH_SET_PROPERTY = 3,    /* Set property name of node to value */
+        CE_PATCH_REMOVE_PROPERTY = 4, /* Remove property name from node */
+        CE_PATCH_SET_TEXT = 5         /* Replace the content of text node with value */
+    } ce_patch_type;
+
+    typedef enum ce_node_kind
+    {
+        CE_NODE_ELEMENT = 0,
+        CE_NODE_TEXT = 1
+    } ce_node_kind;
+
+    typedef enum ce_value_type
+    {
+        CE_VALUE_NONE = 0,
+        CE_VALUE_BOOL = 1,
+        CE_VALUE_INTEGER = 2,
+        CE_VALUE_FLOAT = 3,
+        CE_VALUE_STRING = 4,
+        CE_VALUE_OPAQUE = 5 /* A persistent map or vector, only meaningful to the engine */
+    } ce_value_type;
+
+    /* UTF-8 characters, not NUL-terminated */
+    typedef struct ce_string
+    {
+        const char *data;
+        size_t size;
+    } ce_string;
+
+    typedef struct ce_value
+    {
+        uint32_t type; /* ce_value_type */
+        union
+        {
+            int32_t boolean;
+            int64_t integer;
+            double floating;
+            ce_string string;
+        } as;
+    } ce_value;
+
+    /* One operation; a null before means "append", a null parent means "as the root" */
+    typedef struct ce_patch
+    {
+        uint8_t type; /* ce_patch_type */
+        uint8_t kind; /* ce_node_kind */
+        uint16_t reserved;
+        ce_atom name;
+        ce_handle node;
+        ce_handle parent;
+        ce_handle before;
+        ce_value value;
+    } ce_patch;
+
+    /*
+     * The patches of one frame, applied front to back
+     *
+     * atoms[atom] is the name of every atom up to atom_count. Atoms never
+     * change meaning, so a backend may cache names: those from first_new_atom
+     * on were added since the previous frame, and a first_new_atom of 0 means
+     * the table was replaced. Strings of patches and atoms are only valid
+     * during the apply() call.
+     */
+    typedef struct ce_frame
+    {
+        const ce_patch *patches;
+        size_t patch_count;
+        const ce_string *atoms;
+        uint32_t atom_count;
+        uint32_t first_new_atom;
+        uint64_t sequence; /* Number of frames applied to this instance before */
+    } ce_frame;
+
+    /* An instance of a backend, opaque to the engine */
+    typedef struct ce_backend ce_backend;
+
+    typedef struct ce_backend_api
+    {
+        uint32_t abi_version; /* CE_BACKEND_ABI_VERSION the backend was built with */
+        uint32_t size;        /* sizeof(ce_backend_api) the backend was built with */
+        const char *name;
+
+        /* Create an instance from backend-specific options, which may be NULL; return NULL on failure */
+        ce_backend *(*create)(const char *options);
+
+        void (*destroy)(ce_backend *backend);
+
+        /* Apply the patches of a frame; return 0 on success, anything else on failure */
+        int (*apply)(ce_backend *backend, const ce_frame *frame);
+
+        /* Describe the last failure of an instance, NUL-terminated; may be NULL */
+        const char *(*error)(ce_backend *backend);
+    } ce_backend_api;
+
+    /*
+     * Signature of the function exported as CE_BACKEND_ENTRY
+     *
+     * Receives the CE_BACKEND_ABI_VERSION of the engine, returns the function
+     * table of the backend, valid until the library is unloaded, or NULL if
+     * the backend does not support that version.
+     */
+    typedef const ce_backend_api *(*ce_backend_entry_function)(uint32_t abi_version);
+
+#ifdef __cplusplus
+}
+#endif
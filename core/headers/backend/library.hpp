@@ -0,0 +1,37 @@
+#pragma once
+
+#include <filesystem>
+
+#include "backend/backend.h"
+
+namespace backend
+{
+    /**
+     * @brief A renderer backend library loaded at run time, with dlopen() or LoadLibrary()
+     *
+     * The library stays loaded for the lifetime of the object, so every
+     * instance created through api() must be destroyed first.
+     */
+    class Library
+    {
+    private:
+        void *_handle;
+        const ce_backend_api *_api;
+
+    protected:
+    public:
+        /**
+         * @brief Load a backend library and get its function table
+         *
+         * @param path The library, e.g. libmemory-backend.so
+         * @throw std::runtime_error If the library cannot be loaded, lacks CE_BACKEND_ENTRY or refuses CE_BACKEND_ABI_VERSION
+         */
+        explicit Library(const std::filesystem::path &path);
+
+        Library(const Library &) = delete;
+        Library &operator=(const Library &) = delete;
+        ~Library();
+
+        const ce_backend_api &api() const noexcept { return *_api; }
+    };
+} // namespace backend
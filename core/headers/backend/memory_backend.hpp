@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "backend/backend.h"
+
+namespace backend
+{
+    /**
+     * @brief Reference renderer backend keeping the document in memory
+     *
+     * Nodes are kept in a hash map by handle and linked to their siblings, as
+     * in a DOM, so that every patch applies in constant time apart from the
+     * removal of a whole subtree. Names and strings are copied out of the
+     * frame, as a backend must do. Meant for tests and benchmarks, and as a
+     * starting point for real backends; memory_backend_api() exposes it
+     * through the C interface, and the memory-backend example builds it as
+     * a loadable library.
+     */
+    class MemoryBackend
+    {
+    private:
+        struct Node
+        {
+            ce_node_kind kind;
+            ce_atom tag;
+            std::string text;
+            std::vector<std::pair<ce_atom, std::string>> properties;
+            ce_handle parent = 0;
+            ce_handle first_child = 0;
+            ce_handle last_child = 0;
+            ce_handle previous_sibling = 0;
+            ce_handle next_sibling = 0;
+        };
+
+        std::unordered_map<ce_handle, Node> _nodes;
+        ce_handle _root = 0;
+        std::vector<std::string> _names;
+        std::uint64_t _frames = 0;
+
+        Node &at(ce_handle handle);
+        void detach(ce_handle handle, Node &node);
+        void attach(ce_handle handle, Node &node, ce_handle parent_handle, ce_handle before);
+        void erase(ce_handle handle);
+        void apply(const ce_patch &patch);
+
+    protected:
+    public:
+        /**
+         * @brief Apply the patches of a frame, front to back
+         *
+         * @param frame Patches computed against the current content of the document
+         * @throw std::out_of_range If a patch designates an unknown node; the patches before it stay applied
+         */
+        void apply(const ce_frame &frame);
+
+        /**
+         * @brief Remove every node, keeping the names
+         *
+         */
+        void clear() noexcept;
+
+        /**
+         * @brief Write the document as markup, e.g. <ul class="list"><li>row</li></ul>
+         *
+         * Properties are written in the order they were first set.
+         */
+        std::string html() const;
+
+        /**
+         * @brief Get the name of an atom received so far
+         *
+         */
+        std::string_view name(ce_atom atom) const noexcept;
+
+        /**
+         * @brief Get the document of an instance created through memory_backend_api()
+         *
+         */
+        static MemoryBackend &of(ce_backend *instance) noexcept;
+
+        std::size_t size() const noexcept { return _nodes.size(); }
+        ce_handle root() const noexcept { return _root; }
+        std::uint64_t frames() const noexcept { return _frames; }
+    };
+
+    /**
+     * @brief Get the function table of the in-memory backend, for linking it in
+     *
+     * Instances ignore their options.
+     */
+    const ce_backend_api &memory_backend_api() noexcept;
+} // namespace backend
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "backend/backend.h"
+#include "backend/library.hpp"
+#include "vdom/atom_table.hpp"
+#include "vdom/patch.hpp"
+
+namespace backend
+{
+    /**
+     * @brief An instance of a renderer backend, fed one batch of patches per frame
+     *
+     * apply() converts a frame's patches into one contiguous array of
+     * ce_patch and makes a single call into the backend, passing the atom
+     * table along as an array of names that only grows between frames. The
+     * conversion buffers are kept between frames, so a steady stream of frames
+     * does not allocate.
+     *
+     * The backend may be linked in, given by its function table, or loaded
+     * from a library, which the renderer then keeps loaded until destroyed.
+     */
+    class Renderer
+    {
+    private:
+        std::unique_ptr<Library> _library;
+        const ce_backend_api *_api;
+        ce_backend *_instance;
+        const vdom::AtomTable *_atom_table;
+        std::vector<ce_string> _atoms;
+        std::vector<ce_patch> _patches;
+        std::uint64_t _frames;
+
+        void create(const char *options);
+        std::uint32_t sync_atoms(const vdom::AtomTable &atoms);
+
+    protected:
+    public:
+        /**
+         * @brief Create an instance of a backend linked into the program
+         *
+         * @param api The function table of the backend, which must outlive the renderer
+         * @param options Backend-specific options, nullptr for none
+         * @throw std::runtime_error If the table is incomplete or built for another ABI version, or creation fails
+         */
+        explicit Renderer(const ce_backend_api &api, const char *options = nullptr);
+
+        /**
+         * @brief Load a backend library and create an instance of it
+         *
+         * @param library The library, see Library
+         * @param options Backend-specific options, nullptr for none
+         * @throw std::runtime_error If loading or creation fails
+         */
+        explicit Renderer(const std::filesystem::path &library, const char *options = nullptr);
+
+        Renderer(const Renderer &) = delete;
+        Renderer &operator=(const Renderer &) = delete;
+        ~Renderer();
+
+        /**
+         * @brief Hand the patches of a frame to the backend, in one call
+         *
+         * @param patches The patches, applied front to back
+         * @param atoms The table the patch names were interned in
+         * @throw std::runtime_error If the backend reports a failure, with its description
+         */
+        void apply(std::span<const vdom::Patch> patches, const vdom::AtomTable &atoms = vdom::AtomTable::global());
+
+        /**
+         * @brief Convert a patch to its C representation
+         *
+         * The strings of the result point into the same storage as those of patch.
+         */
+        static ce_patch convert(const vdom::Patch &patch) noexcept;
+
+        const ce_backend_api &api() const noexcept { return *_api; }
+        ce_backend *instance() const noexcept { return _instance; }
+        std::uint64_t frames() const noexcept { return _frames; }
+    };
+} // namespace backend
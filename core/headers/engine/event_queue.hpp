@@ -0,0 +1,124 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "vdom/tree.hpp"
+
+namespace engine
+{
+    /**
+     * @brief A raw input event, as reported by a renderer backend
+     *
+     * The meaning of the payload depends on the type: a pointer position for
+     * pointer events, a scroll offset for scroll events, a button or key code
+     * in detail, ...
+     */
+    struct Event
+    {
+        vdom::Atom type;
+        vdom::Handle target;
+        double x;
+        double y;
+        std::int64_t detail;
+    };
+
+    /**
+     * @brief Bounded multi-producer, single-consumer queue of input events
+     *
+     * push() is lock-free and may be called from any thread, e.g. a backend's
+     * input thread, with no GIL held; drain() is called by the thread running
+     * frames. Each slot carries a sequence number telling producers and the
+     * consumer whose turn it is, so no lock is ever taken.
+     *
+     * Draining coalesces high-frequency events: of successive events of a
+     * coalesced type and target, only the last is kept, at the position of
+     * the first. Any other event ends the run, so that the order of discrete
+     * events such as clicks relative to the others is preserved. Coalesced
+     * types should therefore carry absolute state, e.g. a position or scroll
+     * offset, rather than deltas.
+     */
+    class EventQueue
+    {
+    public:
+        struct Statistics
+        {
+            std::uint64_t dropped = 0;   ///< Events pushed while the queue was full
+            std::uint64_t coalesced = 0; ///< Events replaced by a later one when drained
+        };
+
+    private:
+        struct Slot
+        {
+            std::atomic<std::size_t> sequence;
+            Event event;
+        };
+
+        struct Key
+        {
+            vdom::Atom type;
+            vdom::Handle target;
+
+            bool operator==(const Key &other) const noexcept { return type == other.type && target == other.target; }
+        };
+
+        struct KeyHash
+        {
+            std::size_t operator()(const Key &key) const noexcept
+            {
+                return std::hash<vdom::Handle>{}(key.target * 0x9E3779B97F4A7C15ull ^ key.type);
+            }
+        };
+
+        std::unique_ptr<Slot[]> _slots;
+        std::size_t _mask;
+        alignas(64) std::atomic<std::size_t> _tail;
+        alignas(64) std::size_t _head;
+        std::atomic<std::uint64_t> _dropped;
+        std::uint64_t _coalesced;
+        std::vector<vdom::Atom> _coalesced_types;
+        std::unordered_map<Key, std::size_t, KeyHash> _runs;
+
+        bool pop(Event &event) noexcept;
+
+    protected:
+    public:
+        /**
+         * @brief Construct an empty EventQueue
+         *
+         * @param capacity The number of events it holds, rounded up to a power of two
+         */
+        explicit EventQueue(std::size_t capacity = 4096);
+
+        EventQueue(const EventQueue &) = delete;
+        EventQueue &operator=(const EventQueue &) = delete;
+
+        /**
+         * @brief Coalesce the events of a type when draining; not thread-safe, call before use
+         *
+         * @param type The event type
+         */
+        void coalesce(vdom::Atom type);
+
+        /**
+         * @brief Queue an event, from any thread
+         *
+         * @param event The event
+         * @return true If it was queued, false if the queue was full and it was dropped
+         */
+        bool push(const Event &event) noexcept;
+
+        /**
+         * @brief Take every queued event, coalescing runs of high-frequency ones
+         *
+         * @param events Cleared, then filled with the events in order
+         */
+        void drain(std::vector<Event> &events);
+
+        Statistics statistics() const noexcept { return {_dropped.load(std::memory_order_relaxed), _coalesced}; }
+    };
+} // namespace engine
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <chrono>
+#include <coroutine>
+#include <exception>
+#include <utility>
+
+namespace engine
+{
+    /**
+     * @brief End of the current time slice
+     *
+     */
+    class Deadline
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+    private:
+        Clock::time_point _end;
+
+    protected:
+    public:
+        /**
+         * @brief Construct a Deadline that never expires
+         *
+         */
+        Deadline() noexcept : _end(Clock::time_point::max()) {}
+
+        /**
+         * @brief Start a slice lasting budget from now
+         *
+         * @param budget The slice duration
+         */
+        void arm(Clock::duration budget) noexcept { _end = Clock::now() + budget; }
+
+        /**
+         * @brief Make the slice unbounded
+         *
+         */
+        void disarm() noexcept { _end = Clock::time_point::max(); }
+
+        bool unbounded() const noexcept { return _end == Clock::time_point::max(); }
+        bool expired() const noexcept { return !unbounded() && Clock::now() >= _end; }
+    };
+
+    /**
+     * @brief Awaitable suspending the calling Job once its deadline has expired
+     *
+     * `co_await engine::Yield{deadline};` costs one clock read while time remains.
+     */
+    struct Yield
+    {
+        const Deadline &deadline;
+
+        bool await_ready() const noexcept { return !deadline.expired(); }
+        void await_suspend(std::coroutine_handle<>) const noexcept {}
+        void await_resume() const noexcept {}
+    };
+
+    /**
+     * @brief Resumable unit of work written as a C++20 coroutine
+     *
+     * The coroutine starts suspended; each resume() runs it until its next
+     * suspension point, typically a `co_await Yield{deadline}`, or its end.
+     * Destroying the Job destroys the coroutine wherever it is suspended,
+     * which abandons the work.
+     */
+    class Job
+    {
+    public:
+        struct promise_type
+        {
+            std::exception_ptr exception;
+
+            Job get_return_object() noexcept { return Job(std::coroutine_handle<promise_type>::from_promise(*this)); }
+            std::suspend_always initial_suspend() const noexcept { return {}; }
+            std::suspend_always final_suspend() const noexcept { return {}; }
+            void return_void() const noexcept {}
+            void unhandled_exception() noexcept { exception = std::current_exception(); }
+        };
+
+    private:
+        std::coroutine_handle<promise_type> _handle;
+
+        explicit Job(std::coroutine_handle<promise_type> handle) noexcept : _handle(handle) {}
+
+    protected:
+    public:
+        Job() noexcept : _handle(nullptr) {}
+
+        Job(const Job &) = delete;
+        Job &operator=(const Job &) = delete;
+
+        Job(Job &&other) noexcept : _handle(std::exchange(other._handle, nullptr)) {}
+
+        Job &operator=(Job &&other) noexcept
+        {
+            std::swap(_handle, other._handle);
+            return *this;
+        }
+
+        ~Job()
+        {
+            if (_handle)
+                _handle.destroy();
+        }
+
+        /**
+         * @brief Run the work until it suspends or finishes
+         *
+         * @return true If the work is finished
+         * @throw Rethrows the exception that ended the work, if any
+         */
+        bool resume()
+        {
+            if (!_handle.done())
+                _handle.resume();
+            if (!_handle.done())
+                return false;
+            if (std::exception_ptr exception = std::exchange(_handle.promise().exception, nullptr))
+                std::rethrow_exception(exception);
+            return true;
+        }
+
+        bool done() const noexcept { return !_handle || _handle.done(); }
+        explicit operator bool() const noexcept { return _handle != nullptr; }
+    };
+} // namespace engine
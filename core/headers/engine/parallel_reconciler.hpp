@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "engine/thread_pool.hpp"
+#include "vdom/reconciler.hpp"
+
+namespace engine
+{
+    /**
+     * @brief Reconciler diffing independent subtrees on a ThreadPool
+     *
+     * The calling thread walks the top of both trees, descending into matched
+     * subtrees larger than a chunk and deferring the others. Consecutive
+     * deferred subtrees are grouped into tasks of about one chunk of nodes,
+     * each diffed into its own patch buffer. The buffers are then spliced back
+     * where the walk would have emitted them, so the patches and handles are
+     * exactly those of a sequential vdom::Reconciler, whatever the scheduling.
+     *
+     * The phases are also exposed one by one, split(), diff_group() for each
+     * group, then merge(), so that a diff can be spread over time slices.
+     *
+     * Pure C++: call it with the GIL released. An instance runs one diff at a
+     * time and keeps its buffers between diffs.
+     */
+    class ParallelReconciler : private vdom::Reconciler::Deferral
+    {
+    private:
+        struct Subtree
+        {
+            vdom::NodeId old_node;
+            vdom::NodeId new_node;
+        };
+
+        struct Group
+        {
+            std::size_t offset;
+            std::size_t begin;
+            std::size_t end;
+            std::size_t nodes;
+        };
+
+        std::size_t _grain;
+        std::size_t _chunk;
+        const vdom::Tree *_old;
+        vdom::Tree *_next;
+        vdom::Reconciler _reconciler;
+        vdom::PatchList _patches;
+        std::vector<std::uint32_t> _sizes;
+        std::vector<vdom::NodeId> _stack;
+        std::vector<vdom::NodeId> _order;
+        std::vector<Subtree> _subtrees;
+        std::vector<Group> _groups;
+        std::vector<vdom::Reconciler> _group_reconcilers;
+        std::vector<vdom::PatchList> _group_patches;
+
+        void measure_subtrees(const vdom::Tree &tree);
+        bool defer(vdom::NodeId old_node, vdom::NodeId new_node, std::size_t offset) override;
+
+    protected:
+    public:
+        /**
+         * @brief Construct a new ParallelReconciler
+         *
+         * @param grain The smallest number of nodes worth a task; smaller trees are diffed sequentially
+         */
+        explicit ParallelReconciler(std::size_t grain = 4096);
+
+        /**
+         * @brief Diff two trees and append the patches to a list, see vdom::Reconciler::diff()
+         *
+         * @param old The mounted tree, whose handles are already assigned; may be empty
+         * @param next The tree to mount
+         * @param patches The list receiving the patches
+         * @param pool The threads to diff on, nullptr to diff on the calling thread only
+         */
+        void diff(const vdom::Tree &old, vdom::Tree &next, vdom::PatchList &patches, ThreadPool *pool);
+
+        /**
+         * @brief Walk the top of both trees, setting the deferred subtrees aside in groups
+         *
+         * Trees smaller than two grains are diffed in full, leaving no group.
+         * Both trees must outlive merge().
+         *
+         * @param old The mounted tree, whose handles are already assigned; may be empty
+         * @param next The tree to mount
+         * @param tasks The number of groups to aim for; groups never hold fewer than a grain of nodes
+         * @return std::size_t The number of groups to diff
+         */
+        std::size_t split(const vdom::Tree &old, vdom::Tree &next, std::size_t tasks);
+
+        /**
+         * @brief Diff the subtrees of a group; distinct groups may be diffed concurrently
+         *
+         * @param index The group, below the count returned by split()
+         */
+        void diff_group(std::size_t index);
+
+        /**
+         * @brief Splice the patches of the walk and of every group, in sequential order
+         *
+         * @param patches The list receiving the patches
+         */
+        void merge(vdom::PatchList &patches);
+    };
+} // namespace engine
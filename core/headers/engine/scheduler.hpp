@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace engine
+{
+    /**
+     * @brief Priority class of an update, highest priority first
+     *
+     */
+    enum class Lane : std::uint8_t
+    {
+        Input,      ///< Direct reaction to user input, rendered on the next frame
+        Background  ///< Data refreshes and other updates that may wait
+    };
+
+    constexpr std::size_t lane_count = 2;
+
+    /**
+     * @brief Collects component updates and hands them out once per frame
+     *
+     * Scheduling a component that is already pending coalesces both updates
+     * into one, promoted to the higher priority lane. begin_frame() takes the
+     * pending updates of the requested lanes, sorted top-down so that every
+     * parent comes before its descendants; updates scheduled during a frame
+     * wait for the next one. The order costs O(k log k) for k updates; it
+     * lets callers re-render each dirty subtree once, from its outermost
+     * dirty component, as bindings::RootObject does.
+     *
+     * Components are identified by an opaque integer, e.g. an address, and
+     * their depth in the component tree. Scheduling is thread-safe; frames
+     * are meant to be run by one thread at a time.
+     */
+    class Scheduler
+    {
+    public:
+        using Id = std::uintptr_t;
+
+        struct Update
+        {
+            Id component;
+            std::uint32_t depth;
+            Lane lane;
+        };
+
+    private:
+        mutable std::mutex _mutex;
+        std::vector<Update> _pending;
+        std::unordered_map<Id, std::size_t> _indices;
+        std::vector<Update> _frame;
+        std::size_t _lane_sizes[lane_count] = {};
+
+        void erase(std::size_t index);
+
+    protected:
+    public:
+        /**
+         * @brief Mark a component dirty
+         *
+         * @param component The component
+         * @param depth Its depth in the component tree, 0 for the root component
+         * @param lane The priority of the update
+         * @return true If the component was not pending yet
+         */
+        bool schedule(Id component, std::uint32_t depth, Lane lane = Lane::Background);
+
+        /**
+         * @brief Drop the pending update of a component, e.g. once it is unmounted
+         *
+         * @param component The component
+         * @return true If an update was pending
+         */
+        bool cancel(Id component);
+
+        /**
+         * @brief Take the updates of a frame
+         *
+         * @param lowest The lowest priority lane to take; updates of lower priority stay pending
+         * @return std::span<const Update> The updates sorted by depth then lane, valid until the next begin_frame()
+         */
+        std::span<const Update> begin_frame(Lane lowest = Lane::Background);
+
+        /**
+         * @brief Count the pending updates
+         *
+         * @return std::size_t The number of dirty components waiting for a frame
+         */
+        std::size_t pending() const;
+
+        /**
+         * @brief Count the pending updates of one lane
+         *
+         * @param lane The lane
+         * @return std::size_t The number of dirty components waiting in that lane, counted in constant time
+         */
+        std::size_t pending(Lane lane) const;
+    };
+} // namespace engine
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace engine
+{
+    /**
+     * @brief Fixed set of worker threads running fork-join task batches
+     *
+     * Each worker owns a deque of tasks: it pops its own tasks from the back
+     * and, when out of work, steals from the front of the others. The thread
+     * calling run() executes tasks too while it waits, so run() may be nested
+     * inside a task, and a pool of N workers runs batches on N + 1 threads.
+     */
+    class ThreadPool
+    {
+    private:
+        struct Batch
+        {
+            void (*run)(void *context, std::size_t index);
+            void *context;
+            std::atomic<std::size_t> remaining;
+            std::mutex mutex;
+            std::exception_ptr exception;
+        };
+
+        struct Task
+        {
+            Batch *batch;
+            std::size_t index;
+        };
+
+        struct Queue
+        {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        std::vector<std::unique_ptr<Queue>> _queues;
+        std::vector<std::thread> _threads;
+        std::atomic<std::size_t> _queued;
+        std::mutex _mutex;
+        std::condition_variable _wake;
+        bool _stopping;
+
+        std::size_t own_queue() const noexcept;
+        bool pop(std::size_t queue, bool back, Task &task);
+        bool run_one();
+        void work(std::size_t index);
+        void submit(Batch &batch, std::size_t count);
+
+    protected:
+    public:
+        /**
+         * @brief Construct a new ThreadPool and start its workers
+         *
+         * @param workers The number of worker threads, 0 to run everything on the calling thread
+         */
+        explicit ThreadPool(std::size_t workers);
+
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        /**
+         * @brief Stop and join the workers; no batch may be running
+         *
+         */
+        ~ThreadPool();
+
+        /**
+         * @brief Get the number of worker threads
+         *
+         * @return std::size_t The worker count, not counting threads calling run()
+         */
+        std::size_t workers() const noexcept { return _threads.size(); }
+
+        /**
+         * @brief Call body(index) for every index in [0, count) and wait for all of them
+         *
+         * Calls may run concurrently and in any order.
+         *
+         * @param count The number of tasks
+         * @param body Callable taking a std::size_t index
+         * @throw Rethrows the first exception thrown by a task, once every task is done
+         */
+        template <typename Body>
+        void run(std::size_t count, Body &&body)
+        {
+            if (count == 0)
+                return;
+
+            Batch batch;
+            batch.run = [](void *context, std::size_t index)
+            { (*static_cast<std::remove_reference_t<Body> *>(context))(index); };
+            batch.context = const_cast<void *>(static_cast<const void *>(std::addressof(body)));
+            batch.remaining.store(count, std::memory_order_relaxed);
+            submit(batch, count);
+
+            while (batch.remaining.load(std::memory_order_acquire) != 0)
+            {
+                if (!run_one())
+                    std::this_thread::yield();
+            }
+            if (batch.exception)
+                std::rethrow_exception(batch.exception);
+        }
+    };
+} // namespace engine
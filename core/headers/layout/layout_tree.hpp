@@ -0,0 +1,218 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "layout/style.hpp"
+#include "vdom/patch.hpp"
+
+namespace layout
+{
+    struct Size
+    {
+        float width;
+        float height;
+    };
+
+    /**
+     * @brief Border box of a node, its position relative to its parent's border box
+     *
+     */
+    struct Box
+    {
+        float x = 0;
+        float y = 0;
+        float width = 0;
+        float height = 0;
+    };
+
+    /**
+     * @brief Measures the content of a text node
+     *
+     * Called with the text and the width it may take, undefined when
+     * unconstrained; returns the size of the laid out text.
+     */
+    using Measure = std::function<Size(std::string_view text, float max_width)>;
+
+    /**
+     * @brief Retained mirror of the mounted tree that computes flexbox boxes incrementally
+     *
+     * A LayoutTree follows the mounted tree through the same patch lists as a
+     * renderer backend, keyed by handle, and keeps the style of each element
+     * and the text of each text node. Only style properties matter: patches
+     * setting other properties cost a lookup.
+     *
+     * Every node caches its last layout and a few measurements by the
+     * constraints they were computed for. A change marks the node and its
+     * ancestors dirty; compute() then lays out again only the dirty nodes,
+     * each repositioning its children and reusing the cached layout of every
+     * clean child that gets the same constraints as before. Editing a text
+     * deep in a large tree costs the siblings along its path, not the tree.
+     *
+     * The layout is a single-line flexbox: no wrapping, no reversed
+     * directions, no absolute positioning, no min or max sizes.
+     */
+    class LayoutTree
+    {
+    public:
+        struct Statistics
+        {
+            std::uint64_t layouts = 0;      ///< Nodes laid out or measured instead of taken from a cache
+            std::uint64_t measurements = 0; ///< Calls to the Measure function
+        };
+
+    private:
+        using Index = std::uint32_t;
+
+        static constexpr Index null_index = std::numeric_limits<Index>::max();
+        static constexpr std::size_t measurement_slots = 4;
+
+        struct Constraint
+        {
+            float width;
+            float height;
+            bool exact_width;
+            bool exact_height;
+
+            bool operator==(const Constraint &other) const noexcept;
+        };
+
+        struct Measurement
+        {
+            Constraint constraint;
+            Size size;
+        };
+
+        struct Node
+        {
+            vdom::Handle handle;
+            vdom::NodeKind kind;
+            Style style;
+            std::string text;
+            Index parent;
+            Index first_child;
+            Index last_child;
+            Index previous_sibling;
+            Index next_sibling;
+            bool dirty;
+            bool laid_out;
+            Constraint constraint;
+            Box box;
+            std::array<Measurement, measurement_slots> measurements;
+            std::uint8_t measurement_count;
+            std::uint8_t next_measurement;
+        };
+
+        struct Item
+        {
+            Index node;
+            float basis;
+            float main;
+            float cross;
+        };
+
+        StyleTable _styles;
+        Measure _measure;
+        std::vector<Node> _nodes;
+        std::vector<Index> _free;
+        std::unordered_map<vdom::Handle, Index> _indices;
+        std::vector<Item> _items;
+        Index _root;
+        Statistics _statistics;
+
+        Index find(vdom::Handle handle) const;
+        Index allocate(vdom::Handle handle, vdom::NodeKind kind);
+        void detach(Index index) noexcept;
+        void attach(Index index, Index parent, Index before) noexcept;
+        void erase(Index index);
+        void mark_dirty(Index index) noexcept;
+
+        Size layout(Index index, const Constraint &constraint, bool perform);
+        Size layout_text(Node &node, const Constraint &constraint);
+        Size layout_element(Index index, const Constraint &constraint, bool perform);
+
+    protected:
+    public:
+        /**
+         * @brief Construct an empty LayoutTree measuring text with default_measure()
+         *
+         * @param atoms The table the property names of patches come from
+         */
+        explicit LayoutTree(vdom::AtomTable &atoms = vdom::AtomTable::global());
+
+        LayoutTree(const LayoutTree &) = delete;
+        LayoutTree &operator=(const LayoutTree &) = delete;
+
+        /**
+         * @brief Estimate text as a monospace font of 8 by 16 pixels, wrapped at any character
+         *
+         */
+        static Size default_measure(std::string_view text, float max_width);
+
+        /**
+         * @brief Replace the text measuring function, e.g. with the backend's font metrics
+         *
+         * Every text node is measured again by the next compute().
+         *
+         * @param measure The new function
+         */
+        void set_measure(Measure measure);
+
+        /**
+         * @brief Follow a patch list, marking what it changes dirty
+         *
+         * @param patches Patches computed against the tree mirrored so far
+         * @throw std::out_of_range If a patch designates an unknown node
+         */
+        void apply(const vdom::PatchList &patches);
+
+        /**
+         * @brief Lay out the dirty part of the tree in a viewport
+         *
+         * @param width The viewport width, which the root fills
+         * @param height The viewport height, which the root fills
+         */
+        void compute(float width, float height);
+
+        /**
+         * @brief Get the box computed for a node
+         *
+         * @param handle The node
+         * @return const Box* Its box as of the last compute(), or nullptr for an unknown node
+         */
+        const Box *box(vdom::Handle handle) const;
+
+        /**
+         * @brief Get the box of a node relative to the viewport
+         *
+         * @param handle A known node
+         * @return Box Its box, offset by the positions of its ancestors
+         * @throw std::out_of_range If the node is unknown
+         */
+        Box absolute_box(vdom::Handle handle) const;
+
+        /**
+         * @brief Tell whether a node changed since the last compute()
+         *
+         * @param handle A known node
+         * @throw std::out_of_range If the node is unknown
+         */
+        bool dirty(vdom::Handle handle) const;
+
+        /**
+         * @brief Remove every node
+         *
+         */
+        void clear() noexcept;
+
+        std::size_t size() const noexcept { return _indices.size(); }
+        vdom::Handle root() const noexcept { return _root != null_index ? _nodes[_root].handle : vdom::null_handle; }
+        const Statistics &statistics() const noexcept { return _statistics; }
+    };
+} // namespace layout
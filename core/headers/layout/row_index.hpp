@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace layout
+{
+    /**
+     * @brief Heights and offsets of the rows of a virtualized list
+     *
+     * Rows start at an estimated height until a backend measures them. A
+     * Fenwick tree over the heights gives the offset of a row, and the row at
+     * an offset, in O(log n), so that a list of millions of rows finds the
+     * rows in view without walking the rows above them. Growing the list,
+     * e.g. a log receiving new lines, costs O(log n) per added row.
+     */
+    class RowIndex
+    {
+    public:
+        /**
+         * @brief Rows to render, from first up to but excluding last
+         *
+         */
+        struct Window
+        {
+            std::size_t first = 0;
+            std::size_t last = 0;
+        };
+
+    private:
+        std::vector<float> _heights;
+        std::vector<double> _tree; ///< 1-based: entry i sums the heights of rows [i - lowbit(i), i)
+        float _estimated_height;
+
+        void add(std::size_t row, double delta) noexcept;
+        void rebuild();
+
+    protected:
+    public:
+        /**
+         * @brief Construct an index of rows of the estimated height
+         *
+         * @param count The number of rows
+         * @param estimated_height The height of the rows not measured yet
+         */
+        explicit RowIndex(std::size_t count = 0, float estimated_height = 20);
+
+        std::size_t size() const noexcept { return _heights.size(); }
+        float estimated_height() const noexcept { return _estimated_height; }
+
+        /**
+         * @brief Add rows of the estimated height at the end, or remove the last ones
+         *
+         * @param count The new number of rows
+         */
+        void resize(std::size_t count);
+
+        /**
+         * @brief Record the measured height of a row
+         *
+         * @param row The row, less than size()
+         * @param height Its height
+         */
+        void set_height(std::size_t row, float height) noexcept;
+
+        float height(std::size_t row) const noexcept { return _heights[row]; }
+
+        /**
+         * @brief Get the offset of the top of a row, the sum of the heights above it
+         *
+         * @param row The row, up to size() for the total height
+         */
+        double offset(std::size_t row) const noexcept;
+
+        double total() const noexcept { return offset(size()); }
+
+        /**
+         * @brief Find the row an offset falls in
+         *
+         * @param offset The offset from the top of the first row
+         * @return std::size_t The row, clamped to the last one; 0 for an empty index
+         */
+        std::size_t row_at(double offset) const noexcept;
+
+        /**
+         * @brief Find the rows intersecting a viewport, plus overscan rows on each side
+         *
+         * @param scroll The offset of the top of the viewport
+         * @param viewport The height of the viewport
+         * @param overscan The number of extra rows above and below
+         */
+        Window window(double scroll, double viewport, std::size_t overscan) const noexcept;
+    };
+} // namespace layout
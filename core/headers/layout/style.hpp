@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "vdom/atom_table.hpp"
+#include "vdom/value.hpp"
+
+namespace layout
+{
+    /**
+     * @brief The length meaning "auto": sized from content or from the parent
+     *
+     */
+    constexpr float undefined = std::numeric_limits<float>::quiet_NaN();
+
+    enum class Direction : std::uint8_t
+    {
+        Column,
+        Row
+    };
+
+    enum class Justify : std::uint8_t
+    {
+        Start,
+        Center,
+        End,
+        SpaceBetween,
+        SpaceAround,
+        SpaceEvenly
+    };
+
+    enum class Align : std::uint8_t
+    {
+        Auto, ///< Only for align-self: use the parent's align-items
+        Stretch,
+        Start,
+        Center,
+        End
+    };
+
+    struct Edges
+    {
+        float left = 0;
+        float top = 0;
+        float right = 0;
+        float bottom = 0;
+    };
+
+    /**
+     * @brief Flexbox style of an element, in pixels
+     *
+     * Defaults follow React Native rather than CSS: children are stacked in a
+     * column, stretched across it, and neither grow nor shrink.
+     */
+    struct Style
+    {
+        Direction direction = Direction::Column;
+        Justify justify_content = Justify::Start;
+        Align align_items = Align::Stretch;
+        Align align_self = Align::Auto;
+        float grow = 0;
+        float shrink = 0;
+        float basis = undefined;
+        float width = undefined;
+        float height = undefined;
+        float gap = 0;
+        Edges padding;
+        Edges margin;
+    };
+
+    /**
+     * @brief Maps element properties to Style fields
+     *
+     * Recognized properties use their CSS names: flex-direction, flex-grow,
+     * flex-shrink, flex-basis, width, height, gap, padding, margin and their
+     * -left, -top, -right and -bottom variants, justify-content, align-items
+     * and align-self. Lengths are numbers or strings such as "12" or "12px";
+     * keywords accept both "start" and "flex-start" spellings. An invalid or
+     * None value resets the field to its default.
+     */
+    class StyleTable
+    {
+    public:
+        enum class Field : std::uint8_t
+        {
+            None,
+            Direction,
+            Grow,
+            Shrink,
+            Basis,
+            Width,
+            Height,
+            Gap,
+            Padding,
+            PaddingLeft,
+            PaddingTop,
+            PaddingRight,
+            PaddingBottom,
+            Margin,
+            MarginLeft,
+            MarginTop,
+            MarginRight,
+            MarginBottom,
+            JustifyContent,
+            AlignItems,
+            AlignSelf
+        };
+
+    private:
+        std::vector<Field> _fields;
+
+    protected:
+    public:
+        /**
+         * @brief Intern the names of every style property
+         *
+         * @param atoms The table the property names of patches come from
+         */
+        explicit StyleTable(vdom::AtomTable &atoms);
+
+        /**
+         * @brief Get the style field a property sets
+         *
+         * @param name The property name
+         * @return Field The field, Field::None for a property that is not a style
+         */
+        Field field(vdom::Atom name) const noexcept
+        {
+            return name < _fields.size() ? _fields[name] : Field::None;
+        }
+
+        /**
+         * @brief Set a style field from a property value
+         *
+         * @param style The style to update
+         * @param field The field, not Field::None
+         * @param value The property value, None to reset the field
+         */
+        static void set(Style &style, Field field, const vdom::Value &value) noexcept;
+    };
+} // namespace layout
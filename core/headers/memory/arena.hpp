@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+
+namespace memory
+{
+    /**
+     * @brief Monotonic memory resource released wholesale once per frame
+     *
+     * Allocations bump a pointer through large chunks obtained from an upstream
+     * resource; deallocation is a no-op. reset() makes the whole arena
+     * available again. When a frame needed more than one chunk, reset() merges
+     * them into a single chunk large enough for that frame. Once frames stop
+     * growing, the arena no longer touches the upstream resource.
+     *
+     * Everything allocated from the arena must be dead before reset(). An
+     * Arena is not thread-safe.
+     */
+    class Arena : public std::pmr::memory_resource
+    {
+    public:
+        /**
+         * @brief Counters describing the arena's activity
+         *
+         */
+        struct Statistics
+        {
+            std::size_t bytes_allocated = 0;       ///< Bytes handed out since the last reset
+            std::size_t allocations = 0;           ///< Allocations served since the last reset
+            std::size_t peak_bytes_allocated = 0;  ///< Largest bytes_allocated reached by any frame
+            std::size_t bytes_reserved = 0;        ///< Bytes currently held from the upstream resource
+            std::size_t upstream_allocations = 0;  ///< Chunks ever requested from the upstream resource
+            std::size_t frames = 0;                ///< Number of resets
+        };
+
+    private:
+        struct Chunk
+        {
+            Chunk *next;
+            std::size_t size;
+        };
+
+        std::pmr::memory_resource *_upstream;
+        Chunk *_chunks;
+        std::byte *_cursor;
+        std::byte *_end;
+        std::size_t _chunk_size;
+        Statistics _statistics;
+
+        void add_chunk(std::size_t minimum_size);
+        void release_chunks() noexcept;
+
+    protected:
+        void *do_allocate(std::size_t bytes, std::size_t alignment) override;
+        void do_deallocate(void *pointer, std::size_t bytes, std::size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+    public:
+        /**
+         * @brief Construct a new Arena
+         *
+         * @param initial_size The size of the first chunk, in bytes
+         * @param upstream The resource chunks are obtained from
+         */
+        explicit Arena(std::size_t initial_size = 64 * 1024,
+                       std::pmr::memory_resource *upstream = std::pmr::get_default_resource());
+
+        Arena(const Arena &) = delete;
+        Arena &operator=(const Arena &) = delete;
+
+        /**
+         * @brief Destroy the Arena, returning every chunk upstream
+         *
+         */
+        ~Arena() override;
+
+        /**
+         * @brief End the frame: forget every allocation and keep the memory for the next one
+         *
+         */
+        void reset();
+
+        /**
+         * @brief Get the activity counters
+         *
+         * @return const Statistics& The counters
+         */
+        const Statistics &statistics() const noexcept { return _statistics; }
+    };
+} // namespace memory
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <Python.h>
+
+#include <new>
+#include <stdexcept>
+#include <string>
+
+namespace python
+{
+    /**
+     * @brief Thrown when a Python call fails, leaving the Python error pending
+     *
+     * The exception only describes the error for C++ callers, e.g.
+     * "KeyError: 'name'"; the Python exception itself, with its type and
+     * traceback, stays set so that guarded() hands it back to Python
+     * untouched. Code catching it without returning to Python must call
+     * PyErr_Clear().
+     */
+    class ErrorAlreadySet : public std::runtime_error
+    {
+    public:
+        explicit ErrorAlreadySet(const std::string &message) : std::runtime_error(message) {}
+    };
+
+    /**
+     * @brief Run a C API entry point body, turning C++ exceptions into Python exceptions
+     *
+     * A pending Python error, e.g. the one an ErrorAlreadySet was thrown for,
+     * is kept as is; otherwise std::bad_alloc becomes
+     * MemoryError, std::overflow_error OverflowError, std::out_of_range
+     * IndexError and any other std::exception the given fallback type.
+     *
+     * @param body Callable returning a new reference, or nullptr with an error set
+     * @param fallback The Python exception type for other C++ exceptions
+     * @return PyObject* The result of body, or nullptr with a Python error set
+     */
+    template <typename Body>
+    PyObject *guarded(Body &&body, PyObject *fallback = PyExc_RuntimeError)
+    {
+        try
+        {
+            return body();
+        }
+        catch (const std::bad_alloc &)
+        {
+            return PyErr_NoMemory();
+        }
+        catch (const std::exception &exception)
+        {
+            if (PyErr_Occurred())
+                return nullptr;
+
+            PyObject *type = fallback;
+            if (dynamic_cast<const std::overflow_error *>(&exception))
+                type = PyExc_OverflowError;
+            else if (dynamic_cast<const std::out_of_range *>(&exception))
+                type = PyExc_IndexError;
+            PyErr_SetString(type, exception.what());
+            return nullptr;
+        }
+    }
+} // namespace python
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <Python.h>
+
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "engine/event_queue.hpp"
+#include "python/object.hpp"
+#include "python/tree_builder.hpp"
+#include "vdom/patch.hpp"
+#include "vdom/tree.hpp"
+
+namespace python
+{
+    /**
+     * @brief Delegates the input events of a mounted tree to Python handlers
+     *
+     * Rather than one listener object per node, a root keeps a single table
+     * mapping (event type, node handle) to a handler, rebuilt from the
+     * handlers the TreeBuilder collected whenever a frame completes, and the
+     * parent of each handle, kept up to date from the frames' patches.
+     *
+     * Backends push raw events into queue() from any thread. dispatch()
+     * drains them once per frame and calls the handlers of the whole batch
+     * under the GIL the caller already holds, instead of taking it per event.
+     * An event is delivered to the handler of its target, then bubbles up to
+     * the handlers of the same type on its ancestors, until one returns True.
+     * The GIL must be held by every call but push().
+     */
+    class EventTable
+    {
+    public:
+        struct Statistics
+        {
+            std::uint64_t events = 0;   ///< Events dispatched, after coalescing
+            std::uint64_t handlers = 0; ///< Handler calls
+        };
+
+    private:
+        struct Key
+        {
+            vdom::Atom type;
+            vdom::Handle node;
+
+            bool operator==(const Key &other) const noexcept { return type == other.type && node == other.node; }
+        };
+
+        struct KeyHash
+        {
+            std::size_t operator()(const Key &key) const noexcept
+            {
+                return std::hash<vdom::Handle>{}(key.node * 0x9E3779B97F4A7C15ull ^ key.type);
+            }
+        };
+
+        vdom::AtomTable &_atoms;
+        engine::EventQueue _queue;
+        std::unordered_map<vdom::Handle, vdom::Handle> _parents;
+        std::unordered_map<Key, Object, KeyHash> _handlers;
+        std::unordered_map<vdom::Atom, Object> _type_names;
+        std::vector<engine::Event> _batch;
+        std::size_t _next;
+        bool _dispatching;
+        Statistics _statistics;
+
+        PyObject *type_name(vdom::Atom type);
+        Object make_event(const engine::Event &event, PyObject *type, vdom::Handle current_target);
+
+    protected:
+    public:
+        /**
+         * @brief Construct an empty EventTable, coalescing pointermove, mousemove and scroll events
+         *
+         * @param atoms The table the tree and the event types are interned in
+         */
+        explicit EventTable(vdom::AtomTable &atoms = vdom::AtomTable::global());
+
+        EventTable(const EventTable &) = delete;
+        EventTable &operator=(const EventTable &) = delete;
+
+        /**
+         * @brief Get the queue backends push events into
+         *
+         */
+        engine::EventQueue &queue() noexcept { return _queue; }
+
+        /**
+         * @brief Follow the structural patches of a completed frame
+         *
+         * @param patches The patches from the previously mounted tree
+         * @param mounted The tree they lead to, now mounted
+         */
+        void apply(const vdom::PatchList &patches, const vdom::Tree &mounted);
+
+        /**
+         * @brief Forget every node and take the structure of a tree mounted without patches, e.g. hydrated
+         *
+         * @param mounted The mounted tree
+         */
+        void reset(const vdom::Tree &mounted);
+
+        /**
+         * @brief Replace the handlers with those of a newly mounted tree
+         *
+         * @param mounted The mounted tree, whose handles are assigned
+         * @param handlers The handlers collected while building it
+         */
+        void bind(const vdom::Tree &mounted, std::span<const TreeBuilder::Handler> handlers);
+
+        /**
+         * @brief Deliver the queued events to their handlers
+         *
+         * Does nothing when called from a handler. If a handler raises, the
+         * events after the one it handled stay queued for the next call.
+         *
+         * @return std::size_t The number of handler calls
+         * @throw std::runtime_error If a handler raises
+         */
+        std::size_t dispatch();
+
+        /**
+         * @brief Visit every held reference, for the owner's tp_traverse
+         *
+         */
+        int traverse(visitproc visit, void *arg);
+
+        /**
+         * @brief Drop every handler, for the owner's tp_clear
+         *
+         */
+        void clear();
+
+        const Statistics &statistics() const noexcept { return _statistics; }
+    };
+
+    /**
+     * @brief Get the Event Python type handlers receive, of the calling interpreter, see interpreter_type()
+     *
+     * A named tuple of (type, target, current_target, x, y, detail), where
+     * current_target is the handle of the node whose handler is called.
+     *
+     * @return PyTypeObject* The type, or nullptr with a Python error set
+     */
+    PyTypeObject *event_type();
+} // namespace python
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <Python.h>
+
+namespace python
+{
+    /**
+     * @brief Scoped acquisition of the GIL from any thread
+     *
+     * Safe to nest and to use on threads Python has never seen.
+     */
+    class GIL
+    {
+    private:
+        PyGILState_STATE _state;
+
+    protected:
+    public:
+        GIL() noexcept : _state(PyGILState_Ensure()) {}
+
+        GIL(const GIL &) = delete;
+        GIL &operator=(const GIL &) = delete;
+
+        ~GIL()
+        {
+            PyGILState_Release(_state);
+        }
+    };
+
+    /**
+     * @brief Scoped release of the GIL held by the current thread
+     *
+     * Wrap long-running pure C++ work so other threads can run Python meanwhile.
+     * No Python object may be touched while the guard is alive.
+     */
+    class GILRelease
+    {
+    private:
+        PyThreadState *_state;
+
+    protected:
+    public:
+        GILRelease() noexcept : _state(PyEval_SaveThread()) {}
+
+        GILRelease(const GILRelease &) = delete;
+        GILRelease &operator=(const GILRelease &) = delete;
+
+        ~GILRelease()
+        {
+            PyEval_RestoreThread(_state);
+        }
+    };
+} // namespace python
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <Python.h>
+
+#include "python/object.hpp"
+
+namespace python
+{
+    /**
+     * @brief Intern a string in the interpreter of the calling thread
+     *
+     * Interned strings belong to one interpreter. Code that may run in
+     * several, e.g. in subinterpreters, keeps them per instance rather than
+     * in function-local statics. The GIL must be held.
+     *
+     * @param text The UTF-8 text
+     * @return Object The interned str
+     * @throw std::runtime_error If interning fails
+     */
+    inline Object interned(const char *text)
+    {
+        return Object(PyUnicode_InternFromString(text));
+    }
+} // namespace python
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <Python.h>
+
+namespace python
+{
+    /**
+     * @brief Get a type of the interpreter of the calling thread, creating it on first use
+     *
+     * The engine's Python types are heap types, and a heap type belongs to
+     * the interpreter it was created in. Each interpreter, the main one or a
+     * subinterpreter with its own GIL, therefore gets its own instance of
+     * every type, kept in its state dictionary until it is finalized, whether
+     * or not it imports the `_core` module. Lookups are cached per thread.
+     * The GIL must be held.
+     *
+     * @param create Makes the type, a new reference or nullptr with a Python error set; identifies it across interpreters
+     * @return PyTypeObject* A borrowed reference, or nullptr with a Python error set
+     */
+    PyTypeObject *interpreter_type(PyObject *(*create)());
+
+    /**
+     * @brief Get a type of the calling thread's interpreter only if it was created already
+     *
+     * For type checks: an object cannot be an instance of a type not created yet.
+     * The GIL must be held.
+     *
+     * @param create The function given to interpreter_type()
+     * @return PyTypeObject* A borrowed reference, or nullptr, with no Python error set
+     */
+    PyTypeObject *existing_interpreter_type(PyObject *(*create)()) noexcept;
+} // namespace python
@@ -2,8 +2,20 @@
 
 #include <Python.h>
 
+#include <utility>
+
+#include "python/errors.hpp"
+
 namespace python
 {
+    /**
+     * @brief Owning, move-only handle to a Python object
+     *
+     * An Object holds exactly one strong reference. Creating and destroying a
+     * handle costs a single Py_INCREF / Py_DECREF; the interpreter itself is
+     * owned by python::Runtime. The GIL must be held whenever a non-null handle
+     * is created, reset or destroyed.
+     */
     class Object
     {
     private:
@@ -12,22 +24,168 @@ namespace python
     protected:
     public:
         /**
-         * @brief Construct a new Python Object
+         * @brief Construct an empty Python Object
          *
          */
-        Object();
+        Object() noexcept : _object(nullptr) {}
 
         /**
          * @brief Construct a new Python Object
          *
-         * @param object A pointer to a Python object, the ownership is transferred to the new Object
+         * @param object A new reference to a Python object, the ownership is transferred to the new Object
+         * @throw ErrorAlreadySet If object is null, i.e. the call that produced it raised
+         */
+        explicit Object(PyObject *object) : _object(object)
+        {
+            if (!_object)
+                throw_error_occurred();
+        }
+
+        Object(const Object &) = delete;
+        Object &operator=(const Object &) = delete;
+
+        Object(Object &&other) noexcept : _object(other._object)
+        {
+            other._object = nullptr;
+        }
+
+        Object &operator=(Object &&other) noexcept
+        {
+            std::swap(_object, other._object);
+            return *this;
+        }
+
+        /**
+         * @brief Destroy the Python Object, releasing its reference
+         *
+         */
+        ~Object()
+        {
+            Py_XDECREF(_object);
+        }
+
+        /**
+         * @brief Wrap a borrowed reference, taking a new strong reference to it
+         *
+         * @param object A borrowed reference, may be null
+         * @return Object The new handle
+         */
+        static Object borrow(PyObject *object) noexcept
+        {
+            Py_XINCREF(object);
+            return steal(object);
+        }
+
+        /**
+         * @brief Wrap a new reference without checking it for null
+         *
+         * @param object A new reference, may be null
+         * @return Object The new handle
+         */
+        static Object steal(PyObject *object) noexcept
+        {
+            Object result;
+            result._object = object;
+            return result;
+        }
+
+        /**
+         * @brief Create a second handle to the same Python object
+         *
+         * @return Object A handle holding its own strong reference
+         */
+        Object share() const noexcept
+        {
+            return borrow(_object);
+        }
+
+        /**
+         * @brief Get the wrapped pointer without transferring ownership
+         *
+         * @return PyObject* A borrowed reference, may be null
+         */
+        PyObject *get() const noexcept { return _object; }
+
+        /**
+         * @brief Give up ownership of the wrapped pointer
+         *
+         * @return PyObject* The new reference previously held by this handle
+         */
+        PyObject *release() noexcept
+        {
+            return std::exchange(_object, nullptr);
+        }
+
+        /**
+         * @brief Replace the wrapped object, releasing the previous reference
+         *
+         * @param object A new reference, may be null
+         */
+        void reset(PyObject *object = nullptr) noexcept
+        {
+            Py_XDECREF(std::exchange(_object, object));
+        }
+
+        explicit operator bool() const noexcept { return _object != nullptr; }
+
+        /**
+         * @brief Get an attribute
+         *
+         * @param name The attribute name, ideally an interned str
+         * @return Object The attribute
+         * @throw ErrorAlreadySet If the lookup raises
+         */
+        Object attribute(PyObject *name) const
+        {
+            return Object(PyObject_GetAttr(_object, name));
+        }
+
+        /**
+         * @brief Get an attribute that may be missing
+         *
+         * @param name The attribute name, ideally an interned str
+         * @return Object The attribute, or an empty handle if there is none
+         * @throw ErrorAlreadySet If the lookup raises anything but AttributeError
+         */
+        Object optional_attribute(PyObject *name) const;
+
+        /**
+         * @brief Call the object through vectorcall with positional arguments
+         *
+         * The arguments are passed with PY_VECTORCALL_ARGUMENTS_OFFSET, so
+         * that calling a bound method does not allocate.
+         *
+         * @param arguments Borrowed references to the arguments
+         * @return Object The result
+         * @throw ErrorAlreadySet If the call raises
+         */
+        template <typename... Arguments>
+        Object call(Arguments... arguments) const
+        {
+            PyObject *vector[] = {nullptr, arguments...};
+            return Object(PyObject_Vectorcall(_object, vector + 1, sizeof...(Arguments) | PY_VECTORCALL_ARGUMENTS_OFFSET, nullptr));
+        }
+
+        /**
+         * @brief Call a method of the object through vectorcall, without creating a bound method
+         *
+         * @param name The method name, ideally an interned str
+         * @param arguments Borrowed references to the arguments
+         * @return Object The result
+         * @throw ErrorAlreadySet If the lookup or the call raises
          */
-        Object(PyObject *object);
+        template <typename... Arguments>
+        Object call_method(PyObject *name, Arguments... arguments) const
+        {
+            PyObject *vector[] = {nullptr, _object, arguments...};
+            return Object(PyObject_VectorcallMethod(name, vector + 1, (1 + sizeof...(Arguments)) | PY_VECTORCALL_ARGUMENTS_OFFSET, nullptr));
+        }
 
         /**
-         * @brief Destroy the Python Object
+         * @brief Throw a C++ exception for the pending Python error, leaving it pending
          *
+         * @throw ErrorAlreadySet Always, describing the Python error, or std::runtime_error if none is pending
          */
-        ~Object();
+        [[noreturn]] static void throw_error_occurred();
     };
 } // namespace python
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <Python.h>
+
+#include "vdom/persistent.hpp"
+
+namespace python
+{
+    /**
+     * @brief Instance layout of the PersistentMap Python type
+     *
+     */
+    struct PersistentMapObject
+    {
+        PyObject_HEAD
+        vdom::Ref<const vdom::PersistentMap> map;
+    };
+
+    /**
+     * @brief Instance layout of the PersistentVector Python type
+     *
+     */
+    struct PersistentVectorObject
+    {
+        PyObject_HEAD
+        vdom::Ref<const vdom::PersistentVector> vector;
+    };
+
+    /**
+     * @brief Get the PersistentMap Python type of the calling interpreter, see interpreter_type()
+     *
+     * An immutable mapping whose set(), remove() and update() return new
+     * versions sharing the unchanged structure of the vdom::PersistentMap
+     * they wrap. Keys are None, bool, int, float or str, values any property
+     * value. The GIL must be held.
+     *
+     * @return PyTypeObject* The type, or nullptr with a Python error set
+     */
+    PyTypeObject *persistent_map_type();
+
+    /**
+     * @brief Get the PersistentVector Python type of the calling interpreter, see interpreter_type()
+     *
+     * An immutable sequence whose append(), set(), pop() and extend() return
+     * new versions sharing the unchanged structure of the
+     * vdom::PersistentVector they wrap. The GIL must be held.
+     *
+     * @return PyTypeObject* The type, or nullptr with a Python error set
+     */
+    PyTypeObject *persistent_vector_type();
+
+    bool is_persistent_map(PyObject *object);
+    bool is_persistent_vector(PyObject *object);
+
+    /**
+     * @brief Wrap a map into a PersistentMap
+     *
+     * @return PyObject* A new reference, or nullptr with a Python error set
+     */
+    PyObject *wrap(vdom::Ref<const vdom::PersistentMap> map);
+
+    /**
+     * @brief Wrap a vector into a PersistentVector
+     *
+     * @return PyObject* A new reference, or nullptr with a Python error set
+     */
+    PyObject *wrap(vdom::Ref<const vdom::PersistentVector> vector);
+} // namespace python
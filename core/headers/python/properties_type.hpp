@@ -0,0 +1,38 @@
+#pragma once
+
+#include <Python.h>
+
+#include "vdom/properties.hpp"
+
+namespace python
+{
+    /**
+     * @brief Instance layout of the native Properties Python type
+     *
+     */
+    struct PropertiesObject
+    {
+        PyObject_HEAD
+        vdom::Properties properties;
+    };
+
+    /**
+     * @brief Get the native Properties Python type of the calling interpreter, see interpreter_type()
+     *
+     * The type keeps the API of the pure Python component_engine.Properties
+     * (set_property, get_property, remove_property, clear_properties) and
+     * stores the properties in a vdom::Properties keyed by global atoms.
+     * The GIL must be held.
+     *
+     * @return PyTypeObject* The type, or nullptr with a Python error set
+     */
+    PyTypeObject *properties_type();
+
+    /**
+     * @brief Tell whether an object is a native Properties instance
+     *
+     * @param object Any object
+     * @return true If object is an instance of properties_type() or of a subclass
+     */
+    bool is_properties(PyObject *object);
+} // namespace python
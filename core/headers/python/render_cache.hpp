@@ -0,0 +1,368 @@
+#pragma once
+
+#include <Python.h>
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "python/object.hpp"
+#include "snapshot/snapshot.hpp"
+#include "vdom/properties.hpp"
+#include "vdom/static_block.hpp"
+#include "vdom/tree.hpp"
+
+namespace python
+{
+    /**
+     * @brief Remembers what every mounted component rendered
+     *
+     * A TreeBuilder given a cache only calls render() when it cannot reuse a
+     * previous output. A memoized component is skipped when:
+     * - it is the same instance as in the previous frame, it was not
+     *   invalidated and its Properties equal those it last rendered from, or
+     * - it is pure, i.e. renders from its Properties alone, and replaces a
+     *   component of the same type at the same position under the same
+     *   parent, which was never updated and rendered from equal Properties.
+     *
+     * A new instance of a component that is not pure may carry anything else,
+     * e.g. constructor arguments kept as attributes, so it always renders.
+     * Each entry keeps a copy of the Properties its output was rendered from;
+     * their hashes are cached by the native Properties type until the next
+     * mutation, so a mismatch costs a few loads and only equal hashes are
+     * compared in full. Components whose properties are not a Properties
+     * instance are only skipped in the first case, and components opted out
+     * of memoization always render.
+     *
+     * Each entry also knows the range of nodes its output was built into in
+     * the tree of the last completed frame, so that the TreeBuilder copies a
+     * skipped component's nodes from that tree, handles included, rather
+     * than building them again: see reuse_nodes(). Its descendants are then
+     * reached without being entered.
+     *
+     * A cache can also start from a tree mounted from a snapshot, along with
+     * the components that rendered it, see hydrate(): the first frame then
+     * treats a new pure component matching the record at its place as
+     * memoized, and copies its recorded nodes instead of rendering it.
+     *
+     * Each component is mounted once seen by a frame and unmounted by the
+     * first frame that no longer reaches it. Mounted components get a `_root`
+     * attribute holding a weak reference to the cache owner, so that they can
+     * schedule their own updates; it is reset to None on unmount.
+     *
+     * The cache also keeps the StaticBlock frozen from the first output of each
+     * static component class, which later instances copy instead of entering
+     * the cache at all. The GIL must be held by every call, including
+     * construction.
+     */
+    class RenderCache
+    {
+    public:
+        /**
+         * @brief The nodes a component's output was built into, whole subtrees laid out contiguously in pre-order
+         *
+         */
+        struct NodeRange
+        {
+            vdom::NodeId first; ///< null_node if unknown, e.g. for a streamed build
+            vdom::NodeId count;
+        };
+
+        /**
+         * @brief The nodes of tree() a component built again by the current frame replaces, see retain()
+         *
+         */
+        struct Replacement
+        {
+            NodeRange nodes;
+            vdom::NodeId count; ///< The number of nodes built in their place
+        };
+
+        struct Entry
+        {
+            Object component;
+            Object output;
+            Object properties;
+            std::uint64_t properties_hash;
+            bool hashed;
+            std::optional<vdom::Properties> rendered; ///< What `output` was rendered from, if the properties are a Properties
+            std::uint32_t depth;
+            bool memoize;
+            bool pure;
+            bool hydrated; ///< Reuses nodes recorded by a snapshot instead of an output, see hydrate()
+            std::uint32_t record; ///< Its snapshot::Component, snapshot::format::null_index if none
+            std::uint64_t frame;
+            std::uint64_t updates;
+            std::vector<PyObject *> children;
+            std::vector<PyObject *> next_children;
+            NodeRange nodes; ///< In the tree of the last completed frame, see tree()
+            NodeRange next_nodes;
+        };
+
+        struct Statistics
+        {
+            std::uint64_t renders = 0;          ///< Calls to render()
+            std::uint64_t skipped_renders = 0;  ///< Components rebuilt from a previous output instead
+        };
+
+    private:
+        struct StaticEntry
+        {
+            Object type; ///< Held so that its address cannot be reused by another type
+            unsigned int version;
+            vdom::Ref<const vdom::StaticBlock> block;
+        };
+
+        std::unordered_map<PyObject *, Entry> _entries;
+        std::unordered_map<PyTypeObject *, StaticEntry> _static_blocks;
+        std::vector<Entry *> _parents;
+        std::vector<std::pair<Entry *, std::uint32_t>> _reused; ///< Scratch of reuse_nodes(), with depths
+        std::vector<snapshot::Component> _records; ///< Until the first frame ends, see hydrate()
+        std::vector<std::uint32_t> _record_children; ///< Grouped by parent record
+        std::vector<std::uint32_t> _record_offsets; ///< Into _record_children, per record and one past the last
+        std::unordered_map<PyTypeObject *, std::string> _type_names;
+        PyObject *_owner;
+        Object _owner_reference;
+        std::uint64_t _frame;
+        std::uint64_t _tree;
+        std::uint64_t _next_tree;
+        Statistics _statistics;
+        Object _root_name;
+        Object _properties_name;
+
+        void set_root(PyObject *component, PyObject *root);
+        void hash_properties(Entry &entry);
+        bool unchanged(Entry &entry);
+        static bool rendered_from(const Entry &entry, const Entry &properties);
+        static bool has_output(const Entry &entry) noexcept { return entry.output || entry.hydrated; }
+        bool reuse_predecessor(Entry &entry, const Entry *parent, std::size_t position, bool pure);
+        bool reuse_record(Entry &entry, const Entry *parent, std::size_t position, bool pure);
+        const std::string &type_name(PyTypeObject *type);
+        void forget_records() noexcept;
+
+    protected:
+    public:
+        /**
+         * @brief Construct an empty RenderCache
+         *
+         * @param owner The object components are linked to through `_root`, nullptr for none; must support weak references
+         */
+        explicit RenderCache(PyObject *owner = nullptr);
+
+        RenderCache(const RenderCache &) = delete;
+        RenderCache &operator=(const RenderCache &) = delete;
+
+        /**
+         * @brief Find the entry of a mounted component
+         *
+         * @param component The component
+         * @return const Entry* The entry, or nullptr if the component is not mounted
+         */
+        const Entry *find(PyObject *component) const;
+
+        /**
+         * @brief Forget the output of a component so that the next frame renders it again
+         *
+         * @param component The component
+         * @return true If the component is mounted
+         */
+        bool invalidate(PyObject *component);
+
+        /**
+         * @brief Start a frame; components not reached before end_frame() get unmounted
+         *
+         * A frame may be abandoned by starting the next one without calling
+         * end_frame(); outputs it stored stay valid.
+         */
+        void begin_frame() noexcept
+        {
+            _frame++;
+            _parents.clear();
+        }
+
+        /**
+         * @brief Name the tree the current frame builds into, which tree() becomes once the frame ends
+         *
+         * @param tree The tree, identified by its serial
+         */
+        void build_into(const vdom::Tree &tree) noexcept { _next_tree = tree.serial(); }
+
+        /**
+         * @brief Get the serial of the tree of the last completed frame, which the node ranges of the entries point into
+         *
+         * @return std::uint64_t The vdom::Tree::serial() of the tree, the hydrated one before the first frame ends, or 0
+         */
+        std::uint64_t tree() const noexcept { return _tree; }
+
+        /**
+         * @brief Start from a tree mounted from a snapshot, instead of an empty one
+         *
+         * Until the first frame ends, each component it enters is matched
+         * with the record of the same class at the same position under the
+         * record of its parent, the root with the first record. A pure and
+         * memoized component whose properties equal those its record saved
+         * is then skipped: reuse_nodes() copies the recorded nodes, and its
+         * descendants are not reached, as write() only saves the properties
+         * of components whose descendants are pure too. The cache must be
+         * empty.
+         *
+         * @param components The components that rendered the tree, see snapshot::Snapshot::components()
+         * @param tree The tree, which becomes tree()
+         */
+        void hydrate(std::span<const snapshot::Component> components, const vdom::Tree &tree);
+
+        /**
+         * @brief Save the mounted components, for snapshot::write()
+         *
+         * Each component is saved with the nodes of tree() it rendered, and
+         * with the properties it rendered from if a new instance rendering
+         * from equal ones would reuse its output, see enter(), and so would
+         * each of its descendants.
+         *
+         * @param root The root component
+         * @return std::vector<snapshot::Component> The components reached from root in the last completed frame, in pre-order
+         */
+        std::vector<snapshot::Component> components(PyObject *root);
+
+        /**
+         * @brief Enter a component reached by the current frame
+         *
+         * Every enter() must be matched by a leave() once the output of the
+         * component is built.
+         *
+         * @param component The component
+         * @param depth Its depth in the component tree
+         * @param memoize False to always render the component
+         * @param pure True if the component renders from its Properties alone, so that a new instance may reuse the output of its predecessor
+         * @return PyObject* A previous output to reuse as a borrowed reference, or nullptr if it must render, unless hydrated()
+         */
+        PyObject *enter(PyObject *component, std::uint32_t depth, bool memoize, bool pure);
+
+        /**
+         * @brief Tell whether the component entered last is skipped for the nodes a snapshot recorded, see hydrate()
+         *
+         * Such a component has no output to build: if reuse_nodes() cannot
+         * copy its nodes, it must render.
+         */
+        bool hydrated() const noexcept { return !_parents.empty() && _parents.back()->hydrated; }
+
+        /**
+         * @brief Reach the descendants of the component entered last without entering them, to copy its nodes
+         *
+         * Only succeeds if enter() returned a previous output, or hydrated()
+         * is true, and that output was built into tree(), and if every
+         * component it holds would be skipped by enter() too. Each of them
+         * is then reached by the current frame, its nodes moved to where the
+         * copy starts, and counted as a skipped render. The component must
+         * still be left.
+         *
+         * @param first The node the copy of the output will start at, in the tree the frame builds into
+         * @return const NodeRange* The nodes to copy from tree(), or nullptr to build the output instead
+         */
+        const NodeRange *reuse_nodes(vdom::NodeId first);
+
+        /**
+         * @brief Keep mounted the components of tree() the current frame did not enter, as it copies their nodes
+         *
+         * For a frame that only builds some components again, in place of
+         * their nodes in tree(), and copies every other node: the components
+         * reached from `root` without going through an entered one are
+         * reached by the frame too, with their nodes moved and resized by
+         * the replacements. The descendants of the entered components that
+         * the frame did not enter again get unmounted.
+         *
+         * @param root The root component, whose entry must exist
+         * @param replacements The nodes replaced by the entered components, sorted and disjoint
+         */
+        void retain(PyObject *root, std::span<const Replacement> replacements);
+
+        /**
+         * @brief Remember the output of the component entered last
+         *
+         * @param component The component
+         * @param output What its render() returned
+         */
+        void store(PyObject *component, Object output);
+
+        /**
+         * @brief Find the block of a static component class, counted as a skipped render when found
+         *
+         * @param type The class
+         * @return const vdom::StaticBlock* The block, or nullptr if the class must render once more
+         */
+        const vdom::StaticBlock *static_block(PyTypeObject *type);
+
+        /**
+         * @brief Remember the block frozen from the output of a static component class
+         *
+         * Changing the class, e.g. replacing its render(), forgets the block.
+         *
+         * @param type The class
+         * @param block The block
+         */
+        void store_static_block(PyTypeObject *type, vdom::Ref<const vdom::StaticBlock> block);
+
+        /**
+         * @brief Leave the component entered last
+         *
+         * @param nodes The nodes its output was built into by the current frame
+         */
+        void leave(NodeRange nodes) noexcept
+        {
+            _parents.back()->next_nodes = nodes;
+            _parents.pop_back();
+        }
+
+        /**
+         * @brief End the frame, unmounting the components it did not reach
+         *
+         * @param on_unmount Called with each unmounted component, still alive
+         */
+        template <typename Unmount>
+        void end_frame(Unmount &&on_unmount)
+        {
+            // Detach first: releasing references may run arbitrary Python code
+            std::vector<Entry> unmounted;
+            _tree = _next_tree;
+            forget_records();
+            for (auto it = _entries.begin(); it != _entries.end();)
+            {
+                if (it->second.frame == _frame)
+                {
+                    std::swap(it->second.children, it->second.next_children);
+                    it->second.next_children.clear();
+                    it->second.nodes = it->second.next_nodes;
+                    ++it;
+                    continue;
+                }
+                unmounted.push_back(std::move(it->second));
+                it = _entries.erase(it);
+            }
+
+            for (Entry &entry : unmounted)
+            {
+                set_root(entry.component.get(), Py_None);
+                on_unmount(entry.component.get());
+            }
+        }
+
+        /**
+         * @brief Visit every held reference, for the owner's tp_traverse
+         *
+         */
+        int traverse(visitproc visit, void *arg);
+
+        /**
+         * @brief Drop every entry, for the owner's tp_clear
+         *
+         */
+        void clear();
+
+        std::size_t size() const noexcept { return _entries.size(); }
+        const Statistics &statistics() const noexcept { return _statistics; }
+    };
+} // namespace python
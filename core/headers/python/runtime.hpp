@@ -0,0 +1,77 @@
+#pragma once
+
+#include <Python.h>
+
+#include <string>
+#include <vector>
+
+namespace python
+{
+    /**
+     * @brief Settings applied to the embedded interpreter when it is first initialized
+     *
+     */
+    struct RuntimeConfig
+    {
+        std::string program_name;                     ///< Value of sys.executable / program name, empty for the default
+        std::vector<std::string> arguments;           ///< Value of sys.argv, left unparsed by Python
+        std::vector<std::string> module_search_paths; ///< Replaces sys.path when not empty
+        bool isolated = false;                        ///< Ignore environment variables and user site-packages
+        bool install_signal_handlers = false;         ///< Let Python install its own SIGINT handler
+        bool write_bytecode = true;                   ///< Allow Python to write .pyc files
+    };
+
+    /**
+     * @brief Process-wide owner of the embedded Python interpreter
+     *
+     * The interpreter is initialized once, on the first call to initialize(),
+     * and finalized when the process exits. When Python is already running
+     * (e.g. the engine is loaded as an extension module) the runtime attaches
+     * to it and never finalizes it.
+     *
+     * After initialization the GIL is released; every thread, including the one
+     * that initialized the runtime, accesses Python through a python::GIL guard.
+     */
+    class Runtime
+    {
+    private:
+        bool _owned;
+        PyThreadState *_main_thread_state;
+
+        explicit Runtime(const RuntimeConfig &config);
+
+    protected:
+    public:
+        Runtime(const Runtime &) = delete;
+        Runtime &operator=(const Runtime &) = delete;
+
+        /**
+         * @brief Destroy the Runtime, finalizing the interpreter if this runtime started it
+         *
+         */
+        ~Runtime();
+
+        /**
+         * @brief Initialize the interpreter on first use and return the runtime
+         *
+         * @param config The settings to apply, ignored once the runtime exists
+         * @return Runtime& The process-wide runtime
+         * @throw std::runtime_error If Python fails to initialize
+         */
+        static Runtime &initialize(const RuntimeConfig &config = {});
+
+        /**
+         * @brief Tell whether a Python interpreter is running in this process
+         *
+         * @return true If Python is initialized, whoever initialized it
+         */
+        static bool is_initialized() noexcept;
+
+        /**
+         * @brief Tell whether this runtime started, and will finalize, the interpreter
+         *
+         * @return true If the interpreter is owned by this runtime
+         */
+        bool owns_interpreter() const noexcept { return _owned; }
+    };
+} // namespace python
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <Python.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+namespace python
+{
+    /**
+     * @brief Isolated interpreter with its own GIL, running jobs on its own thread
+     *
+     * Each Subinterpreter owns a thread and an interpreter created there with
+     * a GIL of its own (Python 3.12 and later), so that N instances run N
+     * independent component roots truly in parallel. Jobs run in submission
+     * order on that thread, holding the subinterpreter's GIL: they may use
+     * the embedding API (python::Object, python::TreeBuilder,
+     * python::RenderCache) but not python::GIL, which targets the main
+     * interpreter. Python objects never cross interpreters; the vdom::Tree
+     * and vdom::PatchList a job fills are plain C++ and are handed to other
+     * threads as is.
+     *
+     * Every interpreter has its own module state, so modules are imported
+     * again in each. The `_core` module supports that: it is initialized in
+     * phases, declares its support of a per-interpreter GIL, and its types
+     * are created once per interpreter, so jobs may import component_engine
+     * and drive Root objects. Extension modules that do not support multiple
+     * interpreters cannot be imported from a job.
+     *
+     * The main runtime must be initialized first, and every Subinterpreter
+     * destroyed before it is finalized. Creating and destroying one briefly
+     * takes the main interpreter's GIL, which the calling thread must not
+     * hold.
+     */
+    class Subinterpreter
+    {
+    private:
+        std::mutex _mutex;
+        std::condition_variable _condition;
+        std::deque<std::function<void()>> _jobs;
+        bool _stopping;
+        std::thread _thread;
+
+        void enqueue(std::function<void()> job);
+        void run(std::promise<void> &started);
+
+    protected:
+    public:
+        /**
+         * @brief Create the interpreter and its thread
+         *
+         * @throw std::runtime_error If Python is older than 3.12, not initialized, or the interpreter cannot be created
+         */
+        Subinterpreter();
+
+        Subinterpreter(const Subinterpreter &) = delete;
+        Subinterpreter &operator=(const Subinterpreter &) = delete;
+
+        /**
+         * @brief Run the jobs already submitted, then end the interpreter and join its thread
+         *
+         */
+        ~Subinterpreter();
+
+        /**
+         * @brief Tell whether this build of the engine can create subinterpreters with their own GIL
+         *
+         * @return true If compiled against Python 3.12 or later
+         */
+        static constexpr bool supported() noexcept
+        {
+#if PY_VERSION_HEX >= 0x030C0000
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        /**
+         * @brief Queue a job to run in the subinterpreter
+         *
+         * @param function Called with no argument on the subinterpreter's thread, its GIL held
+         * @return std::future The result of function, or the exception it threw
+         */
+        template <typename Function>
+        std::future<std::invoke_result_t<Function>> submit(Function &&function)
+        {
+            using Result = std::invoke_result_t<Function>;
+
+            auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Function>(function));
+            std::future<Result> result = task->get_future();
+            enqueue([task]
+                    { (*task)(); });
+            return result;
+        }
+    };
+} // namespace python
@@ -0,0 +1,285 @@
+#pragma once
+
+#include <Python.h>
+
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "python/object.hpp"
+#include "python/render_cache.hpp"
+#include "vdom/tree.hpp"
+
+namespace python
+{
+    /**
+     * @brief Converts the output of Component.render() into a vdom::Tree
+     *
+     * Accepted nodes are:
+     * - objects with `tag`, `properties`, `children` and `key` attributes (Element),
+     * - objects whose class has a `render` method (Component), rendered
+     *   recursively; as for Python's special methods, an instance attribute
+     *   named `render` is ignored,
+     * - str, int and float, converted to text nodes,
+     * - list and tuple, whose items are spliced into the parent (fragments),
+     * - None and bool, which render nothing.
+     *
+     * Properties may be a Properties instance, a dict or None. A dict
+     * property named `on_<type>` whose value is callable is an event handler:
+     * the node gets the property with the value True, and the handler is
+     * collected into handlers() for the event type `<type>`. With a
+     * RenderCache, components whose previous output can be reused are not
+     * rendered again, unless their class sets `memoize = False`. Given the
+     * tree of the last completed frame, the nodes of such a component are
+     * copied from it, handles and handlers included, instead of walking its
+     * output again, when no component inside must render; a frame may even
+     * build its dirty components alone and copy every other node, see
+     * start(). The tree may also be one hydrated from a snapshot, whose
+     * recorded components are copied the same way, see
+     * RenderCache::hydrate(). Classes setting `static = True` render once:
+     * their single node of output, if
+     * it has no event handler, is frozen into a vdom::StaticBlock that every
+     * later instance copies without entering the cache. Both attributes are
+     * read once per class. The GIL must be held, including by the
+     * constructor, and a builder is used in the interpreter it was made in.
+     *
+     * The output is walked with an explicit work stack rather than recursion,
+     * so a build can be run in slices: start(), then advance() until it
+     * returns false, then finish(). Nothing bounds the nesting depth.
+     *
+     * With a Listener, the builder streams instead: each node is handed to
+     * the listener as soon as it is built, and dropped from the tree once
+     * left, so that the tree only holds the root and the elements still open.
+     */
+    class TreeBuilder
+    {
+    public:
+        /**
+         * @brief Receives the nodes of a streamed build in document order
+         *
+         * Every node is entered, then left once its children have been
+         * entered and left. A node may only be read from the tree between
+         * the two calls, and is not linked to its parent.
+         */
+        class Listener
+        {
+        public:
+            virtual ~Listener() = default;
+
+            virtual void enter(const vdom::Tree &tree, vdom::NodeId node) = 0;
+            virtual void leave(const vdom::Tree &tree, vdom::NodeId node) = 0;
+        };
+
+        /**
+         * @brief An event handler given as a property of an element
+         *
+         */
+        struct Handler
+        {
+            vdom::NodeId node;
+            vdom::Atom type;
+            Object callback;
+        };
+
+    private:
+        enum class NodeType
+        {
+            Element,
+            Component,
+            UnmemoizedComponent,
+            StaticComponent
+        };
+
+        /**
+         * @brief What the builder knows about a class it met
+         *
+         * `render` is the plain function the class resolves `render` to,
+         * called unbound through vectorcall while the version tag of the
+         * class is still `version`; any change to the class or its bases
+         * gives it a new tag, and render is resolved again.
+         */
+        struct TypeInfo
+        {
+            Object type; ///< Held so that its address cannot be reused by another type
+            NodeType node_type;
+            bool pure; ///< Renders from its Properties alone, see RenderCache
+            unsigned int version;
+            Object render;
+        };
+
+        struct Names
+        {
+            Object tag;
+            Object key;
+            Object properties;
+            Object children;
+            Object render;
+            Object memoize;
+            Object is_static;
+            Object pure;
+        };
+
+        enum class Action : std::uint8_t
+        {
+            Build,
+            LeaveComponent,
+            LeaveStaticComponent, ///< Builds with a cache only, the object is the component
+            LeaveElement ///< Streamed builds only, the element is parent
+        };
+
+        struct Work
+        {
+            Object object;
+            vdom::NodeId parent;
+            Action action;
+        };
+
+        /**
+         * @brief Where the output of a component being built with a cache starts
+         *
+         */
+        struct Output
+        {
+            vdom::NodeId node;
+            std::size_t handlers;
+        };
+
+        /**
+         * @brief A dirty component built again in place of its nodes in the mounted tree
+         *
+         */
+        struct Splice
+        {
+            Object component;
+            RenderCache::NodeRange nodes;
+            std::uint32_t depth;
+        };
+
+        vdom::Tree &_tree;
+        vdom::AtomTable &_atoms;
+        RenderCache *_cache;
+        Listener *_listener;
+        const vdom::Tree *_mounted;
+        std::span<const Handler> _mounted_handlers;
+        std::vector<vdom::Tree::Checkpoint> _checkpoints;
+        std::vector<Output> _outputs;
+        std::uint32_t _depth;
+        std::vector<vdom::Property> _properties;
+        std::vector<Handler> _handlers;
+        std::unordered_map<vdom::Atom, vdom::Atom> _event_types;
+        std::unordered_map<PyTypeObject *, TypeInfo> _types;
+        std::vector<Work> _work;
+        Object _root;
+        std::vector<Splice> _splices; ///< Sorted by node
+        std::size_t _next_splice;
+        std::vector<RenderCache::Replacement> _replacements;
+        std::vector<std::pair<vdom::NodeId, vdom::NodeId>> _ancestors; ///< End of the subtree in the mounted tree, and the copy, of the nodes enclosing the copy position
+        vdom::NodeId _cursor; ///< The next node of the mounted tree to copy
+        vdom::NodeId _spliced; ///< Where the output of the splice being built starts, null_node if none
+        bool _splicing;
+        Names _names;
+
+        TypeInfo &type_info(PyObject *object);
+        void resolve_render(TypeInfo &info);
+        Object render(PyObject *component, TypeInfo &info);
+        bool step();
+        void attach(vdom::NodeId node, vdom::NodeId parent);
+        void leave(vdom::NodeId node, const vdom::Tree::Checkpoint &checkpoint);
+        bool build_component(PyObject *component, TypeInfo &info, vdom::NodeId parent);
+        void leave_component();
+        bool copy_cached(vdom::NodeId parent);
+        void copy_mounted(vdom::NodeId first, vdom::NodeId count, vdom::NodeId parent);
+        void copy_handlers(vdom::NodeId first, vdom::NodeId count, vdom::NodeId copy);
+        bool plan_splices(PyObject *root, std::span<PyObject *const> dirty);
+        bool splice();
+        bool copy_static(PyObject *component, vdom::NodeId parent);
+        void freeze_static(PyObject *component);
+        void push_children(PyObject *children, vdom::NodeId parent);
+        vdom::NodeId build_element(PyObject *element);
+        vdom::NodeId build_text(PyObject *object);
+        void collect_properties(PyObject *properties);
+        vdom::Atom event_type(vdom::Atom property);
+        vdom::Atom to_atom(PyObject *object);
+
+    protected:
+    public:
+        /**
+         * @brief Construct a new TreeBuilder writing into a tree
+         *
+         * @param tree The tree to fill
+         * @param atoms The table interning tags and property names
+         * @param cache The outputs of components rendered by earlier builds, nullptr to render every component
+         * @param listener The receiver of a streamed build, nullptr to keep the whole tree
+         * @param mounted The tree of the last frame of cache, to copy the nodes of skipped components from; nullptr to build them
+         * @param mounted_handlers The handlers collected while building mounted, sorted by node
+         */
+        explicit TreeBuilder(vdom::Tree &tree, vdom::AtomTable &atoms = vdom::AtomTable::global(),
+                             RenderCache *cache = nullptr, Listener *listener = nullptr,
+                             const vdom::Tree *mounted = nullptr, std::span<const Handler> mounted_handlers = {});
+
+        /**
+         * @brief Clear the tree and fill it from a component or element
+         *
+         * @param root A Component, or an Element, rendering exactly one node
+         * @param dirty The components to render again, see start()
+         * @return vdom::NodeId The root of the tree
+         * @throw std::runtime_error If a render() call raises or the output is malformed
+         */
+        vdom::NodeId build(PyObject *root, std::span<PyObject *const> dirty = {});
+
+        /**
+         * @brief Clear the tree and start a build from a component or element
+         *
+         * Given the dirty components of a frame, and the mounted tree of the
+         * cache, only the outermost dirty components are built, each in place
+         * of its nodes in a copy of the mounted tree, and every other
+         * component of the cache stays mounted, see RenderCache::retain().
+         * The copy keeps the handles of the untouched subtrees, so that the
+         * reconciler skips them, and the ancestors of the dirty components
+         * are copied alone, to be diffed again. The whole tree is built from
+         * root instead when the root is dirty, when a dirty component is not
+         * mounted or rendered nothing, or without a mounted tree.
+         *
+         * @param root A Component, or an Element, rendering exactly one node
+         * @param dirty The components to render again, parents before their descendants as engine::Scheduler sorts them; empty to build the whole tree
+         */
+        void start(PyObject *root, std::span<PyObject *const> dirty = {});
+
+        /**
+         * @brief Continue the build until a component has rendered or a batch of nodes is built
+         *
+         * @return true If work remains
+         * @throw std::runtime_error If a render() call raises or the output is malformed
+         */
+        bool advance();
+
+        /**
+         * @brief Complete a build once advance() returned false
+         *
+         * @return vdom::NodeId The root of the tree
+         * @throw std::runtime_error If the root rendered nothing
+         */
+        vdom::NodeId finish();
+
+        /**
+         * @brief Get the event handlers of the elements built since start(), none for streamed builds
+         *
+         * @return std::span<const Handler> The handlers, sorted by node
+         */
+        std::span<const Handler> handlers() const noexcept { return _handlers; }
+
+        /**
+         * @brief Take the event handlers of a finished build, e.g. to pass them on to the next frame's builder
+         *
+         */
+        std::vector<Handler> take_handlers() noexcept { return std::move(_handlers); }
+
+        /**
+         * @brief Visit the objects held by an unfinished build, for the owner's tp_traverse
+         *
+         */
+        int traverse(visitproc visit, void *arg);
+    };
+} // namespace python
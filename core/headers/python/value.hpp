@@ -0,0 +1,41 @@
+#pragma once
+
+#include <Python.h>
+
+#include <string_view>
+
+#include "vdom/value.hpp"
+
+namespace python
+{
+    /**
+     * @brief Get the UTF-8 content of a str without copying it
+     *
+     * @param string A str object, which must outlive the view
+     * @return std::string_view The UTF-8 content
+     * @throw std::runtime_error If the string cannot be encoded
+     */
+    std::string_view utf8_view(PyObject *string);
+
+    /**
+     * @brief Convert None, bool, int, float, str, PersistentMap or PersistentVector to an unboxed value
+     *
+     * String values view the UTF-8 buffer of object, and map and vector values
+     * the structure it holds: they must be copied or retained before object
+     * is released.
+     *
+     * @param object The Python value
+     * @return vdom::Value The unboxed value
+     * @throw std::runtime_error If object has another type
+     * @throw std::overflow_error If object is an int that does not fit in 64 bits
+     */
+    vdom::Value to_value(PyObject *object);
+
+    /**
+     * @brief Box a value into the matching Python object
+     *
+     * @param value The value
+     * @return PyObject* A new reference, or nullptr with a Python error set
+     */
+    PyObject *from_value(const vdom::Value &value);
+} // namespace python
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+
+namespace snapshot
+{
+    /**
+     * @brief Read-only memory mapping of a whole file
+     *
+     * The file may be replaced or removed while mapped; the mapping keeps
+     * seeing the content it was opened with.
+     */
+    class MappedFile
+    {
+    private:
+        const std::byte *_data;
+        std::size_t _size;
+#ifdef _WIN32
+        void *_mapping;
+#endif
+
+        void unmap() noexcept;
+
+    protected:
+    public:
+        /**
+         * @brief Construct an empty mapping
+         *
+         */
+        MappedFile() noexcept;
+
+        /**
+         * @brief Map a file
+         *
+         * @param path The file to map
+         * @throw std::system_error If the file cannot be opened or mapped
+         */
+        explicit MappedFile(const std::filesystem::path &path);
+
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+        MappedFile(MappedFile &&other) noexcept;
+        MappedFile &operator=(MappedFile &&other) noexcept;
+        ~MappedFile();
+
+        const std::byte *data() const noexcept { return _data; }
+        std::size_t size() const noexcept { return _size; }
+    };
+} // namespace snapshot
@@ -0,0 +1,266 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "layout/layout_tree.hpp"
+#include "snapshot/mapped_file.hpp"
+#include "vdom/properties.hpp"
+#include "vdom/tree.hpp"
+
+namespace snapshot
+{
+    /**
+     * @brief On-disk layout of a snapshot, version 2
+     *
+     * A snapshot is a header followed by sections, each an array of fixed
+     * size records starting at an 8-byte aligned offset from the start of
+     * the file. Nothing in the file is an address: nodes refer to each other
+     * by index, strings by offset into the Strings section, tags and
+     * property names by index into the Atoms section, whose entry 0 is the
+     * empty atom. Integers are in the byte order of the writer, which the
+     * header records; a reader with the other order rejects the file.
+     *
+     * The node columns have the layout of the vdom::Tree columns they are
+     * saved from, null_index being vdom::null_node, so that a mounted tree
+     * reads them in place.
+     */
+    namespace format
+    {
+        constexpr char magic[8] = {'C', 'E', 'S', 'N', 'A', 'P', '\r', '\n'};
+        constexpr std::uint32_t version = 2;
+        constexpr std::uint32_t byte_order = 0x01020304;
+        constexpr std::uint32_t null_index = 0xFFFFFFFF;
+
+        enum class Section : std::uint32_t
+        {
+            Kinds,          ///< std::uint8_t per node
+            Tags,           ///< Atom index per node
+            Keys,           ///< Value per node
+            Texts,          ///< Value per node
+            Parents,        ///< Node index per node, null_index for none
+            FirstChildren,  ///< Node index per node
+            LastChildren,   ///< Node index per node
+            NextSiblings,   ///< Node index per node
+            Handles,        ///< std::uint64_t per node
+            PropertySlices, ///< vdom::PropertySlice per node, into Properties
+            Properties,     ///< Property, grouped by node
+            Atoms,          ///< StringRange per atom
+            Strings,        ///< Characters
+            Boxes,          ///< layout::Box per node, empty without layout
+            Components,     ///< Component, in pre-order, empty for a bare tree
+            ComponentProperties, ///< Property, grouped by component
+            Count
+        };
+
+        struct Range
+        {
+            std::uint64_t offset;
+            std::uint64_t size; ///< In bytes
+        };
+
+        struct Header
+        {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t byte_order;
+            std::uint32_t nodes;
+            std::uint32_t root;
+            std::uint32_t generation;
+            std::uint32_t reserved;
+            Range sections[static_cast<std::size_t>(Section::Count)];
+        };
+
+        struct StringRange
+        {
+            std::uint32_t offset;
+            std::uint32_t size;
+        };
+
+        struct Value
+        {
+            std::uint8_t type; ///< vdom::Value::Type
+            std::uint8_t padding[3];
+            std::uint32_t size; ///< Of a string
+            std::uint64_t payload; ///< Bits of the number, or offset of the string
+        };
+
+        struct Property
+        {
+            std::uint32_t atom;
+            std::uint32_t padding;
+            Value value;
+        };
+
+        struct Component
+        {
+            StringRange type;
+            std::uint32_t parent;  ///< Component index, lower than its own, null_index for the first one
+            std::uint32_t first;   ///< Node index, null_index if unknown
+            std::uint32_t count;   ///< Number of nodes
+            std::uint32_t reusable; ///< 1 if properties holds what it rendered from, see snapshot::Component
+            vdom::PropertySlice properties; ///< Into ComponentProperties
+            std::uint64_t properties_hash; ///< properties_hash() of the properties
+        };
+    } // namespace format
+
+    /**
+     * @brief A component that rendered part of a saved tree
+     *
+     */
+    struct Component
+    {
+        std::string type;     ///< Module and qualified name of its class
+        std::uint32_t parent; ///< Index of the component that rendered it, lower than its own; format::null_index for the root
+        vdom::NodeId first;   ///< The nodes of its output, whole subtrees in pre-order; null_node if unknown
+        vdom::NodeId count;
+        std::optional<vdom::Properties> properties; ///< What it rendered from, if a new instance rendering from equal ones produces the same nodes
+    };
+
+    /**
+     * @brief Hash a property set by names and values, so that it compares across processes
+     *
+     * vdom::Properties::hash() depends on the atoms of the process; this one
+     * does not, and ignores the order of the properties.
+     *
+     * @param properties The properties
+     * @param atoms The table their keys come from
+     * @return std::optional<std::uint64_t> The hash, or nothing if a value is a map or vector, which a snapshot cannot hold
+     */
+    std::optional<std::uint64_t> properties_hash(std::span<const vdom::Property> properties,
+                                                 const vdom::AtomTable &atoms = vdom::AtomTable::global());
+
+    /**
+     * @brief Save a tree, the atoms it uses and optionally its layout and components to a snapshot file
+     *
+     * The file is written next to its destination, then renamed over it, so
+     * that readers never see a partial snapshot. The properties of a
+     * component holding a map or vector are not saved, since they live in
+     * the memory of the writer.
+     *
+     * @param tree The tree, typically the mounted one
+     * @param path The destination file
+     * @param layout The layout whose boxes to save for each node by handle, nullptr for none
+     * @param components The components that rendered the tree, in pre-order, the root first; empty for none
+     * @param atoms The table the tags and property names of the tree come from
+     * @throw std::system_error If the file cannot be written
+     */
+    void write(const vdom::Tree &tree, const std::filesystem::path &path, const layout::LayoutTree *layout = nullptr,
+               std::span<const Component> components = {}, vdom::AtomTable &atoms = vdom::AtomTable::global());
+
+    /**
+     * @brief A snapshot file mapped in memory
+     *
+     * Opening checks the header and the bounds of every section, in constant
+     * time; nodes are then read in place, with no parsing. mount() lets a
+     * vdom::Tree read them in place too, and keeps the mapping alive for as
+     * long as the tree reads it.
+     */
+    class Snapshot
+    {
+    private:
+        std::shared_ptr<const MappedFile> _file;
+        const format::Header *_header;
+
+        template <typename Record>
+        std::span<const Record> section(format::Section section) const noexcept
+        {
+            const format::Range &range = _header->sections[static_cast<std::size_t>(section)];
+            return {reinterpret_cast<const Record *>(_file->data() + range.offset), range.size / sizeof(Record)};
+        }
+
+        std::string_view string(std::uint32_t offset, std::uint32_t size) const noexcept;
+        std::string_view checked_string(std::uint32_t offset, std::uint32_t size) const;
+        vdom::Value value(const format::Value &value) const noexcept;
+        vdom::Value checked_value(const format::Value &value) const;
+        std::vector<vdom::Atom> intern_atoms(vdom::AtomTable &atoms) const;
+
+    protected:
+    public:
+        /**
+         * @brief Map and check a snapshot file
+         *
+         * @param path The file
+         * @throw std::system_error If the file cannot be mapped
+         * @throw std::runtime_error If it is not a snapshot of this version and byte order, or is truncated
+         */
+        explicit Snapshot(const std::filesystem::path &path);
+
+        std::size_t size() const noexcept { return _header->nodes; }
+        vdom::NodeId root() const noexcept { return _header->root; }
+        std::uint32_t generation() const noexcept { return _header->generation; }
+
+        vdom::NodeKind kind(vdom::NodeId node) const noexcept
+        {
+            return static_cast<vdom::NodeKind>(section<std::uint8_t>(format::Section::Kinds)[node]);
+        }
+
+        vdom::Handle handle(vdom::NodeId node) const noexcept
+        {
+            return section<std::uint64_t>(format::Section::Handles)[node];
+        }
+
+        vdom::NodeId parent(vdom::NodeId node) const noexcept
+        {
+            return section<std::uint32_t>(format::Section::Parents)[node];
+        }
+
+        /**
+         * @brief Get the tag name of an element
+         *
+         */
+        std::string_view tag(vdom::NodeId node) const noexcept;
+
+        /**
+         * @brief Get the content of a text node
+         *
+         */
+        std::string_view text(vdom::NodeId node) const noexcept;
+
+        /**
+         * @brief Get the layout saved for every node, indexed by NodeId
+         *
+         * @return std::span<const layout::Box> The boxes, empty if the snapshot has no layout
+         */
+        std::span<const layout::Box> boxes() const noexcept { return section<layout::Box>(format::Section::Boxes); }
+
+        /**
+         * @brief Mount the saved tree, with the same NodeIds, handles and generation, reading it in place
+         *
+         * The tree reads the link, handle and property slice columns from
+         * the mapping, see vdom::Tree::view(), and strings from the Strings
+         * section, without copying them. Tags, keys, texts and properties
+         * only have their atoms and string offsets translated, a column at a
+         * time, into columns the tree retains along with the mapping.
+         * Mounting checks the whole snapshot in time linear in its size:
+         * the strings are checked as UTF-8 at once, then each only for its
+         * bounds, and every node for its links.
+         *
+         * The mounted tree can be diffed as is: diffing it against the next
+         * rendered tree yields only the changes since the snapshot.
+         *
+         * @param tree The tree to mount into, cleared first
+         * @param atoms The table to intern tags and property names into
+         * @throw std::runtime_error If an index or link is out of bounds or inconsistent, or a string is not UTF-8
+         */
+        void mount(vdom::Tree &tree, vdom::AtomTable &atoms = vdom::AtomTable::global()) const;
+
+        /**
+         * @brief Get the components saved with the tree, see write()
+         *
+         * The properties of a component are only returned if they hash to
+         * what the writer computed.
+         *
+         * @param atoms The table to intern property names into
+         * @return std::vector<Component> The components in pre-order, empty for a bare tree
+         * @throw std::runtime_error If an index or string is out of bounds, or a string is not UTF-8
+         */
+        std::vector<Component> components(vdom::AtomTable &atoms = vdom::AtomTable::global()) const;
+    };
+} // namespace snapshot
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "python/tree_builder.hpp"
+#include "ssr/sink.hpp"
+#include "vdom/tree.hpp"
+
+namespace ssr
+{
+    /**
+     * @brief Serializes virtual DOM nodes to HTML into a reusable buffer, flushed to a sink in chunks
+     *
+     * Elements become tags and their properties attributes: strings and
+     * numbers are written as values, true as a bare attribute, and None and
+     * false leave the attribute out, as do names that are not valid attribute
+     * names. Text and attribute values are escaped. Void elements, such as br
+     * or img, get no closing tag.
+     *
+     * The buffer is handed to the sink whenever it grows past the chunk size,
+     * between two tokens, so that a chunk never splits a tag or a UTF-8
+     * character. It keeps its capacity from one chunk, and one document, to
+     * the next.
+     *
+     * As a TreeBuilder::Listener, a writer serializes a component tree while
+     * it is being rendered; write() serializes a tree already built.
+     */
+    class HtmlWriter : public python::TreeBuilder::Listener
+    {
+    private:
+        struct Name
+        {
+            std::string_view text;
+            bool known = false;
+            bool void_element = false;
+            bool valid_attribute = false;
+        };
+
+        Sink _sink;
+        std::size_t _chunk_size;
+        vdom::AtomTable &_atoms;
+        std::string _buffer;
+        std::vector<Name> _names;
+        std::uint64_t _written;
+
+        const Name &name(vdom::Atom atom);
+        void append_escaped(std::string_view text, bool attribute);
+        void append_value(const vdom::Value &value);
+
+        void flush_if_full()
+        {
+            if (_buffer.size() >= _chunk_size)
+                flush();
+        }
+
+    protected:
+    public:
+        static constexpr std::size_t default_chunk_size = 16 * 1024;
+
+        /**
+         * @brief Construct a new HtmlWriter
+         *
+         * @param sink The receiver of the output
+         * @param chunk_size The size past which buffered output is flushed
+         * @param atoms The table tags and property names come from
+         */
+        explicit HtmlWriter(Sink sink, std::size_t chunk_size = default_chunk_size,
+                            vdom::AtomTable &atoms = vdom::AtomTable::global());
+
+        /**
+         * @brief Write the opening tag of an element, or a text
+         *
+         */
+        void enter(const vdom::Tree &tree, vdom::NodeId node) override;
+
+        /**
+         * @brief Write the closing tag of an element
+         *
+         */
+        void leave(const vdom::Tree &tree, vdom::NodeId node) override;
+
+        /**
+         * @brief Write a whole tree, then flush
+         *
+         * @param tree The tree, written from its root
+         */
+        void write(const vdom::Tree &tree);
+
+        /**
+         * @brief Hand the buffered output to the sink
+         *
+         */
+        void flush();
+
+        /**
+         * @brief Get the number of bytes handed to the sink so far
+         *
+         */
+        std::uint64_t written() const noexcept { return _written; }
+    };
+} // namespace ssr
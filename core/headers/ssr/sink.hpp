@@ -0,0 +1,25 @@
+#pragma once
+
+#include <functional>
+#include <string_view>
+
+namespace ssr
+{
+    /**
+     * @brief Receives the output of a renderer, one chunk at a time
+     *
+     * Chunks are only valid during the call.
+     */
+    using Sink = std::function<void(std::string_view chunk)>;
+
+    /**
+     * @brief Make a sink writing every chunk to a file descriptor
+     *
+     * Short writes are resumed and interrupted writes retried; the descriptor
+     * is neither owned nor closed.
+     *
+     * @param descriptor An open file descriptor, e.g. a socket or a pipe
+     * @return Sink The sink, throwing std::system_error if a write fails
+     */
+    Sink descriptor_sink(int descriptor);
+} // namespace ssr
@@ -0,0 +1,257 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "vdom/patch.hpp"
+
+namespace stream
+{
+    /**
+     * @brief Layout of a patch stream in shared memory, version 1
+     *
+     * A RingHeader followed by a ring of capacity bytes, a power of two.
+     * The writer appends records at head and the reader consumes them up to
+     * it, then advances tail; both are byte positions that only grow, taken
+     * modulo the capacity. Each side owns one and only reads the other, so
+     * the ring needs no lock.
+     *
+     * Records are 8-byte aligned and never wrap: a Padding record fills the
+     * end of the ring when the next one does not fit. A patch record carries
+     * its string value after it. Atoms are numbered by the writer and named
+     * by an Atom record before their first use, so the reader interns each
+     * name once. A Frame record closes the patches of a frame.
+     */
+    namespace format
+    {
+        constexpr char magic[8] = {'C', 'E', 'P', 'A', 'T', 'C', 'H', '\n'};
+        constexpr std::uint32_t version = 1;
+        constexpr std::uint32_t byte_order = 0x01020304;
+
+        static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "Shared positions must be lock-free");
+
+        struct RingHeader
+        {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t byte_order;
+            std::uint64_t capacity;
+            alignas(64) std::atomic<std::uint64_t> head; ///< Written by the writer
+            alignas(64) std::atomic<std::uint64_t> tail; ///< Written by the reader
+            alignas(64) std::atomic<std::uint32_t> closed;
+        };
+
+        enum class RecordType : std::uint8_t
+        {
+            // vdom::PatchType values come first
+            Atom = 0x40,  ///< name: the atom, followed by its characters
+            Frame,        ///< node: the patch count, payload: the generation
+            Padding       ///< Only size and type are written
+        };
+
+        struct Record
+        {
+            std::uint32_t size; ///< In bytes, with the characters and their padding
+            std::uint8_t type;  ///< vdom::PatchType or RecordType
+            std::uint8_t kind;  ///< vdom::NodeKind
+            std::uint8_t value_type; ///< vdom::Value::Type
+            std::uint8_t padding;
+            std::uint32_t name;
+            std::uint32_t value_size; ///< Characters of a string value following the record
+            std::uint64_t node;
+            std::uint64_t parent;
+            std::uint64_t before;
+            std::uint64_t payload; ///< Bits of the number value
+        };
+
+        constexpr std::size_t alignment = 8;
+        constexpr std::size_t minimum_capacity = 256;
+    } // namespace format
+
+    /**
+     * @brief Writes the patches of frames into a patch stream, the single producer
+     *
+     */
+    class PatchWriter
+    {
+    public:
+        struct Statistics
+        {
+            std::uint64_t frames = 0;
+            std::uint64_t patches = 0;
+            std::uint64_t bytes = 0; ///< Of records, padding included
+            std::uint64_t waits = 0; ///< Times the ring was full
+        };
+
+    private:
+        format::RingHeader *_header;
+        std::byte *_records;
+        std::uint64_t _mask;
+        std::uint64_t _head;
+        std::uint64_t _tail;
+        vdom::AtomTable &_atoms;
+        std::vector<bool> _sent_atoms;
+        Statistics _statistics;
+
+        void reserve(std::uint64_t size);
+        std::byte *claim(std::uint64_t size);
+        void emit(const format::Record &record, std::string_view characters);
+        void send_atom(vdom::Atom atom);
+        void publish() noexcept { _header->head.store(_head, std::memory_order_release); }
+
+    protected:
+    public:
+        /**
+         * @brief Get the memory a stream needs for a ring of at least capacity bytes
+         *
+         */
+        static std::size_t memory_size(std::size_t capacity) noexcept;
+
+        /**
+         * @brief Lay out an empty stream in memory, typically a SharedMemory
+         *
+         * Readers may attach once it is constructed.
+         *
+         * @param memory The memory, 64-byte aligned; the ring takes the largest power of two that fits
+         * @param atoms The table the tags and property names of the patches come from
+         * @throw std::length_error If the memory cannot hold a ring of format::minimum_capacity bytes
+         */
+        explicit PatchWriter(std::span<std::byte> memory, vdom::AtomTable &atoms = vdom::AtomTable::global());
+
+        PatchWriter(const PatchWriter &) = delete;
+        PatchWriter &operator=(const PatchWriter &) = delete;
+
+        /**
+         * @brief Close the stream, so that the reader finishes once it has read everything
+         *
+         */
+        ~PatchWriter();
+
+        /**
+         * @brief Write the patches of a frame, then publish them
+         *
+         * Waits while the ring is full, publishing what was written so far,
+         * so that frames larger than the ring stream through it.
+         *
+         * @param patches The patches, whose strings are copied into the ring
+         * @param generation The generation of the frame's tree, passed to the reader
+         * @throw std::runtime_error If the reader closes the stream while the ring is full
+         * @throw std::length_error If a single string does not fit in the ring
+         */
+        void write(std::span<const vdom::Patch> patches, std::uint32_t generation);
+
+        /**
+         * @brief Tell the reader that nothing more will be written
+         *
+         */
+        void close() noexcept;
+
+        /**
+         * @brief Check whether the reader has consumed everything written
+         *
+         */
+        bool drained() const noexcept { return _header->tail.load(std::memory_order_acquire) == _head; }
+
+        const Statistics &statistics() const noexcept { return _statistics; }
+    };
+
+    /**
+     * @brief Reads the patches of a patch stream in place, the single consumer
+     *
+     * Patches are decoded into vdom::Patch with the reader's own atoms, and
+     * their string values point into the ring: nothing is copied, and the
+     * ring space is released only once the sink has applied them.
+     */
+    class PatchReader
+    {
+    private:
+        format::RingHeader *_header;
+        const std::byte *_records;
+        std::uint64_t _mask;
+        std::uint64_t _tail;
+        vdom::AtomTable &_atoms;
+        std::vector<vdom::Atom> _remote_atoms;
+        vdom::PatchList _batch;
+
+        /**
+         * @brief Decode the record at the tail and move past it
+         *
+         * @return true If it closes a frame, whose generation is then set
+         */
+        bool decode(std::uint32_t &generation);
+
+    protected:
+    public:
+        /**
+         * @brief Attach to a stream laid out by a PatchWriter
+         *
+         * @param memory The memory of the stream
+         * @param atoms The table to intern tags and property names into
+         * @throw std::runtime_error If it is not a stream of this version and byte order, or is truncated
+         */
+        explicit PatchReader(std::span<std::byte> memory, vdom::AtomTable &atoms = vdom::AtomTable::global());
+
+        PatchReader(const PatchReader &) = delete;
+        PatchReader &operator=(const PatchReader &) = delete;
+
+        /**
+         * @brief Consume every published record, without waiting
+         *
+         * The sink's apply(const vdom::PatchList &) is called with the
+         * patches read, in order, and commit(std::uint32_t generation) after
+         * the last patch of each frame. A frame may span several apply()
+         * calls. The string values of the patches are valid until apply()
+         * returns.
+         *
+         * @param sink The consumer of the patches
+         * @return std::size_t The number of patches read
+         * @throw std::runtime_error If a record is malformed
+         */
+        template <typename Sink>
+        std::size_t read(Sink &sink)
+        {
+            const std::uint64_t head = _header->head.load(std::memory_order_acquire);
+            std::size_t patches = 0;
+            while (_tail != head)
+            {
+                std::uint32_t generation = 0;
+                if (decode(generation))
+                {
+                    patches += _batch.size();
+                    if (!_batch.empty())
+                        sink.apply(_batch);
+                    _batch.clear();
+                    sink.commit(generation);
+                }
+            }
+            if (!_batch.empty())
+            {
+                patches += _batch.size();
+                sink.apply(_batch);
+                _batch.clear();
+            }
+
+            // The ring space, and the strings the patches viewed in it, go back to the writer
+            _header->tail.store(_tail, std::memory_order_release);
+            return patches;
+        }
+
+        /**
+         * @brief Tell the writer to stop waiting for space, e.g. when the renderer exits
+         *
+         */
+        void close() noexcept { _header->closed.store(1, std::memory_order_release); }
+
+        /**
+         * @brief Check whether the writer closed the stream and every record was read
+         *
+         */
+        bool finished() const noexcept
+        {
+            return _header->closed.load(std::memory_order_acquire) && _tail == _header->head.load(std::memory_order_acquire);
+        }
+    };
+} // namespace stream
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <string>
+
+namespace stream
+{
+    /**
+     * @brief Named shared memory, mapped read-write
+     *
+     * The process creating it owns the name and removes it when the mapping
+     * is destroyed; other processes open it by name while it exists. Uses
+     * shm_open on POSIX systems and a named file mapping on Windows.
+     */
+    class SharedMemory
+    {
+    private:
+        std::byte *_data;
+        std::size_t _size;
+        std::string _name;
+        bool _owner;
+#ifdef _WIN32
+        void *_mapping;
+#endif
+
+        void unmap() noexcept;
+
+    protected:
+    public:
+        /**
+         * @brief Construct an empty mapping
+         *
+         */
+        SharedMemory() noexcept;
+
+        /**
+         * @brief Create and map shared memory, zero-filled
+         *
+         * @param name The name, e.g. "component-engine-patches"; a leading '/' is added on POSIX systems
+         * @param size The size in bytes
+         * @throw std::system_error If the name exists already or the memory cannot be mapped
+         */
+        SharedMemory(const std::string &name, std::size_t size);
+
+        /**
+         * @brief Map shared memory created by another process
+         *
+         * @param name The name it was created with
+         * @throw std::system_error If it does not exist or cannot be mapped
+         */
+        explicit SharedMemory(const std::string &name);
+
+        SharedMemory(const SharedMemory &) = delete;
+        SharedMemory &operator=(const SharedMemory &) = delete;
+        SharedMemory(SharedMemory &&other) noexcept;
+        SharedMemory &operator=(SharedMemory &&other) noexcept;
+        ~SharedMemory();
+
+        std::byte *data() const noexcept { return _data; }
+        std::size_t size() const noexcept { return _size; }
+        std::span<std::byte> bytes() const noexcept { return {_data, _size}; }
+        const std::string &name() const noexcept { return _name; }
+    };
+} // namespace stream
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+
+namespace trace
+{
+    /**
+     * @brief One completed span
+     *
+     * The name is a string literal; the detail, e.g. a component type name,
+     * is copied and truncated to fit.
+     */
+    struct Event
+    {
+        const char *name;
+        std::uint64_t start;    ///< Nanoseconds since the tracer started
+        std::uint64_t duration; ///< Nanoseconds
+        char detail[40];
+    };
+
+    class Buffer;
+
+    /**
+     * @brief Process-wide switch and sink of the render pipeline spans
+     *
+     * Every thread records into its own ring buffer of the last `capacity`
+     * events, written without locks or allocations once the buffer exists;
+     * the oldest events are overwritten when it is full. Buffers outlive
+     * their threads, so that a dump still shows the work of finished
+     * workers.
+     *
+     * Disabled, a span costs one relaxed atomic load.
+     */
+    class Tracer
+    {
+    private:
+        static std::atomic<bool> _enabled;
+
+    protected:
+    public:
+        static constexpr std::size_t capacity = 1 << 16;
+
+        /**
+         * @brief Start or stop recording spans
+         *
+         * @param enabled True to record
+         */
+        static void enable(bool enabled) noexcept { _enabled.store(enabled, std::memory_order_relaxed); }
+
+        static bool enabled() noexcept { return _enabled.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief Get the buffer of the calling thread, creating it on first use
+         *
+         * @return Buffer& The buffer
+         */
+        static Buffer &thread_buffer();
+
+        /**
+         * @brief Read the steady clock
+         *
+         * @return std::uint64_t Nanoseconds since the tracer started
+         */
+        static std::uint64_t now() noexcept;
+
+        /**
+         * @brief Record a completed span into the calling thread's buffer
+         *
+         * @param name A string literal naming the stage
+         * @param start Its start, from now()
+         * @param detail What the stage worked on, may be empty
+         */
+        static void record(const char *name, std::uint64_t start, std::string_view detail) noexcept;
+
+        /**
+         * @brief Write the recorded events as Chrome trace-event JSON
+         *
+         * The output loads in chrome://tracing and in Perfetto. Threads may
+         * keep recording meanwhile; events overwritten during the dump are
+         * left out.
+         *
+         * @param stream The destination
+         */
+        static void write_chrome_trace(std::ostream &stream);
+
+        /**
+         * @brief Drop the recorded events
+         *
+         */
+        static void clear();
+    };
+
+    /**
+     * @brief Scoped span recorded when tracing is enabled
+     *
+     * `trace::Span span("reconcile");` times the rest of the scope.
+     */
+    class Span
+    {
+    private:
+        const char *_name;
+        std::string_view _detail;
+        std::uint64_t _start;
+
+    protected:
+    public:
+        /**
+         * @brief Open a span
+         *
+         * @param name A string literal naming the stage
+         * @param detail What the stage works on; must stay valid until the span closes
+         */
+        explicit Span(const char *name, std::string_view detail = {}) noexcept
+            : _name(Tracer::enabled() ? name : nullptr), _detail(detail), _start(_name ? Tracer::now() : 0)
+        {
+        }
+
+        Span(const Span &) = delete;
+        Span &operator=(const Span &) = delete;
+
+        ~Span()
+        {
+            if (_name)
+                Tracer::record(_name, _start, _detail);
+        }
+    };
+} // namespace trace
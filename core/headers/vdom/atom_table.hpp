@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace vdom
+{
+    /**
+     * @brief Small integer id standing for an interned string (tag or property name)
+     *
+     */
+    using Atom = std::uint32_t;
+
+    /**
+     * @brief The atom of the empty string, used as "no atom"
+     *
+     */
+    constexpr Atom null_atom = 0;
+
+    /**
+     * @brief Thread-safe string interning table
+     *
+     * Atoms are dense, start at 1 and are never released, so they can index
+     * flat arrays. Interning the same string twice yields the same atom.
+     */
+    class AtomTable
+    {
+    private:
+        mutable std::shared_mutex _mutex;
+        std::deque<std::string> _names;
+        std::unordered_map<std::string_view, Atom> _atoms;
+
+    protected:
+    public:
+        /**
+         * @brief Construct an atom table holding only the null atom
+         *
+         */
+        AtomTable();
+
+        AtomTable(const AtomTable &) = delete;
+        AtomTable &operator=(const AtomTable &) = delete;
+
+        /**
+         * @brief Get the process-wide atom table
+         *
+         * @return AtomTable& The global table
+         */
+        static AtomTable &global();
+
+        /**
+         * @brief Intern a string
+         *
+         * @param name The string to intern
+         * @return Atom The atom of name, null_atom for the empty string
+         */
+        Atom intern(std::string_view name);
+
+        /**
+         * @brief Look up a string without interning it
+         *
+         * @param name The string to look up
+         * @return Atom The atom of name, or null_atom if it was never interned
+         */
+        Atom find(std::string_view name) const;
+
+        /**
+         * @brief Get the string an atom stands for
+         *
+         * @param atom An atom returned by this table
+         * @return std::string_view The interned string, valid for the lifetime of the table
+         */
+        std::string_view name(Atom atom) const;
+
+        /**
+         * @brief Get the number of atoms, including the null atom
+         *
+         * @return std::size_t The number of atoms
+         */
+        std::size_t size() const;
+    };
+} // namespace vdom
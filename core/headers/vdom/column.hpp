@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace vdom
+{
+    /**
+     * @brief Growable array of a Tree, which may also read memory it does not own
+     *
+     * A column either owns its elements, allocated from its memory resource,
+     * or views an array owned by someone else, e.g. a section of a mapped
+     * snapshot, see borrow(). Reads go through the same pointer in both
+     * cases. Changes are only allowed on an owned column: own() first copies
+     * the viewed elements, except for truncate() and clear(), which never
+     * copy.
+     */
+    template <typename T>
+    class Column
+    {
+    private:
+        std::pmr::vector<T> _owned;
+        const T *_data;
+        std::size_t _size;
+        bool _borrowed;
+
+        void sync() noexcept
+        {
+            _data = _owned.data();
+            _size = _owned.size();
+        }
+
+    protected:
+    public:
+        explicit Column(std::pmr::memory_resource *resource) : _owned(resource), _data(nullptr), _size(0), _borrowed(false) {}
+
+        Column(const Column &) = delete;
+        Column &operator=(const Column &) = delete;
+
+        Column(Column &&other) noexcept
+            : _owned(std::move(other._owned)), _data(other._data), _size(other._size), _borrowed(other._borrowed)
+        {
+            other._borrowed = false;
+            other.sync();
+        }
+
+        Column &operator=(Column &&other) noexcept
+        {
+            // Elements are copied rather than moved between different resources
+            _owned = std::move(other._owned);
+            _borrowed = other._borrowed;
+            if (_borrowed)
+            {
+                _data = other._data;
+                _size = other._size;
+            }
+            else
+                sync();
+            other._borrowed = false;
+            other.sync();
+            return *this;
+        }
+
+        /**
+         * @brief Drop the elements and view an array instead, which must outlive the view
+         *
+         */
+        void borrow(std::span<const T> elements) noexcept
+        {
+            _owned.clear();
+            _data = elements.data();
+            _size = elements.size();
+            _borrowed = true;
+        }
+
+        /**
+         * @brief Copy the viewed elements, if any, so that the column can be changed
+         *
+         */
+        void own()
+        {
+            if (!_borrowed)
+                return;
+            _owned.assign(_data, _data + _size);
+            _borrowed = false;
+            sync();
+        }
+
+        bool borrowed() const noexcept { return _borrowed; }
+
+        void push_back(const T &element)
+        {
+            _owned.push_back(element);
+            sync();
+        }
+
+        void append(std::span<const T> elements)
+        {
+            _owned.insert(_owned.end(), elements.begin(), elements.end());
+            sync();
+        }
+
+        void reserve(std::size_t size)
+        {
+            _owned.reserve(size);
+            sync();
+        }
+
+        /**
+         * @brief Drop the elements past size, owned or viewed
+         *
+         */
+        void truncate(std::size_t size) noexcept
+        {
+            if (size >= _size)
+                return;
+            if (_borrowed)
+                _size = size;
+            else
+            {
+                _owned.resize(size);
+                sync();
+            }
+        }
+
+        /**
+         * @brief Drop every element, keeping the owned storage
+         *
+         */
+        void clear() noexcept
+        {
+            _owned.clear();
+            _borrowed = false;
+            sync();
+        }
+
+        T &operator[](std::size_t index) noexcept { return _owned[index]; }
+        const T &operator[](std::size_t index) const noexcept { return _data[index]; }
+
+        std::pmr::memory_resource *resource() const noexcept { return _owned.get_allocator().resource(); }
+        std::size_t size() const noexcept { return _size; }
+        bool empty() const noexcept { return _size == 0; }
+        const T *data() const noexcept { return _data; }
+        std::span<const T> items() const noexcept { return {_data, _size}; }
+    };
+} // namespace vdom
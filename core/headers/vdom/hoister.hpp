@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "vdom/static_block.hpp"
+#include "vdom/tree.hpp"
+
+namespace vdom
+{
+    /**
+     * @brief Finds the subtrees a render keeps producing unchanged and marks them as static blocks
+     *
+     * Run on each new tree before it is diffed, a hoister fingerprints every
+     * subtree bottom-up, then walks the tree top-down: a subtree of at least
+     * `minimum_nodes` nodes whose fingerprint was seen in `frames` successive
+     * trees is frozen into a StaticBlock and marked, and its nodes are not
+     * walked further. Blocks are interned by fingerprint, so that equal
+     * subtrees of distinct component instances, and of later trees, share one
+     * block; the reconciler skips a subtree marked by the same block as its
+     * match in the old tree.
+     *
+     * Subtrees already marked, e.g. copied by the TreeBuilder from the block
+     * of a static component, are counted as hoisted and not fingerprinted
+     * again. Only subtrees laid out contiguously in pre-order are hoisted,
+     * which is how TreeBuilder lays trees out.
+     *
+     * Fingerprints and blocks not seen for a while are forgotten. A hoister
+     * is used by one thread at a time, one tree after the other.
+     */
+    class Hoister
+    {
+    public:
+        struct Statistics
+        {
+            std::size_t hoisted_nodes = 0;     ///< Nodes of the last tree inside marked subtrees
+            std::size_t hoisted_subtrees = 0;  ///< Marked subtrees of the last tree
+            std::uint64_t frozen_blocks = 0;   ///< Blocks frozen since construction
+        };
+
+    private:
+        struct Candidate
+        {
+            std::uint32_t frames;
+            std::uint64_t last_frame;
+            Ref<const StaticBlock> block;
+        };
+
+        std::size_t _minimum_nodes;
+        std::uint32_t _frames;
+        std::uint64_t _frame;
+        std::size_t _touched;
+        std::size_t _blocks;
+        std::unordered_map<std::uint64_t, Candidate> _candidates;
+        std::vector<std::uint64_t> _fingerprints;
+        std::vector<NodeId> _sizes;
+        std::vector<std::uint8_t> _contiguous;
+        std::vector<NodeId> _order;
+        std::vector<NodeId> _stack;
+        Statistics _statistics;
+
+        void fingerprint(const Tree &tree);
+        const StaticBlock *candidate(const Tree &tree, NodeId node);
+        void sweep();
+
+    protected:
+    public:
+        /**
+         * @brief Construct a new Hoister
+         *
+         * @param minimum_nodes The smallest subtree worth a block
+         * @param frames The number of successive trees a subtree must appear in, unchanged, before it is frozen
+         */
+        explicit Hoister(std::size_t minimum_nodes = 8, std::uint32_t frames = 3);
+
+        /**
+         * @brief Mark the static subtrees of a tree
+         *
+         * @param tree A tree about to be diffed, whose handles are not assigned yet
+         * @return std::size_t The number of nodes inside marked subtrees
+         */
+        std::size_t hoist(Tree &tree);
+
+        /**
+         * @brief Forget every fingerprint and block
+         *
+         */
+        void clear() noexcept;
+
+        /**
+         * @brief Get the number of blocks interned, frozen from earlier trees and still remembered
+         *
+         */
+        std::size_t blocks() const noexcept { return _blocks; }
+
+        const Statistics &statistics() const noexcept { return _statistics; }
+    };
+} // namespace vdom
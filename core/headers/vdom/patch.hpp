@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+#include "vdom/tree.hpp"
+
+namespace vdom
+{
+    enum class PatchType : std::uint8_t
+    {
+        Create,         ///< Create node (kind, name = tag, value = text) under parent, before sibling
+        Remove,         ///< Remove node and its whole subtree
+        Move,           ///< Move node under parent, before sibling
+        SetProperty,    ///< Set property name of node to value
+        RemoveProperty, ///< Remove property name from node
+        SetText         ///< Replace the content of text node with value
+    };
+
+    /**
+     * @brief One operation turning the mounted tree into the next tree
+     *
+     * Nodes are designated by their Handle. A null `before` means "append".
+     * String values point into the storage of the tree the patch was computed
+     * for, so a patch list must be consumed before that tree is cleared.
+     */
+    struct Patch
+    {
+        PatchType type;
+        NodeKind kind;
+        Atom name;
+        Handle node;
+        Handle parent;
+        Handle before;
+        Value value;
+    };
+
+    /**
+     * @brief Flat, ordered list of patches, applied front to back
+     *
+     * Allocator-aware so that a frame's patches can live in a memory::Arena.
+     */
+    using PatchList = std::pmr::vector<Patch>;
+} // namespace vdom
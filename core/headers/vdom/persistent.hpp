@@ -0,0 +1,265 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "vdom/shared.hpp"
+#include "vdom/value.hpp"
+
+namespace vdom
+{
+    /**
+     * @brief A Value owning what it points to: the characters of a string, a reference to a map or vector
+     *
+     * Copying an item shares its string rather than copying it, so that
+     * copying a node of a persistent structure costs a reference count per
+     * element.
+     */
+    class Item
+    {
+    private:
+        Value _value;
+        Ref<const Shared> _owner;
+
+    protected:
+    public:
+        Item() = default;
+
+        /**
+         * @brief Take ownership of a value
+         *
+         * @param value Any value, strings are copied and maps and vectors retained
+         */
+        explicit Item(Value value);
+
+        const Value &value() const noexcept { return _value; }
+    };
+
+    /**
+     * @brief Immutable map of values, updated by making new versions sharing unchanged structure
+     *
+     * A hash array mapped trie in the CHAMP layout: each node keeps its entries
+     * and its children in two arrays indexed by two 32-bit bitmaps over five
+     * bits of the key hash. Lookups and updates cost O(log32 n), and an update
+     * copies only the nodes on the path to its key, so a new version of a map
+     * of a million entries allocates four or five small nodes.
+     *
+     * Updates leaving a map unchanged (setting a key to its current value,
+     * removing a missing key) return the map itself, so that identity keeps
+     * telling versions apart: as a property value, an unchanged map compares
+     * equal in O(1) and memoized components receiving it skip their render.
+     *
+     * Keys are None, bool, int, float or str and compare by type and value,
+     * so 1 and 1.0 are different keys. Values may be maps and vectors.
+     */
+    class PersistentMap final : public Shared
+    {
+    public:
+        struct Node;
+
+    private:
+        Ref<const Node> _root;
+        std::size_t _size;
+
+        PersistentMap(Ref<const Node> root, std::size_t size) noexcept;
+
+        template <typename Function>
+        static void visit(const Node &node, Function &function);
+
+    protected:
+    public:
+        ~PersistentMap() override;
+
+        /**
+         * @brief Get the empty map, shared by every empty version
+         *
+         */
+        static Ref<const PersistentMap> empty();
+
+        std::size_t size() const noexcept { return _size; }
+        bool is_empty() const noexcept { return _size == 0; }
+
+        /**
+         * @brief Look a key up
+         *
+         * @param key The key
+         * @return const Value* The value, or nullptr when the key is missing
+         */
+        const Value *find(Value key) const noexcept;
+
+        /**
+         * @brief Make a version mapping key to value
+         *
+         * @param key The key, None, bool, int, float or str
+         * @param value The value, copied into the new version
+         * @return Ref<const PersistentMap> The new version, or this map when key already maps to value
+         */
+        Ref<const PersistentMap> set(Value key, Value value) const;
+
+        /**
+         * @brief Make a version without a key
+         *
+         * @param key The key
+         * @return Ref<const PersistentMap> The new version, or this map when key is missing
+         */
+        Ref<const PersistentMap> erase(Value key) const;
+
+        /**
+         * @brief Call function(key, value) for every entry, in hash order
+         *
+         */
+        template <typename Function>
+        void for_each(Function &&function) const
+        {
+            if (_root)
+                visit(*_root, function);
+        }
+
+        /**
+         * @brief Compare contents, nested maps and vectors included
+         *
+         */
+        bool equals(const PersistentMap &other) const;
+    };
+
+    /**
+     * @brief Immutable vector of values, updated by making new versions sharing unchanged structure
+     *
+     * A radix balanced tree of 32-way nodes with the last leaf kept apart as
+     * a tail: indexing costs O(log32 n), appending copies the tail until it
+     * fills and then one path of the tree. As with PersistentMap, updates
+     * leaving the vector unchanged return the vector itself.
+     */
+    class PersistentVector final : public Shared
+    {
+    public:
+        struct Node;
+
+    private:
+        Ref<const Node> _root;
+        Ref<const Node> _tail;
+        std::size_t _size;
+        unsigned _shift; ///< Bits of the index consumed above the leaves
+
+        PersistentVector(Ref<const Node> root, Ref<const Node> tail, std::size_t size, unsigned shift) noexcept;
+
+        std::size_t tail_offset() const noexcept;
+        const Node &leaf(std::size_t index) const noexcept;
+
+    protected:
+    public:
+        ~PersistentVector() override;
+
+        /**
+         * @brief Get the empty vector, shared by every empty version
+         *
+         */
+        static Ref<const PersistentVector> empty();
+
+        std::size_t size() const noexcept { return _size; }
+        bool is_empty() const noexcept { return _size == 0; }
+
+        /**
+         * @brief Get an element
+         *
+         * @param index The index, less than size()
+         */
+        const Value &operator[](std::size_t index) const noexcept;
+
+        /**
+         * @brief Make a version with one more element at the end
+         *
+         */
+        Ref<const PersistentVector> push_back(Value value) const;
+
+        /**
+         * @brief Make a version replacing an element
+         *
+         * @param index The index, less than size()
+         * @param value The new element
+         * @return Ref<const PersistentVector> The new version, or this vector when the element is already value
+         */
+        Ref<const PersistentVector> set(std::size_t index, Value value) const;
+
+        /**
+         * @brief Make a version without the last element
+         *
+         * @return Ref<const PersistentVector> The new version; throws std::out_of_range when empty
+         */
+        Ref<const PersistentVector> pop_back() const;
+
+        /**
+         * @brief Call function(value) for every element, in order
+         *
+         */
+        template <typename Function>
+        void for_each(Function &&function) const;
+
+        /**
+         * @brief Compare contents, nested maps and vectors included, skipping the leaves both share
+         *
+         */
+        bool equals(const PersistentVector &other) const;
+    };
+
+    struct PersistentMap::Node final : Shared
+    {
+        struct Entry
+        {
+            std::size_t hash;
+            Item key;
+            Item value;
+        };
+
+        std::uint32_t datamap = 0; ///< Slots holding an entry
+        std::uint32_t nodemap = 0; ///< Slots holding a child; both are empty in collision nodes
+        std::vector<Entry> entries;
+        std::vector<Ref<const Node>> children;
+    };
+
+    struct PersistentVector::Node final : Shared
+    {
+        std::vector<Ref<const Node>> children; ///< Of inner nodes
+        std::vector<Item> items;               ///< Of leaves
+    };
+
+    template <typename Function>
+    void PersistentMap::visit(const Node &node, Function &function)
+    {
+        for (const Node::Entry &entry : node.entries)
+            function(entry.key.value(), entry.value.value());
+        for (const Ref<const Node> &child : node.children)
+            visit(*child, function);
+    }
+
+    template <typename Function>
+    void PersistentVector::for_each(Function &&function) const
+    {
+        for (std::size_t index = 0; index < _size; index += 32)
+        {
+            for (const Item &item : leaf(index).items)
+                function(item.value());
+        }
+    }
+
+    /**
+     * @brief Compare two values, nested maps and vectors by contents rather than identity
+     *
+     */
+    bool equivalent(const Value &value, const Value &other);
+
+    /**
+     * @brief Get the map or vector a value holds, for containers retaining it
+     *
+     * @return const Shared* The map or vector, or nullptr for other values
+     */
+    inline const Shared *shared_of(const Value &value) noexcept
+    {
+        if (value.type() == Value::Type::Map)
+            return value.as_map();
+        if (value.type() == Value::Type::Vector)
+            return value.as_vector();
+        return nullptr;
+    }
+} // namespace vdom
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+#include "vdom/atom_table.hpp"
+#include "vdom/small_vector.hpp"
+#include "vdom/value.hpp"
+
+namespace vdom
+{
+    /**
+     * @brief Property set of a component, keyed by interned names
+     *
+     * Properties are kept sorted by key atom in a small inline vector of
+     * unboxed values, so looking one up is a binary search over integers and
+     * comparing two sets is a single pass over both arrays. String values are
+     * owned by the set, persistent maps and vectors retained by it.
+     *
+     * The structural hash is cached until the next mutation, so that memoized
+     * components compare their properties in constant time between updates.
+     */
+    class Properties
+    {
+    private:
+        static constexpr std::size_t inline_capacity = 8;
+
+        SmallVector<Property, inline_capacity> _properties;
+        mutable std::uint64_t _hash = 0;
+        mutable bool _hashed = false;
+
+        std::size_t lower_bound(Atom key) const noexcept;
+        static Value copy(Value value);
+        static void release(Value value) noexcept;
+
+    protected:
+    public:
+        Properties() = default;
+        Properties(const Properties &other);
+        Properties(Properties &&other) noexcept;
+        Properties &operator=(const Properties &other);
+        Properties &operator=(Properties &&other) noexcept;
+        ~Properties();
+
+        /**
+         * @brief Set a property, replacing its previous value
+         *
+         * @param key The interned property name
+         * @param value The value, strings are copied and maps and vectors retained
+         */
+        void set(Atom key, Value value);
+
+        /**
+         * @brief Get a property
+         *
+         * @param key The interned property name
+         * @return const Value* The value, or nullptr when the property is not set
+         */
+        const Value *get(Atom key) const noexcept;
+
+        /**
+         * @brief Remove a property if it is set
+         *
+         * @param key The interned property name
+         * @return true If the property was set
+         */
+        bool remove(Atom key) noexcept;
+
+        /**
+         * @brief Remove every property
+         *
+         */
+        void clear() noexcept;
+
+        std::size_t size() const noexcept { return _properties.size(); }
+        bool empty() const noexcept { return _properties.empty(); }
+
+        /**
+         * @brief Get the properties sorted by key atom, in the layout vdom::Tree expects
+         *
+         * @return std::span<const Property> The properties
+         */
+        std::span<const Property> items() const noexcept { return {_properties.data(), _properties.size()}; }
+
+        /**
+         * @brief Get the structural hash of the set, computed over key atoms and unboxed values
+         *
+         * Equal sets have equal hashes; the hash is computed once per mutation.
+         *
+         * @return std::uint64_t The hash
+         */
+        std::uint64_t hash() const noexcept;
+
+        /**
+         * @brief Compare two sets key by key and value by value
+         *
+         */
+        bool operator==(const Properties &other) const noexcept;
+        bool operator!=(const Properties &other) const noexcept { return !(*this == other); }
+    };
+} // namespace vdom
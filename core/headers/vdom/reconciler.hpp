@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+#include "vdom/patch.hpp"
+#include "vdom/tree.hpp"
+
+namespace vdom
+{
+    /**
+     * @brief Computes the patches turning one tree into the next
+     *
+     * Children are matched by key; unkeyed children are matched by their rank
+     * among the unkeyed siblings. Common prefixes and suffixes are matched
+     * first, then the remaining children are looked up in a hash map and the
+     * longest increasing subsequence of their old positions is kept in place,
+     * so that only the other matched children are moved. Nodes whose kind or
+     * tag changed are replaced. Matched subtrees marked by the same StaticBlock
+     * in both trees are not walked at all, nor are subtrees Tree::copy_nodes()
+     * copied from the old tree, matched with the nodes they were copied from.
+     *
+     * A Reconciler keeps its scratch buffers between calls; reuse one instance
+     * across frames to avoid reallocating them, or construct one per frame on
+     * that frame's memory::Arena.
+     *
+     * The diff of a matched pair only touches the pair's subtrees, so a
+     * Deferral may take pairs out of the walk and have them diffed later, e.g.
+     * by other threads, with diff_subtree().
+     */
+    class Reconciler
+    {
+    public:
+        /**
+         * @brief Decides which matched subtrees a diff leaves to the caller
+         *
+         */
+        class Deferral
+        {
+        public:
+            virtual ~Deferral() = default;
+
+            /**
+             * @brief Offer a matched pair, whose handle is assigned, before it is diffed
+             *
+             * @param old_node The old node
+             * @param new_node The new node
+             * @param offset The index in the patch list where the patches of the pair belong
+             * @return true To skip the pair, which the caller must then diff with diff_subtree()
+             */
+            virtual bool defer(NodeId old_node, NodeId new_node, std::size_t offset) = 0;
+        };
+
+    private:
+        struct MatchKey
+        {
+            Value key;
+            std::uint32_t rank;
+
+            bool operator==(const MatchKey &other) const noexcept { return rank == other.rank && key == other.key; }
+        };
+
+        struct MatchKeyHash
+        {
+            std::size_t operator()(const MatchKey &match_key) const noexcept
+            {
+                // Finish with a 64-bit mixer: integer keys hash to themselves and the table masks low bits
+                std::uint64_t hash = match_key.key.hash() ^ (static_cast<std::uint64_t>(match_key.rank) << 32);
+                hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ull;
+                hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBull;
+                return static_cast<std::size_t>(hash ^ (hash >> 31));
+            }
+        };
+
+        struct Pair
+        {
+            NodeId old_node;
+            NodeId new_node;
+        };
+
+        const Tree *_old;
+        Tree *_next;
+        PatchList *_patches;
+        Deferral *_deferral;
+        bool _copies; ///< Whether next holds nodes copied from old, see Tree::origin()
+        std::pmr::vector<NodeId> _old_children;
+        std::pmr::vector<NodeId> _new_children;
+        std::pmr::vector<MatchKey> _match_keys;
+        std::pmr::vector<Pair> _pairs;
+        std::pmr::vector<std::int64_t> _sources;
+        std::pmr::vector<std::uint32_t> _lis_tails;
+        std::pmr::vector<std::uint32_t> _lis_previous;
+        std::pmr::vector<std::uint8_t> _stable;
+        std::pmr::vector<std::uint32_t> _new_indices;
+
+        bool same_type(NodeId old_node, NodeId new_node) const noexcept;
+        bool copied(NodeId old_node, NodeId new_node) const noexcept;
+        void pair(NodeId old_node, NodeId new_node);
+        void diff_node(NodeId old_node, NodeId new_node);
+        void diff_properties(NodeId old_node, NodeId new_node);
+        void diff_children(NodeId old_parent, NodeId new_parent);
+        void index_new_keys(std::size_t keys_base, std::size_t begin, std::size_t end);
+        std::uint32_t find_new_key(const MatchKey &key, std::size_t keys_base) const noexcept;
+        void match_keys(const std::pmr::vector<NodeId> &children, std::size_t begin, std::size_t end, const Tree &tree);
+        void mark_longest_increasing_subsequence(std::size_t count);
+        void create(NodeId node, Handle parent, Handle before);
+        void remove(NodeId old_node);
+        void move(NodeId new_node, Handle parent, Handle before);
+
+    protected:
+    public:
+        /**
+         * @brief Construct a new Reconciler
+         *
+         * @param scratch The resource scratch buffers are allocated from, which must outlive the reconciler
+         */
+        explicit Reconciler(std::pmr::memory_resource *scratch = std::pmr::get_default_resource());
+
+        /**
+         * @brief Diff two trees and append the patches to a list
+         *
+         * Assigns the handles of every node of next: matched nodes inherit the
+         * handle of their old counterpart, created nodes get fresh handles.
+         * The handles of next are then its own: a later diff walks nodes it
+         * copied from old like any other.
+         *
+         * @param old The mounted tree, whose handles are already assigned; may be empty
+         * @param next The tree to mount
+         * @param patches The list receiving the patches
+         * @param deferral Chooses the matched pairs to skip, nullptr to diff everything
+         */
+        void diff(const Tree &old, Tree &next, PatchList &patches, Deferral *deferral = nullptr);
+
+        /**
+         * @brief Diff a matched pair skipped by a Deferral and append the patches of its subtrees
+         *
+         * Distinct pairs of the same diff may be diffed concurrently by distinct reconcilers.
+         *
+         * @param old The old tree of the diff
+         * @param next The new tree of the diff
+         * @param old_node The old node of the pair
+         * @param new_node The new node of the pair
+         * @param patches The list receiving the patches
+         */
+        void diff_subtree(const Tree &old, Tree &next, NodeId old_node, NodeId new_node, PatchList &patches);
+    };
+} // namespace vdom
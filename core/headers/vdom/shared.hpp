@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+namespace vdom
+{
+    /**
+     * @brief Base of immutable objects shared between owners by reference counting
+     *
+     * The count is atomic, so that trees diffed on worker threads and renders
+     * in subinterpreters may hold the same objects. Objects start with no
+     * reference and are deleted when the last Ref to them goes away.
+     */
+    class Shared
+    {
+    private:
+        mutable std::atomic<std::uint32_t> _references{0};
+
+    protected:
+        Shared() = default;
+        Shared(const Shared &) noexcept {} ///< A copy starts with no reference
+        virtual ~Shared() = default;
+
+    public:
+        Shared &operator=(const Shared &) = delete;
+
+        void retain() const noexcept { _references.fetch_add(1, std::memory_order_relaxed); }
+
+        void release() const noexcept
+        {
+            if (_references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                delete this;
+        }
+
+        std::uint32_t references() const noexcept { return _references.load(std::memory_order_relaxed); }
+    };
+
+    /**
+     * @brief Owning pointer to a Shared object
+     *
+     */
+    template <typename T>
+    class Ref
+    {
+    private:
+        T *_pointer = nullptr;
+
+        template <typename U>
+        friend class Ref;
+
+    protected:
+    public:
+        Ref() = default;
+
+        explicit Ref(T *pointer) noexcept : _pointer(pointer)
+        {
+            if (_pointer)
+                _pointer->retain();
+        }
+
+        Ref(const Ref &other) noexcept : Ref(other._pointer) {}
+        Ref(Ref &&other) noexcept : _pointer(std::exchange(other._pointer, nullptr)) {}
+
+        template <typename U>
+        Ref(Ref<U> other) noexcept : _pointer(std::exchange(other._pointer, nullptr))
+        {
+        }
+
+        Ref &operator=(Ref other) noexcept
+        {
+            std::swap(_pointer, other._pointer);
+            return *this;
+        }
+
+        ~Ref()
+        {
+            if (_pointer)
+                _pointer->release();
+        }
+
+        T *get() const noexcept { return _pointer; }
+        T *operator->() const noexcept { return _pointer; }
+        T &operator*() const noexcept { return *_pointer; }
+        explicit operator bool() const noexcept { return _pointer != nullptr; }
+    };
+
+    /**
+     * @brief Allocate a Shared object and take the first reference to it
+     *
+     */
+    template <typename T, typename... Arguments>
+    Ref<T> make_ref(Arguments &&...arguments)
+    {
+        return Ref<T>(new T(std::forward<Arguments>(arguments)...));
+    }
+} // namespace vdom
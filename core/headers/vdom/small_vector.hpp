@@ -0,0 +1,140 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace vdom
+{
+    /**
+     * @brief Vector of trivially copyable elements storing the first N inline
+     *
+     * Elements are moved with memcpy; the heap is only touched once more than
+     * N elements are stored.
+     */
+    template <typename T, std::size_t N>
+    class SmallVector
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "SmallVector only holds trivially copyable types");
+
+    private:
+        T *_data;
+        std::size_t _size;
+        std::size_t _capacity;
+        alignas(T) unsigned char _inline[N * sizeof(T)];
+
+        bool is_inline() const noexcept { return _data == reinterpret_cast<const T *>(_inline); }
+
+        void grow(std::size_t capacity)
+        {
+            T *data = static_cast<T *>(::operator new(capacity * sizeof(T)));
+            if (_size)
+                std::memcpy(data, _data, _size * sizeof(T));
+            if (!is_inline())
+                ::operator delete(_data);
+            _data = data;
+            _capacity = capacity;
+        }
+
+    protected:
+    public:
+        SmallVector() noexcept : _data(reinterpret_cast<T *>(_inline)), _size(0), _capacity(N) {}
+
+        SmallVector(const SmallVector &other) : SmallVector()
+        {
+            *this = other;
+        }
+
+        SmallVector(SmallVector &&other) noexcept : SmallVector()
+        {
+            *this = std::move(other);
+        }
+
+        SmallVector &operator=(const SmallVector &other)
+        {
+            if (this == &other)
+                return *this;
+            _size = 0;
+            if (other._size > _capacity)
+                grow(other._size);
+            if (other._size)
+                std::memcpy(_data, other._data, other._size * sizeof(T));
+            _size = other._size;
+            return *this;
+        }
+
+        SmallVector &operator=(SmallVector &&other) noexcept
+        {
+            if (this == &other)
+                return *this;
+            if (!other.is_inline())
+            {
+                if (!is_inline())
+                    ::operator delete(_data);
+                _data = other._data;
+                _capacity = other._capacity;
+                other._data = reinterpret_cast<T *>(other._inline);
+                other._capacity = N;
+            }
+            else
+            {
+                // other's elements fit in any buffer of ours
+                if (other._size)
+                    std::memcpy(_data, other._data, other._size * sizeof(T));
+            }
+            _size = other._size;
+            other._size = 0;
+            return *this;
+        }
+
+        ~SmallVector()
+        {
+            if (!is_inline())
+                ::operator delete(_data);
+        }
+
+        std::size_t size() const noexcept { return _size; }
+        bool empty() const noexcept { return _size == 0; }
+        T *data() noexcept { return _data; }
+        const T *data() const noexcept { return _data; }
+        T *begin() noexcept { return _data; }
+        T *end() noexcept { return _data + _size; }
+        const T *begin() const noexcept { return _data; }
+        const T *end() const noexcept { return _data + _size; }
+        T &operator[](std::size_t index) noexcept { return _data[index]; }
+        const T &operator[](std::size_t index) const noexcept { return _data[index]; }
+
+        /**
+         * @brief Insert an element before position index
+         *
+         * @param index The position, at most size()
+         * @param value The element
+         */
+        void insert(std::size_t index, const T &value)
+        {
+            T copy = value;
+            if (_size == _capacity)
+                grow(_capacity * 2);
+            std::memmove(_data + index + 1, _data + index, (_size - index) * sizeof(T));
+            _data[index] = copy;
+            _size++;
+        }
+
+        void push_back(const T &value) { insert(_size, value); }
+
+        /**
+         * @brief Remove the element at position index
+         *
+         * @param index The position, less than size()
+         */
+        void erase(std::size_t index) noexcept
+        {
+            std::memmove(_data + index, _data + index + 1, (_size - index - 1) * sizeof(T));
+            _size--;
+        }
+
+        void clear() noexcept { _size = 0; }
+    };
+} // namespace vdom
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+
+#include "vdom/shared.hpp"
+#include "vdom/tree.hpp"
+
+namespace vdom
+{
+    /**
+     * @brief Immutable copy of a subtree whose render output never changes, shared by every tree showing it
+     *
+     * A block owns its nodes, in pre-order from node 0, with their strings,
+     * maps and vectors. Trees copy a block with Tree::copy_block() and mark
+     * the copy, or mark an equal subtree they built with Tree::mark_block();
+     * the reconciler then skips a marked subtree matched with one marked by
+     * the same block, only carrying the handles over.
+     *
+     * Blocks are identified by the fingerprint of their subtree, a 64-bit
+     * hash over every node's kind, tag, key, text and properties and over the
+     * shape of the subtree; equal fingerprints are trusted to mean equal
+     * subtrees.
+     */
+    class StaticBlock final : public Shared
+    {
+    private:
+        Tree _tree;
+        std::uint64_t _fingerprint;
+
+        StaticBlock();
+
+    protected:
+    public:
+        /**
+         * @brief Copy a subtree into a new block
+         *
+         * @param tree The tree holding the subtree
+         * @param root The root of the subtree
+         * @return Ref<const StaticBlock> The block, whose storage does not depend on tree
+         */
+        static Ref<const StaticBlock> freeze(const Tree &tree, NodeId root);
+
+        /**
+         * @brief Hash the contents of one node, regardless of its children
+         *
+         */
+        static std::uint64_t hash_node(const Tree &tree, NodeId node) noexcept;
+
+        /**
+         * @brief Fold the fingerprint of the next child into the fingerprint of its parent
+         *
+         * The fingerprint of a subtree is hash_node() of its root folded with
+         * the fingerprints of its children, in order.
+         */
+        static std::uint64_t hash_child(std::uint64_t parent, std::uint64_t child) noexcept;
+
+        const Tree &tree() const noexcept { return _tree; }
+        std::size_t size() const noexcept { return _tree.size(); }
+        std::uint64_t fingerprint() const noexcept { return _fingerprint; }
+    };
+} // namespace vdom
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+
+namespace vdom
+{
+    /**
+     * @brief Append-only character storage with stable addresses
+     *
+     * Strings are copied into large blocks so that a tree holding thousands of
+     * string values performs a handful of allocations. Views returned by store()
+     * stay valid until clear() or destruction.
+     */
+    class StringPool
+    {
+    public:
+        /**
+         * @brief Position in the pool to rewind() to
+         *
+         */
+        struct Mark
+        {
+            std::size_t blocks_in_use;
+            std::size_t used;
+            std::size_t large_blocks;
+        };
+
+    private:
+        static constexpr std::size_t block_size = 16 * 1024;
+
+        struct Block
+        {
+            char *data;
+            std::size_t size;
+        };
+
+        std::pmr::memory_resource *_resource;
+        std::pmr::vector<Block> _blocks;
+        std::pmr::vector<Block> _large_blocks;
+        std::size_t _blocks_in_use;
+        std::size_t _used;
+
+        void release(std::pmr::vector<Block> &blocks) noexcept;
+
+    protected:
+    public:
+        /**
+         * @brief Construct an empty StringPool
+         *
+         * @param resource The resource blocks are allocated from
+         */
+        explicit StringPool(std::pmr::memory_resource *resource = std::pmr::get_default_resource()) noexcept
+            : _resource(resource), _blocks(resource), _large_blocks(resource), _blocks_in_use(0), _used(0) {}
+
+        StringPool(const StringPool &) = delete;
+        StringPool &operator=(const StringPool &) = delete;
+        StringPool(StringPool &&other) noexcept;
+        StringPool &operator=(StringPool &&other) noexcept;
+        ~StringPool();
+
+        /**
+         * @brief Copy a string into the pool
+         *
+         * @param text The characters to copy
+         * @return std::string_view A view of the copy
+         */
+        std::string_view store(std::string_view text);
+
+        /**
+         * @brief Get the current position, to later forget the strings stored after it
+         *
+         */
+        Mark mark() const noexcept { return {_blocks_in_use, _used, _large_blocks.size()}; }
+
+        /**
+         * @brief Forget the strings stored since a mark, keeping the regular blocks for reuse
+         *
+         * @param mark A mark taken since the last clear()
+         */
+        void rewind(const Mark &mark) noexcept;
+
+        /**
+         * @brief Forget every stored string, keeping the regular blocks for reuse
+         *
+         */
+        void clear() noexcept;
+    };
+} // namespace vdom
@@ -0,0 +1,441 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "vdom/atom_table.hpp"
+#include "vdom/column.hpp"
+#include "vdom/shared.hpp"
+#include "vdom/string_pool.hpp"
+#include "vdom/value.hpp"
+
+namespace vdom
+{
+    /**
+     * @brief Index of a node inside a Tree
+     *
+     */
+    using NodeId = std::uint32_t;
+
+    /**
+     * @brief The NodeId meaning "no node"
+     *
+     */
+    constexpr NodeId null_node = std::numeric_limits<NodeId>::max();
+
+    /**
+     * @brief Identity of a node across successive trees
+     *
+     * Handles are what renderer backends key their native objects by: a node
+     * matched by the reconciler keeps the handle of its predecessor, a created
+     * node gets a fresh handle built from the tree generation and its NodeId.
+     */
+    using Handle = std::uint64_t;
+
+    /**
+     * @brief The Handle meaning "no node"
+     *
+     */
+    constexpr Handle null_handle = 0;
+
+    class StaticBlock;
+
+    enum class NodeKind : std::uint8_t
+    {
+        Element,
+        Text
+    };
+
+    /**
+     * @brief Location of a node's properties in the tree's property array
+     *
+     */
+    struct PropertySlice
+    {
+        std::uint32_t offset;
+        std::uint32_t count;
+    };
+
+    /**
+     * @brief Virtual DOM tree stored as a struct of arrays
+     *
+     * Every node attribute lives in its own contiguous column indexed by NodeId,
+     * and the properties of all nodes share a single array, each node owning a
+     * sorted slice of it. Walking the tree touches only the columns that are
+     * read, with no per-node allocation and no pointer chasing.
+     *
+     * Strings (keys, text, property values) are copied into the tree's own
+     * storage when nodes are created, so callers may pass temporaries, and
+     * persistent maps and vectors are retained until the nodes are dropped.
+     * Subtrees may also be copied from, or marked as equal to, a StaticBlock,
+     * which the tree then retains, or copied from another tree along with
+     * their handles, see copy_nodes().
+     *
+     * A tree may also read its nodes in place from columns owned by another
+     * object, e.g. a mapped snapshot, see view(); it copies them into its own
+     * storage before its first change.
+     *
+     * All storage comes from the memory resource given at construction, e.g. a
+     * per-frame memory::Arena; the tree must be destroyed before that resource
+     * releases its memory.
+     */
+    class Tree
+    {
+    public:
+        /**
+         * @brief Size of the tree to roll back to
+         *
+         */
+        struct Checkpoint
+        {
+            NodeId nodes;
+            std::uint32_t properties;
+            StringPool::Mark strings;
+            std::uint32_t shared;
+            std::uint32_t blocks;
+        };
+
+    private:
+        struct BlockMark
+        {
+            NodeId root;
+            const StaticBlock *block;
+        };
+
+        Column<NodeKind> _kinds;
+        Column<Atom> _tags;
+        Column<Value> _keys;
+        Column<Value> _texts;
+        Column<NodeId> _parents;
+        Column<NodeId> _first_children;
+        Column<NodeId> _last_children;
+        Column<NodeId> _next_siblings;
+        Column<PropertySlice> _property_slices;
+        Column<Handle> _handles;
+        Column<Property> _properties;
+        StringPool _strings;
+        std::pmr::vector<Ref<const Shared>> _shared;
+        std::pmr::vector<BlockMark> _blocks; ///< Sorted by root
+        NodeId _root;
+        std::uint32_t _generation;
+        std::uint64_t _serial;
+        std::uint64_t _origin;
+
+        NodeId push_node(NodeKind kind, Atom tag, Value key, Value text);
+        void own_columns();
+
+        void own()
+        {
+            if (_kinds.borrowed())
+                own_columns();
+        }
+
+    protected:
+    public:
+        /**
+         * @brief Node columns owned by another object, for view()
+         *
+         */
+        struct Columns
+        {
+            std::span<const NodeKind> kinds;
+            std::span<const Atom> tags;
+            std::span<const Value> keys;
+            std::span<const Value> texts; ///< String values of text nodes
+            std::span<const NodeId> parents;
+            std::span<const NodeId> first_children;
+            std::span<const NodeId> last_children;
+            std::span<const NodeId> next_siblings;
+            std::span<const PropertySlice> property_slices;
+            std::span<const Handle> handles;
+            std::span<const Property> properties; ///< Each slice sorted by key atom, without duplicates
+        };
+
+        /**
+         * @brief Iterable view over the children of a node
+         *
+         */
+        class Children
+        {
+        private:
+            const Tree *_tree;
+            NodeId _first;
+
+        public:
+            class iterator
+            {
+            private:
+                const Tree *_tree;
+                NodeId _node;
+
+            public:
+                iterator(const Tree *tree, NodeId node) noexcept : _tree(tree), _node(node) {}
+
+                NodeId operator*() const noexcept { return _node; }
+                iterator &operator++() noexcept
+                {
+                    _node = _tree->next_sibling(_node);
+                    return *this;
+                }
+                bool operator==(const iterator &other) const noexcept { return _node == other._node; }
+                bool operator!=(const iterator &other) const noexcept { return _node != other._node; }
+            };
+
+            Children(const Tree *tree, NodeId first) noexcept : _tree(tree), _first(first) {}
+
+            iterator begin() const noexcept { return {_tree, _first}; }
+            iterator end() const noexcept { return {_tree, null_node}; }
+        };
+
+        /**
+         * @brief Construct an empty Tree
+         *
+         * @param resource The resource every column and string is allocated from
+         */
+        explicit Tree(std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+
+        Tree(const Tree &) = delete;
+        Tree &operator=(const Tree &) = delete;
+        Tree(Tree &&) noexcept = default;
+        Tree &operator=(Tree &&) noexcept = default;
+
+        /**
+         * @brief Create a detached element node
+         *
+         * @param tag The interned tag name
+         * @param key The reconciliation key, None when the node is unkeyed
+         * @param properties The properties of the node, in any order; the last of duplicated keys wins
+         * @return NodeId The new node
+         */
+        NodeId create_element(Atom tag, Value key = {}, std::span<const Property> properties = {});
+
+        /**
+         * @brief Create a detached text node
+         *
+         * @param text The text content
+         * @return NodeId The new node
+         */
+        NodeId create_text(std::string_view text);
+
+        /**
+         * @brief Append a detached node as the last child of another node
+         *
+         * @param parent The new parent
+         * @param child A node without parent
+         */
+        void append_child(NodeId parent, NodeId child);
+
+        /**
+         * @brief Append a detached copy of a static block, marked by it
+         *
+         * The copy shares the strings of the block rather than storing them again.
+         *
+         * @param block The block, retained by the tree
+         * @return NodeId The root of the copy; the block's nodes follow it in pre-order
+         */
+        NodeId copy_block(const StaticBlock &block);
+
+        /**
+         * @brief Append a detached copy of whole subtrees of another tree, keeping their handles
+         *
+         * The nodes are copied with their strings, maps and vectors, and with
+         * the static blocks marking them. Copied nodes keep the handles they
+         * have in `source`, so that diffed against the origin() tree, a
+         * copied node matched with the node holding its handle is known to
+         * be equal to it, subtree included, and skipped by the reconciler.
+         *
+         * @param source Another tree
+         * @param first The first node to copy
+         * @param count The number of nodes, the subtrees of a run of siblings laid out contiguously in pre-order, as TreeBuilder lays out the output of a component
+         * @return NodeId The copy of first; the copies of the siblings follow their subtrees and are detached
+         */
+        NodeId copy_nodes(const Tree &source, NodeId first, NodeId count);
+
+        /**
+         * @brief Append a detached copy of a single node of another tree, without its children
+         *
+         * The copy has no handle nor static block, so that the reconciler
+         * diffs it and its new children like any built node.
+         *
+         * @param source Another tree
+         * @param node The node to copy
+         * @return NodeId The copy
+         */
+        NodeId copy_node(const Tree &source, NodeId node);
+
+        /**
+         * @brief Clear the tree and read its nodes in place from columns owned by another object
+         *
+         * Nothing is copied: the tree points into the columns, and into the
+         * strings of their values, and retains their owner until it is
+         * cleared. The columns must describe a valid tree, every link in
+         * bounds and every node linked to its parent once; the caller checks
+         * them. The first change to the tree copies the columns into its own
+         * storage.
+         *
+         * @param columns The columns, each node column holding one element per node
+         * @param owner The object the columns and their strings live in
+         * @throw std::invalid_argument If the node columns differ in size
+         */
+        void view(const Columns &columns, const Shared &owner);
+
+        /**
+         * @brief Tell whether the tree reads its nodes in place, see view()
+         *
+         */
+        bool viewing() const noexcept { return _kinds.borrowed(); }
+
+        /**
+         * @brief Mark a subtree as equal to a static block
+         *
+         * @param root The root of the subtree, whose block().size() nodes are contiguous and in pre-order
+         * @param block The block, retained by the tree
+         */
+        void mark_block(NodeId root, const StaticBlock &block);
+
+        /**
+         * @brief Get the static block a subtree was copied from or marked with
+         *
+         * @param root The root of the subtree
+         * @return const StaticBlock* The block, or nullptr if node is not the root of a marked subtree
+         */
+        const StaticBlock *block(NodeId root) const noexcept;
+
+        /**
+         * @brief Get the number of marked subtrees
+         *
+         */
+        std::size_t blocks() const noexcept { return _blocks.size(); }
+
+        /**
+         * @brief Set the root of the tree
+         *
+         * @param node A node without parent
+         */
+        void set_root(NodeId node) noexcept { _root = node; }
+
+        /**
+         * @brief Set the generation used to mint handles of nodes created in this tree
+         *
+         * @param generation A number greater than the generation of every tree this one is diffed against
+         */
+        void set_generation(std::uint32_t generation) noexcept { _generation = generation; }
+
+        /**
+         * @brief Set the tree whose handles copied nodes carry, see origin()
+         *
+         * @param origin The serial() of that tree, or 0 once the handles of this tree are its own, e.g. after a diff
+         */
+        void set_origin(std::uint64_t origin) noexcept { _origin = origin; }
+
+        /**
+         * @brief Set the handle of a node
+         *
+         * @param node The node
+         * @param handle Its handle
+         */
+        void set_handle(NodeId node, Handle handle)
+        {
+            own();
+            _handles[node] = handle;
+        }
+
+        /**
+         * @brief Mint a fresh handle for a node of this tree
+         *
+         * @param node The node
+         * @return Handle A handle no node of an earlier generation can hold
+         */
+        Handle make_handle(NodeId node) const noexcept
+        {
+            return (static_cast<Handle>(_generation) << 32) | (static_cast<Handle>(node) + 1);
+        }
+
+        /**
+         * @brief Copy a string value into the tree's storage, retain a map or vector value
+         *
+         * @param value Any value
+         * @return Value A value safe to keep for the lifetime of the tree
+         */
+        Value store(Value value);
+
+        /**
+         * @brief Get the current size of the tree, to later drop the nodes created after it
+         *
+         */
+        Checkpoint checkpoint() const noexcept
+        {
+            return {static_cast<NodeId>(_kinds.size()), static_cast<std::uint32_t>(_properties.size()), _strings.mark(),
+                    static_cast<std::uint32_t>(_shared.size()), static_cast<std::uint32_t>(_blocks.size())};
+        }
+
+        /**
+         * @brief Drop every node created since a checkpoint, with their properties and strings
+         *
+         * Streaming consumers use it to forget subtrees they are done with, so
+         * that the tree only holds what is still being built.
+         *
+         * @param checkpoint A checkpoint taken since the last clear(); no node older than it may have a dropped child
+         */
+        void rollback(const Checkpoint &checkpoint) noexcept;
+
+        /**
+         * @brief Preallocate storage for nodes and properties
+         *
+         * @param nodes The expected node count
+         * @param properties The expected total property count
+         */
+        void reserve(std::size_t nodes, std::size_t properties);
+
+        /**
+         * @brief Remove every node, keeping the allocated storage
+         *
+         */
+        void clear() noexcept;
+
+        std::pmr::memory_resource *resource() const noexcept { return _kinds.resource(); }
+        std::size_t size() const noexcept { return _kinds.size(); }
+        bool empty() const noexcept { return _kinds.empty(); }
+        NodeId root() const noexcept { return _root; }
+        std::uint32_t generation() const noexcept { return _generation; }
+
+        /**
+         * @brief Get the identity of the tree's contents, new for every constructed or cleared tree
+         *
+         */
+        std::uint64_t serial() const noexcept { return _serial; }
+
+        /**
+         * @brief Get the serial of the tree the nodes with a handle were copied from before a diff, 0 if none
+         *
+         */
+        std::uint64_t origin() const noexcept { return _origin; }
+
+        NodeKind kind(NodeId node) const noexcept { return _kinds[node]; }
+        Atom tag(NodeId node) const noexcept { return _tags[node]; }
+        const Value &key(NodeId node) const noexcept { return _keys[node]; }
+        std::string_view text(NodeId node) const noexcept { return _texts[node].as_string(); }
+        NodeId parent(NodeId node) const noexcept { return _parents[node]; }
+        NodeId first_child(NodeId node) const noexcept { return _first_children[node]; }
+        NodeId last_child(NodeId node) const noexcept { return _last_children[node]; }
+        NodeId next_sibling(NodeId node) const noexcept { return _next_siblings[node]; }
+        Handle handle(NodeId node) const noexcept { return _handles[node]; }
+        Children children(NodeId node) const noexcept { return {this, _first_children[node]}; }
+
+        /**
+         * @brief Get the properties of a node, sorted by key atom
+         *
+         * @param node The node
+         * @return std::span<const Property> The properties
+         */
+        std::span<const Property> properties(NodeId node) const noexcept
+        {
+            const PropertySlice &slice = _property_slices[node];
+            return {_properties.data() + slice.offset, slice.count};
+        }
+    };
+} // namespace vdom
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string_view>
+
+#include "vdom/atom_table.hpp"
+
+namespace vdom
+{
+    class PersistentMap;
+    class PersistentVector;
+
+    /**
+     * @brief Unboxed property value: None, bool, int, float, string, persistent map or vector
+     *
+     * A Value is a 16-byte tagged union and is trivially copyable. String values
+     * do not own their characters: they point into the storage of the container
+     * that holds them (a Tree, a Properties set, ...). Likewise map and vector
+     * values do not hold a reference: containers retain them.
+     *
+     * Maps and vectors are immutable, so they compare and hash by identity: two
+     * values holding the same map are equal without looking inside it.
+     */
+    class Value
+    {
+    public:
+        enum class Type : std::uint8_t
+        {
+            None,
+            Bool,
+            Integer,
+            Float,
+            String,
+            Map,
+            Vector
+        };
+
+    private:
+        Type _type;
+        std::uint32_t _size;
+        union
+        {
+            bool _boolean;
+            std::int64_t _integer;
+            double _floating;
+            const char *_string;
+            const PersistentMap *_map;
+            const PersistentVector *_vector;
+        };
+
+    protected:
+    public:
+        /**
+         * @brief Construct a None value
+         *
+         */
+        constexpr Value() noexcept : _type(Type::None), _size(0), _integer(0) {}
+
+        static constexpr Value boolean(bool value) noexcept
+        {
+            Value result;
+            result._type = Type::Bool;
+            result._integer = 0;
+            result._boolean = value;
+            return result;
+        }
+
+        static constexpr Value integer(std::int64_t value) noexcept
+        {
+            Value result;
+            result._type = Type::Integer;
+            result._integer = value;
+            return result;
+        }
+
+        static constexpr Value floating(double value) noexcept
+        {
+            Value result;
+            result._type = Type::Float;
+            result._floating = value;
+            return result;
+        }
+
+        /**
+         * @brief Make a string value viewing characters owned elsewhere
+         *
+         * @param value The characters, which must outlive the value
+         * @return Value The string value
+         */
+        static constexpr Value string(std::string_view value) noexcept
+        {
+            Value result;
+            result._type = Type::String;
+            result._size = static_cast<std::uint32_t>(value.size());
+            result._string = value.data();
+            return result;
+        }
+
+        static constexpr Value map(const PersistentMap *value) noexcept
+        {
+            Value result;
+            result._type = Type::Map;
+            result._map = value;
+            return result;
+        }
+
+        static constexpr Value vector(const PersistentVector *value) noexcept
+        {
+            Value result;
+            result._type = Type::Vector;
+            result._vector = value;
+            return result;
+        }
+
+        Type type() const noexcept { return _type; }
+        bool is_none() const noexcept { return _type == Type::None; }
+
+        bool as_bool() const noexcept { return _boolean; }
+        std::int64_t as_integer() const noexcept { return _integer; }
+        double as_float() const noexcept { return _floating; }
+        std::string_view as_string() const noexcept { return {_string, _size}; }
+        const PersistentMap *as_map() const noexcept { return _map; }
+        const PersistentVector *as_vector() const noexcept { return _vector; }
+
+        /**
+         * @brief Compare type and payload, strings by content, maps and vectors by identity
+         *
+         */
+        bool operator==(const Value &other) const noexcept
+        {
+            if (_type != other._type)
+                return false;
+            switch (_type)
+            {
+            case Type::None:
+                return true;
+            case Type::Bool:
+                return _boolean == other._boolean;
+            case Type::Integer:
+                return _integer == other._integer;
+            case Type::Float:
+                return _floating == other._floating;
+            case Type::String:
+                return _size == other._size && (_string == other._string || std::memcmp(_string, other._string, _size) == 0);
+            case Type::Map:
+                return _map == other._map;
+            case Type::Vector:
+                return _vector == other._vector;
+            }
+            return false;
+        }
+
+        bool operator!=(const Value &other) const noexcept { return !(*this == other); }
+
+        /**
+         * @brief Hash type and payload, strings by content, maps and vectors by identity
+         *
+         * @return std::size_t The hash
+         */
+        std::size_t hash() const noexcept
+        {
+            std::size_t seed = static_cast<std::size_t>(_type) * 0x9E3779B97F4A7C15ull;
+            switch (_type)
+            {
+            case Type::None:
+                return seed;
+            case Type::Bool:
+                return seed ^ static_cast<std::size_t>(_boolean);
+            case Type::Integer:
+                return seed ^ std::hash<std::int64_t>{}(_integer);
+            case Type::Float:
+                return seed ^ std::hash<double>{}(_floating);
+            case Type::String:
+                return seed ^ std::hash<std::string_view>{}(as_string());
+            case Type::Map:
+                return seed ^ std::hash<const void *>{}(_map);
+            case Type::Vector:
+                return seed ^ std::hash<const void *>{}(_vector);
+            }
+            return seed;
+        }
+    };
+
+    /**
+     * @brief A property of a node: an interned name and its value
+     *
+     */
+    struct Property
+    {
+        Atom key;
+        Value value;
+    };
+} // namespace vdom
+
+template <>
+struct std::hash<vdom::Value>
+{
+    std::size_t operator()(const vdom::Value &value) const noexcept { return value.hash(); }
+};
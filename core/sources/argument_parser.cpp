@@ -7,6 +7,112 @@
 namespace argument_parser
 {
 
+    Nargs parse_nargs(const std::string &nargs)
+    {
+        if (nargs.empty() || nargs == "1")
+            return Nargs::Single;
+        if (nargs == "0")
+            return Nargs::Zero;
+        if (nargs == "?")
+            return Nargs::Optional;
+        if (nargs == "*")
+            return Nargs::ZeroOrMore;
+        if (nargs == "+")
+            return Nargs::OneOrMore;
+        throw ArgumentError("Unsupported nargs: " + nargs);
+    }
+
+    namespace
+    {
+        bool takes_list(Nargs nargs)
+        {
+            return nargs == Nargs::ZeroOrMore || nargs == Nargs::OneOrMore;
+        }
+
+        template <typename T>
+        std::vector<T> convert_all(const std::vector<std::string> &values)
+        {
+            std::vector<T> result;
+            result.reserve(values.size());
+            for (const auto &value : values)
+            {
+                result.push_back(detail::convert<T>(value));
+            }
+            return result;
+        }
+    } // namespace
+
+    std::string Namespace::format(const Value &value)
+    {
+        std::ostringstream oss;
+        std::visit([&oss](const auto &stored)
+                   {
+                       using Stored = std::decay_t<decltype(stored)>;
+                       if constexpr (std::is_same_v<Stored, bool>)
+                       {
+                           oss << (stored ? "true" : "false");
+                       }
+                       else if constexpr (std::is_same_v<Stored, std::string> || std::is_arithmetic_v<Stored>)
+                       {
+                           oss << stored;
+                       }
+                       else
+                       {
+                           for (size_t i = 0; i < stored.size(); ++i)
+                           {
+                               if (i > 0)
+                                   oss << " ";
+                               oss << stored[i];
+                           }
+                       } },
+                   value);
+        return oss.str();
+    }
+
+    // Adapts the actions of an ArgumentParser to detail::parse_arguments
+    struct ArgumentParser::Table
+    {
+        const ArgumentParser &parser;
+
+        std::size_t find(std::string_view option_string) const noexcept
+        {
+            return detail::find_perfect_hash(parser.option_strings_, parser.option_slots_, parser.option_seed_, option_string);
+        }
+
+        std::size_t positional(std::size_t position) const noexcept
+        {
+            return position < parser.positional_actions_.size() ? parser.option_actions_.size() + position : detail::npos;
+        }
+
+        Nargs nargs(std::size_t index) const noexcept
+        {
+            return action(index)->nargs;
+        }
+
+        // Options first, then positional arguments
+        Action *action(std::size_t index) const noexcept
+        {
+            return index < parser.option_actions_.size() ? parser.option_actions_[index]
+                                                         : parser.positional_actions_[index - parser.option_actions_.size()];
+        }
+    };
+
+    struct ArgumentParser::Sink
+    {
+        ArgumentParser &parser;
+        const Table &table;
+        Namespace &namespace_obj;
+        const std::vector<std::string> &arguments;
+
+        void store(std::size_t index, std::size_t first, std::size_t count, std::string_view option_string)
+        {
+            std::vector<std::string> values(arguments.begin() + first, arguments.begin() + first + count);
+            table.action(index)->call(parser, namespace_obj, values, std::string(option_string));
+        }
+
+        [[noreturn]] void error(const std::string &message) { parser.error(message); }
+    };
+
     // Action implementations
     std::string Action::format_usage() const
     {
@@ -17,11 +123,11 @@ namespace argument_parser
             {
                 usage += option_strings[0];
             }
-            if (nargs != "0" && !metavar.empty())
+            if (nargs != Nargs::Zero && !metavar.empty())
             {
                 usage += " " + metavar;
             }
-            else if (nargs != "0" && metavar.empty() && !dest.empty())
+            else if (nargs != Nargs::Zero && metavar.empty() && !dest.empty())
             {
                 std::string dest_upper = dest;
                 std::transform(dest_upper.begin(), dest_upper.end(), dest_upper.begin(), ::toupper);
@@ -45,11 +151,46 @@ namespace argument_parser
         }
     }
 
+    Namespace::Value Action::convert(const std::string &value) const
+    {
+        switch (type)
+        {
+        case ValueType::Integer:
+            return detail::convert<std::int64_t>(value);
+        case ValueType::Float:
+            return detail::convert<double>(value);
+        case ValueType::Bool:
+            return detail::convert<bool>(value);
+        default:
+            return value;
+        }
+    }
+
+    Namespace::Value Action::convert(const std::vector<std::string> &values) const
+    {
+        if (!takes_list(nargs))
+        {
+            return convert(values.at(0));
+        }
+
+        switch (type)
+        {
+        case ValueType::Integer:
+            return convert_all<std::int64_t>(values);
+        case ValueType::Float:
+            return convert_all<double>(values);
+        case ValueType::Bool:
+            throw ArgumentTypeError("Argument " + dest + " cannot take a list of bools");
+        default:
+            return values;
+        }
+    }
+
     void StoreAction::call(ArgumentParser &parser, Namespace &namespace_obj,
                            const std::vector<std::string> &values,
                            const std::string &option_string)
     {
-        if (values.empty())
+        if (values.empty() && nargs != Nargs::Optional)
         {
             throw ArgumentError("Expected at least one argument for " + option_string);
         }
@@ -63,44 +204,33 @@ namespace argument_parser
             }
         }
 
-        if (nargs == "" || nargs == "1")
-        {
-            namespace_obj.set(dest, values[0]);
-        }
-        else if (nargs == "*" || nargs == "+")
-        {
-            // For multiple values, join with spaces (or could store as list)
-            std::string combined;
-            for (size_t i = 0; i < values.size(); ++i)
-            {
-                if (i > 0)
-                    combined += " ";
-                combined += values[i];
-            }
-            namespace_obj.set(dest, combined);
-        }
-        else if (nargs == "?")
+        // Convert once, here, so that reading the Namespace never parses
+        try
         {
             if (!values.empty())
             {
-                namespace_obj.set(dest, values[0]);
+                namespace_obj.store(dest, convert(values));
             }
             else if (!const_value.empty())
             {
-                namespace_obj.set(dest, const_value);
+                namespace_obj.store(dest, convert(const_value));
             }
             else if (!default_value.empty())
             {
-                namespace_obj.set(dest, default_value);
+                namespace_obj.store(dest, convert(default_value));
             }
         }
+        catch (const ArgumentTypeError &exception)
+        {
+            parser.error("argument " + (option_string.empty() ? dest : option_string) + ": " + exception.what());
+        }
     }
 
     void StoreConstAction::call(ArgumentParser &parser, Namespace &namespace_obj,
                                 const std::vector<std::string> &values,
                                 const std::string &option_string)
     {
-        namespace_obj.set(dest, const_value);
+        namespace_obj.store(dest, convert(const_value));
     }
 
     void HelpAction::call(ArgumentParser &parser, Namespace &namespace_obj,
@@ -127,14 +257,17 @@ namespace argument_parser
         : prog_(prog.empty() ? "program" : prog),
           description_(description),
           epilog_(epilog),
+          option_seed_(0),
+          option_table_stale_(true),
           add_help_(add_help)
     {
 
         if (add_help_)
         {
             auto help_action = std::make_unique<HelpAction>();
-            option_string_actions_["-h"] = help_action.get();
-            option_string_actions_["--help"] = help_action.get();
+            register_option("-h", help_action.get());
+            register_option("--help", help_action.get());
+            dests_.push_back(help_action->dest);
             actions_.push_back(std::move(help_action));
         }
     }
@@ -160,10 +293,11 @@ namespace argument_parser
                                          const std::string &help,
                                          const std::string &metavar,
                                          bool required,
-                                         const std::vector<std::string> &choices)
+                                         const std::vector<std::string> &choices,
+                                         ValueType type)
     {
         return add_argument(std::vector<std::string>{name_or_flags}, action, nargs,
-                            const_value, default_value, help, metavar, required, choices);
+                            const_value, default_value, help, metavar, required, choices, type);
     }
 
     Action &ArgumentParser::add_argument(const std::vector<std::string> &name_or_flags,
@@ -174,23 +308,34 @@ namespace argument_parser
                                          const std::string &help,
                                          const std::string &metavar,
                                          bool required,
-                                         const std::vector<std::string> &choices)
+                                         const std::vector<std::string> &choices,
+                                         ValueType type)
     {
 
         std::string dest = get_dest(name_or_flags);
 
         auto action_ptr = create_action(action, name_or_flags, dest, nargs,
                                         const_value, default_value, help, metavar,
-                                        required, choices);
+                                        required, choices, type);
 
         Action *action_ref = action_ptr.get();
+        if (action_ref->type == ValueType::Bool && takes_list(action_ref->nargs))
+        {
+            throw ArgumentError("Argument " + dest + " cannot take a list of bools");
+        }
+
+        // Actions sharing a destination, e.g. store_true and store_false, share its slot
+        if (std::find(dests_.begin(), dests_.end(), dest) == dests_.end())
+        {
+            dests_.push_back(dest);
+        }
 
         // Register option strings for optional arguments
         for (const auto &option_string : name_or_flags)
         {
             if (is_optional_string(option_string))
             {
-                option_string_actions_[option_string] = action_ref;
+                register_option(option_string, action_ref);
             }
         }
 
@@ -204,6 +349,36 @@ namespace argument_parser
         return *action_ref;
     }
 
+    void ArgumentParser::register_option(const std::string &option_string, Action *action)
+    {
+        // A later registration of the same option string replaces the earlier one
+        for (size_t i = 0; i < option_strings_.size(); ++i)
+        {
+            if (option_strings_[i] == option_string)
+            {
+                option_actions_[i] = action;
+                return;
+            }
+        }
+
+        // A view into the action's own copy, which lives as long as the parser
+        auto own = std::find(action->option_strings.begin(), action->option_strings.end(), option_string);
+        if (own == action->option_strings.end())
+        {
+            throw ArgumentError("Option string " + option_string + " does not belong to its action");
+        }
+        option_strings_.push_back(*own);
+        option_actions_.push_back(action);
+        option_table_stale_ = true;
+    }
+
+    void ArgumentParser::build_option_table()
+    {
+        option_slots_.assign(detail::table_size(option_strings_.size()), detail::empty_slot);
+        option_seed_ = detail::build_perfect_hash(option_strings_, option_slots_);
+        option_table_stale_ = false;
+    }
+
     std::unique_ptr<Action> ArgumentParser::create_action(const std::string &action_type,
                                                           const std::vector<std::string> &option_strings,
                                                           const std::string &dest,
@@ -213,17 +388,18 @@ namespace argument_parser
                                                           const std::string &help,
                                                           const std::string &metavar,
                                                           bool required,
-                                                          const std::vector<std::string> &choices)
+                                                          const std::vector<std::string> &choices,
+                                                          ValueType type)
     {
         if (action_type == "store")
         {
             return std::make_unique<StoreAction>(option_strings, dest, nargs, const_value,
-                                                 default_value, help, metavar, required, choices);
+                                                 default_value, help, metavar, required, choices, type);
         }
         else if (action_type == "store_const")
         {
             return std::make_unique<StoreConstAction>(option_strings, dest, const_value,
-                                                      default_value, help, required);
+                                                      default_value, help, required, type);
         }
         else if (action_type == "store_true")
         {
@@ -276,6 +452,18 @@ namespace argument_parser
         return "";
     }
 
+    std::vector<std::string> ArgumentParser::split_args(const std::string &args_string)
+    {
+        std::vector<std::string> args;
+        std::istringstream iss(args_string);
+        std::string arg;
+        while (iss >> arg)
+        {
+            args.push_back(arg);
+        }
+        return args;
+    }
+
     bool ArgumentParser::is_optional_string(const std::string &arg)
     {
         return !arg.empty() && arg[0] == '-';
@@ -300,85 +488,28 @@ namespace argument_parser
 
     Namespace ArgumentParser::parse_args(const std::vector<std::string> &args)
     {
-        Namespace namespace_obj;
+        Namespace namespace_obj(dests_);
         std::vector<std::string> args_to_parse = args.empty() ? args_ : args;
 
-        // Set default values
+        // Set default values; a list's default holds its values separated by spaces
         for (const auto &action : actions_)
         {
             if (!action->default_value.empty())
             {
-                namespace_obj.set(action->dest, action->default_value);
+                namespace_obj.store(action->dest, takes_list(action->nargs) ? action->convert(split_args(action->default_value))
+                                                                            : action->convert(action->default_value));
             }
         }
 
-        size_t positional_index = 0;
-        for (size_t i = 0; i < args_to_parse.size(); ++i)
+        if (option_table_stale_)
         {
-            const std::string &arg = args_to_parse[i];
-
-            if (is_optional_string(arg))
-            {
-                // Handle optional arguments
-                auto it = option_string_actions_.find(arg);
-                if (it == option_string_actions_.end())
-                {
-                    error("Unrecognized argument: " + arg);
-                }
-
-                Action *action = it->second;
-                std::vector<std::string> values;
-
-                // Handle different nargs values
-                if (action->nargs == "0" ||
-                    dynamic_cast<StoreTrueAction *>(action) ||
-                    dynamic_cast<StoreFalseAction *>(action) ||
-                    dynamic_cast<HelpAction *>(action) ||
-                    dynamic_cast<VersionAction *>(action))
-                {
-                    // No arguments needed
-                }
-                else if (action->nargs == "?" || action->nargs == "" || action->nargs == "1")
-                {
-                    if (i + 1 < args_to_parse.size() && !is_optional_string(args_to_parse[i + 1]))
-                    {
-                        values.push_back(args_to_parse[++i]);
-                    }
-                }
-                else if (action->nargs == "*")
-                {
-                    while (i + 1 < args_to_parse.size() && !is_optional_string(args_to_parse[i + 1]))
-                    {
-                        values.push_back(args_to_parse[++i]);
-                    }
-                }
-                else if (action->nargs == "+")
-                {
-                    if (i + 1 >= args_to_parse.size() || is_optional_string(args_to_parse[i + 1]))
-                    {
-                        error("Argument " + arg + " expected at least one argument");
-                    }
-                    while (i + 1 < args_to_parse.size() && !is_optional_string(args_to_parse[i + 1]))
-                    {
-                        values.push_back(args_to_parse[++i]);
-                    }
-                }
-
-                action->call(*this, namespace_obj, values, arg);
-            }
-            else
-            {
-                // Handle positional arguments
-                if (positional_index >= positional_actions_.size())
-                {
-                    error("Too many positional arguments: " + arg);
-                }
-
-                Action *action = positional_actions_[positional_index++];
-                action->call(*this, namespace_obj, {arg});
-            }
+            build_option_table();
         }
 
+        Table table{*this};
+        Sink sink{*this, table, namespace_obj, args_to_parse};
+        size_t positional_index = detail::parse_arguments(table, args_to_parse, sink);
+
         // Check required arguments
         for (const auto &action : actions_)
         {
@@ -400,6 +531,16 @@ namespace argument_parser
         return namespace_obj;
     }
 
+    Namespace::Handle ArgumentParser::handle(const std::string &dest) const
+    {
+        auto it = std::find(dests_.begin(), dests_.end(), dest);
+        if (it == dests_.end())
+        {
+            throw ArgumentError("Argument '" + dest + "' not found");
+        }
+        return static_cast<Namespace::Handle>(it - dests_.begin());
+    }
+
     Namespace ArgumentParser::parse_known_args(const std::vector<std::string> &args)
     {
         // For simplicity, this implementation is the same as parse_args
@@ -415,7 +556,7 @@ namespace argument_parser
         // Add optional arguments
         for (const auto &action : actions_)
         {
-            if (action->is_optional() && !dynamic_cast<HelpAction *>(action.get()))
+            if (action->is_optional() && action->kind != ActionKind::Help)
             {
                 oss << " " << action->format_usage();
             }
@@ -0,0 +1,56 @@
+#include <stdexcept>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+#include "backend/library.hpp"
+
+#ifdef _WIN32
+backend::Library::Library(const std::filesystem::path &path) : _handle(nullptr), _api(nullptr)
+{
+    HMODULE module = LoadLibraryW(path.c_str());
+    if (!module)
+        throw std::runtime_error("Failed to load backend " + path.string() + ": error " + std::to_string(GetLastError()));
+    _handle = module;
+
+    auto entry = reinterpret_cast<ce_backend_entry_function>(
+        reinterpret_cast<void (*)()>(GetProcAddress(module, CE_BACKEND_ENTRY)));
+    _api = entry ? entry(CE_BACKEND_ABI_VERSION) : nullptr;
+    if (!_api)
+    {
+        FreeLibrary(module);
+        throw std::runtime_error(entry ? "Backend " + path.string() + " does not support ABI version " + std::to_string(CE_BACKEND_ABI_VERSION)
+                                       : "Backend " + path.string() + " does not export " CE_BACKEND_ENTRY);
+    }
+}
+
+backend::Library::~Library()
+{
+    FreeLibrary(static_cast<HMODULE>(_handle));
+}
+#else
+backend::Library::Library(const std::filesystem::path &path) : _handle(nullptr), _api(nullptr)
+{
+    _handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!_handle)
+        throw std::runtime_error("Failed to load backend " + path.string() + ": " + dlerror());
+
+    auto entry = reinterpret_cast<ce_backend_entry_function>(dlsym(_handle, CE_BACKEND_ENTRY));
+    _api = entry ? entry(CE_BACKEND_ABI_VERSION) : nullptr;
+    if (!_api)
+    {
+        dlclose(_handle);
+        throw std::runtime_error(entry ? "Backend " + path.string() + " does not support ABI version " + std::to_string(CE_BACKEND_ABI_VERSION)
+                                       : "Backend " + path.string() + " does not export " CE_BACKEND_ENTRY);
+    }
+}
+
+backend::Library::~Library()
+{
+    dlclose(_handle);
+}
+#endif
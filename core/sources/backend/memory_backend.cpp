@@ -0,0 +1,288 @@
+#include <exception>
+#include <new>
+#include <stdexcept>
+
+#include "backend/memory_backend.hpp"
+#include "trace/tracer.hpp"
+
+namespace
+{
+    /**
+     * @brief What an opaque ce_backend of the in-memory backend points to
+     *
+     */
+    struct Instance
+    {
+        backend::MemoryBackend document;
+        std::string error;
+    };
+
+    std::string to_string(const ce_value &value)
+    {
+        switch (value.type)
+        {
+        case CE_VALUE_BOOL:
+            return value.as.boolean ? "true" : "false";
+        case CE_VALUE_INTEGER:
+            return std::to_string(value.as.integer);
+        case CE_VALUE_FLOAT:
+            return std::to_string(value.as.floating);
+        case CE_VALUE_STRING:
+            return std::string(value.as.string.data, value.as.string.size);
+        default:
+            return {};
+        }
+    }
+
+    void escape(std::string &output, std::string_view text, bool attribute)
+    {
+        for (char character : text)
+        {
+            switch (character)
+            {
+            case '&':
+                output += "&amp;";
+                break;
+            case '<':
+                output += "&lt;";
+                break;
+            case '>':
+                output += "&gt;";
+                break;
+            case '"':
+                output += attribute ? "&quot;" : "\"";
+                break;
+            default:
+                output += character;
+            }
+        }
+    }
+
+    ce_backend *create(const char *)
+    {
+        return reinterpret_cast<ce_backend *>(new (std::nothrow) Instance());
+    }
+
+    void destroy(ce_backend *backend)
+    {
+        delete reinterpret_cast<Instance *>(backend);
+    }
+
+    int apply(ce_backend *backend, const ce_frame *frame)
+    {
+        // Exceptions must not cross the C interface
+        Instance *instance = reinterpret_cast<Instance *>(backend);
+        try
+        {
+            instance->document.apply(*frame);
+            return 0;
+        }
+        catch (const std::exception &error)
+        {
+            instance->error = error.what();
+        }
+        catch (...)
+        {
+            instance->error = "Unknown error";
+        }
+        return 1;
+    }
+
+    const char *error(ce_backend *backend)
+    {
+        return reinterpret_cast<Instance *>(backend)->error.c_str();
+    }
+} // namespace
+
+backend::MemoryBackend::Node &backend::MemoryBackend::at(ce_handle handle)
+{
+    auto it = _nodes.find(handle);
+    if (it == _nodes.end())
+        throw std::out_of_range("Unknown node " + std::to_string(handle));
+    return it->second;
+}
+
+void backend::MemoryBackend::detach(ce_handle handle, Node &node)
+{
+    if (node.parent == 0)
+    {
+        if (_root == handle)
+            _root = 0;
+        return;
+    }
+
+    Node &parent = at(node.parent);
+    (node.previous_sibling != 0 ? at(node.previous_sibling).next_sibling : parent.first_child) = node.next_sibling;
+    (node.next_sibling != 0 ? at(node.next_sibling).previous_sibling : parent.last_child) = node.previous_sibling;
+    node.parent = 0;
+    node.previous_sibling = 0;
+    node.next_sibling = 0;
+}
+
+void backend::MemoryBackend::attach(ce_handle handle, Node &node, ce_handle parent_handle, ce_handle before)
+{
+    if (parent_handle == 0)
+    {
+        _root = handle;
+        return;
+    }
+
+    Node &parent = at(parent_handle);
+    node.parent = parent_handle;
+    node.next_sibling = before;
+    node.previous_sibling = before != 0 ? at(before).previous_sibling : parent.last_child;
+    (node.previous_sibling != 0 ? at(node.previous_sibling).next_sibling : parent.first_child) = handle;
+    (before != 0 ? at(before).previous_sibling : parent.last_child) = handle;
+}
+
+void backend::MemoryBackend::erase(ce_handle handle)
+{
+    std::vector<ce_handle> pending{handle};
+    while (!pending.empty())
+    {
+        auto it = _nodes.find(pending.back());
+        pending.pop_back();
+        for (ce_handle child = it->second.first_child; child != 0; child = at(child).next_sibling)
+            pending.push_back(child);
+        _nodes.erase(it);
+    }
+}
+
+void backend::MemoryBackend::apply(const ce_patch &patch)
+{
+    switch (patch.type)
+    {
+    case CE_PATCH_CREATE:
+    {
+        if (_nodes.contains(patch.node))
+            throw std::out_of_range("Node " + std::to_string(patch.node) + " already exists");
+        Node &node = _nodes[patch.node];
+        node.kind = static_cast<ce_node_kind>(patch.kind);
+        node.tag = patch.name;
+        if (patch.kind == CE_NODE_TEXT)
+            node.text = to_string(patch.value);
+        attach(patch.node, node, patch.parent, patch.before);
+        break;
+    }
+    case CE_PATCH_REMOVE:
+    {
+        Node &node = at(patch.node);
+        detach(patch.node, node);
+        erase(patch.node);
+        break;
+    }
+    case CE_PATCH_MOVE:
+    {
+        Node &node = at(patch.node);
+        detach(patch.node, node);
+        attach(patch.node, node, patch.parent, patch.before);
+        break;
+    }
+    case CE_PATCH_SET_PROPERTY:
+    {
+        Node &node = at(patch.node);
+        auto it = node.properties.begin();
+        while (it != node.properties.end() && it->first != patch.name)
+            ++it;
+        if (it == node.properties.end())
+            node.properties.emplace_back(patch.name, to_string(patch.value));
+        else
+            it->second = to_string(patch.value);
+        break;
+    }
+    case CE_PATCH_REMOVE_PROPERTY:
+    {
+        Node &node = at(patch.node);
+        std::erase_if(node.properties, [&](const auto &property)
+                      { return property.first == patch.name; });
+        break;
+    }
+    case CE_PATCH_SET_TEXT:
+        at(patch.node).text = to_string(patch.value);
+        break;
+    default:
+        throw std::out_of_range("Unknown patch type " + std::to_string(patch.type));
+    }
+}
+
+void backend::MemoryBackend::apply(const ce_frame &frame)
+{
+    trace::Span span("memory backend");
+
+    // Copy the names added since the previous frame, all of them when the table was replaced
+    if (frame.first_new_atom == 0)
+        _names.clear();
+    for (std::size_t atom = _names.size(); atom < frame.atom_count; ++atom)
+        _names.emplace_back(frame.atoms[atom].data, frame.atoms[atom].size);
+
+    for (std::size_t index = 0; index < frame.patch_count; ++index)
+        apply(frame.patches[index]);
+    _frames++;
+}
+
+void backend::MemoryBackend::clear() noexcept
+{
+    _nodes.clear();
+    _root = 0;
+}
+
+std::string backend::MemoryBackend::html() const
+{
+    std::string output;
+    if (_root == 0)
+        return output;
+
+    // Explicit stack of nodes to enter, and of elements to close
+    std::vector<std::pair<ce_handle, bool>> pending{{_root, false}};
+    while (!pending.empty())
+    {
+        auto [handle, closing] = pending.back();
+        pending.pop_back();
+        const Node &node = _nodes.at(handle);
+        if (closing)
+        {
+            output += "</";
+            output += name(node.tag);
+            output += '>';
+            continue;
+        }
+        if (node.kind == CE_NODE_TEXT)
+        {
+            escape(output, node.text, false);
+            continue;
+        }
+
+        output += '<';
+        output += name(node.tag);
+        for (const auto &[key, value] : node.properties)
+        {
+            output += ' ';
+            output += name(key);
+            output += "=\"";
+            escape(output, value, true);
+            output += '"';
+        }
+        output += '>';
+
+        pending.push_back({handle, true});
+        for (ce_handle child = node.last_child; child != 0; child = _nodes.at(child).previous_sibling)
+            pending.push_back({child, false});
+    }
+    return output;
+}
+
+std::string_view backend::MemoryBackend::name(ce_atom atom) const noexcept
+{
+    return atom < _names.size() ? std::string_view(_names[atom]) : std::string_view();
+}
+
+backend::MemoryBackend &backend::MemoryBackend::of(ce_backend *instance) noexcept
+{
+    return reinterpret_cast<Instance *>(instance)->document;
+}
+
+const ce_backend_api &backend::memory_backend_api() noexcept
+{
+    static const ce_backend_api api{CE_BACKEND_ABI_VERSION, sizeof(ce_backend_api), "memory", create, destroy, apply, error};
+    return api;
+}
@@ -0,0 +1,129 @@
+#include <stdexcept>
+#include <string>
+
+#include "backend/renderer.hpp"
+#include "trace/tracer.hpp"
+
+namespace
+{
+    static_assert(static_cast<int>(vdom::PatchType::Create) == CE_PATCH_CREATE &&
+                      static_cast<int>(vdom::PatchType::SetText) == CE_PATCH_SET_TEXT,
+                  "Patch types must keep their C values");
+    static_assert(static_cast<int>(vdom::NodeKind::Element) == CE_NODE_ELEMENT &&
+                      static_cast<int>(vdom::NodeKind::Text) == CE_NODE_TEXT,
+                  "Node kinds must keep their C values");
+
+    std::string name_of(const ce_backend_api &api)
+    {
+        return api.name ? api.name : "(unnamed)";
+    }
+} // namespace
+
+backend::Renderer::Renderer(const ce_backend_api &api, const char *options)
+    : _api(&api), _instance(nullptr), _atom_table(nullptr), _frames(0)
+{
+    create(options);
+}
+
+backend::Renderer::Renderer(const std::filesystem::path &library, const char *options)
+    : _library(std::make_unique<Library>(library)), _api(&_library->api()), _instance(nullptr), _atom_table(nullptr),
+      _frames(0)
+{
+    create(options);
+}
+
+backend::Renderer::~Renderer()
+{
+    _api->destroy(_instance);
+}
+
+void backend::Renderer::create(const char *options)
+{
+    if (_api->abi_version != CE_BACKEND_ABI_VERSION)
+        throw std::runtime_error("Backend " + name_of(*_api) + " is built for ABI version " + std::to_string(_api->abi_version) +
+                                 ", not " + std::to_string(CE_BACKEND_ABI_VERSION));
+    if (_api->size < sizeof(ce_backend_api) || !_api->create || !_api->destroy || !_api->apply)
+        throw std::runtime_error("Backend " + name_of(*_api) + " has an incomplete function table");
+
+    _instance = _api->create(options);
+    if (!_instance)
+        throw std::runtime_error("Backend " + name_of(*_api) + " failed to create an instance");
+}
+
+std::uint32_t backend::Renderer::sync_atoms(const vdom::AtomTable &atoms)
+{
+    // Names are stable for the lifetime of their table, only the new ones are looked up
+    if (_atom_table != &atoms)
+    {
+        _atom_table = &atoms;
+        _atoms.clear();
+    }
+    const std::uint32_t first_new = static_cast<std::uint32_t>(_atoms.size());
+    for (std::size_t atom = _atoms.size(); atom < atoms.size(); ++atom)
+    {
+        std::string_view name = atoms.name(static_cast<vdom::Atom>(atom));
+        _atoms.push_back({name.data(), name.size()});
+    }
+    return first_new;
+}
+
+void backend::Renderer::apply(std::span<const vdom::Patch> patches, const vdom::AtomTable &atoms)
+{
+    trace::Span span("apply patches");
+    const std::uint32_t first_new = sync_atoms(atoms);
+
+    _patches.clear();
+    _patches.reserve(patches.size());
+    for (const vdom::Patch &patch : patches)
+        _patches.push_back(convert(patch));
+
+    const ce_frame frame{_patches.data(), _patches.size(), _atoms.data(), static_cast<std::uint32_t>(_atoms.size()),
+                         first_new, _frames};
+    if (_api->apply(_instance, &frame) != 0)
+    {
+        const char *error = _api->error ? _api->error(_instance) : nullptr;
+        throw std::runtime_error("Backend " + name_of(*_api) + " failed to apply frame " + std::to_string(_frames) +
+                                 (error ? ": " + std::string(error) : std::string()));
+    }
+    _frames++;
+}
+
+ce_patch backend::Renderer::convert(const vdom::Patch &patch) noexcept
+{
+    ce_patch converted{};
+    converted.type = static_cast<std::uint8_t>(patch.type);
+    converted.kind = static_cast<std::uint8_t>(patch.kind);
+    converted.name = patch.name;
+    converted.node = patch.node;
+    converted.parent = patch.parent;
+    converted.before = patch.before;
+
+    const vdom::Value &value = patch.value;
+    switch (value.type())
+    {
+    case vdom::Value::Type::None:
+        converted.value.type = CE_VALUE_NONE;
+        break;
+    case vdom::Value::Type::Bool:
+        converted.value.type = CE_VALUE_BOOL;
+        converted.value.as.boolean = value.as_bool();
+        break;
+    case vdom::Value::Type::Integer:
+        converted.value.type = CE_VALUE_INTEGER;
+        converted.value.as.integer = value.as_integer();
+        break;
+    case vdom::Value::Type::Float:
+        converted.value.type = CE_VALUE_FLOAT;
+        converted.value.as.floating = value.as_float();
+        break;
+    case vdom::Value::Type::String:
+        converted.value.type = CE_VALUE_STRING;
+        converted.value.as.string = {value.as_string().data(), value.as_string().size()};
+        break;
+    case vdom::Value::Type::Map:
+    case vdom::Value::Type::Vector:
+        converted.value.type = CE_VALUE_OPAQUE;
+        break;
+    }
+    return converted;
+}
@@ -0,0 +1,84 @@
+#include <algorithm>
+#include <bit>
+
+#include "engine/event_queue.hpp"
+
+engine::EventQueue::EventQueue(std::size_t capacity)
+    : _slots(std::make_unique<Slot[]>(std::bit_ceil(std::max<std::size_t>(capacity, 2)))),
+      _mask(std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1), _tail(0), _head(0), _dropped(0), _coalesced(0)
+{
+    for (std::size_t index = 0; index <= _mask; ++index)
+        _slots[index].sequence.store(index, std::memory_order_relaxed);
+}
+
+void engine::EventQueue::coalesce(vdom::Atom type)
+{
+    if (std::find(_coalesced_types.begin(), _coalesced_types.end(), type) == _coalesced_types.end())
+        _coalesced_types.push_back(type);
+}
+
+bool engine::EventQueue::push(const Event &event) noexcept
+{
+    // A slot is free for the producer at position p when its sequence is p,
+    // and holds an event for the consumer when it is p + 1
+    std::size_t position = _tail.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        Slot &slot = _slots[position & _mask];
+        const std::size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        const std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence - position);
+        if (difference == 0)
+        {
+            if (_tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+                slot.event = event;
+                slot.sequence.store(position + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (difference < 0)
+        {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        else
+            position = _tail.load(std::memory_order_relaxed);
+    }
+}
+
+bool engine::EventQueue::pop(Event &event) noexcept
+{
+    Slot &slot = _slots[_head & _mask];
+    if (slot.sequence.load(std::memory_order_acquire) != _head + 1)
+        return false;
+
+    event = slot.event;
+    slot.sequence.store(_head + _mask + 1, std::memory_order_release);
+    _head++;
+    return true;
+}
+
+void engine::EventQueue::drain(std::vector<Event> &events)
+{
+    events.clear();
+    _runs.clear();
+
+    // At most one queue's worth, so that producers cannot keep the consumer draining forever
+    Event event;
+    for (std::size_t count = 0; count <= _mask && pop(event); ++count)
+    {
+        if (std::find(_coalesced_types.begin(), _coalesced_types.end(), event.type) == _coalesced_types.end())
+            _runs.clear();
+        else
+        {
+            auto [run, inserted] = _runs.try_emplace({event.type, event.target}, events.size());
+            if (!inserted)
+            {
+                events[run->second] = event;
+                _coalesced++;
+                continue;
+            }
+        }
+        events.push_back(event);
+    }
+}
@@ -0,0 +1,133 @@
+#include <algorithm>
+
+#include "engine/parallel_reconciler.hpp"
+#include "trace/tracer.hpp"
+
+engine::ParallelReconciler::ParallelReconciler(std::size_t grain)
+    : _grain(std::max<std::size_t>(grain, 1)), _chunk(0), _old(nullptr), _next(nullptr)
+{
+}
+
+void engine::ParallelReconciler::measure_subtrees(const vdom::Tree &tree)
+{
+    _sizes.assign(tree.size(), 1);
+    _order.clear();
+    _stack.clear();
+
+    // Pre-order walk, then accumulate the sizes bottom-up in reverse order
+    _stack.push_back(tree.root());
+    while (!_stack.empty())
+    {
+        vdom::NodeId node = _stack.back();
+        _stack.pop_back();
+        _order.push_back(node);
+        for (vdom::NodeId child : tree.children(node))
+            _stack.push_back(child);
+    }
+
+    for (std::size_t index = _order.size(); index-- > 1;)
+    {
+        vdom::NodeId node = _order[index];
+        _sizes[tree.parent(node)] += _sizes[node];
+    }
+}
+
+bool engine::ParallelReconciler::defer(vdom::NodeId old_node, vdom::NodeId new_node, std::size_t offset)
+{
+    const std::size_t nodes = _sizes[new_node];
+    if (nodes > _chunk)
+        return false;
+
+    // Extend the last group only if nothing was emitted since, so that splicing keeps the sequential order
+    if (!_groups.empty() && _groups.back().offset == offset && _groups.back().nodes + nodes <= _chunk)
+    {
+        _groups.back().end++;
+        _groups.back().nodes += nodes;
+    }
+    else
+    {
+        _groups.push_back({offset, _subtrees.size(), _subtrees.size() + 1, nodes});
+    }
+    _subtrees.push_back({old_node, new_node});
+    return true;
+}
+
+void engine::ParallelReconciler::diff(const vdom::Tree &old, vdom::Tree &next, vdom::PatchList &patches, ThreadPool *pool)
+{
+    const std::size_t threads = pool ? pool->workers() + 1 : 1;
+    if (threads == 1)
+    {
+        _reconciler.diff(old, next, patches);
+        return;
+    }
+
+    // A few chunks per thread leave room for stealing when subtrees differ in cost
+    std::size_t groups = split(old, next, threads * 4);
+    pool->run(groups, [this](std::size_t index)
+              { diff_group(index); });
+    merge(patches);
+}
+
+std::size_t engine::ParallelReconciler::split(const vdom::Tree &old, vdom::Tree &next, std::size_t tasks)
+{
+    _old = &old;
+    _next = &next;
+    _subtrees.clear();
+    _groups.clear();
+    _patches.clear();
+
+    if (old.root() == vdom::null_node || next.root() == vdom::null_node || next.size() < 2 * _grain)
+    {
+        _reconciler.diff(old, next, _patches);
+        return 0;
+    }
+
+    measure_subtrees(next);
+    _chunk = std::max(_grain, next.size() / std::max<std::size_t>(tasks, 1));
+    _reconciler.diff(old, next, _patches, this);
+
+    if (_group_reconcilers.size() < _groups.size())
+    {
+        _group_reconcilers.resize(_groups.size());
+        _group_patches.resize(_groups.size());
+    }
+    return _groups.size();
+}
+
+void engine::ParallelReconciler::diff_group(std::size_t index)
+{
+    trace::Span span("reconcile subtrees");
+    const Group &group = _groups[index];
+    vdom::PatchList &group_patches = _group_patches[index];
+    group_patches.clear();
+
+    for (std::size_t subtree = group.begin; subtree < group.end; ++subtree)
+        _group_reconcilers[index].diff_subtree(*_old, *_next, _subtrees[subtree].old_node, _subtrees[subtree].new_node,
+                                               group_patches);
+}
+
+void engine::ParallelReconciler::merge(vdom::PatchList &patches)
+{
+    trace::Span span("emit patches");
+    std::size_t total = _patches.size();
+    for (std::size_t index = 0; index < _groups.size(); ++index)
+        total += _group_patches[index].size();
+    patches.reserve(patches.size() + total);
+
+    std::size_t emitted = 0;
+    for (std::size_t index = 0; index < _groups.size(); ++index)
+    {
+        const Group &group = _groups[index];
+        patches.insert(patches.end(), _patches.begin() + static_cast<std::ptrdiff_t>(emitted),
+                       _patches.begin() + static_cast<std::ptrdiff_t>(group.offset));
+        patches.insert(patches.end(), _group_patches[index].begin(), _group_patches[index].end());
+        emitted = group.offset;
+    }
+    patches.insert(patches.end(), _patches.begin() + static_cast<std::ptrdiff_t>(emitted), _patches.end());
+
+    // Every group is diffed, the handles of the new tree are its own
+    if (_next)
+        _next->set_origin(0);
+    _old = nullptr;
+    _next = nullptr;
+}
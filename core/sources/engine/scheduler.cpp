@@ -0,0 +1,87 @@
+#include <algorithm>
+
+#include "engine/scheduler.hpp"
+#include "trace/tracer.hpp"
+
+bool engine::Scheduler::schedule(Id component, std::uint32_t depth, Lane lane)
+{
+    std::lock_guard lock(_mutex);
+
+    auto [it, inserted] = _indices.try_emplace(component, _pending.size());
+    if (inserted)
+    {
+        _pending.push_back({component, depth, lane});
+        _lane_sizes[static_cast<std::size_t>(lane)]++;
+        return true;
+    }
+
+    Update &update = _pending[it->second];
+    update.depth = depth;
+    if (lane < update.lane)
+    {
+        _lane_sizes[static_cast<std::size_t>(update.lane)]--;
+        _lane_sizes[static_cast<std::size_t>(lane)]++;
+        update.lane = lane;
+    }
+    return false;
+}
+
+void engine::Scheduler::erase(std::size_t index)
+{
+    // Swap with the last update, order is restored by begin_frame()
+    _indices.erase(_pending[index].component);
+    _lane_sizes[static_cast<std::size_t>(_pending[index].lane)]--;
+    if (index + 1 != _pending.size())
+    {
+        _pending[index] = _pending.back();
+        _indices[_pending[index].component] = index;
+    }
+    _pending.pop_back();
+}
+
+bool engine::Scheduler::cancel(Id component)
+{
+    std::lock_guard lock(_mutex);
+
+    auto it = _indices.find(component);
+    if (it == _indices.end())
+        return false;
+    erase(it->second);
+    return true;
+}
+
+std::span<const engine::Scheduler::Update> engine::Scheduler::begin_frame(Lane lowest)
+{
+    trace::Span span("schedule");
+    std::lock_guard lock(_mutex);
+
+    _frame.clear();
+    for (std::size_t index = _pending.size(); index-- > 0;)
+    {
+        if (_pending[index].lane > lowest)
+            continue;
+        _frame.push_back(_pending[index]);
+        erase(index);
+    }
+
+    std::sort(_frame.begin(), _frame.end(), [](const Update &left, const Update &right)
+              {
+                  if (left.depth != right.depth)
+                      return left.depth < right.depth;
+                  if (left.lane != right.lane)
+                      return left.lane < right.lane;
+                  return left.component < right.component; });
+    return _frame;
+}
+
+std::size_t engine::Scheduler::pending() const
+{
+    std::lock_guard lock(_mutex);
+    return _pending.size();
+}
+
+std::size_t engine::Scheduler::pending(Lane lane) const
+{
+    std::lock_guard lock(_mutex);
+    return _lane_sizes[static_cast<std::size_t>(lane)];
+}
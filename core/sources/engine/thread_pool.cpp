@@ -0,0 +1,120 @@
+#include "engine/thread_pool.hpp"
+
+namespace
+{
+    thread_local const engine::ThreadPool *current_pool = nullptr;
+    thread_local std::size_t current_queue = 0;
+} // namespace
+
+engine::ThreadPool::ThreadPool(std::size_t workers) : _queued(0), _stopping(false)
+{
+    // One more queue than workers, shared by the threads calling run()
+    for (std::size_t index = 0; index <= workers; ++index)
+        _queues.push_back(std::make_unique<Queue>());
+
+    _threads.reserve(workers);
+    for (std::size_t index = 0; index < workers; ++index)
+        _threads.emplace_back(&ThreadPool::work, this, index);
+}
+
+engine::ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard lock(_mutex);
+        _stopping = true;
+    }
+    _wake.notify_all();
+    for (std::thread &thread : _threads)
+        thread.join();
+}
+
+std::size_t engine::ThreadPool::own_queue() const noexcept
+{
+    return current_pool == this ? current_queue : _threads.size();
+}
+
+bool engine::ThreadPool::pop(std::size_t queue, bool back, Task &task)
+{
+    Queue &tasks = *_queues[queue];
+    std::lock_guard lock(tasks.mutex);
+
+    if (tasks.tasks.empty())
+        return false;
+    if (back)
+    {
+        task = tasks.tasks.back();
+        tasks.tasks.pop_back();
+    }
+    else
+    {
+        task = tasks.tasks.front();
+        tasks.tasks.pop_front();
+    }
+    _queued.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool engine::ThreadPool::run_one()
+{
+    if (_queued.load(std::memory_order_relaxed) == 0)
+        return false;
+
+    // Own queue from the back (most recent, cache-warm), then steal the oldest tasks of the others
+    const std::size_t own = own_queue();
+    Task task;
+    bool found = pop(own, true, task);
+    for (std::size_t offset = 1; !found && offset < _queues.size(); ++offset)
+        found = pop((own + offset) % _queues.size(), false, task);
+    if (!found)
+        return false;
+
+    Batch &batch = *task.batch;
+    try
+    {
+        batch.run(batch.context, task.index);
+    }
+    catch (...)
+    {
+        std::lock_guard lock(batch.mutex);
+        if (!batch.exception)
+            batch.exception = std::current_exception();
+    }
+    batch.remaining.fetch_sub(1, std::memory_order_acq_rel);
+    return true;
+}
+
+void engine::ThreadPool::work(std::size_t index)
+{
+    current_pool = this;
+    current_queue = index;
+
+    for (;;)
+    {
+        if (run_one())
+            continue;
+
+        std::unique_lock lock(_mutex);
+        _wake.wait(lock, [this]
+                   { return _stopping || _queued.load(std::memory_order_relaxed) != 0; });
+        if (_stopping)
+            return;
+    }
+}
+
+void engine::ThreadPool::submit(Batch &batch, std::size_t count)
+{
+    // Deal the tasks round-robin so that every worker starts with local work
+    for (std::size_t index = 0; index < count; ++index)
+    {
+        Queue &queue = *_queues[index % _queues.size()];
+        std::lock_guard lock(queue.mutex);
+        queue.tasks.push_back({&batch, index});
+        _queued.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    {
+        // Pairs with the predicate check of sleeping workers, so that no wakeup is lost
+        std::lock_guard lock(_mutex);
+    }
+    _wake.notify_all();
+}
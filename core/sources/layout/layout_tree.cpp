@@ -0,0 +1,519 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "layout/layout_tree.hpp"
+#include "trace/tracer.hpp"
+
+namespace
+{
+    bool defined(float length) noexcept
+    {
+        return !std::isnan(length);
+    }
+
+    float shrink_by(float length, float amount) noexcept
+    {
+        return defined(length) ? std::max(0.0f, length - amount) : length;
+    }
+
+    bool same(float left, float right) noexcept
+    {
+        return left == right || (std::isnan(left) && std::isnan(right));
+    }
+
+    std::string_view text_of(const vdom::Value &value) noexcept
+    {
+        return value.type() == vdom::Value::Type::String ? value.as_string() : std::string_view();
+    }
+
+    layout::Align align_of(const layout::Style &parent, const layout::Style &child) noexcept
+    {
+        return child.align_self == layout::Align::Auto ? parent.align_items : child.align_self;
+    }
+} // namespace
+
+bool layout::LayoutTree::Constraint::operator==(const Constraint &other) const noexcept
+{
+    return exact_width == other.exact_width && exact_height == other.exact_height &&
+           same(width, other.width) && same(height, other.height);
+}
+
+layout::LayoutTree::LayoutTree(vdom::AtomTable &atoms)
+    : _styles(atoms), _measure(default_measure), _root(null_index)
+{
+}
+
+layout::Size layout::LayoutTree::default_measure(std::string_view text, float max_width)
+{
+    constexpr float character_width = 8;
+    constexpr float line_height = 16;
+
+    // Count code points, not bytes
+    std::size_t characters = std::count_if(text.begin(), text.end(), [](char byte)
+                                           { return (static_cast<unsigned char>(byte) & 0xC0) != 0x80; });
+    if (characters == 0)
+        return {0, 0};
+
+    const float width = static_cast<float>(characters) * character_width;
+    if (!defined(max_width) || width <= max_width)
+        return {width, line_height};
+
+    const std::size_t per_line = std::max<std::size_t>(1, static_cast<std::size_t>(max_width / character_width));
+    const std::size_t lines = (characters + per_line - 1) / per_line;
+    return {static_cast<float>(per_line) * character_width, static_cast<float>(lines) * line_height};
+}
+
+void layout::LayoutTree::set_measure(Measure measure)
+{
+    _measure = std::move(measure);
+    for (const auto &[handle, index] : _indices)
+    {
+        if (_nodes[index].kind == vdom::NodeKind::Text)
+            mark_dirty(index);
+    }
+}
+
+layout::LayoutTree::Index layout::LayoutTree::find(vdom::Handle handle) const
+{
+    auto it = _indices.find(handle);
+    if (it == _indices.end())
+        throw std::out_of_range("Unknown node handle " + std::to_string(handle));
+    return it->second;
+}
+
+layout::LayoutTree::Index layout::LayoutTree::allocate(vdom::Handle handle, vdom::NodeKind kind)
+{
+    Index index;
+    if (!_free.empty())
+    {
+        index = _free.back();
+        _free.pop_back();
+    }
+    else
+    {
+        index = static_cast<Index>(_nodes.size());
+        _nodes.emplace_back();
+    }
+
+    Node &node = _nodes[index];
+    node.handle = handle;
+    node.kind = kind;
+    node.style = Style();
+    node.text.clear();
+    node.parent = node.first_child = node.last_child = null_index;
+    node.previous_sibling = node.next_sibling = null_index;
+    node.dirty = true;
+    node.laid_out = false;
+    node.box = Box();
+    node.measurement_count = 0;
+    node.next_measurement = 0;
+    _indices[handle] = index;
+    return index;
+}
+
+void layout::LayoutTree::detach(Index index) noexcept
+{
+    Node &node = _nodes[index];
+    if (node.parent == null_index)
+    {
+        if (_root == index)
+            _root = null_index;
+        return;
+    }
+
+    Node &parent = _nodes[node.parent];
+    (node.previous_sibling != null_index ? _nodes[node.previous_sibling].next_sibling : parent.first_child) = node.next_sibling;
+    (node.next_sibling != null_index ? _nodes[node.next_sibling].previous_sibling : parent.last_child) = node.previous_sibling;
+    node.parent = null_index;
+    node.previous_sibling = null_index;
+    node.next_sibling = null_index;
+}
+
+void layout::LayoutTree::attach(Index index, Index parent_index, Index before) noexcept
+{
+    if (parent_index == null_index)
+    {
+        _root = index;
+        return;
+    }
+
+    Node &node = _nodes[index];
+    Node &parent = _nodes[parent_index];
+    node.parent = parent_index;
+    node.next_sibling = before;
+    node.previous_sibling = before != null_index ? _nodes[before].previous_sibling : parent.last_child;
+    (node.previous_sibling != null_index ? _nodes[node.previous_sibling].next_sibling : parent.first_child) = index;
+    (before != null_index ? _nodes[before].previous_sibling : parent.last_child) = index;
+}
+
+void layout::LayoutTree::erase(Index index)
+{
+    std::vector<Index> pending{index};
+    while (!pending.empty())
+    {
+        Index current = pending.back();
+        pending.pop_back();
+        for (Index child = _nodes[current].first_child; child != null_index; child = _nodes[child].next_sibling)
+            pending.push_back(child);
+        _indices.erase(_nodes[current].handle);
+        _nodes[current].text.clear();
+        _free.push_back(current);
+    }
+}
+
+void layout::LayoutTree::mark_dirty(Index index) noexcept
+{
+    // Ancestors of a dirty node are dirty, the walk stops at the first one
+    while (index != null_index)
+    {
+        Node &node = _nodes[index];
+        node.measurement_count = 0;
+        if (node.dirty)
+            break;
+        node.dirty = true;
+        index = node.parent;
+    }
+}
+
+void layout::LayoutTree::apply(const vdom::PatchList &patches)
+{
+    for (const vdom::Patch &patch : patches)
+    {
+        switch (patch.type)
+        {
+        case vdom::PatchType::Create:
+        {
+            Index parent = patch.parent != vdom::null_handle ? find(patch.parent) : null_index;
+            Index before = patch.before != vdom::null_handle ? find(patch.before) : null_index;
+            Index index = allocate(patch.node, patch.kind);
+            if (patch.kind == vdom::NodeKind::Text)
+                _nodes[index].text = text_of(patch.value);
+            attach(index, parent, before);
+            mark_dirty(parent);
+            break;
+        }
+        case vdom::PatchType::Remove:
+        {
+            Index index = find(patch.node);
+            Index parent = _nodes[index].parent;
+            detach(index);
+            erase(index);
+            mark_dirty(parent);
+            break;
+        }
+        case vdom::PatchType::Move:
+        {
+            Index index = find(patch.node);
+            Index parent = patch.parent != vdom::null_handle ? find(patch.parent) : null_index;
+            Index before = patch.before != vdom::null_handle ? find(patch.before) : null_index;
+            mark_dirty(_nodes[index].parent);
+            detach(index);
+            attach(index, parent, before);
+            mark_dirty(parent);
+            break;
+        }
+        case vdom::PatchType::SetProperty:
+        case vdom::PatchType::RemoveProperty:
+        {
+            StyleTable::Field field = _styles.field(patch.name);
+            if (field == StyleTable::Field::None)
+                break;
+            Index index = find(patch.node);
+            StyleTable::set(_nodes[index].style, field, patch.type == vdom::PatchType::SetProperty ? patch.value : vdom::Value());
+            mark_dirty(index);
+            break;
+        }
+        case vdom::PatchType::SetText:
+        {
+            Index index = find(patch.node);
+            _nodes[index].text = text_of(patch.value);
+            mark_dirty(index);
+            break;
+        }
+        }
+    }
+}
+
+void layout::LayoutTree::compute(float width, float height)
+{
+    trace::Span span("layout");
+    if (_root == null_index)
+        return;
+
+    layout(_root, {width, height, true, true}, true);
+    _nodes[_root].box.x = 0;
+    _nodes[_root].box.y = 0;
+}
+
+layout::Size layout::LayoutTree::layout(Index index, const Constraint &constraint, bool perform)
+{
+    Node &node = _nodes[index];
+    if (!node.dirty && node.laid_out && node.constraint == constraint)
+        return {node.box.width, node.box.height};
+
+    // Measurements are dropped when the node gets dirty, so they stay valid until then
+    if (!perform)
+    {
+        for (std::size_t slot = 0; slot < node.measurement_count; ++slot)
+        {
+            if (node.measurements[slot].constraint == constraint)
+                return node.measurements[slot].size;
+        }
+    }
+
+    _statistics.layouts++;
+    Size size = node.kind == vdom::NodeKind::Text ? layout_text(node, constraint) : layout_element(index, constraint, perform);
+
+    if (perform)
+    {
+        node.box.width = size.width;
+        node.box.height = size.height;
+        node.constraint = constraint;
+        node.laid_out = true;
+        node.dirty = false;
+    }
+    else
+    {
+        node.measurements[node.next_measurement] = {constraint, size};
+        node.next_measurement = static_cast<std::uint8_t>((node.next_measurement + 1) % measurement_slots);
+        node.measurement_count = static_cast<std::uint8_t>(std::min<std::size_t>(node.measurement_count + 1, measurement_slots));
+    }
+    return size;
+}
+
+layout::Size layout::LayoutTree::layout_text(Node &node, const Constraint &constraint)
+{
+    _statistics.measurements++;
+    Size size = _measure(node.text, constraint.width);
+    if (constraint.exact_width)
+        size.width = constraint.width;
+    if (constraint.exact_height)
+        size.height = constraint.height;
+    return size;
+}
+
+layout::Size layout::LayoutTree::layout_element(Index index, const Constraint &constraint, bool perform)
+{
+    // Children are laid out recursively, but no node is added or removed meanwhile, so references stay valid
+    const Node &node = _nodes[index];
+    const Style &style = node.style;
+    const bool row = style.direction == Direction::Row;
+
+    auto make_constraint = [row](float main, bool exact_main, float cross, bool exact_cross) -> Constraint
+    {
+        if (row)
+            return {main, cross, exact_main, exact_cross};
+        return {cross, main, exact_cross, exact_main};
+    };
+    auto main_of = [row](Size size)
+    { return row ? size.width : size.height; };
+    auto cross_of = [row](Size size)
+    { return row ? size.height : size.width; };
+
+    // The size of the node itself: what the parent imposes, then its style, else its content
+    const float width = constraint.exact_width ? constraint.width : style.width;
+    const float height = constraint.exact_height ? constraint.height : style.height;
+    const float padding_width = style.padding.left + style.padding.right;
+    const float padding_height = style.padding.top + style.padding.bottom;
+
+    // The room left to children, at most the constraint when the size is not definite
+    const float available_width = shrink_by(defined(width) ? width : constraint.width, padding_width);
+    const float available_height = shrink_by(defined(height) ? height : constraint.height, padding_height);
+
+    const bool definite_main = defined(row ? width : height);
+    const bool definite_cross = defined(row ? height : width);
+    const float available_main = row ? available_width : available_height;
+    const float available_cross = row ? available_height : available_width;
+    const float padding_main_start = row ? style.padding.left : style.padding.top;
+    const float padding_cross_start = row ? style.padding.top : style.padding.left;
+
+    auto margin_main = [row](const Style &child)
+    { return row ? child.margin.left + child.margin.right : child.margin.top + child.margin.bottom; };
+    auto margin_cross = [row](const Style &child)
+    { return row ? child.margin.top + child.margin.bottom : child.margin.left + child.margin.right; };
+
+    // Stretched children without a cross size of their own fill the definite cross size of the container
+    auto cross_constraint = [&](const Style &child, float cross_size, bool definite) -> std::pair<float, bool>
+    {
+        const float own = row ? child.height : child.width;
+        const float room = shrink_by(cross_size, margin_cross(child));
+        return {room, definite && align_of(style, child) == Align::Stretch && !defined(own)};
+    };
+
+    // Flex basis of each child: its basis, its main size, or its content
+    const std::size_t first = _items.size();
+    float used_main = 0;
+    float total_grow = 0;
+    float total_scaled_shrink = 0;
+    for (Index child = node.first_child; child != null_index; child = _nodes[child].next_sibling)
+    {
+        const Style &child_style = _nodes[child].style;
+        float basis = defined(child_style.basis) ? child_style.basis : (row ? child_style.width : child_style.height);
+        if (!defined(basis))
+        {
+            auto [cross, exact_cross] = cross_constraint(child_style, available_cross, definite_cross);
+            const float room = shrink_by(available_main, margin_main(child_style));
+            basis = main_of(layout(child, make_constraint(room, false, cross, exact_cross), false));
+        }
+
+        _items.push_back({child, basis, basis, 0});
+        used_main += basis + margin_main(child_style);
+        total_grow += child_style.grow;
+        total_scaled_shrink += child_style.shrink * basis;
+    }
+
+    const std::size_t count = _items.size() - first;
+    const float gaps = count > 1 ? style.gap * static_cast<float>(count - 1) : 0;
+    used_main += gaps;
+
+    // Grow into free space or shrink out of overflow, only along a bounded main axis
+    float content_main = used_main;
+    if (definite_main)
+        content_main = available_main;
+    else if (defined(available_main))
+        content_main = std::min(used_main, available_main);
+
+    const float free_main = content_main - used_main;
+    for (std::size_t item = first; item < _items.size(); ++item)
+    {
+        const Style &child_style = _nodes[_items[item].node].style;
+        if (free_main > 0 && total_grow > 0)
+            _items[item].main += free_main * child_style.grow / total_grow;
+        else if (free_main < 0 && total_scaled_shrink > 0)
+            _items[item].main = std::max(0.0f, _items[item].main + free_main * child_style.shrink * _items[item].basis / total_scaled_shrink);
+    }
+
+    // Lay out each child at its final main size
+    float content_cross = 0;
+    for (std::size_t item = first; item < _items.size(); ++item)
+    {
+        const Index child = _items[item].node;
+        const Style &child_style = _nodes[child].style;
+        auto [cross, exact_cross] = cross_constraint(child_style, available_cross, definite_cross);
+        Size size = layout(child, make_constraint(_items[item].main, true, cross, exact_cross), perform);
+        _items[item].main = main_of(size);
+        _items[item].cross = cross_of(size);
+        content_cross = std::max(content_cross, _items[item].cross + margin_cross(child_style));
+    }
+
+    if (definite_cross)
+        content_cross = available_cross;
+    else if (defined(available_cross))
+        content_cross = std::min(content_cross, available_cross);
+
+    const float main_size = definite_main ? (row ? width : height) : content_main + (row ? padding_width : padding_height);
+    const float cross_size = definite_cross ? (row ? height : width) : content_cross + (row ? padding_height : padding_width);
+
+    if (perform)
+    {
+        // Stretch children across a cross size known only now
+        if (!definite_cross)
+        {
+            for (std::size_t item = first; item < _items.size(); ++item)
+            {
+                const Index child = _items[item].node;
+                const Style &child_style = _nodes[child].style;
+                auto [cross, exact_cross] = cross_constraint(child_style, content_cross, true);
+                if (!exact_cross)
+                    continue;
+                Size size = layout(child, make_constraint(_items[item].main, true, cross, true), true);
+                _items[item].cross = cross_of(size);
+            }
+        }
+
+        float placed_main = gaps;
+        for (std::size_t item = first; item < _items.size(); ++item)
+            placed_main += _items[item].main + margin_main(_nodes[_items[item].node].style);
+
+        const float remaining = std::max(0.0f, content_main - placed_main);
+        float leading = 0;
+        float between = 0;
+        switch (style.justify_content)
+        {
+        case Justify::Start:
+            break;
+        case Justify::Center:
+            leading = remaining / 2;
+            break;
+        case Justify::End:
+            leading = remaining;
+            break;
+        case Justify::SpaceBetween:
+            between = count > 1 ? remaining / static_cast<float>(count - 1) : 0;
+            break;
+        case Justify::SpaceAround:
+            between = count ? remaining / static_cast<float>(count) : 0;
+            leading = between / 2;
+            break;
+        case Justify::SpaceEvenly:
+            between = remaining / static_cast<float>(count + 1);
+            leading = between;
+            break;
+        }
+
+        float position = padding_main_start + leading;
+        for (std::size_t item = first; item < _items.size(); ++item)
+        {
+            Node &child = _nodes[_items[item].node];
+            const Style &child_style = child.style;
+            const float margin_main_start = row ? child_style.margin.left : child_style.margin.top;
+            const float margin_cross_start = row ? child_style.margin.top : child_style.margin.left;
+            const float free_cross = content_cross - _items[item].cross - margin_cross(child_style);
+
+            float offset = 0;
+            switch (align_of(style, child_style))
+            {
+            case Align::Center:
+                offset = free_cross / 2;
+                break;
+            case Align::End:
+                offset = free_cross;
+                break;
+            default:
+                break;
+            }
+
+            const float main_position = position + margin_main_start;
+            const float cross_position = padding_cross_start + margin_cross_start + offset;
+            child.box.x = row ? main_position : cross_position;
+            child.box.y = row ? cross_position : main_position;
+            position += _items[item].main + margin_main(child_style) + style.gap + between;
+        }
+    }
+
+    _items.resize(first);
+    return row ? Size{main_size, cross_size} : Size{cross_size, main_size};
+}
+
+const layout::Box *layout::LayoutTree::box(vdom::Handle handle) const
+{
+    auto it = _indices.find(handle);
+    return it != _indices.end() ? &_nodes[it->second].box : nullptr;
+}
+
+layout::Box layout::LayoutTree::absolute_box(vdom::Handle handle) const
+{
+    Index index = find(handle);
+    Box box = _nodes[index].box;
+    for (Index parent = _nodes[index].parent; parent != null_index; parent = _nodes[parent].parent)
+    {
+        box.x += _nodes[parent].box.x;
+        box.y += _nodes[parent].box.y;
+    }
+    return box;
+}
+
+bool layout::LayoutTree::dirty(vdom::Handle handle) const
+{
+    return _nodes[find(handle)].dirty;
+}
+
+void layout::LayoutTree::clear() noexcept
+{
+    _nodes.clear();
+    _free.clear();
+    _indices.clear();
+    _items.clear();
+    _root = null_index;
+}
@@ -0,0 +1,106 @@
+#include <algorithm>
+#include <bit>
+
+#include "layout/row_index.hpp"
+
+namespace
+{
+    std::size_t lowbit(std::size_t index) noexcept
+    {
+        return index & (~index + 1);
+    }
+} // namespace
+
+layout::RowIndex::RowIndex(std::size_t count, float estimated_height)
+    : _heights(count, estimated_height), _estimated_height(estimated_height)
+{
+    rebuild();
+}
+
+void layout::RowIndex::rebuild()
+{
+    // Each entry hands its sum on to the next entry covering it, in O(n)
+    const std::size_t count = _heights.size();
+    _tree.assign(count + 1, 0);
+    for (std::size_t index = 1; index <= count; ++index)
+    {
+        _tree[index] += _heights[index - 1];
+        const std::size_t parent = index + lowbit(index);
+        if (parent <= count)
+            _tree[parent] += _tree[index];
+    }
+}
+
+void layout::RowIndex::add(std::size_t row, double delta) noexcept
+{
+    for (std::size_t index = row + 1; index < _tree.size(); index += lowbit(index))
+        _tree[index] += delta;
+}
+
+void layout::RowIndex::resize(std::size_t count)
+{
+    const std::size_t previous = _heights.size();
+    _heights.resize(count, _estimated_height);
+
+    // Entries of the remaining rows only cover rows before them, so shrinking needs no update
+    if (count <= previous)
+    {
+        _tree.resize(count + 1);
+        return;
+    }
+    if (count - previous > previous)
+    {
+        rebuild();
+        return;
+    }
+
+    _tree.resize(count + 1);
+    for (std::size_t index = previous + 1; index <= count; ++index)
+        _tree[index] = offset(index - 1) - offset(index - lowbit(index)) + _heights[index - 1];
+}
+
+void layout::RowIndex::set_height(std::size_t row, float height) noexcept
+{
+    const double delta = static_cast<double>(height) - _heights[row];
+    _heights[row] = height;
+    if (delta != 0)
+        add(row, delta);
+}
+
+double layout::RowIndex::offset(std::size_t row) const noexcept
+{
+    double sum = 0;
+    for (std::size_t index = std::min(row, size()); index > 0; index -= lowbit(index))
+        sum += _tree[index];
+    return sum;
+}
+
+std::size_t layout::RowIndex::row_at(double offset) const noexcept
+{
+    const std::size_t count = size();
+    if (count == 0)
+        return 0;
+
+    // Descend from the largest power of two, skipping every block that ends at or above offset
+    std::size_t position = 0;
+    for (std::size_t step = std::bit_floor(count); step > 0; step >>= 1)
+    {
+        if (position + step <= count && _tree[position + step] <= offset)
+        {
+            position += step;
+            offset -= _tree[position];
+        }
+    }
+    return std::min(position, count - 1);
+}
+
+layout::RowIndex::Window layout::RowIndex::window(double scroll, double viewport, std::size_t overscan) const noexcept
+{
+    const std::size_t count = size();
+    if (count == 0)
+        return {};
+
+    const std::size_t first = row_at(std::max(scroll, 0.0));
+    const std::size_t last = row_at(std::max(scroll, 0.0) + std::max(viewport, 0.0)) + 1;
+    return {first > overscan ? first - overscan : 0, std::min(count, last + overscan)};
+}
@@ -0,0 +1,177 @@
+#include <charconv>
+#include <string_view>
+#include <utility>
+
+#include "layout/style.hpp"
+
+namespace
+{
+    float to_length(const vdom::Value &value, float fallback) noexcept
+    {
+        switch (value.type())
+        {
+        case vdom::Value::Type::Integer:
+            return static_cast<float>(value.as_integer());
+        case vdom::Value::Type::Float:
+            return static_cast<float>(value.as_float());
+        case vdom::Value::Type::String:
+        {
+            std::string_view text = value.as_string();
+            float length = 0;
+            auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), length);
+            std::string_view unit(end, text.data() + text.size() - end);
+            if (error != std::errc() || (!unit.empty() && unit != "px"))
+                return fallback;
+            return length;
+        }
+        default:
+            return fallback;
+        }
+    }
+
+    std::string_view to_keyword(const vdom::Value &value) noexcept
+    {
+        if (value.type() != vdom::Value::Type::String)
+            return {};
+        std::string_view keyword = value.as_string();
+        if (keyword.starts_with("flex-"))
+            keyword.remove_prefix(5);
+        return keyword;
+    }
+
+    layout::Justify to_justify(const vdom::Value &value) noexcept
+    {
+        std::string_view keyword = to_keyword(value);
+        if (keyword == "center")
+            return layout::Justify::Center;
+        if (keyword == "end")
+            return layout::Justify::End;
+        if (keyword == "space-between")
+            return layout::Justify::SpaceBetween;
+        if (keyword == "space-around")
+            return layout::Justify::SpaceAround;
+        if (keyword == "space-evenly")
+            return layout::Justify::SpaceEvenly;
+        return layout::Justify::Start;
+    }
+
+    layout::Align to_align(const vdom::Value &value, layout::Align fallback) noexcept
+    {
+        std::string_view keyword = to_keyword(value);
+        if (keyword == "stretch")
+            return layout::Align::Stretch;
+        if (keyword == "start")
+            return layout::Align::Start;
+        if (keyword == "center")
+            return layout::Align::Center;
+        if (keyword == "end")
+            return layout::Align::End;
+        return fallback;
+    }
+} // namespace
+
+layout::StyleTable::StyleTable(vdom::AtomTable &atoms)
+{
+    const std::pair<const char *, Field> names[] = {
+        {"flex-direction", Field::Direction},
+        {"flex-grow", Field::Grow},
+        {"flex-shrink", Field::Shrink},
+        {"flex-basis", Field::Basis},
+        {"width", Field::Width},
+        {"height", Field::Height},
+        {"gap", Field::Gap},
+        {"padding", Field::Padding},
+        {"padding-left", Field::PaddingLeft},
+        {"padding-top", Field::PaddingTop},
+        {"padding-right", Field::PaddingRight},
+        {"padding-bottom", Field::PaddingBottom},
+        {"margin", Field::Margin},
+        {"margin-left", Field::MarginLeft},
+        {"margin-top", Field::MarginTop},
+        {"margin-right", Field::MarginRight},
+        {"margin-bottom", Field::MarginBottom},
+        {"justify-content", Field::JustifyContent},
+        {"align-items", Field::AlignItems},
+        {"align-self", Field::AlignSelf},
+    };
+
+    // Atoms are dense, so fields are looked up by indexing
+    for (const auto &[name, field] : names)
+    {
+        vdom::Atom atom = atoms.intern(name);
+        if (atom >= _fields.size())
+            _fields.resize(atom + 1, Field::None);
+        _fields[atom] = field;
+    }
+}
+
+void layout::StyleTable::set(Style &style, Field field, const vdom::Value &value) noexcept
+{
+    const Style defaults;
+
+    switch (field)
+    {
+    case Field::None:
+        break;
+    case Field::Direction:
+        style.direction = to_keyword(value) == "row" ? Direction::Row : Direction::Column;
+        break;
+    case Field::Grow:
+        style.grow = to_length(value, defaults.grow);
+        break;
+    case Field::Shrink:
+        style.shrink = to_length(value, defaults.shrink);
+        break;
+    case Field::Basis:
+        style.basis = to_length(value, defaults.basis);
+        break;
+    case Field::Width:
+        style.width = to_length(value, defaults.width);
+        break;
+    case Field::Height:
+        style.height = to_length(value, defaults.height);
+        break;
+    case Field::Gap:
+        style.gap = to_length(value, defaults.gap);
+        break;
+    case Field::Padding:
+        style.padding.left = style.padding.top = style.padding.right = style.padding.bottom = to_length(value, 0);
+        break;
+    case Field::PaddingLeft:
+        style.padding.left = to_length(value, 0);
+        break;
+    case Field::PaddingTop:
+        style.padding.top = to_length(value, 0);
+        break;
+    case Field::PaddingRight:
+        style.padding.right = to_length(value, 0);
+        break;
+    case Field::PaddingBottom:
+        style.padding.bottom = to_length(value, 0);
+        break;
+    case Field::Margin:
+        style.margin.left = style.margin.top = style.margin.right = style.margin.bottom = to_length(value, 0);
+        break;
+    case Field::MarginLeft:
+        style.margin.left = to_length(value, 0);
+        break;
+    case Field::MarginTop:
+        style.margin.top = to_length(value, 0);
+        break;
+    case Field::MarginRight:
+        style.margin.right = to_length(value, 0);
+        break;
+    case Field::MarginBottom:
+        style.margin.bottom = to_length(value, 0);
+        break;
+    case Field::JustifyContent:
+        style.justify_content = to_justify(value);
+        break;
+    case Field::AlignItems:
+        style.align_items = to_align(value, defaults.align_items);
+        break;
+    case Field::AlignSelf:
+        style.align_self = to_align(value, defaults.align_self);
+        break;
+    }
+}
@@ -0,0 +1,105 @@
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+#include "memory/arena.hpp"
+
+namespace
+{
+    constexpr std::size_t header_size = 64;
+} // namespace
+
+memory::Arena::Arena(std::size_t initial_size, std::pmr::memory_resource *upstream)
+    : _upstream(upstream), _chunks(nullptr), _cursor(nullptr), _end(nullptr),
+      _chunk_size(std::max<std::size_t>(initial_size, header_size * 2))
+{
+}
+
+memory::Arena::~Arena()
+{
+    release_chunks();
+}
+
+void memory::Arena::add_chunk(std::size_t minimum_size)
+{
+    std::size_t size = std::max(_chunk_size, minimum_size + header_size);
+    void *memory = _upstream->allocate(size, alignof(std::max_align_t));
+
+    Chunk *chunk = static_cast<Chunk *>(memory);
+    chunk->next = _chunks;
+    chunk->size = size;
+    _chunks = chunk;
+    _cursor = static_cast<std::byte *>(memory) + header_size;
+    _end = static_cast<std::byte *>(memory) + size;
+
+    _statistics.bytes_reserved += size;
+    _statistics.upstream_allocations++;
+    // Geometric growth keeps the number of chunks per frame logarithmic
+    _chunk_size = size * 2;
+}
+
+void memory::Arena::release_chunks() noexcept
+{
+    while (_chunks)
+    {
+        Chunk *next = _chunks->next;
+        _upstream->deallocate(_chunks, _chunks->size, alignof(std::max_align_t));
+        _chunks = next;
+    }
+    _cursor = nullptr;
+    _end = nullptr;
+    _statistics.bytes_reserved = 0;
+}
+
+void *memory::Arena::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+    auto aligned = [&]()
+    {
+        std::uintptr_t address = reinterpret_cast<std::uintptr_t>(_cursor);
+        return reinterpret_cast<std::byte *>((address + alignment - 1) & ~(static_cast<std::uintptr_t>(alignment) - 1));
+    };
+
+    std::byte *pointer = _cursor ? aligned() : nullptr;
+    if (!pointer || pointer + bytes > _end)
+    {
+        add_chunk(bytes + alignment);
+        pointer = aligned();
+    }
+
+    _cursor = pointer + bytes;
+    _statistics.bytes_allocated += bytes;
+    _statistics.allocations++;
+    _statistics.peak_bytes_allocated = std::max(_statistics.peak_bytes_allocated, _statistics.bytes_allocated);
+    return pointer;
+}
+
+void memory::Arena::do_deallocate(void *, std::size_t, std::size_t)
+{
+}
+
+bool memory::Arena::do_is_equal(const std::pmr::memory_resource &other) const noexcept
+{
+    return this == &other;
+}
+
+void memory::Arena::reset()
+{
+    _statistics.frames++;
+    _statistics.bytes_allocated = 0;
+    _statistics.allocations = 0;
+
+    if (!_chunks)
+        return;
+
+    if (_chunks->next)
+    {
+        // The frame overflowed the first chunk: replace all chunks by one that fits it
+        std::size_t total = _statistics.bytes_reserved;
+        release_chunks();
+        _chunk_size = total;
+        add_chunk(total - header_size);
+        return;
+    }
+
+    _cursor = reinterpret_cast<std::byte *>(_chunks) + header_size;
+}
@@ -0,0 +1,178 @@
+#include "python/event_table.hpp"
+#include "python/interpreter_types.hpp"
+#include "trace/tracer.hpp"
+
+namespace
+{
+    PyStructSequence_Field event_fields[] = {
+        {"type", "The event type, e.g. 'click'"},
+        {"target", "The handle of the node the event happened on"},
+        {"current_target", "The handle of the node whose handler is called"},
+        {"x", "Horizontal position or offset"},
+        {"y", "Vertical position or offset"},
+        {"detail", "Button, key code or other integer payload"},
+        {nullptr, nullptr}};
+
+    PyStructSequence_Desc event_description = {
+        "component_engine.Event",
+        "Event(type, target, current_target, x, y, detail)\n--\n\nAn input event, as passed to handlers.",
+        event_fields,
+        6};
+
+    PyObject *create_event_type()
+    {
+        return reinterpret_cast<PyObject *>(PyStructSequence_NewType(&event_description));
+    }
+} // namespace
+
+python::EventTable::EventTable(vdom::AtomTable &atoms)
+    : _atoms(atoms), _next(0), _dispatching(false)
+{
+    for (const char *type : {"pointermove", "mousemove", "scroll"})
+        _queue.coalesce(_atoms.intern(type));
+}
+
+void python::EventTable::apply(const vdom::PatchList &patches, const vdom::Tree &mounted)
+{
+    for (const vdom::Patch &patch : patches)
+    {
+        switch (patch.type)
+        {
+        case vdom::PatchType::Create:
+        case vdom::PatchType::Move:
+            _parents[patch.node] = patch.parent;
+            break;
+        case vdom::PatchType::Remove:
+            // Descendants keep stale entries, which bubbling never reaches past their removed ancestor
+            _parents.erase(patch.node);
+            break;
+        default:
+            break;
+        }
+    }
+
+    // Drop the stale entries once they outnumber the live ones
+    if (_parents.size() > 2 * mounted.size() + 64)
+        reset(mounted);
+}
+
+void python::EventTable::reset(const vdom::Tree &mounted)
+{
+    _parents.clear();
+    _parents.reserve(mounted.size());
+    for (vdom::NodeId node = 0; node < mounted.size(); ++node)
+    {
+        const vdom::NodeId parent = mounted.parent(node);
+        _parents.emplace(mounted.handle(node), parent != vdom::null_node ? mounted.handle(parent) : vdom::null_handle);
+    }
+}
+
+void python::EventTable::bind(const vdom::Tree &mounted, std::span<const TreeBuilder::Handler> handlers)
+{
+    // Swap first: releasing the previous handlers may run arbitrary Python code
+    std::unordered_map<Key, Object, KeyHash> previous;
+    previous.swap(_handlers);
+    _handlers.reserve(handlers.size());
+    for (const TreeBuilder::Handler &handler : handlers)
+        _handlers.insert_or_assign(Key{handler.type, mounted.handle(handler.node)}, handler.callback.share());
+}
+
+PyObject *python::EventTable::type_name(vdom::Atom type)
+{
+    auto it = _type_names.find(type);
+    if (it == _type_names.end())
+    {
+        const std::string_view name = _atoms.name(type);
+        it = _type_names.emplace(type, Object(PyUnicode_FromStringAndSize(name.data(), static_cast<Py_ssize_t>(name.size())))).first;
+    }
+    return it->second.get();
+}
+
+python::Object python::EventTable::make_event(const engine::Event &event, PyObject *type, vdom::Handle current_target)
+{
+    PyTypeObject *result_type = event_type();
+    if (!result_type)
+        Object::throw_error_occurred();
+    Object result(PyStructSequence_New(result_type));
+    PyObject *items[] = {Py_NewRef(type), PyLong_FromUnsignedLongLong(event.target),
+                         PyLong_FromUnsignedLongLong(current_target), PyFloat_FromDouble(event.x),
+                         PyFloat_FromDouble(event.y), PyLong_FromLongLong(event.detail)};
+    for (Py_ssize_t index = 0; index < 6; ++index)
+    {
+        // Set even when null, so that the event owns and releases every item
+        PyStructSequence_SetItem(result.get(), index, items[index]);
+        if (!items[index])
+            Object::throw_error_occurred();
+    }
+    return result;
+}
+
+std::size_t python::EventTable::dispatch()
+{
+    if (_dispatching)
+        return 0;
+
+    _dispatching = true;
+    struct Guard
+    {
+        bool &dispatching;
+        ~Guard() { dispatching = false; }
+    } guard{_dispatching};
+
+    if (_next == _batch.size())
+    {
+        _queue.drain(_batch);
+        _next = 0;
+    }
+    if (_batch.empty())
+        return 0;
+
+    trace::Span span("events");
+    std::size_t calls = 0;
+    while (_next < _batch.size())
+    {
+        const engine::Event event = _batch[_next++];
+        _statistics.events++;
+        PyObject *type = type_name(event.type);
+
+        // Handlers may remount the tree: look every node up again after a call
+        for (vdom::Handle node = event.target; node != vdom::null_handle;)
+        {
+            auto handler = _handlers.find({event.type, node});
+            if (handler != _handlers.end())
+            {
+                Object callback = handler->second.share();
+                Object argument = make_event(event, type, node);
+                Object result(PyObject_CallOneArg(callback.get(), argument.get()));
+                calls++;
+                _statistics.handlers++;
+                if (result.get() == Py_True)
+                    break;
+            }
+
+            auto parent = _parents.find(node);
+            if (parent == _parents.end())
+                break;
+            node = parent->second;
+        }
+    }
+    return calls;
+}
+
+int python::EventTable::traverse(visitproc visit, void *arg)
+{
+    for (auto &[key, handler] : _handlers)
+        Py_VISIT(handler.get());
+    return 0;
+}
+
+void python::EventTable::clear()
+{
+    std::unordered_map<Key, Object, KeyHash> previous;
+    previous.swap(_handlers);
+}
+
+PyTypeObject *python::event_type()
+{
+    return interpreter_type(create_event_type);
+}
@@ -0,0 +1,135 @@
+#include <atomic>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "python/interpreter_types.hpp"
+
+namespace
+{
+    using Create = PyObject *(*)();
+
+    const char capsule_name[] = "component_engine.types";
+
+    /**
+     * @brief The types of one interpreter, owned by a capsule of its state dictionary
+     *
+     */
+    struct Types
+    {
+        std::vector<std::pair<Create, PyObject *>> types;
+
+        PyTypeObject *find(Create create) const noexcept
+        {
+            for (const auto &[type_create, type] : types)
+            {
+                if (type_create == create)
+                    return reinterpret_cast<PyTypeObject *>(type);
+            }
+            return nullptr;
+        }
+    };
+
+    // Bumped whenever an interpreter drops its types, so that no thread trusts a cache of a finalized interpreter
+    std::atomic<std::uint64_t> generation(0);
+
+    struct Cache
+    {
+        PyInterpreterState *interpreter = nullptr;
+        std::uint64_t generation = 0;
+        Types *types = nullptr;
+    };
+
+    void destroy_types(PyObject *capsule)
+    {
+        Types *types = static_cast<Types *>(PyCapsule_GetPointer(capsule, capsule_name));
+        generation.fetch_add(1, std::memory_order_acq_rel);
+        for (const auto &[create, type] : types->types)
+            Py_DECREF(type);
+        delete types;
+    }
+
+    /**
+     * @brief Get the types of the calling thread's interpreter
+     *
+     * @param create Whether to make the table if missing; failures then set a Python error
+     * @return Types* The table, or nullptr
+     */
+    Types *interpreter_types(bool create)
+    {
+        thread_local Cache cache;
+        PyInterpreterState *interpreter = PyInterpreterState_Get();
+        const std::uint64_t current = generation.load(std::memory_order_acquire);
+        if (cache.types && cache.interpreter == interpreter && cache.generation == current)
+            return cache.types;
+
+        PyObject *dictionary = PyInterpreterState_GetDict(interpreter);
+        if (!dictionary)
+        {
+            if (create)
+                PyErr_SetString(PyExc_RuntimeError, "The interpreter has no state dictionary for the engine's types");
+            return nullptr;
+        }
+
+        Types *types = nullptr;
+        if (PyObject *capsule = PyDict_GetItemString(dictionary, capsule_name))
+        {
+            types = static_cast<Types *>(PyCapsule_GetPointer(capsule, capsule_name));
+        }
+        else if (create)
+        {
+            types = new (std::nothrow) Types();
+            if (!types)
+            {
+                PyErr_NoMemory();
+                return nullptr;
+            }
+            PyObject *capsule = PyCapsule_New(types, capsule_name, destroy_types);
+            if (!capsule)
+            {
+                delete types;
+                return nullptr;
+            }
+            const int stored = PyDict_SetItemString(dictionary, capsule_name, capsule);
+            Py_DECREF(capsule);
+            if (stored < 0)
+                return nullptr;
+        }
+        if (!types)
+            return nullptr;
+
+        cache = {interpreter, current, types};
+        return types;
+    }
+} // namespace
+
+PyTypeObject *python::interpreter_type(PyObject *(*create)())
+{
+    Types *types = interpreter_types(true);
+    if (!types)
+        return nullptr;
+    if (PyTypeObject *type = types->find(create))
+        return type;
+
+    PyObject *type = create();
+    if (!type)
+        return nullptr;
+    try
+    {
+        types->types.emplace_back(create, type);
+    }
+    catch (const std::bad_alloc &)
+    {
+        Py_DECREF(type);
+        PyErr_NoMemory();
+        return nullptr;
+    }
+    return reinterpret_cast<PyTypeObject *>(type);
+}
+
+PyTypeObject *python::existing_interpreter_type(PyObject *(*create)()) noexcept
+{
+    Types *types = interpreter_types(false);
+    return types ? types->find(create) : nullptr;
+}
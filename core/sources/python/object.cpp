@@ -1,24 +1,48 @@
 #include <stdexcept>
+#include <string>
 
 #include "python/object.hpp"
 
-python::Object::Object() : _object(nullptr)
+void python::Object::throw_error_occurred()
 {
-    Py_Initialize();
-}
+#if PY_VERSION_HEX >= 0x030C0000
+    PyObject *exception = PyErr_GetRaisedException();
+#else
+    PyObject *type = nullptr;
+    PyObject *exception = nullptr;
+    PyObject *traceback = nullptr;
+    PyErr_Fetch(&type, &exception, &traceback);
+    PyErr_NormalizeException(&type, &exception, &traceback);
+#endif
 
-python::Object::Object(PyObject *object)
-    : _object(object)
-{
-    Py_Initialize();
+    if (!exception)
+        throw std::runtime_error("A Python call failed without setting an error");
 
-    if (!_object)
-        throw std::runtime_error("Failed to create Python object");
+    // Describe the error for C++ callers, then leave it pending with its type and traceback
+    std::string message = Py_TYPE(exception)->tp_name;
+    PyObject *text = PyObject_Str(exception);
+    const char *utf8 = text ? PyUnicode_AsUTF8(text) : nullptr;
+    if (utf8 && *utf8)
+        message += std::string(": ") + utf8;
+    Py_XDECREF(text);
+    PyErr_Clear();
+
+#if PY_VERSION_HEX >= 0x030C0000
+    PyErr_SetRaisedException(exception);
+#else
+    PyErr_Restore(type, exception, traceback);
+#endif
+    throw ErrorAlreadySet(message);
 }
 
-python::Object::~Object()
+python::Object python::Object::optional_attribute(PyObject *name) const
 {
-    if (_object)
-        Py_XDECREF(_object);
-    Py_Finalize();
-}
\ No newline at end of file
+    PyObject *attribute = PyObject_GetAttr(_object, name);
+    if (!attribute)
+    {
+        if (!PyErr_ExceptionMatches(PyExc_AttributeError))
+            throw_error_occurred();
+        PyErr_Clear();
+    }
+    return steal(attribute);
+}
@@ -0,0 +1,464 @@
+#include <new>
+
+#include "python/errors.hpp"
+#include "python/interpreter_types.hpp"
+#include "python/object.hpp"
+#include "python/persistent_type.hpp"
+#include "python/value.hpp"
+
+namespace
+{
+    PyObject *create_map_type();
+    PyObject *create_vector_type();
+
+    using MapRef = vdom::Ref<const vdom::PersistentMap>;
+    using VectorRef = vdom::Ref<const vdom::PersistentVector>;
+
+    const MapRef &map_of(PyObject *self)
+    {
+        return reinterpret_cast<python::PersistentMapObject *>(self)->map;
+    }
+
+    const VectorRef &vector_of(PyObject *self)
+    {
+        return reinterpret_cast<python::PersistentVectorObject *>(self)->vector;
+    }
+
+    /**
+     * @brief Set the entries of a dict, a PersistentMap or any mapping into a map
+     *
+     */
+    MapRef update(MapRef map, PyObject *items)
+    {
+        if (python::is_persistent_map(items))
+        {
+            if (map->is_empty())
+                return map_of(items);
+            map_of(items)->for_each([&](const vdom::Value &key, const vdom::Value &value)
+                                    { map = map->set(key, value); });
+            return map;
+        }
+        if (PyDict_Check(items))
+        {
+            Py_ssize_t position = 0;
+            PyObject *key = nullptr;
+            PyObject *value = nullptr;
+            while (PyDict_Next(items, &position, &key, &value))
+                map = map->set(python::to_value(key), python::to_value(value));
+            return map;
+        }
+
+        python::Object pairs(PyMapping_Items(items));
+        for (Py_ssize_t index = 0; index < PyList_GET_SIZE(pairs.get()); ++index)
+        {
+            PyObject *pair = PyList_GET_ITEM(pairs.get(), index);
+            map = map->set(python::to_value(PyTuple_GET_ITEM(pair, 0)), python::to_value(PyTuple_GET_ITEM(pair, 1)));
+        }
+        return map;
+    }
+
+    VectorRef extend(VectorRef vector, PyObject *items)
+    {
+        python::Object iterator(PyObject_GetIter(items));
+        while (PyObject *item = PyIter_Next(iterator.get()))
+        {
+            python::Object owned = python::Object::steal(item);
+            vector = vector->push_back(python::to_value(item));
+        }
+        if (PyErr_Occurred())
+            python::Object::throw_error_occurred();
+        return vector;
+    }
+
+    /**
+     * @brief Convert an index, counting from the end when negative
+     *
+     */
+    bool parse_index(PyObject *self, PyObject *argument, std::size_t &index)
+    {
+        Py_ssize_t position = PyNumber_AsSsize_t(argument, PyExc_IndexError);
+        if (position == -1 && PyErr_Occurred())
+            return false;
+        const Py_ssize_t size = static_cast<Py_ssize_t>(vector_of(self)->size());
+        if (position < 0)
+            position += size;
+        if (position < 0 || position >= size)
+        {
+            PyErr_SetString(PyExc_IndexError, "PersistentVector index out of range");
+            return false;
+        }
+        index = static_cast<std::size_t>(position);
+        return true;
+    }
+
+    PyObject *compare(bool equal, int op)
+    {
+        return PyBool_FromLong(op == Py_EQ ? equal : !equal);
+    }
+
+    // PersistentMap
+
+    PyObject *map_new(PyTypeObject *, PyObject *args, PyObject *kwargs)
+    {
+        static const char *keywords[] = {"items", nullptr};
+        PyObject *items = nullptr;
+        if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O:PersistentMap", const_cast<char **>(keywords), &items))
+            return nullptr;
+
+        auto body = [&]
+        {
+            MapRef map = vdom::PersistentMap::empty();
+            return python::wrap(items && items != Py_None ? update(std::move(map), items) : std::move(map));
+        };
+        return python::guarded(body, PyExc_TypeError);
+    }
+
+    void map_dealloc(PyObject *self)
+    {
+        PyTypeObject *type = Py_TYPE(self);
+        reinterpret_cast<python::PersistentMapObject *>(self)->map.~MapRef();
+        type->tp_free(self);
+        Py_DECREF(type);
+    }
+
+    PyObject *map_set(PyObject *self, PyObject *const *args, Py_ssize_t nargs)
+    {
+        if (nargs != 2)
+            return PyErr_Format(PyExc_TypeError, "set() takes exactly 2 arguments (%zd given)", nargs);
+
+        auto body = [&]
+        { return python::wrap(map_of(self)->set(python::to_value(args[0]), python::to_value(args[1]))); };
+        return python::guarded(body, PyExc_TypeError);
+    }
+
+    PyObject *map_remove(PyObject *self, PyObject *key)
+    {
+        auto body = [&]
+        { return python::wrap(map_of(self)->erase(python::to_value(key))); };
+        return python::guarded(body, PyExc_TypeError);
+    }
+
+    PyObject *map_update(PyObject *self, PyObject *items)
+    {
+        auto body = [&]
+        { return python::wrap(update(map_of(self), items)); };
+        return python::guarded(body, PyExc_TypeError);
+    }
+
+    PyObject *map_get(PyObject *self, PyObject *const *args, Py_ssize_t nargs)
+    {
+        if (nargs < 1 || nargs > 2)
+            return PyErr_Format(PyExc_TypeError, "get() takes 1 or 2 arguments (%zd given)", nargs);
+
+        auto body = [&]() -> PyObject *
+        {
+            const vdom::Value *value = map_of(self)->find(python::to_value(args[0]));
+            if (value)
+                return python::from_value(*value);
+            PyObject *fallback = nargs == 2 ? args[1] : Py_None;
+            return Py_NewRef(fallback);
+        };
+        return python::guarded(body, PyExc_TypeError);
+    }
+
+    /**
+     * @brief Collect the keys, the values or (key, value) tuples into a list
+     *
+     */
+    template <typename Convert>
+    PyObject *map_list(PyObject *self, Convert convert)
+    {
+        auto body = [&]
+        {
+            python::Object list(PyList_New(static_cast<Py_ssize_t>(map_of(self)->size())));
+            Py_ssize_t index = 0;
+            map_of(self)->for_each([&](const vdom::Value &key, const vdom::Value &value)
+                                   { PyList_SET_ITEM(list.get(), index++, python::Object(convert(key, value)).release()); });
+            return list.release();
+        };
+        return python::guarded(body);
+    }
+
+    PyObject *map_keys(PyObject *self, PyObject *)
+    {
+        return map_list(self, [](const vdom::Value &key, const vdom::Value &)
+                        { return python::from_value(key); });
+    }
+
+    PyObject *map_values(PyObject *self, PyObject *)
+    {
+        return map_list(self, [](const vdom::Value &, const vdom::Value &value)
+                        { return python::from_value(value); });
+    }
+
+    PyObject *map_items(PyObject *self, PyObject *)
+    {
+        return map_list(self, [](const vdom::Value &key, const vdom::Value &value)
+                        {
+                            python::Object first(python::from_value(key));
+                            python::Object second(python::from_value(value));
+                            return PyTuple_Pack(2, first.get(), second.get()); });
+    }
+
+    Py_ssize_t map_length(PyObject *self)
+    {
+        return static_cast<Py_ssize_t>(map_of(self)->size());
+    }
+
+    PyObject *map_subscript(PyObject *self, PyObject *key)
+    {
+        auto body = [&]() -> PyObject *
+        {
+            const vdom::Value *value = map_of(self)->find(python::to_value(key));
+            if (!value)
+            {
+                PyErr_SetObject(PyExc_KeyError, key);
+                return nullptr;
+            }
+            return python::from_value(*value);
+        };
+        return python::guarded(body, PyExc_TypeError);
+    }
+
+    int map_contains(PyObject *self, PyObject *key)
+    {
+        PyObject *found = python::guarded([&]
+                                          { return PyBool_FromLong(map_of(self)->find(python::to_value(key)) != nullptr); },
+                                          PyExc_TypeError);
+        if (!found)
+            return -1;
+        const int result = found == Py_True;
+        Py_DECREF(found);
+        return result;
+    }
+
+    PyObject *map_iter(PyObject *self)
+    {
+        python::Object keys = python::Object::steal(map_keys(self, nullptr));
+        return keys ? PyObject_GetIter(keys.get()) : nullptr;
+    }
+
+    PyObject *map_richcompare(PyObject *self, PyObject *other, int op)
+    {
+        if ((op != Py_EQ && op != Py_NE) || !python::is_persistent_map(other))
+            Py_RETURN_NOTIMPLEMENTED;
+        return compare(map_of(self)->equals(*map_of(other)), op);
+    }
+
+    PyObject *map_repr(PyObject *self)
+    {
+        auto body = [&]
+        {
+            python::Object dictionary(PyDict_New());
+            map_of(self)->for_each([&](const vdom::Value &key, const vdom::Value &value)
+                                   {
+                                       python::Object first(python::from_value(key));
+                                       python::Object second(python::from_value(value));
+                                       if (PyDict_SetItem(dictionary.get(), first.get(), second.get()) < 0)
+                                           python::Object::throw_error_occurred(); });
+            return PyUnicode_FromFormat("PersistentMap(%R)", dictionary.get());
+        };
+        return python::guarded(body);
+    }
+
+    PyMethodDef map_methods[] = {
+        {"set", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)()>(map_set)), METH_FASTCALL,
+         "set(key, value)\n--\n\nReturn a version mapping key to value, or this map if it already does."},
+        {"remove", map_remove, METH_O,
+         "remove(key)\n--\n\nReturn a version without key, or this map if key is missing."},
+        {"update", map_update, METH_O,
+         "update(items)\n--\n\nReturn a version with the entries of a mapping set."},
+        {"get", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)()>(map_get)), METH_FASTCALL,
+         "get(key, default=None)\n--\n\nGet the value of key, or default when it is missing."},
+        {"keys", map_keys, METH_NOARGS, "keys()\n--\n\nA list of the keys."},
+        {"values", map_values, METH_NOARGS, "values()\n--\n\nA list of the values."},
+        {"items", map_items, METH_NOARGS, "items()\n--\n\nA list of (key, value) tuples."},
+        {nullptr, nullptr, 0, nullptr}};
+
+    PyType_Slot map_slots[] = {
+        {Py_tp_doc, const_cast<char *>("Immutable map whose updates return new versions sharing structure.")},
+        {Py_tp_new, reinterpret_cast<void *>(map_new)},
+        {Py_tp_dealloc, reinterpret_cast<void *>(map_dealloc)},
+        {Py_tp_repr, reinterpret_cast<void *>(map_repr)},
+        {Py_tp_richcompare, reinterpret_cast<void *>(map_richcompare)},
+        {Py_tp_hash, reinterpret_cast<void *>(PyObject_HashNotImplemented)},
+        {Py_tp_iter, reinterpret_cast<void *>(map_iter)},
+        {Py_mp_length, reinterpret_cast<void *>(map_length)},
+        {Py_mp_subscript, reinterpret_cast<void *>(map_subscript)},
+        {Py_sq_contains, reinterpret_cast<void *>(map_contains)},
+        {Py_tp_methods, map_methods},
+        {0, nullptr}};
+
+    PyType_Spec map_spec = {"component_engine.PersistentMap", sizeof(python::PersistentMapObject), 0,
+                            Py_TPFLAGS_DEFAULT | Py_TPFLAGS_IMMUTABLETYPE, map_slots};
+
+    PyObject *create_map_type()
+    {
+        return PyType_FromSpec(&map_spec);
+    }
+
+    // PersistentVector
+
+    PyObject *vector_new(PyTypeObject *, PyObject *args, PyObject *kwargs)
+    {
+        static const char *keywords[] = {"items", nullptr};
+        PyObject *items = nullptr;
+        if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O:PersistentVector", const_cast<char **>(keywords), &items))
+            return nullptr;
+
+        auto body = [&]
+        {
+            if (items && python::is_persistent_vector(items))
+                return python::wrap(vector_of(items));
+            VectorRef vector = vdom::PersistentVector::empty();
+            return python::wrap(items && items != Py_None ? extend(std::move(vector), items) : std::move(vector));
+        };
+        return python::guarded(body, PyExc_TypeError);
+    }
+
+    void vector_dealloc(PyObject *self)
+    {
+        PyTypeObject *type = Py_TYPE(self);
+        reinterpret_cast<python::PersistentVectorObject *>(self)->vector.~VectorRef();
+        type->tp_free(self);
+        Py_DECREF(type);
+    }
+
+    PyObject *vector_append(PyObject *self, PyObject *value)
+    {
+        auto body = [&]
+        { return python::wrap(vector_of(self)->push_back(python::to_value(value))); };
+        return python::guarded(body, PyExc_TypeError);
+    }
+
+    PyObject *vector_set(PyObject *self, PyObject *const *args, Py_ssize_t nargs)
+    {
+        if (nargs != 2)
+            return PyErr_Format(PyExc_TypeError, "set() takes exactly 2 arguments (%zd given)", nargs);
+        std::size_t index = 0;
+        if (!parse_index(self, args[0], index))
+            return nullptr;
+
+        auto body = [&]
+        { return python::wrap(vector_of(self)->set(index, python::to_value(args[1]))); };
+        return python::guarded(body, PyExc_TypeError);
+    }
+
+    PyObject *vector_pop(PyObject *self, PyObject *)
+    {
+        return python::guarded([&]
+                               { return python::wrap(vector_of(self)->pop_back()); });
+    }
+
+    PyObject *vector_extend(PyObject *self, PyObject *items)
+    {
+        auto body = [&]
+        { return python::wrap(extend(vector_of(self), items)); };
+        return python::guarded(body, PyExc_TypeError);
+    }
+
+    Py_ssize_t vector_length(PyObject *self)
+    {
+        return static_cast<Py_ssize_t>(vector_of(self)->size());
+    }
+
+    PyObject *vector_item(PyObject *self, Py_ssize_t index)
+    {
+        if (index < 0 || static_cast<std::size_t>(index) >= vector_of(self)->size())
+        {
+            PyErr_SetString(PyExc_IndexError, "PersistentVector index out of range");
+            return nullptr;
+        }
+        return python::from_value((*vector_of(self))[static_cast<std::size_t>(index)]);
+    }
+
+    PyObject *vector_richcompare(PyObject *self, PyObject *other, int op)
+    {
+        if ((op != Py_EQ && op != Py_NE) || !python::is_persistent_vector(other))
+            Py_RETURN_NOTIMPLEMENTED;
+        return compare(vector_of(self)->equals(*vector_of(other)), op);
+    }
+
+    PyObject *vector_repr(PyObject *self)
+    {
+        python::Object list = python::Object::steal(PySequence_List(self));
+        if (!list)
+            return nullptr;
+        return PyUnicode_FromFormat("PersistentVector(%R)", list.get());
+    }
+
+    PyMethodDef vector_methods[] = {
+        {"append", vector_append, METH_O,
+         "append(value)\n--\n\nReturn a version with value added at the end."},
+        {"set", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)()>(vector_set)), METH_FASTCALL,
+         "set(index, value)\n--\n\nReturn a version with the element at index replaced, or this vector if it already is value."},
+        {"pop", vector_pop, METH_NOARGS,
+         "pop()\n--\n\nReturn a version without the last element."},
+        {"extend", vector_extend, METH_O,
+         "extend(items)\n--\n\nReturn a version with the items of an iterable added at the end."},
+        {nullptr, nullptr, 0, nullptr}};
+
+    PyType_Slot vector_slots[] = {
+        {Py_tp_doc, const_cast<char *>("Immutable vector whose updates return new versions sharing structure.")},
+        {Py_tp_new, reinterpret_cast<void *>(vector_new)},
+        {Py_tp_dealloc, reinterpret_cast<void *>(vector_dealloc)},
+        {Py_tp_repr, reinterpret_cast<void *>(vector_repr)},
+        {Py_tp_richcompare, reinterpret_cast<void *>(vector_richcompare)},
+        {Py_tp_hash, reinterpret_cast<void *>(PyObject_HashNotImplemented)},
+        {Py_sq_length, reinterpret_cast<void *>(vector_length)},
+        {Py_sq_item, reinterpret_cast<void *>(vector_item)},
+        {Py_tp_methods, vector_methods},
+        {0, nullptr}};
+
+    PyType_Spec vector_spec = {"component_engine.PersistentVector", sizeof(python::PersistentVectorObject), 0,
+                               Py_TPFLAGS_DEFAULT | Py_TPFLAGS_IMMUTABLETYPE, vector_slots};
+
+    PyObject *create_vector_type()
+    {
+        return PyType_FromSpec(&vector_spec);
+    }
+} // namespace
+
+PyTypeObject *python::persistent_map_type()
+{
+    return interpreter_type(create_map_type);
+}
+
+PyTypeObject *python::persistent_vector_type()
+{
+    return interpreter_type(create_vector_type);
+}
+
+bool python::is_persistent_map(PyObject *object)
+{
+    PyTypeObject *type = existing_interpreter_type(create_map_type);
+    return type && PyObject_TypeCheck(object, type);
+}
+
+bool python::is_persistent_vector(PyObject *object)
+{
+    PyTypeObject *type = existing_interpreter_type(create_vector_type);
+    return type && PyObject_TypeCheck(object, type);
+}
+
+PyObject *python::wrap(vdom::Ref<const vdom::PersistentMap> map)
+{
+    PyTypeObject *type = persistent_map_type();
+    if (!type)
+        return nullptr;
+    PyObject *self = type->tp_alloc(type, 0);
+    if (self)
+        new (&reinterpret_cast<PersistentMapObject *>(self)->map) MapRef(std::move(map));
+    return self;
+}
+
+PyObject *python::wrap(vdom::Ref<const vdom::PersistentVector> vector)
+{
+    PyTypeObject *type = persistent_vector_type();
+    if (!type)
+        return nullptr;
+    PyObject *self = type->tp_alloc(type, 0);
+    if (self)
+        new (&reinterpret_cast<PersistentVectorObject *>(self)->vector) VectorRef(std::move(vector));
+    return self;
+}
@@ -0,0 +1,477 @@
+#include <new>
+
+#include "python/errors.hpp"
+#include "python/interpreter_types.hpp"
+#include "python/object.hpp"
+#include "python/properties_type.hpp"
+#include "python/value.hpp"
+
+namespace
+{
+    PyObject *create_properties_type();
+    PyObject *create_view_type();
+
+    /**
+     * @brief Instance layout of the live view returned by Properties.properties
+     *
+     */
+    struct ViewObject
+    {
+        PyObject_HEAD
+        PyObject *owner;
+    };
+
+    vdom::Properties &properties_of(PyObject *self)
+    {
+        return reinterpret_cast<python::PropertiesObject *>(self)->properties;
+    }
+
+    bool check_key(PyObject *key)
+    {
+        if (PyUnicode_Check(key))
+            return true;
+        PyErr_Format(PyExc_TypeError, "property name must be str, not '%s'", Py_TYPE(key)->tp_name);
+        return false;
+    }
+
+    PyObject *allocate(PyTypeObject *type)
+    {
+        PyObject *self = type->tp_alloc(type, 0);
+        if (self)
+            new (&properties_of(self)) vdom::Properties();
+        return self;
+    }
+
+    PyObject *properties_new(PyTypeObject *type, PyObject *args, PyObject *kwargs)
+    {
+        // Subclasses may define an __init__ taking arguments
+        if (type == python::existing_interpreter_type(create_properties_type) &&
+            (PyTuple_GET_SIZE(args) != 0 || (kwargs && PyDict_GET_SIZE(kwargs) != 0)))
+        {
+            PyErr_SetString(PyExc_TypeError, "Properties() takes no arguments");
+            return nullptr;
+        }
+        return allocate(type);
+    }
+
+    PyObject *properties_vectorcall(PyObject *type, PyObject *const *, size_t nargsf, PyObject *kwnames)
+    {
+        if (PyVectorcall_NARGS(nargsf) != 0 || (kwnames && PyTuple_GET_SIZE(kwnames) != 0))
+        {
+            PyErr_SetString(PyExc_TypeError, "Properties() takes no arguments");
+            return nullptr;
+        }
+        return allocate(reinterpret_cast<PyTypeObject *>(type));
+    }
+
+    void properties_dealloc(PyObject *self)
+    {
+        PyTypeObject *type = Py_TYPE(self);
+        properties_of(self).~Properties();
+        type->tp_free(self);
+        Py_DECREF(type);
+    }
+
+    PyObject *set_property(PyObject *self, PyObject *const *args, Py_ssize_t nargs)
+    {
+        if (nargs != 2)
+            return PyErr_Format(PyExc_TypeError, "set_property() takes exactly 2 arguments (%zd given)", nargs);
+        if (!check_key(args[0]))
+            return nullptr;
+
+        auto body = [&]() -> PyObject *
+        {
+            vdom::Atom key = vdom::AtomTable::global().intern(python::utf8_view(args[0]));
+            properties_of(self).set(key, python::to_value(args[1]));
+            Py_RETURN_NONE;
+        };
+        return python::guarded(body, PyExc_TypeError);
+    }
+
+    PyObject *get_property(PyObject *self, PyObject *key)
+    {
+        if (!check_key(key))
+            return nullptr;
+
+        auto body = [&]() -> PyObject *
+        {
+            vdom::Atom atom = vdom::AtomTable::global().find(python::utf8_view(key));
+            const vdom::Value *value = atom == vdom::null_atom ? nullptr : properties_of(self).get(atom);
+            if (!value)
+                Py_RETURN_NONE;
+            return python::from_value(*value);
+        };
+        return python::guarded(body);
+    }
+
+    PyObject *remove_property(PyObject *self, PyObject *key)
+    {
+        if (!check_key(key))
+            return nullptr;
+
+        auto body = [&]() -> PyObject *
+        {
+            vdom::Atom atom = vdom::AtomTable::global().find(python::utf8_view(key));
+            if (atom != vdom::null_atom)
+                properties_of(self).remove(atom);
+            Py_RETURN_NONE;
+        };
+        return python::guarded(body);
+    }
+
+    PyObject *clear_properties(PyObject *self, PyObject *)
+    {
+        properties_of(self).clear();
+        Py_RETURN_NONE;
+    }
+
+    PyObject *to_dict(PyObject *self)
+    {
+        python::Object dictionary(PyDict_New());
+
+        for (const vdom::Property &property : properties_of(self).items())
+        {
+            std::string_view name = vdom::AtomTable::global().name(property.key);
+            python::Object key(PyUnicode_FromStringAndSize(name.data(), static_cast<Py_ssize_t>(name.size())));
+            python::Object value(python::from_value(property.value));
+            if (PyDict_SetItem(dictionary.get(), key.get(), value.get()) < 0)
+                python::Object::throw_error_occurred();
+        }
+        return dictionary.release();
+    }
+
+    PyObject *properties_getter(PyObject *self, void *)
+    {
+        PyTypeObject *type = python::interpreter_type(create_view_type);
+        ViewObject *view = type ? PyObject_New(ViewObject, type) : nullptr;
+        if (view)
+            view->owner = Py_NewRef(self);
+        return reinterpret_cast<PyObject *>(view);
+    }
+
+    Py_ssize_t properties_length(PyObject *self)
+    {
+        return static_cast<Py_ssize_t>(properties_of(self).size());
+    }
+
+    int properties_contains(PyObject *self, PyObject *key)
+    {
+        if (!check_key(key))
+            return -1;
+
+        Py_ssize_t size = 0;
+        const char *data = PyUnicode_AsUTF8AndSize(key, &size);
+        if (!data)
+            return -1;
+        vdom::Atom atom = vdom::AtomTable::global().find({data, static_cast<std::size_t>(size)});
+        return atom != vdom::null_atom && properties_of(self).get(atom) != nullptr;
+    }
+
+    PyObject *properties_richcompare(PyObject *self, PyObject *other, int op)
+    {
+        if ((op != Py_EQ && op != Py_NE) || !python::is_properties(other))
+            Py_RETURN_NOTIMPLEMENTED;
+
+        bool equal = properties_of(self) == properties_of(other);
+        return PyBool_FromLong(op == Py_EQ ? equal : !equal);
+    }
+
+    PyObject *properties_repr(PyObject *self)
+    {
+        python::Object dictionary = python::Object::steal(python::guarded([&]
+                                                                          { return to_dict(self); }));
+        if (!dictionary)
+            return nullptr;
+        return PyUnicode_FromFormat("%s(%R)", Py_TYPE(self)->tp_name, dictionary.get());
+    }
+
+    PyMethodDef properties_methods[] = {
+        {"set_property", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)()>(set_property)), METH_FASTCALL,
+         "set_property(key, value)\n--\n\nSet a property to None, a str, an int, a float, a bool, a PersistentMap or a PersistentVector."},
+        {"get_property", get_property, METH_O,
+         "get_property(key)\n--\n\nGet a property, or None when it is not set."},
+        {"remove_property", remove_property, METH_O,
+         "remove_property(key)\n--\n\nRemove a property if it is set."},
+        {"clear_properties", clear_properties, METH_NOARGS,
+         "clear_properties()\n--\n\nRemove every property."},
+        {nullptr, nullptr, 0, nullptr}};
+
+    PyGetSetDef properties_getset[] = {
+        {"properties", properties_getter, nullptr, "A live mapping view of the properties, writing through.", nullptr},
+        {nullptr, nullptr, nullptr, nullptr, nullptr}};
+
+    // Properties.properties
+
+    PyObject *owner_of(PyObject *view)
+    {
+        return reinterpret_cast<ViewObject *>(view)->owner;
+    }
+
+    void view_dealloc(PyObject *self)
+    {
+        PyTypeObject *type = Py_TYPE(self);
+        Py_DECREF(owner_of(self));
+        type->tp_free(self);
+        Py_DECREF(type);
+    }
+
+    Py_ssize_t view_length(PyObject *self)
+    {
+        return properties_length(owner_of(self));
+    }
+
+    int view_contains(PyObject *self, PyObject *key)
+    {
+        return properties_contains(owner_of(self), key);
+    }
+
+    PyObject *view_subscript(PyObject *self, PyObject *key)
+    {
+        switch (properties_contains(owner_of(self), key))
+        {
+        case -1:
+            return nullptr;
+        case 0:
+            PyErr_SetObject(PyExc_KeyError, key);
+            return nullptr;
+        default:
+            return get_property(owner_of(self), key);
+        }
+    }
+
+    int view_assign(PyObject *self, PyObject *key, PyObject *value)
+    {
+        PyObject *owner = owner_of(self);
+        python::Object result;
+        if (value)
+        {
+            PyObject *args[] = {key, value};
+            result = python::Object::steal(set_property(owner, args, 2));
+        }
+        else
+        {
+            const int found = properties_contains(owner, key);
+            if (found == 0)
+                PyErr_SetObject(PyExc_KeyError, key);
+            if (found != 1)
+                return -1;
+            result = python::Object::steal(remove_property(owner, key));
+        }
+        return result ? 0 : -1;
+    }
+
+    PyObject *view_get(PyObject *self, PyObject *const *args, Py_ssize_t nargs)
+    {
+        if (nargs < 1 || nargs > 2)
+            return PyErr_Format(PyExc_TypeError, "get() takes 1 or 2 arguments (%zd given)", nargs);
+
+        switch (properties_contains(owner_of(self), args[0]))
+        {
+        case -1:
+            return nullptr;
+        case 0:
+            return Py_NewRef(nargs == 2 ? args[1] : Py_None);
+        default:
+            return get_property(owner_of(self), args[0]);
+        }
+    }
+
+    PyObject *view_pop(PyObject *self, PyObject *const *args, Py_ssize_t nargs)
+    {
+        if (nargs < 1 || nargs > 2)
+            return PyErr_Format(PyExc_TypeError, "pop() takes 1 or 2 arguments (%zd given)", nargs);
+
+        switch (properties_contains(owner_of(self), args[0]))
+        {
+        case -1:
+            return nullptr;
+        case 0:
+            if (nargs == 2)
+                return Py_NewRef(args[1]);
+            PyErr_SetObject(PyExc_KeyError, args[0]);
+            return nullptr;
+        default:
+            break;
+        }
+        python::Object value = python::Object::steal(get_property(owner_of(self), args[0]));
+        if (!value || !python::Object::steal(remove_property(owner_of(self), args[0])))
+            return nullptr;
+        return value.release();
+    }
+
+    PyObject *view_update(PyObject *self, PyObject *items)
+    {
+        auto body = [&]() -> PyObject *
+        {
+            // Like dict.update(): a mapping, or an iterable of pairs
+            python::Object dictionary(PyDict_New());
+            const int merged = PyObject_HasAttrString(items, "keys") ? PyDict_Update(dictionary.get(), items)
+                                                                     : PyDict_MergeFromSeq2(dictionary.get(), items, 1);
+            if (merged < 0)
+                return nullptr;
+
+            Py_ssize_t position = 0;
+            PyObject *key = nullptr;
+            PyObject *value = nullptr;
+            while (PyDict_Next(dictionary.get(), &position, &key, &value))
+            {
+                if (view_assign(self, key, value) < 0)
+                    return nullptr;
+            }
+            Py_RETURN_NONE;
+        };
+        return python::guarded(body);
+    }
+
+    PyObject *view_clear(PyObject *self, PyObject *)
+    {
+        return clear_properties(owner_of(self), nullptr);
+    }
+
+    PyObject *view_copy(PyObject *self, PyObject *)
+    {
+        return python::guarded([&]
+                               { return to_dict(owner_of(self)); });
+    }
+
+    /**
+     * @brief Collect the names, the values or (name, value) tuples into a list
+     *
+     */
+    template <typename Convert>
+    PyObject *view_list(PyObject *self, Convert convert)
+    {
+        auto body = [&]
+        {
+            const vdom::Properties &properties = properties_of(owner_of(self));
+            python::Object list(PyList_New(static_cast<Py_ssize_t>(properties.size())));
+            Py_ssize_t index = 0;
+            for (const vdom::Property &property : properties.items())
+            {
+                std::string_view name = vdom::AtomTable::global().name(property.key);
+                python::Object key(PyUnicode_FromStringAndSize(name.data(), static_cast<Py_ssize_t>(name.size())));
+                PyList_SET_ITEM(list.get(), index++, python::Object(convert(key, property.value)).release());
+            }
+            return list.release();
+        };
+        return python::guarded(body);
+    }
+
+    PyObject *view_keys(PyObject *self, PyObject *)
+    {
+        return view_list(self, [](python::Object &key, const vdom::Value &)
+                         { return key.release(); });
+    }
+
+    PyObject *view_values(PyObject *self, PyObject *)
+    {
+        return view_list(self, [](python::Object &, const vdom::Value &value)
+                         { return python::from_value(value); });
+    }
+
+    PyObject *view_items(PyObject *self, PyObject *)
+    {
+        return view_list(self, [](python::Object &key, const vdom::Value &value)
+                         {
+                             python::Object second(python::from_value(value));
+                             return PyTuple_Pack(2, key.get(), second.get()); });
+    }
+
+    PyObject *view_iter(PyObject *self)
+    {
+        python::Object keys = python::Object::steal(view_keys(self, nullptr));
+        return keys ? PyObject_GetIter(keys.get()) : nullptr;
+    }
+
+    PyObject *view_richcompare(PyObject *self, PyObject *other, int op)
+    {
+        if (op != Py_EQ && op != Py_NE)
+            Py_RETURN_NOTIMPLEMENTED;
+        if (Py_TYPE(other) == Py_TYPE(self))
+            return properties_richcompare(owner_of(self), owner_of(other), op);
+        python::Object dictionary = python::Object::steal(view_copy(self, nullptr));
+        if (!dictionary)
+            return nullptr;
+        return PyObject_RichCompare(dictionary.get(), other, op);
+    }
+
+    PyObject *view_repr(PyObject *self)
+    {
+        python::Object dictionary = python::Object::steal(view_copy(self, nullptr));
+        if (!dictionary)
+            return nullptr;
+        return PyObject_Repr(dictionary.get());
+    }
+
+    PyMethodDef view_methods[] = {
+        {"get", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)()>(view_get)), METH_FASTCALL,
+         "get(key, default=None)\n--\n\nGet a property, or default when it is not set."},
+        {"pop", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)()>(view_pop)), METH_FASTCALL,
+         "pop(key[, default])\n--\n\nRemove a property and return its value, or default when it is not set."},
+        {"update", view_update, METH_O,
+         "update(items)\n--\n\nSet the properties of a mapping or of (key, value) pairs."},
+        {"clear", view_clear, METH_NOARGS, "clear()\n--\n\nRemove every property."},
+        {"copy", view_copy, METH_NOARGS, "copy()\n--\n\nA dict copy of the properties."},
+        {"keys", view_keys, METH_NOARGS, "keys()\n--\n\nA list of the property names."},
+        {"values", view_values, METH_NOARGS, "values()\n--\n\nA list of the property values."},
+        {"items", view_items, METH_NOARGS, "items()\n--\n\nA list of (name, value) tuples."},
+        {nullptr, nullptr, 0, nullptr}};
+
+    PyType_Slot view_slots[] = {
+        {Py_tp_doc, const_cast<char *>("Live mapping view of a Properties, reading and writing through to it.")},
+        {Py_tp_dealloc, reinterpret_cast<void *>(view_dealloc)},
+        {Py_tp_repr, reinterpret_cast<void *>(view_repr)},
+        {Py_tp_richcompare, reinterpret_cast<void *>(view_richcompare)},
+        {Py_tp_hash, reinterpret_cast<void *>(PyObject_HashNotImplemented)},
+        {Py_tp_iter, reinterpret_cast<void *>(view_iter)},
+        {Py_mp_length, reinterpret_cast<void *>(view_length)},
+        {Py_mp_subscript, reinterpret_cast<void *>(view_subscript)},
+        {Py_mp_ass_subscript, reinterpret_cast<void *>(view_assign)},
+        {Py_sq_contains, reinterpret_cast<void *>(view_contains)},
+        {Py_tp_methods, view_methods},
+        {0, nullptr}};
+
+    PyType_Spec view_spec = {"component_engine.PropertiesView", sizeof(ViewObject), 0,
+                             Py_TPFLAGS_DEFAULT | Py_TPFLAGS_IMMUTABLETYPE | Py_TPFLAGS_DISALLOW_INSTANTIATION, view_slots};
+
+    PyObject *create_view_type()
+    {
+        return PyType_FromSpec(&view_spec);
+    }
+
+    PyType_Slot properties_slots[] = {
+        {Py_tp_doc, const_cast<char *>("Class to manage properties for a UI component.")},
+        {Py_tp_new, reinterpret_cast<void *>(properties_new)},
+        {Py_tp_dealloc, reinterpret_cast<void *>(properties_dealloc)},
+        {Py_tp_repr, reinterpret_cast<void *>(properties_repr)},
+        {Py_tp_richcompare, reinterpret_cast<void *>(properties_richcompare)},
+        {Py_tp_hash, reinterpret_cast<void *>(PyObject_HashNotImplemented)},
+        {Py_sq_length, reinterpret_cast<void *>(properties_length)},
+        {Py_sq_contains, reinterpret_cast<void *>(properties_contains)},
+        {Py_tp_methods, properties_methods},
+        {Py_tp_getset, properties_getset},
+        {0, nullptr}};
+
+    PyType_Spec properties_spec = {"component_engine.Properties", sizeof(python::PropertiesObject), 0,
+                                   Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE | Py_TPFLAGS_IMMUTABLETYPE, properties_slots};
+
+    PyObject *create_properties_type()
+    {
+        PyObject *type = PyType_FromSpec(&properties_spec);
+        // No slot sets the vectorcall of a type before Python 3.14
+        if (type)
+            reinterpret_cast<PyTypeObject *>(type)->tp_vectorcall = properties_vectorcall;
+        return type;
+    }
+} // namespace
+
+PyTypeObject *python::properties_type()
+{
+    return interpreter_type(create_properties_type);
+}
+
+bool python::is_properties(PyObject *object)
+{
+    PyTypeObject *type = existing_interpreter_type(create_properties_type);
+    return type && PyObject_TypeCheck(object, type);
+}
@@ -0,0 +1,408 @@
+#include <algorithm>
+
+#include "python/interned.hpp"
+#include "python/properties_type.hpp"
+#include "python/render_cache.hpp"
+
+python::RenderCache::RenderCache(PyObject *owner)
+    : _owner(owner), _frame(0), _tree(0), _next_tree(0), _root_name(interned("_root")), _properties_name(interned("properties"))
+{
+}
+
+void python::RenderCache::set_root(PyObject *component, PyObject *root)
+{
+    // Components refusing the attribute, e.g. slotted ones, can still be scheduled by their owner
+    if (root && PyObject_SetAttr(component, _root_name.get(), root) < 0)
+        PyErr_Clear();
+}
+
+const python::RenderCache::Entry *python::RenderCache::find(PyObject *component) const
+{
+    auto it = _entries.find(component);
+    return it == _entries.end() ? nullptr : &it->second;
+}
+
+bool python::RenderCache::invalidate(PyObject *component)
+{
+    auto it = _entries.find(component);
+    if (it == _entries.end())
+        return false;
+    it->second.updates++;
+    it->second.hydrated = false;
+    Object output = std::move(it->second.output);
+    return true;
+}
+
+void python::RenderCache::hash_properties(Entry &entry)
+{
+    entry.properties = Object::steal(PyObject_GetAttr(entry.component.get(), _properties_name.get()));
+    if (!entry.properties)
+        PyErr_Clear();
+
+    entry.hashed = entry.properties && is_properties(entry.properties.get());
+    if (entry.hashed)
+        entry.properties_hash = reinterpret_cast<PropertiesObject *>(entry.properties.get())->properties.hash();
+}
+
+bool python::RenderCache::unchanged(Entry &entry)
+{
+    hash_properties(entry);
+    return has_output(entry) && (entry.hashed ? rendered_from(entry, entry) : !entry.rendered);
+}
+
+bool python::RenderCache::rendered_from(const Entry &entry, const Entry &properties)
+{
+    if (!entry.rendered || !properties.hashed || entry.rendered->hash() != properties.properties_hash)
+        return false;
+    // Equal hashes may still collide
+    return *entry.rendered == reinterpret_cast<PropertiesObject *>(properties.properties.get())->properties;
+}
+
+bool python::RenderCache::reuse_predecessor(Entry &entry, const Entry *parent, std::size_t position, bool pure)
+{
+    // The component at the same position under the same parent in the previous frame
+    if (!parent || position >= parent->children.size())
+        return false;
+    auto it = _entries.find(parent->children[position]);
+    if (it == _entries.end() || &it->second == &entry ||
+        Py_TYPE(it->second.component.get()) != Py_TYPE(entry.component.get()))
+        return false;
+
+    const Entry &predecessor = it->second;
+    entry.children = predecessor.children;
+    if (!pure || !has_output(predecessor) || predecessor.updates != 0 || !rendered_from(predecessor, entry))
+        return false;
+
+    entry.output = predecessor.output.share();
+    entry.hydrated = predecessor.hydrated;
+    entry.rendered = predecessor.rendered;
+    entry.nodes = predecessor.nodes;
+    return true;
+}
+
+bool python::RenderCache::reuse_record(Entry &entry, const Entry *parent, std::size_t position, bool pure)
+{
+    // The record at the same position under the record of the parent, the root's being the first
+    std::uint32_t index = 0;
+    if (_records.empty())
+        return false;
+    if (parent)
+    {
+        if (parent->record == snapshot::format::null_index ||
+            position >= _record_offsets[parent->record + 1] - _record_offsets[parent->record])
+            return false;
+        index = _record_children[_record_offsets[parent->record] + position];
+    }
+
+    const snapshot::Component &record = _records[index];
+    if (record.type != type_name(Py_TYPE(entry.component.get())))
+        return false;
+    entry.record = index;
+
+    // Only a pure component renders the same nodes as the instance the record was saved from
+    if (!pure || !entry.hashed || !record.properties || record.first == vdom::null_node)
+        return false;
+    entry.rendered = record.properties;
+    if (!rendered_from(entry, entry))
+    {
+        entry.rendered.reset();
+        return false;
+    }
+    entry.hydrated = true;
+    entry.nodes = {record.first, record.count};
+    return true;
+}
+
+const std::string &python::RenderCache::type_name(PyTypeObject *type)
+{
+    auto [it, inserted] = _type_names.try_emplace(type);
+    if (!inserted)
+        return it->second;
+
+    // Module and qualified name, as stable across processes as the class itself
+    PyObject *object = reinterpret_cast<PyObject *>(type);
+    Object module = Object::steal(PyObject_GetAttrString(object, "__module__"));
+    Object name = Object::steal(PyObject_GetAttrString(object, "__qualname__"));
+    const char *module_name = module && PyUnicode_Check(module.get()) ? PyUnicode_AsUTF8(module.get()) : nullptr;
+    const char *qualified_name = name && PyUnicode_Check(name.get()) ? PyUnicode_AsUTF8(name.get()) : nullptr;
+    if (module_name && qualified_name)
+        it->second = std::string(module_name) + "." + qualified_name;
+    else
+    {
+        PyErr_Clear();
+        it->second = type->tp_name;
+    }
+    return it->second;
+}
+
+void python::RenderCache::forget_records() noexcept
+{
+    _records.clear();
+    _record_children.clear();
+    _record_offsets.clear();
+    _type_names.clear();
+}
+
+void python::RenderCache::hydrate(std::span<const snapshot::Component> components, const vdom::Tree &tree)
+{
+    forget_records();
+    _records.assign(components.begin(), components.end());
+    _tree = tree.serial();
+
+    // Children grouped by parent, in order, as the records are in pre-order
+    _record_offsets.assign(_records.size() + 1, 0);
+    for (const snapshot::Component &record : _records)
+    {
+        if (record.parent != snapshot::format::null_index)
+            _record_offsets[record.parent + 1]++;
+    }
+    for (std::size_t index = 0; index < _records.size(); ++index)
+        _record_offsets[index + 1] += _record_offsets[index];
+    _record_children.resize(_record_offsets.back());
+    std::vector<std::uint32_t> filled(_record_offsets.begin(), _record_offsets.end() - 1);
+    for (std::size_t index = 0; index < _records.size(); ++index)
+    {
+        if (_records[index].parent != snapshot::format::null_index)
+            _record_children[filled[_records[index].parent]++] = static_cast<std::uint32_t>(index);
+    }
+}
+
+std::vector<snapshot::Component> python::RenderCache::components(PyObject *root)
+{
+    std::vector<snapshot::Component> components;
+    std::vector<std::pair<const Entry *, std::uint32_t>> pending; // With the index of the parent
+    if (auto it = _entries.find(root); it != _entries.end())
+        pending.push_back({&it->second, snapshot::format::null_index});
+    while (!pending.empty())
+    {
+        auto [entry, parent] = pending.back();
+        pending.pop_back();
+        const std::uint32_t index = static_cast<std::uint32_t>(components.size());
+        snapshot::Component &component = components.emplace_back();
+        component.type = type_name(Py_TYPE(entry->component.get()));
+        component.parent = parent;
+        component.first = entry->nodes.first;
+        component.count = entry->nodes.count;
+
+        // What reuse_predecessor() asks of the output a new instance reuses
+        if (entry->pure && entry->memoize && has_output(*entry) && entry->updates == 0 && entry->rendered &&
+            entry->nodes.first != vdom::null_node)
+            component.properties = entry->rendered;
+
+        for (auto child = entry->children.rbegin(); child != entry->children.rend(); ++child)
+        {
+            if (auto it = _entries.find(*child); it != _entries.end())
+                pending.push_back({&it->second, index});
+        }
+    }
+    _type_names.clear();
+
+    // A skipped component does not reach its descendants, which must not need to render either
+    for (std::size_t index = components.size(); index-- > 1;)
+    {
+        if (!components[index].properties)
+            components[components[index].parent].properties.reset();
+    }
+    return components;
+}
+
+PyObject *python::RenderCache::enter(PyObject *component, std::uint32_t depth, bool memoize, bool pure)
+{
+    Entry *parent = _parents.empty() ? nullptr : _parents.back();
+    std::size_t position = 0;
+    if (parent)
+    {
+        position = parent->next_children.size();
+        parent->next_children.push_back(component);
+    }
+
+    auto [it, inserted] = _entries.try_emplace(component);
+    Entry &entry = it->second;
+    if (inserted)
+    {
+        entry.component = Object::borrow(component);
+        entry.properties_hash = 0;
+        entry.hashed = false;
+        entry.updates = 0;
+        entry.hydrated = false;
+        entry.record = snapshot::format::null_index;
+        entry.frame = 0;
+        entry.nodes = {vdom::null_node, 0};
+        entry.next_nodes = {vdom::null_node, 0};
+        if (_owner && !_owner_reference)
+            _owner_reference = Object(PyWeakref_NewRef(_owner, nullptr));
+        set_root(component, _owner_reference.get());
+    }
+
+    // A frame abandoned before end_frame() may have left children behind
+    if (entry.frame != _frame)
+        entry.next_children.clear();
+
+    entry.depth = depth;
+    entry.memoize = memoize;
+    entry.pure = pure;
+    entry.frame = _frame;
+    _parents.push_back(&entry);
+
+    bool reused = false;
+    if (inserted)
+    {
+        hash_properties(entry);
+        reused = reuse_predecessor(entry, parent, position, pure) || reuse_record(entry, parent, position, pure);
+    }
+    else
+        reused = unchanged(entry);
+
+    if (!memoize)
+        reused = false;
+    if (!reused)
+        entry.hydrated = false;
+    if (reused)
+        _statistics.skipped_renders++;
+    else
+        _statistics.renders++;
+    return reused ? entry.output.get() : nullptr;
+}
+
+const python::RenderCache::NodeRange *python::RenderCache::reuse_nodes(vdom::NodeId first)
+{
+    Entry &entry = *_parents.back();
+    if (_tree == 0 || entry.nodes.first == vdom::null_node || !has_output(entry))
+        return nullptr;
+
+    // Every descendant must be one enter() would skip: memoized, not invalidated and with unchanged properties
+    _reused.clear();
+    for (std::size_t index = 0; index <= _reused.size(); ++index)
+    {
+        const Entry &parent = index == 0 ? entry : *_reused[index - 1].first;
+        const std::uint32_t depth = index == 0 ? entry.depth + 1 : _reused[index - 1].second + 1;
+        for (PyObject *child : parent.children)
+        {
+            auto it = _entries.find(child);
+            if (it == _entries.end())
+                return nullptr;
+            Entry &descendant = it->second;
+            if (!descendant.memoize || descendant.nodes.first == vdom::null_node || !unchanged(descendant))
+                return nullptr;
+            _reused.push_back({&descendant, depth});
+        }
+    }
+
+    const vdom::NodeId origin = entry.nodes.first;
+    entry.next_nodes = {first, entry.nodes.count};
+    entry.next_children = entry.children;
+    for (auto [descendant, depth] : _reused)
+    {
+        descendant->depth = depth;
+        descendant->frame = _frame;
+        descendant->next_nodes = {descendant->nodes.first - origin + first, descendant->nodes.count};
+        descendant->next_children = descendant->children;
+        _statistics.skipped_renders++;
+    }
+    return &entry.nodes;
+}
+
+void python::RenderCache::retain(PyObject *root, std::span<const Replacement> replacements)
+{
+    // A node of tree() moves by the growth of the replacements ending before it
+    std::vector<std::int64_t> growth(replacements.size() + 1, 0);
+    for (std::size_t index = 0; index < replacements.size(); ++index)
+        growth[index + 1] = growth[index] + static_cast<std::int64_t>(replacements[index].count) - replacements[index].nodes.count;
+    auto moved = [replacements, &growth](vdom::NodeId node)
+    {
+        auto ended = std::upper_bound(replacements.begin(), replacements.end(), node,
+                                      [](vdom::NodeId node, const Replacement &replacement)
+                                      { return node < replacement.nodes.first + replacement.nodes.count; });
+        return static_cast<vdom::NodeId>(node + growth[ended - replacements.begin()]);
+    };
+
+    std::vector<Entry *> pending;
+    if (auto it = _entries.find(root); it != _entries.end())
+        pending.push_back(&it->second);
+    while (!pending.empty())
+    {
+        Entry &entry = *pending.back();
+        pending.pop_back();
+        if (entry.frame == _frame)
+            continue;
+
+        entry.frame = _frame;
+        entry.next_nodes = entry.nodes;
+        if (entry.nodes.first != vdom::null_node)
+        {
+            const vdom::NodeId first = moved(entry.nodes.first);
+            entry.next_nodes = {first, moved(entry.nodes.first + entry.nodes.count) - first};
+        }
+        entry.next_children = entry.children;
+        for (PyObject *child : entry.children)
+        {
+            if (auto it = _entries.find(child); it != _entries.end())
+                pending.push_back(&it->second);
+        }
+    }
+}
+
+void python::RenderCache::store(PyObject *component, Object output)
+{
+    auto it = _entries.find(component);
+    if (it == _entries.end())
+        return;
+    Entry &entry = it->second;
+    std::swap(entry.output, output);
+    if (entry.hydrated)
+    {
+        // Its recorded nodes could not be copied after all
+        entry.hydrated = false;
+        _statistics.skipped_renders--;
+        _statistics.renders++;
+    }
+    if (entry.hashed)
+        entry.rendered = reinterpret_cast<PropertiesObject *>(entry.properties.get())->properties;
+    else
+        entry.rendered.reset();
+}
+
+const vdom::StaticBlock *python::RenderCache::static_block(PyTypeObject *type)
+{
+    auto it = _static_blocks.find(type);
+    if (it == _static_blocks.end())
+        return nullptr;
+    if (!(type->tp_flags & Py_TPFLAGS_VALID_VERSION_TAG) || it->second.version != type->tp_version_tag)
+    {
+        _static_blocks.erase(it);
+        return nullptr;
+    }
+    _statistics.skipped_renders++;
+    return it->second.block.get();
+}
+
+void python::RenderCache::store_static_block(PyTypeObject *type, vdom::Ref<const vdom::StaticBlock> block)
+{
+    // Without a valid version tag, a change to the class could go unnoticed
+    if (!(type->tp_flags & Py_TPFLAGS_VALID_VERSION_TAG))
+        return;
+    _static_blocks[type] = {Object::borrow(reinterpret_cast<PyObject *>(type)), type->tp_version_tag, std::move(block)};
+}
+
+int python::RenderCache::traverse(visitproc visit, void *arg)
+{
+    for (auto &[component, entry] : _entries)
+    {
+        Py_VISIT(entry.component.get());
+        Py_VISIT(entry.output.get());
+        Py_VISIT(entry.properties.get());
+    }
+    for (auto &[type, entry] : _static_blocks)
+        Py_VISIT(entry.type.get());
+    return 0;
+}
+
+void python::RenderCache::clear()
+{
+    std::unordered_map<PyObject *, Entry> entries;
+    entries.swap(_entries);
+    std::unordered_map<PyTypeObject *, StaticEntry> static_blocks;
+    static_blocks.swap(_static_blocks);
+    forget_records();
+    _owner_reference.reset();
+}
@@ -0,0 +1,95 @@
+#include <stdexcept>
+#include <string>
+
+#include "python/runtime.hpp"
+
+namespace
+{
+    void check_status(PyStatus status, PyConfig *config)
+    {
+        if (!PyStatus_Exception(status))
+            return;
+
+        std::string message = "Failed to initialize Python";
+        if (status.err_msg)
+            message += std::string(": ") + status.err_msg;
+        PyConfig_Clear(config);
+        throw std::runtime_error(message);
+    }
+} // namespace
+
+python::Runtime::Runtime(const RuntimeConfig &config)
+    : _owned(false), _main_thread_state(nullptr)
+{
+    if (Py_IsInitialized())
+        return;
+
+    PyConfig py_config;
+    if (config.isolated)
+        PyConfig_InitIsolatedConfig(&py_config);
+    else
+        PyConfig_InitPythonConfig(&py_config);
+
+    py_config.parse_argv = 0;
+    py_config.install_signal_handlers = config.install_signal_handlers ? 1 : 0;
+    py_config.write_bytecode = config.write_bytecode ? 1 : 0;
+
+    if (!config.program_name.empty())
+        check_status(PyConfig_SetBytesString(&py_config, &py_config.program_name,
+                                             config.program_name.c_str()),
+                     &py_config);
+
+    if (!config.arguments.empty())
+    {
+        std::vector<char *> argv;
+        argv.reserve(config.arguments.size());
+        for (const auto &argument : config.arguments)
+            argv.push_back(const_cast<char *>(argument.c_str()));
+        check_status(PyConfig_SetBytesArgv(&py_config, static_cast<Py_ssize_t>(argv.size()), argv.data()),
+                     &py_config);
+    }
+
+    if (!config.module_search_paths.empty())
+    {
+        py_config.module_search_paths_set = 1;
+        for (const auto &path : config.module_search_paths)
+        {
+            wchar_t *wide_path = Py_DecodeLocale(path.c_str(), nullptr);
+            if (!wide_path)
+            {
+                PyConfig_Clear(&py_config);
+                throw std::runtime_error("Failed to decode Python module search path: " + path);
+            }
+            PyStatus status = PyWideStringList_Append(&py_config.module_search_paths, wide_path);
+            PyMem_RawFree(wide_path);
+            check_status(status, &py_config);
+        }
+    }
+
+    check_status(Py_InitializeFromConfig(&py_config), &py_config);
+    PyConfig_Clear(&py_config);
+
+    _owned = true;
+    _main_thread_state = PyEval_SaveThread();
+}
+
+python::Runtime::~Runtime()
+{
+    if (!_owned)
+        return;
+
+    PyEval_RestoreThread(_main_thread_state);
+    Py_FinalizeEx();
+}
+
+python::Runtime &python::Runtime::initialize(const RuntimeConfig &config)
+{
+    static Runtime runtime(config);
+
+    return runtime;
+}
+
+bool python::Runtime::is_initialized() noexcept
+{
+    return Py_IsInitialized() != 0;
+}
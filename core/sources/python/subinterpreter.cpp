@@ -0,0 +1,109 @@
+#include <stdexcept>
+#include <string>
+
+#include "python/subinterpreter.hpp"
+
+python::Subinterpreter::Subinterpreter() : _stopping(false)
+{
+    if (!supported())
+        throw std::runtime_error("Subinterpreters with their own GIL need Python 3.12 or later");
+    if (!Py_IsInitialized())
+        throw std::runtime_error("The Python runtime must be initialized before creating a subinterpreter");
+
+    std::promise<void> started;
+    std::future<void> ready = started.get_future();
+    _thread = std::thread([this, &started]
+                          { run(started); });
+
+    try
+    {
+        ready.get();
+    }
+    catch (...)
+    {
+        _thread.join();
+        throw;
+    }
+}
+
+python::Subinterpreter::~Subinterpreter()
+{
+    {
+        std::lock_guard lock(_mutex);
+        _stopping = true;
+    }
+    _condition.notify_one();
+    _thread.join();
+}
+
+void python::Subinterpreter::enqueue(std::function<void()> job)
+{
+    {
+        std::lock_guard lock(_mutex);
+        _jobs.push_back(std::move(job));
+    }
+    _condition.notify_one();
+}
+
+void python::Subinterpreter::run(std::promise<void> &started)
+{
+#if PY_VERSION_HEX >= 0x030C0000
+    // Creating an interpreter requires a thread state of the main interpreter, whose GIL it releases
+    PyThreadState *main_state = PyThreadState_New(PyInterpreterState_Main());
+    PyEval_RestoreThread(main_state);
+
+    PyInterpreterConfig config = {};
+    config.use_main_obmalloc = 0;
+    config.allow_fork = 0;
+    config.allow_exec = 0;
+    config.allow_threads = 1;
+    config.allow_daemon_threads = 0;
+    config.check_multi_interp_extensions = 1;
+    config.gil = PyInterpreterConfig_OWN_GIL;
+
+    PyThreadState *state = nullptr;
+    PyStatus status = Py_NewInterpreterFromConfig(&state, &config);
+    if (PyStatus_Exception(status))
+    {
+        std::string message = "Failed to create a subinterpreter";
+        if (status.err_msg)
+            message += std::string(": ") + status.err_msg;
+        PyThreadState_Clear(main_state);
+        PyThreadState_DeleteCurrent();
+        started.set_exception(std::make_exception_ptr(std::runtime_error(message)));
+        return;
+    }
+
+    // Idle with the GIL released, so that threads started by jobs can run
+    PyEval_SaveThread();
+    started.set_value();
+
+    for (;;)
+    {
+        std::function<void()> job;
+        {
+            std::unique_lock lock(_mutex);
+            _condition.wait(lock, [this]
+                            { return _stopping || !_jobs.empty(); });
+            if (_jobs.empty())
+                break;
+            job = std::move(_jobs.front());
+            _jobs.pop_front();
+        }
+
+        // A job reports failures through its future, drop the Python error an ErrorAlreadySet left behind
+        PyEval_RestoreThread(state);
+        job();
+        PyErr_Clear();
+        PyEval_SaveThread();
+    }
+
+    PyEval_RestoreThread(state);
+    Py_EndInterpreter(state);
+    PyEval_RestoreThread(main_state);
+    PyThreadState_Clear(main_state);
+    PyThreadState_DeleteCurrent();
+#else
+    started.set_exception(std::make_exception_ptr(std::runtime_error("Subinterpreters with their own GIL need Python 3.12 or later")));
+#endif
+}
@@ -0,0 +1,589 @@
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#include "python/interned.hpp"
+#include "python/properties_type.hpp"
+#include "python/tree_builder.hpp"
+#include "python/value.hpp"
+#include "trace/tracer.hpp"
+#include "vdom/static_block.hpp"
+
+namespace
+{
+    std::string type_name(PyObject *object)
+    {
+        return Py_TYPE(object)->tp_name;
+    }
+} // namespace
+
+python::TreeBuilder::TreeBuilder(vdom::Tree &tree, vdom::AtomTable &atoms, RenderCache *cache, Listener *listener,
+                                 const vdom::Tree *mounted, std::span<const Handler> mounted_handlers)
+    : _tree(tree), _atoms(atoms), _cache(cache), _listener(listener), _mounted(mounted),
+      _mounted_handlers(mounted_handlers), _depth(0), _next_splice(0), _cursor(0), _spliced(vdom::null_node),
+      _splicing(false),
+      _names{interned("tag"), interned("key"), interned("properties"), interned("children"), interned("render"),
+             interned("memoize"), interned("static"), interned("pure")}
+{
+}
+
+vdom::NodeId python::TreeBuilder::build(PyObject *root, std::span<PyObject *const> dirty)
+{
+    start(root, dirty);
+    while (advance())
+    {
+    }
+    return finish();
+}
+
+void python::TreeBuilder::start(PyObject *root, std::span<PyObject *const> dirty)
+{
+    _tree.clear();
+    _depth = 0;
+    _work.clear();
+    _checkpoints.clear();
+    _outputs.clear();
+    _handlers.clear();
+    _root.reset();
+    _splices.clear();
+    _replacements.clear();
+    _ancestors.clear();
+    _next_splice = 0;
+    _cursor = 0;
+    _spliced = vdom::null_node;
+    if (_cache)
+        _cache->build_into(_tree);
+    _splicing = plan_splices(root, dirty);
+    if (!_splicing)
+        _work.push_back({Object::borrow(root), vdom::null_node, Action::Build});
+}
+
+bool python::TreeBuilder::advance()
+{
+    // Stop after each render() call, the expensive step, or after a batch of cheap ones
+    constexpr std::size_t batch = 256;
+
+    for (std::size_t steps = 0; steps < batch; ++steps)
+    {
+        if (_work.empty() && !splice())
+            break;
+        if (step())
+            break;
+    }
+    return !_work.empty() || _splicing;
+}
+
+vdom::NodeId python::TreeBuilder::finish()
+{
+    if (_tree.root() == vdom::null_node)
+        throw std::runtime_error("The root component rendered nothing");
+    return _tree.root();
+}
+
+int python::TreeBuilder::traverse(visitproc visit, void *arg)
+{
+    for (Work &work : _work)
+        Py_VISIT(work.object.get());
+    Py_VISIT(_root.get());
+    for (Splice &splice : _splices)
+        Py_VISIT(splice.component.get());
+    for (Handler &handler : _handlers)
+        Py_VISIT(handler.callback.get());
+    return 0;
+}
+
+python::TreeBuilder::TypeInfo &python::TreeBuilder::type_info(PyObject *object)
+{
+    PyTypeObject *type = Py_TYPE(object);
+    auto it = _types.find(type);
+    if (it != _types.end())
+        return it->second;
+
+    TypeInfo info{Object::borrow(reinterpret_cast<PyObject *>(type)), NodeType::Element, false, 0, Object()};
+    if (PyObject_HasAttr(info.type.get(), _names.render.get()))
+    {
+        info.node_type = NodeType::Component;
+        Object memoize = info.type.optional_attribute(_names.memoize.get());
+        if (memoize)
+        {
+            int disabled = PyObject_Not(memoize.get());
+            if (disabled < 0)
+                Object::throw_error_occurred();
+            if (disabled)
+                info.node_type = NodeType::UnmemoizedComponent;
+        }
+        Object pure = info.type.optional_attribute(_names.pure.get());
+        if (pure)
+        {
+            int enabled = PyObject_IsTrue(pure.get());
+            if (enabled < 0)
+                Object::throw_error_occurred();
+            info.pure = enabled;
+        }
+        Object is_static = info.type.optional_attribute(_names.is_static.get());
+        if (is_static && info.node_type == NodeType::Component)
+        {
+            int enabled = PyObject_IsTrue(is_static.get());
+            if (enabled < 0)
+                Object::throw_error_occurred();
+            if (enabled)
+                info.node_type = NodeType::StaticComponent;
+        }
+        resolve_render(info);
+    }
+    else if (!PyObject_HasAttr(object, _names.tag.get()))
+        throw std::runtime_error("Cannot render object of type '" + type_name(object) + "'");
+
+    return _types.emplace(type, std::move(info)).first->second;
+}
+
+void python::TreeBuilder::resolve_render(TypeInfo &info)
+{
+    PyTypeObject *type = reinterpret_cast<PyTypeObject *>(info.type.get());
+    info.version = 0;
+    info.render.reset();
+
+    // The tag is taken before the lookup, so that a class changed by it is resolved again next time
+#if PY_VERSION_HEX >= 0x030C0000
+    if (!PyUnstable_Type_AssignVersionTag(type))
+        return;
+#else
+    // Looking an attribute up on the class assigns its tag
+    if (!PyObject_HasAttr(info.type.get(), _names.render.get()) || !(type->tp_flags & Py_TPFLAGS_VALID_VERSION_TAG))
+        return;
+#endif
+    const unsigned int version = type->tp_version_tag;
+
+    // Walk the MRO like attribute lookup does, keeping only plain functions: the
+    // result of a descriptor, e.g. a staticmethod, must not be called with the instance
+    PyObject *mro = type->tp_mro;
+    for (Py_ssize_t index = 0; mro && index < PyTuple_GET_SIZE(mro); ++index)
+    {
+        PyObject *dictionary = reinterpret_cast<PyTypeObject *>(PyTuple_GET_ITEM(mro, index))->tp_dict;
+        PyObject *found = dictionary ? PyDict_GetItemWithError(dictionary, _names.render.get()) : nullptr;
+        if (!found && PyErr_Occurred())
+            Object::throw_error_occurred();
+        if (!found)
+            continue;
+        if (PyFunction_Check(found))
+        {
+            info.render = Object::borrow(found);
+            info.version = version;
+        }
+        return;
+    }
+}
+
+python::Object python::TreeBuilder::render(PyObject *component, TypeInfo &info)
+{
+    PyTypeObject *type = Py_TYPE(component);
+    if (info.version != type->tp_version_tag || !(type->tp_flags & Py_TPFLAGS_VALID_VERSION_TAG))
+        resolve_render(info);
+
+    if (info.render && info.version != 0)
+        return info.render.call(component);
+    return Object::borrow(component).call_method(_names.render.get());
+}
+
+bool python::TreeBuilder::step()
+{
+    Work work = std::move(_work.back());
+    _work.pop_back();
+    PyObject *object = work.object.get();
+    const vdom::NodeId parent = work.parent;
+
+    if (work.action == Action::LeaveComponent)
+    {
+        _depth--;
+        if (_cache)
+            leave_component();
+        return false;
+    }
+
+    if (work.action == Action::LeaveStaticComponent)
+    {
+        _depth--;
+        freeze_static(object);
+        leave_component();
+        return false;
+    }
+
+    if (work.action == Action::LeaveElement)
+    {
+        leave(parent, _checkpoints.back());
+        _checkpoints.pop_back();
+        return false;
+    }
+
+    if (object == Py_None || PyBool_Check(object))
+        return false;
+
+    if (PyList_Check(object) || PyTuple_Check(object))
+    {
+        if (parent == vdom::null_node)
+            throw std::runtime_error("The root component must render a single node, not a sequence");
+        push_children(object, parent);
+        return false;
+    }
+
+    if (PyUnicode_Check(object) || PyLong_Check(object) || PyFloat_Check(object))
+    {
+        const vdom::Tree::Checkpoint checkpoint = _tree.checkpoint();
+        vdom::NodeId node = build_text(object);
+        attach(node, parent);
+        if (_listener)
+            leave(node, checkpoint);
+        return false;
+    }
+
+    TypeInfo &info = type_info(object);
+    if (info.node_type == NodeType::Element)
+    {
+        attach(build_element(object), parent);
+        return false;
+    }
+
+    if (info.node_type == NodeType::StaticComponent && copy_static(object, parent))
+        return false;
+    return build_component(object, info, parent);
+}
+
+void python::TreeBuilder::attach(vdom::NodeId node, vdom::NodeId parent)
+{
+    // Streamed nodes are not linked, they are dropped once left
+    if (parent != vdom::null_node)
+    {
+        if (!_listener)
+            _tree.append_child(parent, node);
+    }
+    else if (_tree.root() == vdom::null_node)
+        _tree.set_root(node);
+    else
+        throw std::runtime_error("The root component must render a single node");
+
+    if (_listener)
+        _listener->enter(_tree, node);
+}
+
+void python::TreeBuilder::leave(vdom::NodeId node, const vdom::Tree::Checkpoint &checkpoint)
+{
+    _listener->leave(_tree, node);
+    if (node != _tree.root())
+        _tree.rollback(checkpoint);
+}
+
+bool python::TreeBuilder::build_component(PyObject *component, TypeInfo &info, vdom::NodeId parent)
+{
+    PyObject *cached = _cache ? _cache->enter(component, _depth, info.node_type != NodeType::UnmemoizedComponent, info.pure) : nullptr;
+    if ((cached || (_cache && _cache->hydrated())) && copy_cached(parent))
+        return false;
+
+    Object output = Object::borrow(cached);
+    if (!cached)
+    {
+        trace::Span span("render", Py_TYPE(component)->tp_name);
+        output = render(component, info);
+    }
+    if (_cache && !cached)
+        _cache->store(component, output.share());
+
+    // The output is built before the component is left
+    _depth++;
+    if (_cache)
+        _outputs.push_back({static_cast<vdom::NodeId>(_tree.size()), _handlers.size()});
+    if (info.node_type == NodeType::StaticComponent && _cache && !_listener)
+        _work.push_back({Object::borrow(component), parent, Action::LeaveStaticComponent});
+    else
+        _work.push_back({Object(), parent, Action::LeaveComponent});
+    _work.push_back({std::move(output), parent, Action::Build});
+    return !cached;
+}
+
+void python::TreeBuilder::leave_component()
+{
+    const Output output = _outputs.back();
+    _outputs.pop_back();
+
+    // Streamed nodes are dropped once left, they cannot be copied by a later build
+    if (_listener)
+        _cache->leave({vdom::null_node, 0});
+    else
+        _cache->leave({output.node, static_cast<vdom::NodeId>(_tree.size() - output.node)});
+}
+
+bool python::TreeBuilder::copy_cached(vdom::NodeId parent)
+{
+    if (_listener || !_mounted || _mounted->serial() != _cache->tree())
+        return false;
+    const vdom::NodeId first = static_cast<vdom::NodeId>(_tree.size());
+    const RenderCache::NodeRange *nodes = _cache->reuse_nodes(first);
+    if (!nodes)
+        return false;
+
+    copy_mounted(nodes->first, nodes->count, parent);
+    _cache->leave({first, nodes->count});
+    return true;
+}
+
+void python::TreeBuilder::copy_mounted(vdom::NodeId first, vdom::NodeId count, vdom::NodeId parent)
+{
+    const vdom::NodeId copy = _tree.copy_nodes(*_mounted, first, count);
+    const vdom::NodeId end = first + count;
+    for (vdom::NodeId node = first; node < end; node = _mounted->next_sibling(node))
+        attach(node - first + copy, parent);
+    copy_handlers(first, count, copy);
+}
+
+void python::TreeBuilder::copy_handlers(vdom::NodeId first, vdom::NodeId count, vdom::NodeId copy)
+{
+    // Handlers are sorted by node, as nodes are built and copied in order
+    const vdom::NodeId end = first + count;
+    auto handler = std::lower_bound(_mounted_handlers.begin(), _mounted_handlers.end(), first,
+                                    [](const Handler &handler, vdom::NodeId node)
+                                    { return handler.node < node; });
+    for (; handler != _mounted_handlers.end() && handler->node < end; ++handler)
+        _handlers.push_back({handler->node - first + copy, handler->type, handler->callback.share()});
+}
+
+bool python::TreeBuilder::plan_splices(PyObject *root, std::span<PyObject *const> dirty)
+{
+    if (dirty.empty() || !_cache || _listener || !_mounted || _mounted->root() == vdom::null_node ||
+        _mounted->serial() != _cache->tree() || !_cache->find(root))
+        return false;
+
+    for (PyObject *component : dirty)
+    {
+        // The root spans every node, and an empty output leaves no place to build the new one at
+        const RenderCache::Entry *entry = _cache->find(component);
+        if (component == root || !entry || entry->nodes.first == vdom::null_node || entry->nodes.count == 0)
+        {
+            _splices.clear();
+            return false;
+        }
+        _splices.push_back({Object::borrow(component), entry->nodes, entry->depth});
+    }
+
+    // Outputs nest or are disjoint: keep the outermost, the first of equal ones being the parent
+    std::stable_sort(_splices.begin(), _splices.end(), [](const Splice &left, const Splice &right)
+                     { return left.nodes.first < right.nodes.first ||
+                              (left.nodes.first == right.nodes.first && left.nodes.count > right.nodes.count); });
+    vdom::NodeId end = 0;
+    auto inside = [&end](const Splice &splice)
+    {
+        if (splice.nodes.first < end)
+            return true;
+        end = splice.nodes.first + splice.nodes.count;
+        return false;
+    };
+    _splices.erase(std::remove_if(_splices.begin(), _splices.end(), inside), _splices.end());
+    _root = Object::borrow(root);
+    return true;
+}
+
+bool python::TreeBuilder::splice()
+{
+    if (!_splicing)
+        return false;
+    if (_spliced != vdom::null_node)
+    {
+        _replacements.back().count = static_cast<vdom::NodeId>(_tree.size()) - _spliced;
+        _spliced = vdom::null_node;
+    }
+
+    // Copy the mounted tree in pre-order up to the next splice
+    const vdom::Tree &mounted = *_mounted;
+    while (_cursor < mounted.size())
+    {
+        while (!_ancestors.empty() && _ancestors.back().first <= _cursor)
+            _ancestors.pop_back();
+        const vdom::NodeId parent = _ancestors.empty() ? vdom::null_node : _ancestors.back().second;
+        const Splice *next = _next_splice < _splices.size() ? &_splices[_next_splice] : nullptr;
+        if (next && next->nodes.first == _cursor)
+        {
+            _next_splice++;
+            _depth = next->depth;
+            _spliced = static_cast<vdom::NodeId>(_tree.size());
+            _replacements.push_back({next->nodes, 0});
+            _cursor += next->nodes.count;
+            _work.push_back({next->component.share(), parent, Action::Build});
+            return true;
+        }
+
+        vdom::NodeId last = _cursor;
+        while (mounted.last_child(last) != vdom::null_node)
+            last = mounted.last_child(last);
+        if (next && next->nodes.first <= last)
+        {
+            // An ancestor of the splice gets new children: copied alone, without its handle
+            const vdom::NodeId copy = _tree.copy_node(mounted, _cursor);
+            attach(copy, parent);
+            copy_handlers(_cursor, 1, copy);
+            _ancestors.push_back({last + 1, copy});
+            _cursor++;
+        }
+        else
+        {
+            copy_mounted(_cursor, last + 1 - _cursor, parent);
+            _cursor = last + 1;
+        }
+    }
+
+    _splicing = false;
+    _cache->retain(_root.get(), _replacements);
+    return false;
+}
+
+bool python::TreeBuilder::copy_static(PyObject *component, vdom::NodeId parent)
+{
+    // Streamed nodes are left one by one, a copied block would not be
+    if (!_cache || _listener)
+        return false;
+    const vdom::StaticBlock *block = _cache->static_block(Py_TYPE(component));
+    if (!block)
+        return false;
+    attach(_tree.copy_block(*block), parent);
+    return true;
+}
+
+void python::TreeBuilder::freeze_static(PyObject *component)
+{
+    const Output output = _outputs.back();
+
+    // Handlers belong to an instance, and a fragment has no single root to mark
+    if (_handlers.size() != output.handlers || output.node >= _tree.size())
+        return;
+    if (const vdom::StaticBlock *block = _tree.block(output.node))
+    {
+        if (block->size() == _tree.size() - output.node)
+            _cache->store_static_block(Py_TYPE(component), vdom::Ref<const vdom::StaticBlock>(block));
+        return;
+    }
+
+    std::size_t nodes = 0;
+    std::vector<vdom::NodeId> stack{output.node};
+    while (!stack.empty())
+    {
+        vdom::NodeId node = stack.back();
+        stack.pop_back();
+        nodes++;
+        for (vdom::NodeId child : _tree.children(node))
+            stack.push_back(child);
+    }
+    if (nodes != _tree.size() - output.node)
+        return;
+
+    vdom::Ref<const vdom::StaticBlock> block = vdom::StaticBlock::freeze(_tree, output.node);
+    _tree.mark_block(output.node, *block);
+    _cache->store_static_block(Py_TYPE(component), std::move(block));
+}
+
+void python::TreeBuilder::push_children(PyObject *children, vdom::NodeId parent)
+{
+    Object sequence(PySequence_Fast(children, "Element children must be a sequence"));
+    Py_ssize_t size = PySequence_Fast_GET_SIZE(sequence.get());
+    PyObject **items = PySequence_Fast_ITEMS(sequence.get());
+
+    // Reversed, so that children are popped in order; each item is held, render() calls may mutate the sequence
+    for (Py_ssize_t index = size; index-- > 0;)
+        _work.push_back({Object::borrow(items[index]), parent, Action::Build});
+}
+
+vdom::NodeId python::TreeBuilder::build_element(PyObject *element)
+{
+    Object tag(PyObject_GetAttr(element, _names.tag.get()));
+    Object key(PyObject_GetAttr(element, _names.key.get()));
+    Object properties(PyObject_GetAttr(element, _names.properties.get()));
+    Object children(PyObject_GetAttr(element, _names.children.get()));
+
+    if (!PyUnicode_Check(tag.get()))
+        throw std::runtime_error("Element tag must be a str, not '" + type_name(tag.get()) + "'");
+
+    _properties.clear();
+    const std::size_t handlers = _handlers.size();
+    collect_properties(properties.get());
+    const vdom::Tree::Checkpoint checkpoint = _tree.checkpoint();
+    vdom::NodeId node = _tree.create_element(to_atom(tag.get()), to_value(key.get()), _properties);
+    for (std::size_t index = handlers; index < _handlers.size(); ++index)
+        _handlers[index].node = node;
+
+    // A streamed element is left once its children are built
+    if (_listener)
+    {
+        _checkpoints.push_back(checkpoint);
+        _work.push_back({Object(), node, Action::LeaveElement});
+    }
+    if (children.get() != Py_None)
+        push_children(children.get(), node);
+    return node;
+}
+
+vdom::NodeId python::TreeBuilder::build_text(PyObject *object)
+{
+    if (PyUnicode_Check(object))
+        return _tree.create_text(utf8_view(object));
+
+    Object text(PyObject_Str(object));
+    return _tree.create_text(utf8_view(text.get()));
+}
+
+void python::TreeBuilder::collect_properties(PyObject *properties)
+{
+    if (properties == Py_None)
+        return;
+
+    if (is_properties(properties))
+    {
+        std::span<const vdom::Property> items = reinterpret_cast<PropertiesObject *>(properties)->properties.items();
+        _properties.insert(_properties.end(), items.begin(), items.end());
+        return;
+    }
+
+    Object dictionary = Object::borrow(properties);
+    if (!PyDict_Check(properties))
+        dictionary = Object(PyObject_GetAttr(properties, _names.properties.get()));
+    if (!PyDict_Check(dictionary.get()))
+        throw std::runtime_error("Element properties must be a Properties or a dict, not '" + type_name(properties) + "'");
+
+    Py_ssize_t position = 0;
+    PyObject *key = nullptr;
+    PyObject *value = nullptr;
+    while (PyDict_Next(dictionary.get(), &position, &key, &value))
+    {
+        if (!PyUnicode_Check(key))
+            throw std::runtime_error("Property names must be str, not '" + type_name(key) + "'");
+
+        const vdom::Atom name = to_atom(key);
+        if (PyCallable_Check(value))
+        {
+            const vdom::Atom type = event_type(name);
+            if (type != vdom::null_atom)
+            {
+                // Streamed nodes are dropped once left, their handlers could never be called
+                if (!_listener)
+                    _handlers.push_back({vdom::null_node, type, Object::borrow(value)});
+                _properties.push_back({name, vdom::Value::boolean(true)});
+                continue;
+            }
+        }
+        _properties.push_back({name, to_value(value)});
+    }
+}
+
+vdom::Atom python::TreeBuilder::event_type(vdom::Atom property)
+{
+    auto it = _event_types.find(property);
+    if (it != _event_types.end())
+        return it->second;
+
+    constexpr std::string_view prefix = "on_";
+    const std::string_view name = _atoms.name(property);
+    const vdom::Atom type = name.size() > prefix.size() && name.starts_with(prefix) ? _atoms.intern(name.substr(prefix.size()))
+                                                                                   : vdom::null_atom;
+    _event_types.emplace(property, type);
+    return type;
+}
+
+vdom::Atom python::TreeBuilder::to_atom(PyObject *object)
+{
+    return _atoms.intern(utf8_view(object));
+}
@@ -0,0 +1,66 @@
+#include <stdexcept>
+#include <string>
+
+#include "python/object.hpp"
+#include "python/persistent_type.hpp"
+#include "python/value.hpp"
+
+std::string_view python::utf8_view(PyObject *string)
+{
+    Py_ssize_t size = 0;
+    const char *data = PyUnicode_AsUTF8AndSize(string, &size);
+
+    if (!data)
+        Object::throw_error_occurred();
+    return {data, static_cast<std::size_t>(size)};
+}
+
+vdom::Value python::to_value(PyObject *object)
+{
+    if (object == Py_None)
+        return vdom::Value();
+    if (PyBool_Check(object))
+        return vdom::Value::boolean(object == Py_True);
+    if (PyLong_Check(object))
+    {
+        int overflow = 0;
+        long long integer = PyLong_AsLongLongAndOverflow(object, &overflow);
+        if (overflow)
+            throw std::overflow_error("Python int too large for a 64-bit property value");
+        return vdom::Value::integer(integer);
+    }
+    if (PyFloat_Check(object))
+        return vdom::Value::floating(PyFloat_AS_DOUBLE(object));
+    if (PyUnicode_Check(object))
+        return vdom::Value::string(utf8_view(object));
+    if (is_persistent_map(object))
+        return vdom::Value::map(reinterpret_cast<PersistentMapObject *>(object)->map.get());
+    if (is_persistent_vector(object))
+        return vdom::Value::vector(reinterpret_cast<PersistentVectorObject *>(object)->vector.get());
+    throw std::runtime_error(std::string("Unsupported property value of type '") + Py_TYPE(object)->tp_name + "'");
+}
+
+PyObject *python::from_value(const vdom::Value &value)
+{
+    switch (value.type())
+    {
+    case vdom::Value::Type::None:
+        Py_RETURN_NONE;
+    case vdom::Value::Type::Bool:
+        return PyBool_FromLong(value.as_bool());
+    case vdom::Value::Type::Integer:
+        return PyLong_FromLongLong(value.as_integer());
+    case vdom::Value::Type::Float:
+        return PyFloat_FromDouble(value.as_float());
+    case vdom::Value::Type::String:
+    {
+        std::string_view text = value.as_string();
+        return PyUnicode_FromStringAndSize(text.data(), static_cast<Py_ssize_t>(text.size()));
+    }
+    case vdom::Value::Type::Map:
+        return wrap(vdom::Ref<const vdom::PersistentMap>(value.as_map()));
+    case vdom::Value::Type::Vector:
+        return wrap(vdom::Ref<const vdom::PersistentVector>(value.as_vector()));
+    }
+    Py_RETURN_NONE;
+}
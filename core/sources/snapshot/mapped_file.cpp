@@ -0,0 +1,141 @@
+#include <cerrno>
+#include <system_error>
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "snapshot/mapped_file.hpp"
+
+snapshot::MappedFile::MappedFile() noexcept
+    : _data(nullptr), _size(0)
+#ifdef _WIN32
+      ,
+      _mapping(nullptr)
+#endif
+{
+}
+
+#ifdef _WIN32
+snapshot::MappedFile::MappedFile(const std::filesystem::path &path) : MappedFile()
+{
+    auto fail = [](const char *what)
+    { return std::system_error(static_cast<int>(GetLastError()), std::system_category(), what); };
+
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        throw fail("Failed to open snapshot");
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size))
+    {
+        auto error = fail("Failed to read snapshot size");
+        CloseHandle(file);
+        throw error;
+    }
+    _size = static_cast<std::size_t>(size.QuadPart);
+    if (_size == 0)
+    {
+        CloseHandle(file);
+        return;
+    }
+
+    _mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!_mapping)
+        throw fail("Failed to map snapshot");
+    _data = static_cast<const std::byte *>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!_data)
+    {
+        auto error = fail("Failed to map snapshot");
+        CloseHandle(_mapping);
+        _mapping = nullptr;
+        throw error;
+    }
+}
+
+void snapshot::MappedFile::unmap() noexcept
+{
+    if (_data)
+        UnmapViewOfFile(_data);
+    if (_mapping)
+        CloseHandle(_mapping);
+    _data = nullptr;
+    _mapping = nullptr;
+    _size = 0;
+}
+#else
+snapshot::MappedFile::MappedFile(const std::filesystem::path &path) : MappedFile()
+{
+    int descriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (descriptor < 0)
+        throw std::system_error(errno, std::generic_category(), "Failed to open snapshot");
+
+    struct stat status;
+    if (::fstat(descriptor, &status) < 0)
+    {
+        int error = errno;
+        ::close(descriptor);
+        throw std::system_error(error, std::generic_category(), "Failed to read snapshot size");
+    }
+    _size = static_cast<std::size_t>(status.st_size);
+    if (_size == 0)
+    {
+        ::close(descriptor);
+        return;
+    }
+
+    // The mapping outlives the descriptor
+    void *data = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    int error = errno;
+    ::close(descriptor);
+    if (data == MAP_FAILED)
+    {
+        _size = 0;
+        throw std::system_error(error, std::generic_category(), "Failed to map snapshot");
+    }
+    _data = static_cast<const std::byte *>(data);
+}
+
+void snapshot::MappedFile::unmap() noexcept
+{
+    if (_data)
+        ::munmap(const_cast<std::byte *>(_data), _size);
+    _data = nullptr;
+    _size = 0;
+}
+#endif
+
+snapshot::MappedFile::MappedFile(MappedFile &&other) noexcept
+    : _data(std::exchange(other._data, nullptr)), _size(std::exchange(other._size, 0))
+#ifdef _WIN32
+      ,
+      _mapping(std::exchange(other._mapping, nullptr))
+#endif
+{
+}
+
+snapshot::MappedFile &snapshot::MappedFile::operator=(MappedFile &&other) noexcept
+{
+    if (this == &other)
+        return *this;
+    unmap();
+    _data = std::exchange(other._data, nullptr);
+    _size = std::exchange(other._size, 0);
+#ifdef _WIN32
+    _mapping = std::exchange(other._mapping, nullptr);
+#endif
+    return *this;
+}
+
+snapshot::MappedFile::~MappedFile()
+{
+    unmap();
+}
@@ -0,0 +1,636 @@
+#include <bit>
+#include <cstring>
+#include <functional>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include "snapshot/snapshot.hpp"
+#include "trace/tracer.hpp"
+
+namespace
+{
+    using snapshot::format::Section;
+
+    constexpr std::size_t section_count = static_cast<std::size_t>(Section::Count);
+
+    /**
+     * @brief Size of the records of each section, in Section order
+     *
+     */
+    constexpr std::size_t record_sizes[section_count] = {
+        sizeof(std::uint8_t),
+        sizeof(std::uint32_t),
+        sizeof(snapshot::format::Value),
+        sizeof(snapshot::format::Value),
+        sizeof(std::uint32_t),
+        sizeof(std::uint32_t),
+        sizeof(std::uint32_t),
+        sizeof(std::uint32_t),
+        sizeof(std::uint64_t),
+        sizeof(vdom::PropertySlice),
+        sizeof(snapshot::format::Property),
+        sizeof(snapshot::format::StringRange),
+        sizeof(char),
+        sizeof(layout::Box),
+        sizeof(snapshot::format::Component),
+        sizeof(snapshot::format::Property),
+    };
+
+    static_assert(snapshot::format::null_index == vdom::null_node && sizeof(vdom::NodeKind) == sizeof(std::uint8_t),
+                  "Node columns are read in place");
+
+    /**
+     * @brief Tell whether text is well-formed UTF-8: no overlong forms, surrogates or code points past U+10FFFF
+     *
+     */
+    bool valid_utf8(std::string_view text) noexcept
+    {
+        const auto *bytes = reinterpret_cast<const unsigned char *>(text.data());
+        const std::size_t size = text.size();
+        for (std::size_t index = 0; index < size;)
+        {
+            const unsigned char lead = bytes[index];
+            if (lead < 0x80)
+            {
+                index++;
+                continue;
+            }
+
+            std::size_t length = 0;
+            unsigned char low = 0x80;
+            unsigned char high = 0xBF;
+            if (lead >= 0xC2 && lead <= 0xDF)
+                length = 2;
+            else if (lead >= 0xE0 && lead <= 0xEF)
+            {
+                length = 3;
+                low = lead == 0xE0 ? 0xA0 : 0x80;
+                high = lead == 0xED ? 0x9F : 0xBF;
+            }
+            else if (lead >= 0xF0 && lead <= 0xF4)
+            {
+                length = 4;
+                low = lead == 0xF0 ? 0x90 : 0x80;
+                high = lead == 0xF4 ? 0x8F : 0xBF;
+            }
+            else
+                return false;
+
+            if (size - index < length || bytes[index + 1] < low || bytes[index + 1] > high)
+                return false;
+            for (std::size_t continuation = 2; continuation < length; ++continuation)
+            {
+                if ((bytes[index + continuation] & 0xC0) != 0x80)
+                    return false;
+            }
+            index += length;
+        }
+        return true;
+    }
+
+    std::uint32_t to_index(vdom::NodeId node) noexcept
+    {
+        return node == vdom::null_node ? snapshot::format::null_index : node;
+    }
+
+    /**
+     * @brief Sections being assembled in memory before they are written
+     *
+     */
+    struct Writer
+    {
+        const vdom::Tree &tree;
+        vdom::AtomTable &atoms;
+        std::vector<std::uint32_t> atom_indices;
+        std::vector<snapshot::format::StringRange> atom_ranges;
+        std::string strings;
+
+        std::uint32_t store(std::string_view text)
+        {
+            if (strings.size() + text.size() > 0xFFFFFFFF)
+                throw std::length_error("Too many characters in snapshot");
+            std::uint32_t offset = static_cast<std::uint32_t>(strings.size());
+            strings.append(text);
+            return offset;
+        }
+
+        std::uint32_t atom(vdom::Atom atom)
+        {
+            // Only the atoms the tree uses are saved, in order of first use
+            if (atom >= atom_indices.size())
+                atom_indices.resize(atom + 1, snapshot::format::null_index);
+            if (atom_indices[atom] == snapshot::format::null_index)
+            {
+                std::string_view name = atoms.name(atom);
+                atom_indices[atom] = static_cast<std::uint32_t>(atom_ranges.size());
+                atom_ranges.push_back({store(name), static_cast<std::uint32_t>(name.size())});
+            }
+            return atom_indices[atom];
+        }
+
+        snapshot::format::Value value(const vdom::Value &value)
+        {
+            snapshot::format::Value stored{static_cast<std::uint8_t>(value.type()), {}, 0, 0};
+            switch (value.type())
+            {
+            case vdom::Value::Type::None:
+                break;
+            case vdom::Value::Type::Bool:
+                stored.payload = value.as_bool();
+                break;
+            case vdom::Value::Type::Integer:
+                stored.payload = std::bit_cast<std::uint64_t>(value.as_integer());
+                break;
+            case vdom::Value::Type::Float:
+                stored.payload = std::bit_cast<std::uint64_t>(value.as_float());
+                break;
+            case vdom::Value::Type::String:
+                stored.size = static_cast<std::uint32_t>(value.as_string().size());
+                stored.payload = store(value.as_string());
+                break;
+            case vdom::Value::Type::Map:
+            case vdom::Value::Type::Vector:
+                // Live in the memory of the process that built them: saved as None
+                stored.type = static_cast<std::uint8_t>(vdom::Value::Type::None);
+                break;
+            }
+            return stored;
+        }
+    };
+
+    /**
+     * @brief What a tree mounted from a snapshot reads: the mapping, and the columns translated for this process
+     *
+     */
+    struct Mount : vdom::Shared
+    {
+        std::shared_ptr<const snapshot::MappedFile> file;
+        std::vector<vdom::Atom> tags;
+        std::vector<vdom::Value> keys;
+        std::vector<vdom::Value> texts;
+        std::vector<vdom::Property> properties;
+    };
+
+    std::uint64_t mix(std::uint64_t hash) noexcept
+    {
+        hash ^= hash >> 30;
+        hash *= 0xBF58476D1CE4E5B9;
+        hash ^= hash >> 27;
+        hash *= 0x94D049BB133111EB;
+        return hash ^ (hash >> 31);
+    }
+
+    template <typename Record>
+    std::string_view bytes_of(const std::vector<Record> &records) noexcept
+    {
+        return {reinterpret_cast<const char *>(records.data()), records.size() * sizeof(Record)};
+    }
+} // namespace
+
+std::optional<std::uint64_t> snapshot::properties_hash(std::span<const vdom::Property> properties,
+                                                       const vdom::AtomTable &atoms)
+{
+    // Summed, as the properties are sorted by atoms, whose order differs between processes
+    std::uint64_t hash = properties.size();
+    for (const vdom::Property &property : properties)
+    {
+        const vdom::Value::Type type = property.value.type();
+        if (type == vdom::Value::Type::Map || type == vdom::Value::Type::Vector)
+            return std::nullopt;
+        hash += mix(std::hash<std::string_view>{}(atoms.name(property.key)) ^ mix(property.value.hash()));
+    }
+    return hash;
+}
+
+void snapshot::write(const vdom::Tree &tree, const std::filesystem::path &path, const layout::LayoutTree *layout,
+                     std::span<const Component> components, vdom::AtomTable &atoms)
+{
+    trace::Span span("save snapshot");
+    const std::size_t nodes = tree.size();
+
+    Writer writer{tree, atoms, {}, {}, {}};
+    writer.atom(vdom::null_atom);
+
+    std::vector<std::uint8_t> kinds(nodes);
+    std::vector<std::uint32_t> tags(nodes);
+    std::vector<format::Value> keys(nodes);
+    std::vector<format::Value> texts(nodes);
+    std::vector<std::uint32_t> parents(nodes);
+    std::vector<std::uint32_t> first_children(nodes);
+    std::vector<std::uint32_t> last_children(nodes);
+    std::vector<std::uint32_t> next_siblings(nodes);
+    std::vector<std::uint64_t> handles(nodes);
+    std::vector<vdom::PropertySlice> slices(nodes);
+    std::vector<format::Property> properties;
+    std::vector<layout::Box> boxes(layout ? nodes : 0);
+
+    for (vdom::NodeId node = 0; node < nodes; ++node)
+    {
+        kinds[node] = static_cast<std::uint8_t>(tree.kind(node));
+        tags[node] = writer.atom(tree.tag(node));
+        keys[node] = writer.value(tree.key(node));
+        texts[node] = tree.kind(node) == vdom::NodeKind::Text ? writer.value(vdom::Value::string(tree.text(node))) : writer.value({});
+        parents[node] = to_index(tree.parent(node));
+        first_children[node] = to_index(tree.first_child(node));
+        last_children[node] = to_index(tree.last_child(node));
+        next_siblings[node] = to_index(tree.next_sibling(node));
+        handles[node] = tree.handle(node);
+
+        std::span<const vdom::Property> node_properties = tree.properties(node);
+        slices[node] = {static_cast<std::uint32_t>(properties.size()), static_cast<std::uint32_t>(node_properties.size())};
+        for (const vdom::Property &property : node_properties)
+            properties.push_back({writer.atom(property.key), 0, writer.value(property.value)});
+
+        if (layout)
+        {
+            if (const layout::Box *box = layout->box(tree.handle(node)))
+                boxes[node] = *box;
+        }
+    }
+
+    std::vector<format::Component> component_records;
+    std::vector<format::Property> component_properties;
+    for (const Component &component : components)
+    {
+        if (component.type.size() > 0xFFFFFFFF)
+            throw std::length_error("Too many characters in snapshot");
+        format::Component record{{writer.store(component.type), static_cast<std::uint32_t>(component.type.size())},
+                                 component.parent,
+                                 to_index(component.first),
+                                 component.count,
+                                 0,
+                                 {static_cast<std::uint32_t>(component_properties.size()), 0},
+                                 0};
+        std::optional<std::uint64_t> hash;
+        if (component.properties)
+            hash = properties_hash(component.properties->items(), atoms);
+        if (hash)
+        {
+            record.reusable = 1;
+            record.properties_hash = *hash;
+            record.properties.count = static_cast<std::uint32_t>(component.properties->size());
+            for (const vdom::Property &property : component.properties->items())
+                component_properties.push_back({writer.atom(property.key), 0, writer.value(property.value)});
+        }
+        component_records.push_back(record);
+    }
+
+    const std::string_view contents[section_count] = {
+        bytes_of(kinds),
+        bytes_of(tags),
+        bytes_of(keys),
+        bytes_of(texts),
+        bytes_of(parents),
+        bytes_of(first_children),
+        bytes_of(last_children),
+        bytes_of(next_siblings),
+        bytes_of(handles),
+        bytes_of(slices),
+        bytes_of(properties),
+        bytes_of(writer.atom_ranges),
+        writer.strings,
+        bytes_of(boxes),
+        bytes_of(component_records),
+        bytes_of(component_properties),
+    };
+
+    format::Header header{};
+    std::memcpy(header.magic, format::magic, sizeof(header.magic));
+    header.version = format::version;
+    header.byte_order = format::byte_order;
+    header.nodes = static_cast<std::uint32_t>(nodes);
+    header.root = to_index(tree.root());
+    header.generation = tree.generation();
+
+    std::uint64_t offset = sizeof(format::Header);
+    for (std::size_t index = 0; index < section_count; ++index)
+    {
+        offset = (offset + 7) & ~std::uint64_t(7);
+        header.sections[index] = {offset, contents[index].size()};
+        offset += contents[index].size();
+    }
+
+    // Write beside the destination, then replace it at once
+    std::filesystem::path temporary = path;
+    temporary += ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        std::uint64_t position = sizeof(format::Header);
+        for (std::size_t index = 0; index < section_count; ++index)
+        {
+            const char padding[8] = {};
+            file.write(padding, static_cast<std::streamsize>(header.sections[index].offset - position));
+            file.write(contents[index].data(), static_cast<std::streamsize>(contents[index].size()));
+            position = header.sections[index].offset + contents[index].size();
+        }
+        file.close();
+        if (!file)
+            throw std::system_error(std::make_error_code(std::errc::io_error), "Failed to write snapshot " + temporary.string());
+    }
+    std::filesystem::rename(temporary, path);
+}
+
+snapshot::Snapshot::Snapshot(const std::filesystem::path &path)
+    : _file(std::make_shared<const MappedFile>(path)), _header(nullptr)
+{
+    const std::string name = path.string();
+    if (_file->size() < sizeof(format::Header))
+        throw std::runtime_error("Snapshot " + name + " is truncated");
+
+    _header = reinterpret_cast<const format::Header *>(_file->data());
+    if (std::memcmp(_header->magic, format::magic, sizeof(format::magic)) != 0)
+        throw std::runtime_error(name + " is not a snapshot");
+    if (_header->version != format::version)
+        throw std::runtime_error("Snapshot " + name + " has version " + std::to_string(_header->version) +
+                                 ", expected " + std::to_string(format::version));
+    if (_header->byte_order != format::byte_order)
+        throw std::runtime_error("Snapshot " + name + " was written with another byte order");
+
+    for (std::size_t index = 0; index < section_count; ++index)
+    {
+        const format::Range &range = _header->sections[index];
+        if (range.offset % 8 != 0 || range.offset > _file->size() || range.size > _file->size() - range.offset ||
+            range.size % record_sizes[index] != 0)
+            throw std::runtime_error("Snapshot " + name + " is truncated or corrupted");
+
+        // Node columns hold exactly one record per node, layout may be absent
+        const bool per_node = index <= static_cast<std::size_t>(Section::PropertySlices) || index == static_cast<std::size_t>(Section::Boxes);
+        const std::size_t records = range.size / record_sizes[index];
+        if (per_node && records != _header->nodes && !(index == static_cast<std::size_t>(Section::Boxes) && records == 0))
+            throw std::runtime_error("Snapshot " + name + " is truncated or corrupted");
+    }
+
+    if (_header->root != format::null_index && _header->root >= _header->nodes)
+        throw std::runtime_error("Snapshot " + name + " is truncated or corrupted");
+}
+
+std::string_view snapshot::Snapshot::string(std::uint32_t offset, std::uint32_t size) const noexcept
+{
+    std::span<const char> strings = section<char>(Section::Strings);
+    if (offset > strings.size() || size > strings.size() - offset)
+        return {};
+    return {strings.data() + offset, size};
+}
+
+std::string_view snapshot::Snapshot::checked_string(std::uint32_t offset, std::uint32_t size) const
+{
+    // Strings reach Python as str, which a corrupted byte must not turn into a decoding error there
+    std::span<const char> strings = section<char>(Section::Strings);
+    if (offset > strings.size() || size > strings.size() - offset || !valid_utf8({strings.data() + offset, size}))
+        throw std::runtime_error("Snapshot is corrupted");
+    return {strings.data() + offset, size};
+}
+
+vdom::Value snapshot::Snapshot::value(const format::Value &value) const noexcept
+{
+    switch (static_cast<vdom::Value::Type>(value.type))
+    {
+    case vdom::Value::Type::Bool:
+        return vdom::Value::boolean(value.payload != 0);
+    case vdom::Value::Type::Integer:
+        return vdom::Value::integer(std::bit_cast<std::int64_t>(value.payload));
+    case vdom::Value::Type::Float:
+        return vdom::Value::floating(std::bit_cast<double>(value.payload));
+    case vdom::Value::Type::String:
+        return vdom::Value::string(string(static_cast<std::uint32_t>(value.payload), value.size));
+    default:
+        return {};
+    }
+}
+
+vdom::Value snapshot::Snapshot::checked_value(const format::Value &stored) const
+{
+    if (static_cast<vdom::Value::Type>(stored.type) != vdom::Value::Type::String)
+        return value(stored);
+    if (stored.payload > 0xFFFFFFFF)
+        throw std::runtime_error("Snapshot is corrupted");
+    return vdom::Value::string(checked_string(static_cast<std::uint32_t>(stored.payload), stored.size));
+}
+
+std::vector<vdom::Atom> snapshot::Snapshot::intern_atoms(vdom::AtomTable &atoms) const
+{
+    // Atoms are interned once each, nodes and properties only translate indices
+    std::span<const format::StringRange> ranges = section<format::StringRange>(Section::Atoms);
+    std::vector<vdom::Atom> live_atoms(ranges.size());
+    for (std::size_t index = 0; index < ranges.size(); ++index)
+        live_atoms[index] = atoms.intern(checked_string(ranges[index].offset, ranges[index].size));
+    return live_atoms;
+}
+
+std::string_view snapshot::Snapshot::tag(vdom::NodeId node) const noexcept
+{
+    std::span<const format::StringRange> atoms = section<format::StringRange>(Section::Atoms);
+    std::uint32_t atom = section<std::uint32_t>(Section::Tags)[node];
+    if (atom >= atoms.size())
+        return {};
+    return string(atoms[atom].offset, atoms[atom].size);
+}
+
+std::string_view snapshot::Snapshot::text(vdom::NodeId node) const noexcept
+{
+    const format::Value &text = section<format::Value>(Section::Texts)[node];
+    if (static_cast<vdom::Value::Type>(text.type) != vdom::Value::Type::String)
+        return {};
+    return string(static_cast<std::uint32_t>(text.payload), text.size);
+}
+
+void snapshot::Snapshot::mount(vdom::Tree &tree, vdom::AtomTable &atoms) const
+{
+    trace::Span span("load snapshot");
+    const std::size_t nodes = size();
+    std::span<const std::uint8_t> kinds = section<std::uint8_t>(Section::Kinds);
+    std::span<const std::uint32_t> tags = section<std::uint32_t>(Section::Tags);
+    std::span<const format::Value> keys = section<format::Value>(Section::Keys);
+    std::span<const format::Value> texts = section<format::Value>(Section::Texts);
+    std::span<const std::uint32_t> parents = section<std::uint32_t>(Section::Parents);
+    std::span<const std::uint32_t> first_children = section<std::uint32_t>(Section::FirstChildren);
+    std::span<const std::uint32_t> last_children = section<std::uint32_t>(Section::LastChildren);
+    std::span<const std::uint32_t> next_siblings = section<std::uint32_t>(Section::NextSiblings);
+    std::span<const std::uint64_t> handles = section<std::uint64_t>(Section::Handles);
+    std::span<const vdom::PropertySlice> slices = section<vdom::PropertySlice>(Section::PropertySlices);
+    std::span<const format::Property> stored_properties = section<format::Property>(Section::Properties);
+    std::span<const char> strings = section<char>(Section::Strings);
+
+    auto corrupted = []
+    { return std::runtime_error("Snapshot is corrupted"); };
+
+    // The strings are checked as UTF-8 at once, then each for starting and ending between two characters
+    if (!valid_utf8({strings.data(), strings.size()}))
+        throw corrupted();
+    auto boundary = [strings](std::uint64_t offset)
+    { return offset == strings.size() || (static_cast<unsigned char>(strings[offset]) & 0xC0) != 0x80; };
+    auto translated = [&](const format::Value &stored)
+    {
+        if (static_cast<vdom::Value::Type>(stored.type) != vdom::Value::Type::String)
+            return value(stored);
+        if (stored.payload > strings.size() || stored.size > strings.size() - stored.payload || !boundary(stored.payload) ||
+            !boundary(stored.payload + stored.size))
+            throw corrupted();
+        return vdom::Value::string({strings.data() + stored.payload, stored.size});
+    };
+
+    const std::vector<vdom::Atom> live_atoms = intern_atoms(atoms);
+    auto live_atom = [&](std::uint32_t atom)
+    {
+        if (atom >= live_atoms.size())
+            throw corrupted();
+        return live_atoms[atom];
+    };
+
+    vdom::Ref<Mount> mount = vdom::make_ref<Mount>();
+    mount->file = _file;
+    mount->tags.resize(nodes, vdom::null_atom);
+    mount->keys.resize(nodes);
+    mount->texts.resize(nodes);
+    mount->properties.reserve(stored_properties.size());
+    for (const format::Property &property : stored_properties)
+        mount->properties.push_back({live_atom(property.atom), translated(property.value)});
+
+    for (vdom::NodeId node = 0; node < nodes; ++node)
+    {
+        const vdom::PropertySlice &slice = slices[node];
+        if (slice.offset > stored_properties.size() || slice.count > stored_properties.size() - slice.offset)
+            throw corrupted();
+
+        const vdom::NodeKind kind = static_cast<vdom::NodeKind>(kinds[node]);
+        if (kind == vdom::NodeKind::Text)
+        {
+            const vdom::Value text = translated(texts[node]);
+            mount->texts[node] = text.type() == vdom::Value::Type::String ? text : vdom::Value::string({});
+            if (slice.count != 0)
+                throw corrupted();
+            continue;
+        }
+        if (kind != vdom::NodeKind::Element)
+            throw corrupted();
+        mount->tags[node] = live_atom(tags[node]);
+        mount->keys[node] = translated(keys[node]);
+
+        // Saved sorted by the atoms of the writer: sorted again by those of this process
+        vdom::Property *begin = mount->properties.data() + slice.offset;
+        vdom::Property *end = begin + slice.count;
+        for (vdom::Property *property = begin; property != end; ++property)
+        {
+            const vdom::Property moved = *property;
+            vdom::Property *position = property;
+            for (; position != begin && (position - 1)->key > moved.key; --position)
+                *position = *(position - 1);
+            *position = moved;
+            if (position != begin && (position - 1)->key == moved.key)
+                throw corrupted();
+        }
+    }
+
+    // Children are linked in order, each once, to the parent they name
+    auto in_bounds = [nodes](std::uint32_t node)
+    { return node == format::null_index || node < nodes; };
+    for (vdom::NodeId node = 0; node < nodes; ++node)
+    {
+        if (!in_bounds(parents[node]) || !in_bounds(first_children[node]) || !in_bounds(last_children[node]) ||
+            !in_bounds(next_siblings[node]))
+            throw corrupted();
+    }
+    std::vector<bool> linked(nodes, false);
+    for (vdom::NodeId node = 0; node < nodes; ++node)
+    {
+        std::uint32_t last = format::null_index;
+        for (std::uint32_t child = first_children[node]; child != format::null_index; child = next_siblings[child])
+        {
+            if (linked[child] || parents[child] != node)
+                throw corrupted();
+            linked[child] = true;
+            last = child;
+        }
+        if (last != last_children[node])
+            throw corrupted();
+    }
+
+    // Every node hangs from a node without parent, which has no sibling: no node is its own ancestor
+    std::size_t reached = 0;
+    std::vector<std::uint32_t> pending;
+    for (vdom::NodeId node = 0; node < nodes; ++node)
+    {
+        if (parents[node] != format::null_index)
+        {
+            if (!linked[node])
+                throw corrupted();
+            continue;
+        }
+        if (next_siblings[node] != format::null_index)
+            throw corrupted();
+        pending.push_back(node);
+        while (!pending.empty())
+        {
+            const std::uint32_t reached_node = pending.back();
+            pending.pop_back();
+            reached++;
+            for (std::uint32_t child = first_children[reached_node]; child != format::null_index; child = next_siblings[child])
+                pending.push_back(child);
+        }
+    }
+    if (reached != nodes || (root() != format::null_index && parents[root()] != format::null_index))
+        throw corrupted();
+
+    vdom::Tree::Columns columns{{reinterpret_cast<const vdom::NodeKind *>(kinds.data()), nodes},
+                                mount->tags,
+                                mount->keys,
+                                mount->texts,
+                                parents,
+                                first_children,
+                                last_children,
+                                next_siblings,
+                                slices,
+                                handles,
+                                mount->properties};
+    tree.view(columns, *mount);
+    tree.set_root(root());
+    tree.set_generation(generation());
+}
+
+std::vector<snapshot::Component> snapshot::Snapshot::components(vdom::AtomTable &atoms) const
+{
+    std::span<const format::Component> records = section<format::Component>(Section::Components);
+    std::span<const format::Property> stored_properties = section<format::Property>(Section::ComponentProperties);
+    if (records.empty())
+        return {};
+
+    auto corrupted = []
+    { return std::runtime_error("Snapshot is corrupted"); };
+    const std::vector<vdom::Atom> live_atoms = intern_atoms(atoms);
+
+    std::vector<Component> components;
+    components.reserve(records.size());
+    for (std::size_t index = 0; index < records.size(); ++index)
+    {
+        const format::Component &record = records[index];
+        if (index == 0 ? record.parent != format::null_index : record.parent >= index)
+            throw corrupted();
+        if (record.first == format::null_index ? record.count != 0 : record.first > size() || record.count > size() - record.first)
+            throw corrupted();
+
+        Component component{std::string(checked_string(record.type.offset, record.type.size)), record.parent,
+                            record.first, record.count, std::nullopt};
+        if (record.reusable)
+        {
+            const vdom::PropertySlice &slice = record.properties;
+            if (slice.offset > stored_properties.size() || slice.count > stored_properties.size() - slice.offset)
+                throw corrupted();
+            vdom::Properties properties;
+            for (const format::Property &property : stored_properties.subspan(slice.offset, slice.count))
+            {
+                if (property.atom >= live_atoms.size())
+                    throw corrupted();
+                properties.set(live_atoms[property.atom], checked_value(property.value));
+            }
+            if (properties_hash(properties.items(), atoms) == record.properties_hash)
+                component.properties = std::move(properties);
+        }
+        components.push_back(std::move(component));
+    }
+    return components;
+}
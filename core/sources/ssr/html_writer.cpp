@@ -0,0 +1,190 @@
+#include <algorithm>
+#include <charconv>
+
+#include "ssr/html_writer.hpp"
+
+namespace
+{
+    bool is_void_element(std::string_view tag) noexcept
+    {
+        constexpr std::string_view void_elements[] = {"area", "base", "br", "col", "embed", "hr", "img", "input",
+                                                      "link", "meta", "source", "track", "wbr"};
+        return std::find(std::begin(void_elements), std::end(void_elements), tag) != std::end(void_elements);
+    }
+
+    bool is_attribute_name(std::string_view name) noexcept
+    {
+        // on_<type> properties mark event handlers, which static HTML cannot carry
+        if (name.empty() || name.starts_with("on_"))
+            return false;
+        return std::none_of(name.begin(), name.end(), [](char character)
+                            {
+                                unsigned char byte = static_cast<unsigned char>(character);
+                                return byte <= ' ' || byte == 0x7F || character == '"' || character == '\'' ||
+                                       character == '>' || character == '/' || character == '=' || character == '<'; });
+    }
+} // namespace
+
+ssr::HtmlWriter::HtmlWriter(Sink sink, std::size_t chunk_size, vdom::AtomTable &atoms)
+    : _sink(std::move(sink)), _chunk_size(std::max<std::size_t>(chunk_size, 1)), _atoms(atoms), _written(0)
+{
+    _buffer.reserve(_chunk_size + _chunk_size / 4);
+}
+
+const ssr::HtmlWriter::Name &ssr::HtmlWriter::name(vdom::Atom atom)
+{
+    // Atoms are dense and interned names never move, so they are looked up once
+    if (atom >= _names.size())
+        _names.resize(atom + 1);
+    Name &name = _names[atom];
+    if (!name.known)
+    {
+        name.text = _atoms.name(atom);
+        name.known = true;
+        name.void_element = is_void_element(name.text);
+        name.valid_attribute = is_attribute_name(name.text);
+    }
+    return name;
+}
+
+void ssr::HtmlWriter::append_escaped(std::string_view text, bool attribute)
+{
+    std::size_t start = 0;
+    for (std::size_t index = 0; index < text.size(); ++index)
+    {
+        std::string_view replacement;
+        switch (text[index])
+        {
+        case '&':
+            replacement = "&amp;";
+            break;
+        case '<':
+            replacement = "&lt;";
+            break;
+        case '>':
+            replacement = "&gt;";
+            break;
+        case '"':
+            if (attribute)
+                replacement = "&quot;";
+            break;
+        default:
+            break;
+        }
+        if (replacement.empty())
+            continue;
+        _buffer.append(text, start, index - start);
+        _buffer.append(replacement);
+        start = index + 1;
+    }
+    _buffer.append(text, start);
+}
+
+void ssr::HtmlWriter::append_value(const vdom::Value &value)
+{
+    char digits[32];
+    switch (value.type())
+    {
+    case vdom::Value::Type::None:
+    case vdom::Value::Type::Bool:
+    case vdom::Value::Type::Map:
+    case vdom::Value::Type::Vector:
+        break;
+    case vdom::Value::Type::Integer:
+        _buffer.append(digits, std::to_chars(digits, digits + sizeof(digits), value.as_integer()).ptr);
+        break;
+    case vdom::Value::Type::Float:
+        _buffer.append(digits, std::to_chars(digits, digits + sizeof(digits), value.as_float()).ptr);
+        break;
+    case vdom::Value::Type::String:
+        append_escaped(value.as_string(), true);
+        break;
+    }
+}
+
+void ssr::HtmlWriter::enter(const vdom::Tree &tree, vdom::NodeId node)
+{
+    if (tree.kind(node) == vdom::NodeKind::Text)
+    {
+        append_escaped(tree.text(node), false);
+        flush_if_full();
+        return;
+    }
+
+    _buffer += '<';
+    _buffer.append(name(tree.tag(node)).text);
+    for (const vdom::Property &property : tree.properties(node))
+    {
+        const Name &attribute = name(property.key);
+        const vdom::Value &value = property.value;
+        if (!attribute.valid_attribute || value.is_none() || (value.type() == vdom::Value::Type::Bool && !value.as_bool()) ||
+            value.type() == vdom::Value::Type::Map || value.type() == vdom::Value::Type::Vector)
+            continue;
+
+        _buffer += ' ';
+        _buffer.append(attribute.text);
+        if (value.type() == vdom::Value::Type::Bool)
+            continue;
+        _buffer += "=\"";
+        append_value(value);
+        _buffer += '"';
+    }
+    _buffer += '>';
+    flush_if_full();
+}
+
+void ssr::HtmlWriter::leave(const vdom::Tree &tree, vdom::NodeId node)
+{
+    if (tree.kind(node) == vdom::NodeKind::Text)
+        return;
+
+    const Name &tag = name(tree.tag(node));
+    if (tag.void_element)
+        return;
+    _buffer += "</";
+    _buffer.append(tag.text);
+    _buffer += '>';
+    flush_if_full();
+}
+
+void ssr::HtmlWriter::write(const vdom::Tree &tree)
+{
+    const vdom::NodeId root = tree.root();
+    vdom::NodeId node = root;
+    while (node != vdom::null_node)
+    {
+        enter(tree, node);
+        if (tree.kind(node) == vdom::NodeKind::Element && tree.first_child(node) != vdom::null_node)
+        {
+            node = tree.first_child(node);
+            continue;
+        }
+
+        // Leave the node, then every ancestor whose last child it ends
+        for (;;)
+        {
+            leave(tree, node);
+            if (node == root)
+            {
+                node = vdom::null_node;
+                break;
+            }
+            if (tree.next_sibling(node) != vdom::null_node)
+            {
+                node = tree.next_sibling(node);
+                break;
+            }
+            node = tree.parent(node);
+        }
+    }
+    flush();
+}
+
+void ssr::HtmlWriter::flush()
+{
+    if (_buffer.empty())
+        return;
+    _sink(_buffer);
+    _written += _buffer.size();
+    _buffer.clear();
+}
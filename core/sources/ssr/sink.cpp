@@ -0,0 +1,42 @@
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <system_error>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "ssr/sink.hpp"
+
+namespace
+{
+    long write_some(int descriptor, const char *data, std::size_t size) noexcept
+    {
+#ifdef _WIN32
+        return ::_write(descriptor, data, static_cast<unsigned int>(std::min<std::size_t>(size, INT_MAX)));
+#else
+        return static_cast<long>(::write(descriptor, data, size));
+#endif
+    }
+} // namespace
+
+ssr::Sink ssr::descriptor_sink(int descriptor)
+{
+    return [descriptor](std::string_view chunk)
+    {
+        while (!chunk.empty())
+        {
+            long written = write_some(descriptor, chunk.data(), chunk.size());
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                throw std::system_error(errno, std::generic_category(), "Failed to write rendered output");
+            }
+            chunk.remove_prefix(static_cast<std::size_t>(written));
+        }
+    };
+}
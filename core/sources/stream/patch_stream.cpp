@@ -0,0 +1,254 @@
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <thread>
+
+#include "stream/patch_stream.hpp"
+#include "trace/tracer.hpp"
+#include "vdom/persistent.hpp"
+
+namespace
+{
+    std::uint64_t aligned(std::uint64_t size) noexcept
+    {
+        return (size + stream::format::alignment - 1) & ~std::uint64_t(stream::format::alignment - 1);
+    }
+
+    std::uint64_t payload_of(const vdom::Value &value) noexcept
+    {
+        switch (value.type())
+        {
+        case vdom::Value::Type::Bool:
+            return value.as_bool();
+        case vdom::Value::Type::Integer:
+            return std::bit_cast<std::uint64_t>(value.as_integer());
+        case vdom::Value::Type::Float:
+            return std::bit_cast<std::uint64_t>(value.as_float());
+        default:
+            return 0;
+        }
+    }
+} // namespace
+
+std::size_t stream::PatchWriter::memory_size(std::size_t capacity) noexcept
+{
+    return sizeof(format::RingHeader) + std::bit_ceil(std::max(capacity, format::minimum_capacity));
+}
+
+stream::PatchWriter::PatchWriter(std::span<std::byte> memory, vdom::AtomTable &atoms)
+    : _header(nullptr), _records(nullptr), _mask(0), _head(0), _tail(0), _atoms(atoms)
+{
+    if (memory.size() < memory_size(format::minimum_capacity))
+        throw std::length_error("Not enough memory for a patch stream");
+
+    const std::uint64_t capacity = std::bit_floor(memory.size() - sizeof(format::RingHeader));
+    _header = new (memory.data()) format::RingHeader{};
+    std::memcpy(_header->magic, format::magic, sizeof(_header->magic));
+    _header->version = format::version;
+    _header->byte_order = format::byte_order;
+    _header->capacity = capacity;
+    _records = memory.data() + sizeof(format::RingHeader);
+    _mask = capacity - 1;
+}
+
+stream::PatchWriter::~PatchWriter()
+{
+    close();
+}
+
+void stream::PatchWriter::reserve(std::uint64_t size)
+{
+    while (_mask + 1 - (_head - _tail) < size)
+    {
+        _tail = _header->tail.load(std::memory_order_acquire);
+        if (_mask + 1 - (_head - _tail) >= size)
+            return;
+
+        // Let the reader see what it has to consume to make room
+        publish();
+        if (_header->closed.load(std::memory_order_acquire))
+            throw std::runtime_error("Patch stream closed while waiting for the reader");
+        _statistics.waits++;
+        std::this_thread::yield();
+    }
+}
+
+std::byte *stream::PatchWriter::claim(std::uint64_t size)
+{
+    if (size > _mask + 1)
+        throw std::length_error("Patch too large for the patch stream");
+
+    const std::uint64_t offset = _head & _mask;
+    if (offset + size > _mask + 1)
+    {
+        const std::uint64_t rest = _mask + 1 - offset;
+        reserve(rest);
+        const std::uint32_t padding = static_cast<std::uint32_t>(rest);
+        std::memcpy(_records + offset, &padding, sizeof(padding));
+        _records[offset + offsetof(format::Record, type)] = static_cast<std::byte>(format::RecordType::Padding);
+        _head += rest;
+        _statistics.bytes += rest;
+    }
+
+    reserve(size);
+    std::byte *record = _records + (_head & _mask);
+    _head += size;
+    _statistics.bytes += size;
+    return record;
+}
+
+void stream::PatchWriter::emit(const format::Record &record, std::string_view characters)
+{
+    std::byte *target = claim(record.size);
+    std::memcpy(target, &record, sizeof(record));
+    std::memcpy(target + sizeof(record), characters.data(), characters.size());
+}
+
+void stream::PatchWriter::send_atom(vdom::Atom atom)
+{
+    if (atom < _sent_atoms.size() && _sent_atoms[atom])
+        return;
+    if (atom >= _sent_atoms.size())
+        _sent_atoms.resize(atom + 1, false);
+    _sent_atoms[atom] = true;
+
+    const std::string_view name = _atoms.name(atom);
+    format::Record record{};
+    record.size = static_cast<std::uint32_t>(sizeof(record) + aligned(name.size()));
+    record.type = static_cast<std::uint8_t>(format::RecordType::Atom);
+    record.name = atom;
+    record.value_size = static_cast<std::uint32_t>(name.size());
+    emit(record, name);
+}
+
+void stream::PatchWriter::write(std::span<const vdom::Patch> patches, std::uint32_t generation)
+{
+    trace::Span span("stream patches");
+    for (const vdom::Patch &patch : patches)
+    {
+        if (patch.name != vdom::null_atom)
+            send_atom(patch.name);
+
+        const std::string_view characters = patch.value.type() == vdom::Value::Type::String ? patch.value.as_string() : std::string_view();
+        format::Record record{};
+        record.size = static_cast<std::uint32_t>(sizeof(record) + aligned(characters.size()));
+        record.type = static_cast<std::uint8_t>(patch.type);
+        record.kind = static_cast<std::uint8_t>(patch.kind);
+        // Maps and vectors live in the memory of this process: streamed as None
+        record.value_type = static_cast<std::uint8_t>(vdom::shared_of(patch.value) ? vdom::Value::Type::None : patch.value.type());
+        record.name = patch.name;
+        record.value_size = static_cast<std::uint32_t>(characters.size());
+        record.node = patch.node;
+        record.parent = patch.parent;
+        record.before = patch.before;
+        record.payload = payload_of(patch.value);
+        emit(record, characters);
+    }
+
+    format::Record frame{};
+    frame.size = sizeof(frame);
+    frame.type = static_cast<std::uint8_t>(format::RecordType::Frame);
+    frame.node = patches.size();
+    frame.payload = generation;
+    emit(frame, {});
+    publish();
+
+    _statistics.frames++;
+    _statistics.patches += patches.size();
+}
+
+void stream::PatchWriter::close() noexcept
+{
+    publish();
+    _header->closed.store(1, std::memory_order_release);
+}
+
+stream::PatchReader::PatchReader(std::span<std::byte> memory, vdom::AtomTable &atoms)
+    : _header(nullptr), _records(nullptr), _mask(0), _tail(0), _atoms(atoms)
+{
+    if (memory.size() < sizeof(format::RingHeader))
+        throw std::runtime_error("Truncated patch stream");
+
+    _header = std::launder(reinterpret_cast<format::RingHeader *>(memory.data()));
+    if (std::memcmp(_header->magic, format::magic, sizeof(format::magic)) != 0)
+        throw std::runtime_error("Not a patch stream");
+    if (_header->version != format::version || _header->byte_order != format::byte_order)
+        throw std::runtime_error("Unsupported patch stream version or byte order");
+
+    const std::uint64_t capacity = _header->capacity;
+    if (!std::has_single_bit(capacity) || capacity < format::minimum_capacity || capacity > memory.size() - sizeof(format::RingHeader))
+        throw std::runtime_error("Truncated patch stream");
+
+    _records = memory.data() + sizeof(format::RingHeader);
+    _mask = capacity - 1;
+    _tail = _header->tail.load(std::memory_order_acquire);
+}
+
+bool stream::PatchReader::decode(std::uint32_t &generation)
+{
+    const std::uint64_t offset = _tail & _mask;
+    const std::byte *data = _records + offset;
+
+    std::uint32_t size;
+    std::memcpy(&size, data, sizeof(size));
+    const std::uint8_t type = static_cast<std::uint8_t>(data[offsetof(format::Record, type)]);
+    if (size == 0 || size % format::alignment || offset + size > _mask + 1)
+        throw std::runtime_error("Malformed patch stream record");
+
+    _tail += size;
+    if (type == static_cast<std::uint8_t>(format::RecordType::Padding))
+        return false;
+
+    format::Record record;
+    if (size < sizeof(record))
+        throw std::runtime_error("Malformed patch stream record");
+    std::memcpy(&record, data, sizeof(record));
+    if (sizeof(record) + record.value_size > size)
+        throw std::runtime_error("Malformed patch stream record");
+    const std::string_view characters(reinterpret_cast<const char *>(data + sizeof(record)), record.value_size);
+
+    switch (record.type)
+    {
+    case static_cast<std::uint8_t>(format::RecordType::Atom):
+        if (record.name >= _remote_atoms.size())
+            _remote_atoms.resize(record.name + 1, vdom::null_atom);
+        _remote_atoms[record.name] = _atoms.intern(characters);
+        return false;
+    case static_cast<std::uint8_t>(format::RecordType::Frame):
+        generation = static_cast<std::uint32_t>(record.payload);
+        return true;
+    default:
+        break;
+    }
+
+    if (record.type > static_cast<std::uint8_t>(vdom::PatchType::SetText) || (record.name && record.name >= _remote_atoms.size()))
+        throw std::runtime_error("Malformed patch stream record");
+
+    vdom::Value value;
+    switch (static_cast<vdom::Value::Type>(record.value_type))
+    {
+    case vdom::Value::Type::None:
+        break;
+    case vdom::Value::Type::Bool:
+        value = vdom::Value::boolean(record.payload != 0);
+        break;
+    case vdom::Value::Type::Integer:
+        value = vdom::Value::integer(std::bit_cast<std::int64_t>(record.payload));
+        break;
+    case vdom::Value::Type::Float:
+        value = vdom::Value::floating(std::bit_cast<double>(record.payload));
+        break;
+    case vdom::Value::Type::String:
+        value = vdom::Value::string(characters);
+        break;
+    default:
+        throw std::runtime_error("Malformed patch stream record");
+    }
+
+    _batch.push_back({static_cast<vdom::PatchType>(record.type), static_cast<vdom::NodeKind>(record.kind),
+                      record.name ? _remote_atoms[record.name] : vdom::null_atom, record.node, record.parent, record.before, value});
+    return false;
+}
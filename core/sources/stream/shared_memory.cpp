@@ -0,0 +1,190 @@
+#include <cerrno>
+#include <system_error>
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "stream/shared_memory.hpp"
+
+stream::SharedMemory::SharedMemory() noexcept
+    : _data(nullptr), _size(0), _owner(false)
+#ifdef _WIN32
+      ,
+      _mapping(nullptr)
+#endif
+{
+}
+
+#ifdef _WIN32
+namespace
+{
+    std::system_error last_error(const char *what)
+    {
+        return std::system_error(static_cast<int>(GetLastError()), std::system_category(), what);
+    }
+} // namespace
+
+stream::SharedMemory::SharedMemory(const std::string &name, std::size_t size) : SharedMemory()
+{
+    const unsigned long long length = size;
+    _mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, static_cast<DWORD>(length >> 32),
+                                  static_cast<DWORD>(length), name.c_str());
+    if (!_mapping)
+        throw last_error("Failed to create shared memory");
+    if (GetLastError() == ERROR_ALREADY_EXISTS)
+    {
+        CloseHandle(_mapping);
+        _mapping = nullptr;
+        throw std::system_error(EEXIST, std::generic_category(), "Failed to create shared memory");
+    }
+
+    _data = static_cast<std::byte *>(MapViewOfFile(_mapping, FILE_MAP_ALL_ACCESS, 0, 0, size));
+    if (!_data)
+    {
+        auto error = last_error("Failed to map shared memory");
+        unmap();
+        throw error;
+    }
+    _size = size;
+    _name = name;
+    _owner = true;
+}
+
+stream::SharedMemory::SharedMemory(const std::string &name) : SharedMemory()
+{
+    _mapping = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, name.c_str());
+    if (!_mapping)
+        throw last_error("Failed to open shared memory");
+
+    _data = static_cast<std::byte *>(MapViewOfFile(_mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0));
+    MEMORY_BASIC_INFORMATION information;
+    if (!_data || !VirtualQuery(_data, &information, sizeof(information)))
+    {
+        auto error = last_error("Failed to map shared memory");
+        unmap();
+        throw error;
+    }
+    // Rounded up to whole pages, which the creator's size fits in
+    _size = information.RegionSize;
+    _name = name;
+}
+
+void stream::SharedMemory::unmap() noexcept
+{
+    // The mapping disappears with its last handle, so the owner has nothing to remove
+    if (_data)
+        UnmapViewOfFile(_data);
+    if (_mapping)
+        CloseHandle(_mapping);
+    _data = nullptr;
+    _mapping = nullptr;
+    _size = 0;
+    _owner = false;
+}
+#else
+namespace
+{
+    std::string posix_name(const std::string &name)
+    {
+        return name.starts_with('/') ? name : "/" + name;
+    }
+} // namespace
+
+stream::SharedMemory::SharedMemory(const std::string &name, std::size_t size) : SharedMemory()
+{
+    const std::string path = posix_name(name);
+    int descriptor = ::shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (descriptor < 0)
+        throw std::system_error(errno, std::generic_category(), "Failed to create shared memory");
+
+    // The mapping outlives the descriptor
+    void *data = MAP_FAILED;
+    if (::ftruncate(descriptor, static_cast<off_t>(size)) == 0)
+        data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+    int error = errno;
+    ::close(descriptor);
+    if (data == MAP_FAILED)
+    {
+        ::shm_unlink(path.c_str());
+        throw std::system_error(error, std::generic_category(), "Failed to map shared memory");
+    }
+    _data = static_cast<std::byte *>(data);
+    _size = size;
+    _name = path;
+    _owner = true;
+}
+
+stream::SharedMemory::SharedMemory(const std::string &name) : SharedMemory()
+{
+    const std::string path = posix_name(name);
+    int descriptor = ::shm_open(path.c_str(), O_RDWR, 0);
+    if (descriptor < 0)
+        throw std::system_error(errno, std::generic_category(), "Failed to open shared memory");
+
+    struct stat status;
+    if (::fstat(descriptor, &status) < 0)
+    {
+        int error = errno;
+        ::close(descriptor);
+        throw std::system_error(error, std::generic_category(), "Failed to read shared memory size");
+    }
+
+    const std::size_t size = static_cast<std::size_t>(status.st_size);
+    void *data = size ? ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0) : MAP_FAILED;
+    int error = size ? errno : EINVAL;
+    ::close(descriptor);
+    if (data == MAP_FAILED)
+        throw std::system_error(error, std::generic_category(), "Failed to map shared memory");
+    _data = static_cast<std::byte *>(data);
+    _size = size;
+    _name = path;
+}
+
+void stream::SharedMemory::unmap() noexcept
+{
+    if (_data)
+        ::munmap(_data, _size);
+    if (_owner)
+        ::shm_unlink(_name.c_str());
+    _data = nullptr;
+    _size = 0;
+    _owner = false;
+}
+#endif
+
+stream::SharedMemory::SharedMemory(SharedMemory &&other) noexcept
+    : _data(std::exchange(other._data, nullptr)), _size(std::exchange(other._size, 0)), _name(std::move(other._name)),
+      _owner(std::exchange(other._owner, false))
+#ifdef _WIN32
+      ,
+      _mapping(std::exchange(other._mapping, nullptr))
+#endif
+{
+}
+
+stream::SharedMemory &stream::SharedMemory::operator=(SharedMemory &&other) noexcept
+{
+    if (this == &other)
+        return *this;
+    unmap();
+    _data = std::exchange(other._data, nullptr);
+    _size = std::exchange(other._size, 0);
+    _name = std::move(other._name);
+    _owner = std::exchange(other._owner, false);
+#ifdef _WIN32
+    _mapping = std::exchange(other._mapping, nullptr);
+#endif
+    return *this;
+}
+
+stream::SharedMemory::~SharedMemory()
+{
+    unmap();
+}
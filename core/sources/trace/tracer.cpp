@@ -0,0 +1,174 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "trace/tracer.hpp"
+
+namespace trace
+{
+    /**
+     * @brief Single-producer ring of events, readable from any thread
+     *
+     */
+    class Buffer
+    {
+    public:
+        std::unique_ptr<Event[]> events;
+        std::atomic<std::uint64_t> head;    ///< Events ever written, only stored by the owning thread
+        std::atomic<std::uint64_t> cleared; ///< Value of head at the last clear()
+        std::uint32_t thread;
+
+        explicit Buffer(std::uint32_t thread_index)
+            : events(std::make_unique_for_overwrite<Event[]>(Tracer::capacity)), head(0), cleared(0), thread(thread_index)
+        {
+        }
+    };
+} // namespace trace
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    const Clock::time_point epoch = Clock::now();
+
+    struct Registry
+    {
+        std::mutex mutex;
+        std::vector<std::shared_ptr<trace::Buffer>> buffers;
+    };
+
+    Registry &registry()
+    {
+        static Registry instance;
+        return instance;
+    }
+
+    void write_json_string(std::ostream &stream, const char *text, std::size_t size)
+    {
+        static const char digits[] = "0123456789abcdef";
+
+        stream << '"';
+        for (std::size_t index = 0; index < size; ++index)
+        {
+            unsigned char character = static_cast<unsigned char>(text[index]);
+            if (character == '"' || character == '\\')
+                stream << '\\' << text[index];
+            else if (character < 0x20)
+                stream << "\\u00" << digits[character >> 4] << digits[character & 15];
+            else
+                stream << text[index];
+        }
+        stream << '"';
+    }
+} // namespace
+
+std::atomic<bool> trace::Tracer::_enabled(false);
+
+trace::Buffer &trace::Tracer::thread_buffer()
+{
+    thread_local std::shared_ptr<Buffer> buffer = []
+    {
+        Registry &instance = registry();
+        std::lock_guard lock(instance.mutex);
+        instance.buffers.push_back(std::make_shared<Buffer>(static_cast<std::uint32_t>(instance.buffers.size() + 1)));
+        return instance.buffers.back();
+    }();
+    return *buffer;
+}
+
+std::uint64_t trace::Tracer::now() noexcept
+{
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - epoch).count());
+}
+
+void trace::Tracer::record(const char *name, std::uint64_t start, std::string_view detail) noexcept
+{
+    const std::uint64_t end = now();
+    Buffer *buffer = nullptr;
+    try
+    {
+        buffer = &thread_buffer();
+    }
+    catch (...)
+    {
+        return;
+    }
+
+    // Only this thread writes the buffer; the release store publishes the slot to readers
+    const std::uint64_t head = buffer->head.load(std::memory_order_relaxed);
+    Event &event = buffer->events[head % capacity];
+    event.name = name;
+    event.start = start;
+    event.duration = end - start;
+    std::size_t size = std::min(detail.size(), sizeof(event.detail) - 1);
+    // Cut before a whole code point, not inside one: skip back over 10xxxxxx continuation bytes
+    if (size < detail.size())
+    {
+        while (size > 0 && (static_cast<unsigned char>(detail[size]) & 0xC0) == 0x80)
+            size--;
+    }
+    std::memcpy(event.detail, detail.data(), size);
+    event.detail[size] = '\0';
+    buffer->head.store(head + 1, std::memory_order_release);
+}
+
+void trace::Tracer::write_chrome_trace(std::ostream &stream)
+{
+    std::vector<std::shared_ptr<Buffer>> buffers;
+    {
+        Registry &instance = registry();
+        std::lock_guard lock(instance.mutex);
+        buffers = instance.buffers;
+    }
+
+    const std::ios_base::fmtflags flags = stream.flags();
+    const std::streamsize precision = stream.precision();
+    stream << std::fixed << std::setprecision(3) << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    std::vector<Event> events;
+    for (const std::shared_ptr<Buffer> &buffer : buffers)
+    {
+        const std::uint64_t end = buffer->head.load(std::memory_order_acquire);
+        const std::uint64_t begin = std::max(end > capacity ? end - capacity : 0, buffer->cleared.load(std::memory_order_relaxed));
+        events.clear();
+        for (std::uint64_t index = begin; index < end; ++index)
+            events.push_back(buffer->events[index % capacity]);
+
+        // Slots written again while copying may be torn: keep only those still older than the ring
+        const std::uint64_t overwritten = buffer->head.load(std::memory_order_acquire);
+        const std::uint64_t valid = overwritten > capacity + begin ? overwritten - capacity - begin : 0;
+
+        for (std::size_t index = static_cast<std::size_t>(std::min<std::uint64_t>(valid, events.size())); index < events.size(); ++index)
+        {
+            const Event &event = events[index];
+            stream << (first ? "\n" : ",\n") << "{\"name\":";
+            write_json_string(stream, event.name, std::strlen(event.name));
+            stream << ",\"cat\":\"component-engine\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->thread
+                   << ",\"ts\":" << static_cast<double>(event.start) / 1000.0
+                   << ",\"dur\":" << static_cast<double>(event.duration) / 1000.0;
+            if (event.detail[0])
+            {
+                stream << ",\"args\":{\"detail\":";
+                write_json_string(stream, event.detail, std::strlen(event.detail));
+                stream << '}';
+            }
+            stream << '}';
+            first = false;
+        }
+    }
+    stream << "\n]}\n";
+    stream.flags(flags);
+    stream.precision(precision);
+}
+
+void trace::Tracer::clear()
+{
+    Registry &instance = registry();
+    std::lock_guard lock(instance.mutex);
+    for (const std::shared_ptr<Buffer> &buffer : instance.buffers)
+        buffer->cleared.store(buffer->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+}
@@ -0,0 +1,61 @@
+#include <mutex>
+#include <stdexcept>
+
+#include "vdom/atom_table.hpp"
+
+vdom::AtomTable::AtomTable()
+{
+    _names.emplace_back();
+    _atoms.emplace(_names.back(), null_atom);
+}
+
+vdom::AtomTable &vdom::AtomTable::global()
+{
+    static AtomTable table;
+
+    return table;
+}
+
+vdom::Atom vdom::AtomTable::intern(std::string_view name)
+{
+    {
+        std::shared_lock lock(_mutex);
+        auto it = _atoms.find(name);
+        if (it != _atoms.end())
+            return it->second;
+    }
+
+    std::unique_lock lock(_mutex);
+    auto it = _atoms.find(name);
+    if (it != _atoms.end())
+        return it->second;
+
+    Atom atom = static_cast<Atom>(_names.size());
+    _names.emplace_back(name);
+    _atoms.emplace(_names.back(), atom);
+    return atom;
+}
+
+vdom::Atom vdom::AtomTable::find(std::string_view name) const
+{
+    std::shared_lock lock(_mutex);
+    auto it = _atoms.find(name);
+
+    return it == _atoms.end() ? null_atom : it->second;
+}
+
+std::string_view vdom::AtomTable::name(Atom atom) const
+{
+    std::shared_lock lock(_mutex);
+
+    if (atom >= _names.size())
+        throw std::out_of_range("Unknown atom " + std::to_string(atom));
+    return _names[atom];
+}
+
+std::size_t vdom::AtomTable::size() const
+{
+    std::shared_lock lock(_mutex);
+
+    return _names.size();
+}
@@ -0,0 +1,155 @@
+#include <algorithm>
+
+#include "trace/tracer.hpp"
+#include "vdom/hoister.hpp"
+
+namespace
+{
+    // Fingerprints unseen for this many trees lose their block
+    constexpr std::uint64_t retention = 64;
+} // namespace
+
+vdom::Hoister::Hoister(std::size_t minimum_nodes, std::uint32_t frames)
+    : _minimum_nodes(minimum_nodes < 1 ? 1 : minimum_nodes), _frames(frames < 1 ? 1 : frames), _frame(0), _touched(0),
+      _blocks(0)
+{
+}
+
+std::size_t vdom::Hoister::hoist(Tree &tree)
+{
+    trace::Span span("hoist");
+    _frame++;
+    _touched = 0;
+    _statistics.hoisted_nodes = 0;
+    _statistics.hoisted_subtrees = 0;
+    if (tree.root() == null_node)
+        return 0;
+
+    fingerprint(tree);
+
+    _stack.clear();
+    _stack.push_back(tree.root());
+    while (!_stack.empty())
+    {
+        NodeId node = _stack.back();
+        _stack.pop_back();
+
+        const StaticBlock *block = tree.block(node);
+        if (!block && _contiguous[node] && _sizes[node] >= _minimum_nodes)
+        {
+            block = candidate(tree, node);
+            if (block)
+                tree.mark_block(node, *block);
+        }
+        if (block)
+        {
+            _statistics.hoisted_nodes += block->size();
+            _statistics.hoisted_subtrees++;
+            continue;
+        }
+
+        // Reversed, so that subtrees are marked in pre-order
+        const std::size_t first = _stack.size();
+        for (NodeId child : tree.children(node))
+            _stack.push_back(child);
+        std::reverse(_stack.begin() + static_cast<std::ptrdiff_t>(first), _stack.end());
+    }
+
+    sweep();
+    return _statistics.hoisted_nodes;
+}
+
+void vdom::Hoister::fingerprint(const Tree &tree)
+{
+    _fingerprints.resize(tree.size());
+    _sizes.resize(tree.size());
+    _contiguous.resize(tree.size());
+
+    // Pre-order walk, stopping at marked subtrees, whose block knows its fingerprint
+    _order.clear();
+    _stack.clear();
+    _stack.push_back(tree.root());
+    while (!_stack.empty())
+    {
+        NodeId node = _stack.back();
+        _stack.pop_back();
+        _order.push_back(node);
+        if (tree.block(node))
+            continue;
+        for (NodeId child : tree.children(node))
+            _stack.push_back(child);
+    }
+
+    // Bottom-up, children before their parent
+    for (std::size_t index = _order.size(); index-- > 0;)
+    {
+        NodeId node = _order[index];
+        if (const StaticBlock *block = tree.block(node))
+        {
+            _fingerprints[node] = block->fingerprint();
+            _sizes[node] = static_cast<NodeId>(block->size());
+            _contiguous[node] = 1;
+            continue;
+        }
+
+        std::uint64_t fingerprint = StaticBlock::hash_node(tree, node);
+        NodeId size = 1;
+        bool contiguous = true;
+        for (NodeId child : tree.children(node))
+        {
+            fingerprint = StaticBlock::hash_child(fingerprint, _fingerprints[child]);
+            contiguous = contiguous && _contiguous[child] && child == node + size;
+            size += _sizes[child];
+        }
+        _fingerprints[node] = fingerprint;
+        _sizes[node] = size;
+        _contiguous[node] = contiguous;
+    }
+}
+
+const vdom::StaticBlock *vdom::Hoister::candidate(const Tree &tree, NodeId node)
+{
+    _touched++;
+    auto [it, inserted] = _candidates.try_emplace(_fingerprints[node], Candidate{0, 0, {}});
+    Candidate &candidate = it->second;
+
+    // Equal subtrees of one tree count once
+    if (candidate.last_frame != _frame)
+    {
+        candidate.frames = !inserted && candidate.last_frame + 1 == _frame ? candidate.frames + 1 : 1;
+        candidate.last_frame = _frame;
+    }
+    if (!candidate.block && candidate.frames >= _frames)
+    {
+        candidate.block = StaticBlock::freeze(tree, node);
+        _statistics.frozen_blocks++;
+        _blocks++;
+    }
+    return candidate.block.get();
+}
+
+void vdom::Hoister::sweep()
+{
+    // Subtrees that changed every tree would otherwise pile up between periodic sweeps
+    if (_frame % retention != 0 && _candidates.size() <= 2 * _touched + 1024)
+        return;
+
+    for (auto it = _candidates.begin(); it != _candidates.end();)
+    {
+        const Candidate &candidate = it->second;
+        if (candidate.last_frame == _frame || (candidate.block && _frame - candidate.last_frame <= retention))
+        {
+            ++it;
+            continue;
+        }
+        if (candidate.block)
+            _blocks--;
+        it = _candidates.erase(it);
+    }
+}
+
+void vdom::Hoister::clear() noexcept
+{
+    _candidates.clear();
+    _blocks = 0;
+}
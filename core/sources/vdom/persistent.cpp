@@ -0,0 +1,556 @@
+#include <bit>
+#include <stdexcept>
+#include <string>
+
+#include "vdom/persistent.hpp"
+
+namespace
+{
+    constexpr unsigned bits = 5;
+    constexpr std::size_t width = std::size_t(1) << bits;
+    constexpr std::size_t mask = width - 1;
+    constexpr unsigned hash_bits = 64;
+
+    /**
+     * @brief Characters of a string item, shared by the copies of the item
+     *
+     */
+    struct SharedString final : vdom::Shared
+    {
+        std::string text;
+
+        explicit SharedString(std::string_view text) : text(text) {}
+    };
+
+    using MapNode = vdom::PersistentMap::Node;
+    using Entry = MapNode::Entry;
+    using VectorNode = vdom::PersistentVector::Node;
+
+    /**
+     * @brief Copy a node, with room for the entries and children an update adds
+     *
+     * A plain copy has no spare capacity: inserting into it would allocate twice.
+     */
+    vdom::Ref<MapNode> copy_of(const MapNode &node, std::size_t entries, std::size_t children)
+    {
+        vdom::Ref<MapNode> copy = vdom::make_ref<MapNode>();
+        copy->datamap = node.datamap;
+        copy->nodemap = node.nodemap;
+        copy->entries.reserve(node.entries.size() + entries);
+        copy->entries.assign(node.entries.begin(), node.entries.end());
+        copy->children.reserve(node.children.size() + children);
+        copy->children.assign(node.children.begin(), node.children.end());
+        return copy;
+    }
+
+    vdom::Ref<VectorNode> copy_of(const VectorNode &node, std::size_t items)
+    {
+        vdom::Ref<VectorNode> copy = vdom::make_ref<VectorNode>();
+        copy->children = node.children;
+        copy->items.reserve(node.items.size() + items);
+        copy->items.assign(node.items.begin(), node.items.end());
+        return copy;
+    }
+
+    std::uint32_t slot_of(std::size_t hash, unsigned shift) noexcept
+    {
+        return std::uint32_t(1) << ((static_cast<std::uint64_t>(hash) >> shift) & mask);
+    }
+
+    std::size_t index_of(std::uint32_t bitmap, std::uint32_t slot) noexcept
+    {
+        return static_cast<std::size_t>(std::popcount(bitmap & (slot - 1)));
+    }
+
+    bool is_key(const vdom::Value &key) noexcept
+    {
+        return key.type() != vdom::Value::Type::Map && key.type() != vdom::Value::Type::Vector;
+    }
+
+    /**
+     * @brief Make the node holding two entries whose hashes agree on the bits above shift
+     *
+     */
+    vdom::Ref<const MapNode> merge(Entry first, Entry second, unsigned shift)
+    {
+        vdom::Ref<MapNode> node = vdom::make_ref<MapNode>();
+        if (shift >= hash_bits)
+        {
+            node->entries = {std::move(first), std::move(second)};
+            return node;
+        }
+
+        const std::uint32_t first_slot = slot_of(first.hash, shift);
+        const std::uint32_t second_slot = slot_of(second.hash, shift);
+        if (first_slot == second_slot)
+        {
+            node->nodemap = first_slot;
+            node->children.push_back(merge(std::move(first), std::move(second), shift + bits));
+            return node;
+        }
+
+        node->datamap = first_slot | second_slot;
+        if (first_slot < second_slot)
+            node->entries = {std::move(first), std::move(second)};
+        else
+            node->entries = {std::move(second), std::move(first)};
+        return node;
+    }
+
+    vdom::Ref<const MapNode> insert(const vdom::Ref<const MapNode> &node, unsigned shift, std::size_t hash,
+                                    vdom::Value key, vdom::Value value, bool &added)
+    {
+        if (shift >= hash_bits)
+        {
+            for (std::size_t index = 0; index < node->entries.size(); ++index)
+            {
+                if (node->entries[index].key.value() != key)
+                    continue;
+                if (node->entries[index].value.value() == value)
+                    return node;
+                vdom::Ref<MapNode> copy = vdom::make_ref<MapNode>(*node);
+                copy->entries[index].value = vdom::Item(value);
+                return copy;
+            }
+            vdom::Ref<MapNode> copy = copy_of(*node, 1, 0);
+            copy->entries.push_back({hash, vdom::Item(key), vdom::Item(value)});
+            added = true;
+            return copy;
+        }
+
+        const std::uint32_t slot = slot_of(hash, shift);
+        if (node->datamap & slot)
+        {
+            const std::size_t index = index_of(node->datamap, slot);
+            const Entry &entry = node->entries[index];
+            if (entry.hash == hash && entry.key.value() == key)
+            {
+                if (entry.value.value() == value)
+                    return node;
+                vdom::Ref<MapNode> copy = vdom::make_ref<MapNode>(*node);
+                copy->entries[index].value = vdom::Item(value);
+                return copy;
+            }
+
+            // Push the entry down into a child holding both
+            vdom::Ref<MapNode> copy = copy_of(*node, 0, 1);
+            vdom::Ref<const MapNode> child = merge(entry, {hash, vdom::Item(key), vdom::Item(value)}, shift + bits);
+            copy->entries.erase(copy->entries.begin() + static_cast<std::ptrdiff_t>(index));
+            copy->datamap ^= slot;
+            copy->nodemap |= slot;
+            copy->children.insert(copy->children.begin() + static_cast<std::ptrdiff_t>(index_of(copy->nodemap, slot)), std::move(child));
+            added = true;
+            return copy;
+        }
+
+        if (node->nodemap & slot)
+        {
+            const std::size_t index = index_of(node->nodemap, slot);
+            vdom::Ref<const MapNode> child = insert(node->children[index], shift + bits, hash, key, value, added);
+            if (child.get() == node->children[index].get())
+                return node;
+            vdom::Ref<MapNode> copy = vdom::make_ref<MapNode>(*node);
+            copy->children[index] = std::move(child);
+            return copy;
+        }
+
+        vdom::Ref<MapNode> copy = copy_of(*node, 1, 0);
+        copy->datamap |= slot;
+        copy->entries.insert(copy->entries.begin() + static_cast<std::ptrdiff_t>(index_of(copy->datamap, slot)),
+                             {hash, vdom::Item(key), vdom::Item(value)});
+        added = true;
+        return copy;
+    }
+
+    /**
+     * @brief Make a node without a key, keeping the layout canonical
+     *
+     * A child left with a single entry is inlined into its parent, so that the
+     * shape of a trie depends only on its keys.
+     *
+     * @return vdom::Ref<const MapNode> The new node, node itself when key is missing, or null when it becomes empty
+     */
+    vdom::Ref<const MapNode> remove(const vdom::Ref<const MapNode> &node, unsigned shift, std::size_t hash,
+                                    vdom::Value key, bool &removed)
+    {
+        if (shift >= hash_bits)
+        {
+            for (std::size_t index = 0; index < node->entries.size(); ++index)
+            {
+                if (node->entries[index].key.value() != key)
+                    continue;
+                removed = true;
+                if (node->entries.size() == 1)
+                    return {};
+                vdom::Ref<MapNode> copy = vdom::make_ref<MapNode>(*node);
+                copy->entries.erase(copy->entries.begin() + static_cast<std::ptrdiff_t>(index));
+                return copy;
+            }
+            return node;
+        }
+
+        const std::uint32_t slot = slot_of(hash, shift);
+        if (node->datamap & slot)
+        {
+            const std::size_t index = index_of(node->datamap, slot);
+            const Entry &entry = node->entries[index];
+            if (entry.hash != hash || entry.key.value() != key)
+                return node;
+            removed = true;
+            if (node->entries.size() == 1 && node->children.empty())
+                return {};
+            vdom::Ref<MapNode> copy = vdom::make_ref<MapNode>(*node);
+            copy->entries.erase(copy->entries.begin() + static_cast<std::ptrdiff_t>(index));
+            copy->datamap ^= slot;
+            return copy;
+        }
+
+        if (node->nodemap & slot)
+        {
+            const std::size_t index = index_of(node->nodemap, slot);
+            vdom::Ref<const MapNode> child = remove(node->children[index], shift + bits, hash, key, removed);
+            if (child.get() == node->children[index].get())
+                return node;
+
+            vdom::Ref<MapNode> copy = copy_of(*node, 1, 0);
+            if (child->entries.size() == 1 && child->children.empty())
+            {
+                copy->children.erase(copy->children.begin() + static_cast<std::ptrdiff_t>(index));
+                copy->nodemap ^= slot;
+                copy->datamap |= slot;
+                copy->entries.insert(copy->entries.begin() + static_cast<std::ptrdiff_t>(index_of(copy->datamap, slot)), child->entries.front());
+            }
+            else
+                copy->children[index] = std::move(child);
+            return copy;
+        }
+        return node;
+    }
+
+    /**
+     * @brief Make the chain of single-child nodes leading from a new branch at shift down to a leaf
+     *
+     */
+    vdom::Ref<const VectorNode> path_to(unsigned shift, vdom::Ref<const VectorNode> leaf)
+    {
+        if (shift == 0)
+            return leaf;
+        vdom::Ref<VectorNode> node = vdom::make_ref<VectorNode>();
+        node->children.push_back(path_to(shift - bits, std::move(leaf)));
+        return node;
+    }
+
+    /**
+     * @brief Make a version of a subtree with a full tail appended as its last leaf
+     *
+     * @param last The index of the last element of the tail
+     */
+    vdom::Ref<const VectorNode> push_tail(const VectorNode &node, unsigned shift, std::size_t last, vdom::Ref<const VectorNode> tail)
+    {
+        vdom::Ref<VectorNode> copy = vdom::make_ref<VectorNode>();
+        copy->children.reserve(node.children.size() + 1);
+        copy->children.assign(node.children.begin(), node.children.end());
+        const std::size_t index = (last >> shift) & mask;
+        vdom::Ref<const VectorNode> child;
+        if (shift == bits)
+            child = std::move(tail);
+        else if (index < node.children.size())
+            child = push_tail(*node.children[index], shift - bits, last, std::move(tail));
+        else
+            child = path_to(shift - bits, std::move(tail));
+
+        if (index < copy->children.size())
+            copy->children[index] = std::move(child);
+        else
+            copy->children.push_back(std::move(child));
+        return copy;
+    }
+
+    /**
+     * @brief Make a version of a subtree without its last leaf
+     *
+     * @param last The index of the last element of that leaf
+     * @return vdom::Ref<const VectorNode> The new subtree, or null when it becomes empty
+     */
+    vdom::Ref<const VectorNode> pop_tail(const VectorNode &node, unsigned shift, std::size_t last)
+    {
+        const std::size_t index = (last >> shift) & mask;
+        if (shift > bits)
+        {
+            vdom::Ref<const VectorNode> child = pop_tail(*node.children[index], shift - bits, last);
+            if (!child && index == 0)
+                return {};
+            vdom::Ref<VectorNode> copy = vdom::make_ref<VectorNode>(node);
+            if (child)
+                copy->children[index] = std::move(child);
+            else
+                copy->children.pop_back();
+            return copy;
+        }
+        if (index == 0)
+            return {};
+        vdom::Ref<VectorNode> copy = vdom::make_ref<VectorNode>(node);
+        copy->children.pop_back();
+        return copy;
+    }
+
+    vdom::Ref<const VectorNode> assign(const VectorNode &node, unsigned shift, std::size_t index, vdom::Value value)
+    {
+        vdom::Ref<VectorNode> copy = vdom::make_ref<VectorNode>(node);
+        if (shift == 0)
+            copy->items[index & mask] = vdom::Item(value);
+        else
+        {
+            const std::size_t child = (index >> shift) & mask;
+            copy->children[child] = assign(*node.children[child], shift - bits, index, value);
+        }
+        return copy;
+    }
+} // namespace
+
+vdom::Item::Item(Value value) : _value(value)
+{
+    if (value.type() == Value::Type::String)
+    {
+        if (value.as_string().empty())
+        {
+            _value = Value::string({});
+            return;
+        }
+        Ref<const SharedString> text = make_ref<const SharedString>(value.as_string());
+        _value = Value::string(text->text);
+        _owner = std::move(text);
+    }
+    else if (const Shared *shared = shared_of(value))
+        _owner = Ref<const Shared>(shared);
+}
+
+vdom::PersistentMap::PersistentMap(Ref<const Node> root, std::size_t size) noexcept
+    : _root(std::move(root)), _size(size)
+{
+}
+
+vdom::PersistentMap::~PersistentMap() = default;
+
+vdom::Ref<const vdom::PersistentMap> vdom::PersistentMap::empty()
+{
+    static const Ref<const PersistentMap> map(new PersistentMap({}, 0));
+    return map;
+}
+
+const vdom::Value *vdom::PersistentMap::find(Value key) const noexcept
+{
+    const std::size_t hash = key.hash();
+    const Node *node = _root.get();
+
+    for (unsigned shift = 0; node; shift += bits)
+    {
+        if (shift >= hash_bits)
+        {
+            for (const Node::Entry &entry : node->entries)
+            {
+                if (entry.key.value() == key)
+                    return &entry.value.value();
+            }
+            return nullptr;
+        }
+
+        const std::uint32_t slot = slot_of(hash, shift);
+        if (node->datamap & slot)
+        {
+            const Node::Entry &entry = node->entries[index_of(node->datamap, slot)];
+            return entry.hash == hash && entry.key.value() == key ? &entry.value.value() : nullptr;
+        }
+        node = node->nodemap & slot ? node->children[index_of(node->nodemap, slot)].get() : nullptr;
+    }
+    return nullptr;
+}
+
+vdom::Ref<const vdom::PersistentMap> vdom::PersistentMap::set(Value key, Value value) const
+{
+    if (!is_key(key))
+        throw std::invalid_argument("Persistent map keys must be None, bool, int, float or str");
+
+    const std::size_t hash = key.hash();
+    if (!_root)
+    {
+        Ref<Node> root = make_ref<Node>();
+        root->datamap = slot_of(hash, 0);
+        root->entries.push_back({hash, Item(key), Item(value)});
+        return Ref<const PersistentMap>(new PersistentMap(std::move(root), 1));
+    }
+
+    bool added = false;
+    Ref<const Node> root = insert(_root, 0, hash, key, value, added);
+    if (root.get() == _root.get())
+        return Ref<const PersistentMap>(this);
+    return Ref<const PersistentMap>(new PersistentMap(std::move(root), _size + added));
+}
+
+vdom::Ref<const vdom::PersistentMap> vdom::PersistentMap::erase(Value key) const
+{
+    if (!_root || !is_key(key))
+        return Ref<const PersistentMap>(this);
+
+    bool removed = false;
+    Ref<const Node> root = remove(_root, 0, key.hash(), key, removed);
+    if (!removed)
+        return Ref<const PersistentMap>(this);
+    if (!root)
+        return empty();
+    return Ref<const PersistentMap>(new PersistentMap(std::move(root), _size - 1));
+}
+
+bool vdom::PersistentMap::equals(const PersistentMap &other) const
+{
+    if (this == &other || _root.get() == other._root.get())
+        return true;
+    if (_size != other._size)
+        return false;
+
+    bool equal = true;
+    for_each([&](const Value &key, const Value &value)
+             {
+                 const Value *found = equal ? other.find(key) : nullptr;
+                 equal = found && equivalent(value, *found); });
+    return equal;
+}
+
+vdom::PersistentVector::PersistentVector(Ref<const Node> root, Ref<const Node> tail, std::size_t size, unsigned shift) noexcept
+    : _root(std::move(root)), _tail(std::move(tail)), _size(size), _shift(shift)
+{
+}
+
+vdom::PersistentVector::~PersistentVector() = default;
+
+vdom::Ref<const vdom::PersistentVector> vdom::PersistentVector::empty()
+{
+    static const Ref<const PersistentVector> vector(new PersistentVector(make_ref<const Node>(), make_ref<const Node>(), 0, bits));
+    return vector;
+}
+
+std::size_t vdom::PersistentVector::tail_offset() const noexcept
+{
+    return _size < width ? 0 : ((_size - 1) >> bits) << bits;
+}
+
+const vdom::PersistentVector::Node &vdom::PersistentVector::leaf(std::size_t index) const noexcept
+{
+    if (index >= tail_offset())
+        return *_tail;
+
+    const Node *node = _root.get();
+    for (unsigned shift = _shift; shift > 0; shift -= bits)
+        node = node->children[(index >> shift) & mask].get();
+    return *node;
+}
+
+const vdom::Value &vdom::PersistentVector::operator[](std::size_t index) const noexcept
+{
+    return leaf(index).items[index & mask].value();
+}
+
+vdom::Ref<const vdom::PersistentVector> vdom::PersistentVector::push_back(Value value) const
+{
+    if (_size - tail_offset() < width)
+    {
+        Ref<Node> tail = copy_of(*_tail, 1);
+        tail->items.emplace_back(value);
+        return Ref<const PersistentVector>(new PersistentVector(_root, std::move(tail), _size + 1, _shift));
+    }
+
+    // The tail is full: it becomes the last leaf of the tree, adding a level when the root is full
+    Ref<const Node> root;
+    unsigned shift = _shift;
+    if ((_size >> bits) > (std::size_t(1) << _shift))
+    {
+        Ref<Node> grown = make_ref<Node>();
+        grown->children.push_back(_root);
+        grown->children.push_back(path_to(_shift, _tail));
+        root = std::move(grown);
+        shift += bits;
+    }
+    else
+        root = push_tail(*_root, _shift, _size - 1, _tail);
+
+    Ref<Node> tail = make_ref<Node>();
+    tail->items.emplace_back(value);
+    return Ref<const PersistentVector>(new PersistentVector(std::move(root), std::move(tail), _size + 1, shift));
+}
+
+vdom::Ref<const vdom::PersistentVector> vdom::PersistentVector::set(std::size_t index, Value value) const
+{
+    if (index >= _size)
+        throw std::out_of_range("Persistent vector index out of range");
+    if ((*this)[index] == value)
+        return Ref<const PersistentVector>(this);
+
+    if (index >= tail_offset())
+    {
+        Ref<Node> tail = make_ref<Node>(*_tail);
+        tail->items[index & mask] = Item(value);
+        return Ref<const PersistentVector>(new PersistentVector(_root, std::move(tail), _size, _shift));
+    }
+    return Ref<const PersistentVector>(new PersistentVector(assign(*_root, _shift, index, value), _tail, _size, _shift));
+}
+
+vdom::Ref<const vdom::PersistentVector> vdom::PersistentVector::pop_back() const
+{
+    if (_size == 0)
+        throw std::out_of_range("pop from an empty persistent vector");
+    if (_size == 1)
+        return empty();
+
+    if (_size - tail_offset() > 1)
+    {
+        Ref<Node> tail = make_ref<Node>(*_tail);
+        tail->items.pop_back();
+        return Ref<const PersistentVector>(new PersistentVector(_root, std::move(tail), _size - 1, _shift));
+    }
+
+    // The tail empties: the last leaf of the tree becomes the tail, dropping a level the root no longer needs
+    Ref<const Node> tail(&leaf(_size - 2));
+    Ref<const Node> root = pop_tail(*_root, _shift, _size - 2);
+    unsigned shift = _shift;
+    if (!root)
+        root = make_ref<const Node>();
+    if (shift > bits && root->children.size() == 1)
+    {
+        root = root->children.front();
+        shift -= bits;
+    }
+    return Ref<const PersistentVector>(new PersistentVector(std::move(root), std::move(tail), _size - 1, shift));
+}
+
+bool vdom::PersistentVector::equals(const PersistentVector &other) const
+{
+    if (this == &other)
+        return true;
+    if (_size != other._size)
+        return false;
+
+    for (std::size_t index = 0; index < _size; index += width)
+    {
+        const Node &mine = leaf(index);
+        const Node &theirs = other.leaf(index);
+        if (&mine == &theirs)
+            continue;
+        for (std::size_t item = 0; item < mine.items.size(); ++item)
+        {
+            if (!equivalent(mine.items[item].value(), theirs.items[item].value()))
+                return false;
+        }
+    }
+    return true;
+}
+
+bool vdom::equivalent(const Value &value, const Value &other)
+{
+    if (value.type() != other.type())
+        return false;
+    if (value.type() == Value::Type::Map)
+        return value.as_map()->equals(*other.as_map());
+    if (value.type() == Value::Type::Vector)
+        return value.as_vector()->equals(*other.as_vector());
+    return value == other;
+}
@@ -0,0 +1,181 @@
+#include <cstring>
+#include <utility>
+
+#include "vdom/persistent.hpp"
+#include "vdom/properties.hpp"
+
+vdom::Properties::Properties(const Properties &other)
+{
+    *this = other;
+}
+
+vdom::Properties::Properties(Properties &&other) noexcept
+    : _properties(std::move(other._properties)), _hash(other._hash), _hashed(std::exchange(other._hashed, false))
+{
+}
+
+vdom::Properties &vdom::Properties::operator=(const Properties &other)
+{
+    if (this == &other)
+        return *this;
+
+    clear();
+    _properties = other._properties;
+    _hash = other._hash;
+    _hashed = other._hashed;
+    for (Property &property : _properties)
+        property.value = copy(property.value);
+    return *this;
+}
+
+vdom::Properties &vdom::Properties::operator=(Properties &&other) noexcept
+{
+    if (this == &other)
+        return *this;
+
+    clear();
+    _properties = std::move(other._properties);
+    _hash = other._hash;
+    _hashed = std::exchange(other._hashed, false);
+    return *this;
+}
+
+vdom::Properties::~Properties()
+{
+    clear();
+}
+
+std::size_t vdom::Properties::lower_bound(Atom key) const noexcept
+{
+    std::size_t low = 0;
+    std::size_t high = _properties.size();
+
+    while (low < high)
+    {
+        std::size_t middle = (low + high) / 2;
+        if (_properties[middle].key < key)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low;
+}
+
+vdom::Value vdom::Properties::copy(Value value)
+{
+    if (const Shared *shared = shared_of(value))
+        shared->retain();
+    if (value.type() != Value::Type::String || value.as_string().empty())
+        return value;
+
+    std::string_view text = value.as_string();
+    char *characters = new char[text.size()];
+    std::memcpy(characters, text.data(), text.size());
+    return Value::string({characters, text.size()});
+}
+
+void vdom::Properties::release(Value value) noexcept
+{
+    if (const Shared *shared = shared_of(value))
+        shared->release();
+    if (value.type() == Value::Type::String && !value.as_string().empty())
+        delete[] value.as_string().data();
+}
+
+void vdom::Properties::set(Atom key, Value value)
+{
+    std::size_t index = lower_bound(key);
+    Value owned = copy(value);
+    _hashed = false;
+
+    if (index < _properties.size() && _properties[index].key == key)
+    {
+        release(_properties[index].value);
+        _properties[index].value = owned;
+        return;
+    }
+
+    try
+    {
+        _properties.insert(index, {key, owned});
+    }
+    catch (...)
+    {
+        release(owned);
+        throw;
+    }
+}
+
+const vdom::Value *vdom::Properties::get(Atom key) const noexcept
+{
+    std::size_t index = lower_bound(key);
+
+    if (index < _properties.size() && _properties[index].key == key)
+        return &_properties[index].value;
+    return nullptr;
+}
+
+bool vdom::Properties::remove(Atom key) noexcept
+{
+    std::size_t index = lower_bound(key);
+
+    if (index == _properties.size() || _properties[index].key != key)
+        return false;
+    release(_properties[index].value);
+    _properties.erase(index);
+    _hashed = false;
+    return true;
+}
+
+void vdom::Properties::clear() noexcept
+{
+    for (const Property &property : _properties)
+        release(property.value);
+    _properties.clear();
+    _hashed = false;
+}
+
+std::uint64_t vdom::Properties::hash() const noexcept
+{
+    if (_hashed)
+        return _hash;
+
+    // Four independent lanes: no dependency chain between consecutive properties,
+    // so the loop pipelines and vectorizes; the lanes are folded at the end
+    constexpr std::uint64_t multiplier = 0x9E3779B97F4A7C15ull;
+    std::uint64_t lanes[4] = {0x243F6A8885A308D3ull, 0x13198A2E03707344ull, 0xA4093822299F31D0ull, 0x082EFA98EC4E6C89ull};
+
+    for (std::size_t index = 0; index < _properties.size(); ++index)
+    {
+        const Property &property = _properties[index];
+        std::uint64_t word = (static_cast<std::uint64_t>(property.key) * multiplier) ^ property.value.hash();
+        std::uint64_t &lane = lanes[index % 4];
+        lane = (lane ^ word) * multiplier;
+        lane ^= lane >> 29;
+    }
+
+    std::uint64_t hash = _properties.size();
+    for (std::uint64_t lane : lanes)
+    {
+        hash = (hash ^ lane) * 0xBF58476D1CE4E5B9ull;
+        hash ^= hash >> 31;
+    }
+
+    _hash = hash;
+    _hashed = true;
+    return hash;
+}
+
+bool vdom::Properties::operator==(const Properties &other) const noexcept
+{
+    if (_properties.size() != other._properties.size())
+        return false;
+
+    for (std::size_t index = 0; index < _properties.size(); ++index)
+    {
+        if (_properties[index].key != other._properties[index].key ||
+            _properties[index].value != other._properties[index].value)
+            return false;
+    }
+    return true;
+}
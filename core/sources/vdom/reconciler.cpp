@@ -0,0 +1,391 @@
+#include <limits>
+
+#include "trace/tracer.hpp"
+#include "vdom/reconciler.hpp"
+#include "vdom/static_block.hpp"
+
+namespace
+{
+    constexpr std::uint32_t keyed_rank = std::numeric_limits<std::uint32_t>::max();
+    constexpr std::uint32_t no_index = std::numeric_limits<std::uint32_t>::max();
+    constexpr std::uint32_t empty_slot = std::numeric_limits<std::uint32_t>::max();
+} // namespace
+
+vdom::Reconciler::Reconciler(std::pmr::memory_resource *scratch)
+    : _old(nullptr), _next(nullptr), _patches(nullptr), _deferral(nullptr), _copies(false), _old_children(scratch),
+      _new_children(scratch), _match_keys(scratch), _pairs(scratch), _sources(scratch), _lis_tails(scratch),
+      _lis_previous(scratch), _stable(scratch), _new_indices(scratch)
+{
+}
+
+void vdom::Reconciler::diff(const Tree &old, Tree &next, PatchList &patches, Deferral *deferral)
+{
+    trace::Span span("reconcile");
+    _old = &old;
+    _next = &next;
+    _patches = &patches;
+    _deferral = deferral;
+    _copies = next.origin() != 0 && next.origin() == old.serial();
+    next.set_generation(old.generation() + 1);
+
+    NodeId old_root = old.root();
+    NodeId new_root = next.root();
+
+    if (new_root == null_node)
+    {
+        if (old_root != null_node)
+            remove(old_root);
+    }
+    else if (old_root == null_node)
+    {
+        create(new_root, null_handle, null_handle);
+    }
+    else if (same_type(old_root, new_root) && old.key(old_root) == next.key(new_root))
+    {
+        if (!copied(old_root, new_root))
+        {
+            next.set_handle(new_root, old.handle(old_root));
+            diff_node(old_root, new_root);
+        }
+    }
+    else
+    {
+        remove(old_root);
+        create(new_root, null_handle, null_handle);
+    }
+
+    _old = nullptr;
+    _next = nullptr;
+    _patches = nullptr;
+    _deferral = nullptr;
+
+    // Deferred pairs are diffed later, the caller forgets the origin then
+    if (!deferral)
+        next.set_origin(0);
+}
+
+void vdom::Reconciler::diff_subtree(const Tree &old, Tree &next, NodeId old_node, NodeId new_node, PatchList &patches)
+{
+    _old = &old;
+    _next = &next;
+    _patches = &patches;
+    _deferral = nullptr;
+    _copies = next.origin() != 0 && next.origin() == old.serial();
+
+    diff_node(old_node, new_node);
+
+    _old = nullptr;
+    _next = nullptr;
+    _patches = nullptr;
+}
+
+bool vdom::Reconciler::same_type(NodeId old_node, NodeId new_node) const noexcept
+{
+    return _old->kind(old_node) == _next->kind(new_node) && _old->tag(old_node) == _next->tag(new_node);
+}
+
+bool vdom::Reconciler::copied(NodeId old_node, NodeId new_node) const noexcept
+{
+    // Handles are unique within the old tree: a copy holding the handle of its match was copied from it
+    const Handle handle = _next->handle(new_node);
+    return _copies && handle != null_handle && handle == _old->handle(old_node);
+}
+
+void vdom::Reconciler::pair(NodeId old_node, NodeId new_node)
+{
+    // A copy of the old node, subtree and handles included, is equal to it
+    if (copied(old_node, new_node))
+        return;
+    _next->set_handle(new_node, _old->handle(old_node));
+    _pairs.push_back({old_node, new_node});
+}
+
+void vdom::Reconciler::diff_node(NodeId old_node, NodeId new_node)
+{
+    // Both copies of one static block: equal, laid out alike, only the handles carry over
+    const StaticBlock *block = _next->block(new_node);
+    if (block && block == _old->block(old_node))
+    {
+        for (NodeId offset = 1; offset < block->size(); ++offset)
+            _next->set_handle(new_node + offset, _old->handle(old_node + offset));
+        return;
+    }
+
+    if (_next->kind(new_node) == NodeKind::Text)
+    {
+        std::string_view text = _next->text(new_node);
+        if (_old->text(old_node) != text)
+            _patches->push_back({PatchType::SetText, NodeKind::Text, null_atom, _next->handle(new_node),
+                                 null_handle, null_handle, Value::string(text)});
+        return;
+    }
+
+    diff_properties(old_node, new_node);
+    diff_children(old_node, new_node);
+}
+
+void vdom::Reconciler::diff_properties(NodeId old_node, NodeId new_node)
+{
+    std::span<const Property> old_properties = _old->properties(old_node);
+    std::span<const Property> new_properties = _next->properties(new_node);
+    Handle handle = _next->handle(new_node);
+    std::size_t old_index = 0;
+    std::size_t new_index = 0;
+
+    while (old_index < old_properties.size() || new_index < new_properties.size())
+    {
+        if (new_index == new_properties.size() ||
+            (old_index < old_properties.size() && old_properties[old_index].key < new_properties[new_index].key))
+        {
+            _patches->push_back({PatchType::RemoveProperty, NodeKind::Element, old_properties[old_index].key,
+                                 handle, null_handle, null_handle, Value()});
+            old_index++;
+        }
+        else if (old_index == old_properties.size() || new_properties[new_index].key < old_properties[old_index].key)
+        {
+            _patches->push_back({PatchType::SetProperty, NodeKind::Element, new_properties[new_index].key,
+                                 handle, null_handle, null_handle, new_properties[new_index].value});
+            new_index++;
+        }
+        else
+        {
+            if (old_properties[old_index].value != new_properties[new_index].value)
+                _patches->push_back({PatchType::SetProperty, NodeKind::Element, new_properties[new_index].key,
+                                     handle, null_handle, null_handle, new_properties[new_index].value});
+            old_index++;
+            new_index++;
+        }
+    }
+}
+
+void vdom::Reconciler::match_keys(const std::pmr::vector<NodeId> &children, std::size_t begin, std::size_t end, const Tree &tree)
+{
+    std::uint32_t rank = 0;
+
+    for (std::size_t index = begin; index < end; ++index)
+    {
+        const Value &key = tree.key(children[index]);
+        _match_keys.push_back({key, key.is_none() ? rank++ : keyed_rank});
+    }
+}
+
+void vdom::Reconciler::diff_children(NodeId old_parent, NodeId new_parent)
+{
+    const std::size_t old_base = _old_children.size();
+    const std::size_t new_base = _new_children.size();
+    const std::size_t keys_base = _match_keys.size();
+    const std::size_t pairs_base = _pairs.size();
+
+    for (NodeId child : _old->children(old_parent))
+        _old_children.push_back(child);
+    for (NodeId child : _next->children(new_parent))
+        _new_children.push_back(child);
+
+    const std::size_t old_count = _old_children.size() - old_base;
+    const std::size_t new_count = _new_children.size() - new_base;
+    const Handle parent = _next->handle(new_parent);
+
+    match_keys(_old_children, old_base, old_base + old_count, *_old);
+    match_keys(_new_children, new_base, new_base + new_count, *_next);
+
+    auto old_child = [&](std::size_t index)
+    { return _old_children[old_base + index]; };
+    auto new_child = [&](std::size_t index)
+    { return _new_children[new_base + index]; };
+    auto old_key = [&](std::size_t index) -> const MatchKey &
+    { return _match_keys[keys_base + index]; };
+    auto new_key = [&](std::size_t index) -> const MatchKey &
+    { return _match_keys[keys_base + old_count + index]; };
+    auto anchor = [&](std::size_t index)
+    { return index < new_count ? _next->handle(new_child(index)) : null_handle; };
+
+    // Common prefix and suffix
+    std::size_t start = 0;
+    while (start < old_count && start < new_count &&
+           old_key(start) == new_key(start) && same_type(old_child(start), new_child(start)))
+    {
+        pair(old_child(start), new_child(start));
+        start++;
+    }
+
+    std::size_t old_end = old_count;
+    std::size_t new_end = new_count;
+    while (old_end > start && new_end > start &&
+           old_key(old_end - 1) == new_key(new_end - 1) && same_type(old_child(old_end - 1), new_child(new_end - 1)))
+    {
+        pair(old_child(old_end - 1), new_child(new_end - 1));
+        old_end--;
+        new_end--;
+    }
+
+    if (start == old_end)
+    {
+        Handle before = anchor(new_end);
+        for (std::size_t index = start; index < new_end; ++index)
+            create(new_child(index), parent, before);
+    }
+    else if (start == new_end)
+    {
+        for (std::size_t index = start; index < old_end; ++index)
+            remove(old_child(index));
+    }
+    else
+    {
+        const std::size_t count = new_end - start;
+
+        index_new_keys(keys_base + old_count, start, new_end);
+
+        _sources.assign(count, -1);
+        bool moved = false;
+        std::size_t last_index = 0;
+        for (std::size_t index = start; index < old_end; ++index)
+        {
+            std::uint32_t new_index = find_new_key(old_key(index), keys_base + old_count);
+            if (new_index == no_index || _sources[new_index - start] != -1 ||
+                !same_type(old_child(index), new_child(new_index)))
+            {
+                remove(old_child(index));
+                continue;
+            }
+
+            _sources[new_index - start] = static_cast<std::int64_t>(index);
+            pair(old_child(index), new_child(new_index));
+            if (new_index < last_index)
+                moved = true;
+            else
+                last_index = new_index;
+        }
+
+        if (moved)
+            mark_longest_increasing_subsequence(count);
+
+        for (std::size_t offset = count; offset-- > 0;)
+        {
+            std::size_t index = start + offset;
+            if (_sources[offset] == -1)
+                create(new_child(index), parent, anchor(index + 1));
+            else if (moved && !_stable[offset])
+                move(new_child(index), parent, anchor(index + 1));
+        }
+    }
+
+    // Children are settled, descend into the matched pairs
+    for (std::size_t index = pairs_base; index < _pairs.size(); ++index)
+    {
+        Pair matched = _pairs[index];
+        if (_deferral && _deferral->defer(matched.old_node, matched.new_node, _patches->size()))
+            continue;
+        diff_node(matched.old_node, matched.new_node);
+    }
+
+    _pairs.resize(pairs_base);
+    _match_keys.resize(keys_base);
+    _new_children.resize(new_base);
+    _old_children.resize(old_base);
+}
+
+void vdom::Reconciler::index_new_keys(std::size_t keys_base, std::size_t begin, std::size_t end)
+{
+    // Open addressing with linear probing, at most half full
+    std::size_t capacity = 16;
+    while (capacity < (end - begin) * 2)
+        capacity *= 2;
+    _new_indices.assign(capacity, empty_slot);
+
+    const std::size_t mask = capacity - 1;
+    for (std::size_t index = begin; index < end; ++index)
+    {
+        const MatchKey &key = _match_keys[keys_base + index];
+        std::size_t slot = MatchKeyHash{}(key) & mask;
+        while (_new_indices[slot] != empty_slot)
+        {
+            // The first of duplicated keys wins, later ones are created afresh
+            if (_match_keys[keys_base + _new_indices[slot]] == key)
+                break;
+            slot = (slot + 1) & mask;
+        }
+        if (_new_indices[slot] == empty_slot)
+            _new_indices[slot] = static_cast<std::uint32_t>(index);
+    }
+}
+
+std::uint32_t vdom::Reconciler::find_new_key(const MatchKey &key, std::size_t keys_base) const noexcept
+{
+    const std::size_t mask = _new_indices.size() - 1;
+
+    for (std::size_t slot = MatchKeyHash{}(key) & mask; _new_indices[slot] != empty_slot; slot = (slot + 1) & mask)
+    {
+        if (_match_keys[keys_base + _new_indices[slot]] == key)
+            return _new_indices[slot];
+    }
+    return no_index;
+}
+
+void vdom::Reconciler::mark_longest_increasing_subsequence(std::size_t count)
+{
+    _lis_tails.clear();
+    _lis_previous.assign(count, no_index);
+    _stable.assign(count, 0);
+
+    for (std::size_t index = 0; index < count; ++index)
+    {
+        std::int64_t source = _sources[index];
+        if (source < 0)
+            continue;
+
+        std::size_t low = 0;
+        std::size_t high = _lis_tails.size();
+        while (low < high)
+        {
+            std::size_t middle = (low + high) / 2;
+            if (_sources[_lis_tails[middle]] < source)
+                low = middle + 1;
+            else
+                high = middle;
+        }
+
+        if (low > 0)
+            _lis_previous[index] = _lis_tails[low - 1];
+        if (low == _lis_tails.size())
+            _lis_tails.push_back(static_cast<std::uint32_t>(index));
+        else
+            _lis_tails[low] = static_cast<std::uint32_t>(index);
+    }
+
+    if (_lis_tails.empty())
+        return;
+    for (std::uint32_t index = _lis_tails.back(); index != no_index; index = _lis_previous[index])
+        _stable[index] = 1;
+}
+
+void vdom::Reconciler::create(NodeId node, Handle parent, Handle before)
+{
+    Handle handle = _next->make_handle(node);
+    _next->set_handle(node, handle);
+
+    if (_next->kind(node) == NodeKind::Text)
+    {
+        _patches->push_back({PatchType::Create, NodeKind::Text, null_atom, handle, parent, before,
+                             Value::string(_next->text(node))});
+        return;
+    }
+
+    _patches->push_back({PatchType::Create, NodeKind::Element, _next->tag(node), handle, parent, before, Value()});
+    for (const Property &property : _next->properties(node))
+        _patches->push_back({PatchType::SetProperty, NodeKind::Element, property.key, handle,
+                             null_handle, null_handle, property.value});
+    for (NodeId child : _next->children(node))
+        create(child, handle, null_handle);
+}
+
+void vdom::Reconciler::remove(NodeId old_node)
+{
+    _patches->push_back({PatchType::Remove, _old->kind(old_node), null_atom, _old->handle(old_node),
+                         null_handle, null_handle, Value()});
+}
+
+void vdom::Reconciler::move(NodeId new_node, Handle parent, Handle before)
+{
+    _patches->push_back({PatchType::Move, _next->kind(new_node), null_atom, _next->handle(new_node),
+                         parent, before, Value()});
+}
@@ -0,0 +1,83 @@
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
+#include "vdom/static_block.hpp"
+
+namespace
+{
+    std::uint64_t mix(std::uint64_t hash) noexcept
+    {
+        // Finalizer of splitmix64: Value::hash() of small integers and booleans is the payload itself
+        hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ull;
+        hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBull;
+        return hash ^ (hash >> 31);
+    }
+
+    std::uint64_t combine(std::uint64_t seed, std::uint64_t value) noexcept
+    {
+        return mix(seed * 0x9E3779B97F4A7C15ull + value);
+    }
+} // namespace
+
+vdom::StaticBlock::StaticBlock() : _tree(std::pmr::new_delete_resource()), _fingerprint(0)
+{
+}
+
+vdom::Ref<const vdom::StaticBlock> vdom::StaticBlock::freeze(const Tree &tree, NodeId root)
+{
+    // Blocks outlive the frame that froze them, so they never use its arena
+    Ref<StaticBlock> block(new StaticBlock());
+    Tree &copy = block->_tree;
+
+    // Pre-order copy with an explicit stack: (node of tree, parent in the copy)
+    std::vector<std::pair<NodeId, NodeId>> work{{root, null_node}};
+    std::vector<NodeId> children;
+    while (!work.empty())
+    {
+        auto [node, parent] = work.back();
+        work.pop_back();
+
+        NodeId copied = tree.kind(node) == NodeKind::Text
+                            ? copy.create_text(tree.text(node))
+                            : copy.create_element(tree.tag(node), tree.key(node), tree.properties(node));
+        if (parent == null_node)
+            copy.set_root(copied);
+        else
+            copy.append_child(parent, copied);
+
+        children.clear();
+        for (NodeId child : tree.children(node))
+            children.push_back(child);
+        for (std::size_t index = children.size(); index-- > 0;)
+            work.push_back({children[index], copied});
+    }
+
+    // Children follow their parent in pre-order, so a reverse pass sees them first
+    std::vector<std::uint64_t> fingerprints(copy.size());
+    for (NodeId node = static_cast<NodeId>(copy.size()); node-- > 0;)
+    {
+        std::uint64_t fingerprint = hash_node(copy, node);
+        for (NodeId child : copy.children(node))
+            fingerprint = hash_child(fingerprint, fingerprints[child]);
+        fingerprints[node] = fingerprint;
+    }
+    block->_fingerprint = fingerprints[0];
+    return block;
+}
+
+std::uint64_t vdom::StaticBlock::hash_node(const Tree &tree, NodeId node) noexcept
+{
+    if (tree.kind(node) == NodeKind::Text)
+        return combine(1, Value::string(tree.text(node)).hash());
+
+    std::uint64_t hash = combine(combine(2, tree.tag(node)), tree.key(node).hash());
+    for (const Property &property : tree.properties(node))
+        hash = combine(combine(hash, property.key), property.value.hash());
+    return hash;
+}
+
+std::uint64_t vdom::StaticBlock::hash_child(std::uint64_t parent, std::uint64_t child) noexcept
+{
+    return combine(parent ^ 0xA0761D6478BD642Full, child);
+}
@@ -0,0 +1,87 @@
+#include <cstring>
+#include <utility>
+
+#include "vdom/string_pool.hpp"
+
+vdom::StringPool::StringPool(StringPool &&other) noexcept
+    : _resource(other._resource), _blocks(std::move(other._blocks)), _large_blocks(std::move(other._large_blocks)),
+      _blocks_in_use(std::exchange(other._blocks_in_use, 0)), _used(std::exchange(other._used, 0))
+{
+    other._blocks.clear();
+    other._large_blocks.clear();
+}
+
+vdom::StringPool &vdom::StringPool::operator=(StringPool &&other) noexcept
+{
+    if (this == &other)
+        return *this;
+
+    release(_blocks);
+    release(_large_blocks);
+    // Blocks must go back to the resource that allocated them
+    _resource = other._resource;
+    _blocks = std::move(other._blocks);
+    _large_blocks = std::move(other._large_blocks);
+    _blocks_in_use = std::exchange(other._blocks_in_use, 0);
+    _used = std::exchange(other._used, 0);
+    other._blocks.clear();
+    other._large_blocks.clear();
+    return *this;
+}
+
+vdom::StringPool::~StringPool()
+{
+    release(_blocks);
+    release(_large_blocks);
+}
+
+void vdom::StringPool::release(std::pmr::vector<Block> &blocks) noexcept
+{
+    for (const Block &block : blocks)
+        _resource->deallocate(block.data, block.size, 1);
+    blocks.clear();
+}
+
+std::string_view vdom::StringPool::store(std::string_view text)
+{
+    if (text.empty())
+        return {};
+
+    char *destination = nullptr;
+    if (text.size() > block_size / 4)
+    {
+        destination = static_cast<char *>(_resource->allocate(text.size(), 1));
+        _large_blocks.push_back({destination, text.size()});
+    }
+    else
+    {
+        if (_blocks_in_use == 0 || _used + text.size() > block_size)
+        {
+            if (_blocks_in_use == _blocks.size())
+                _blocks.push_back({static_cast<char *>(_resource->allocate(block_size, 1)), block_size});
+            _blocks_in_use++;
+            _used = 0;
+        }
+        destination = _blocks[_blocks_in_use - 1].data + _used;
+        _used += text.size();
+    }
+
+    std::memcpy(destination, text.data(), text.size());
+    return {destination, text.size()};
+}
+
+void vdom::StringPool::rewind(const Mark &mark) noexcept
+{
+    for (std::size_t index = mark.large_blocks; index < _large_blocks.size(); ++index)
+        _resource->deallocate(_large_blocks[index].data, _large_blocks[index].size, 1);
+    _large_blocks.resize(mark.large_blocks);
+    _blocks_in_use = mark.blocks_in_use;
+    _used = mark.used;
+}
+
+void vdom::StringPool::clear() noexcept
+{
+    release(_large_blocks);
+    _blocks_in_use = 0;
+    _used = 0;
+}
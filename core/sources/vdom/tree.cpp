@@ -0,0 +1,315 @@
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <stdexcept>
+
+#include "vdom/persistent.hpp"
+#include "vdom/static_block.hpp"
+#include "vdom/tree.hpp"
+
+namespace
+{
+    std::uint64_t next_serial() noexcept
+    {
+        static std::atomic<std::uint64_t> serial(0);
+        return serial.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+} // namespace
+
+vdom::Tree::Tree(std::pmr::memory_resource *resource)
+    : _kinds(resource), _tags(resource), _keys(resource), _texts(resource), _parents(resource),
+      _first_children(resource), _last_children(resource), _next_siblings(resource),
+      _property_slices(resource), _handles(resource), _properties(resource), _strings(resource), _shared(resource),
+      _blocks(resource), _root(null_node), _generation(0), _serial(next_serial()), _origin(0)
+{
+}
+
+vdom::NodeId vdom::Tree::push_node(NodeKind kind, Atom tag, Value key, Value text)
+{
+    own();
+    if (_kinds.size() >= null_node)
+        throw std::length_error("Too many nodes in virtual DOM tree");
+
+    NodeId node = static_cast<NodeId>(_kinds.size());
+    _kinds.push_back(kind);
+    _tags.push_back(tag);
+    _keys.push_back(store(key));
+    _texts.push_back(store(text));
+    _parents.push_back(null_node);
+    _first_children.push_back(null_node);
+    _last_children.push_back(null_node);
+    _next_siblings.push_back(null_node);
+    _handles.push_back(null_handle);
+    _property_slices.push_back({static_cast<std::uint32_t>(_properties.size()), 0});
+    return node;
+}
+
+vdom::NodeId vdom::Tree::create_element(Atom tag, Value key, std::span<const Property> properties)
+{
+    NodeId node = push_node(NodeKind::Element, tag, key, Value());
+    std::size_t offset = _properties.size();
+
+    for (const Property &property : properties)
+        _properties.push_back({property.key, store(property.value)});
+
+    // Insertion sort: stable, in place and fast for the handful of properties a node has,
+    // where std::stable_sort would take a temporary buffer from the heap on every call
+    for (std::size_t index = offset + 1; index < _properties.size(); ++index)
+    {
+        Property property = _properties[index];
+        std::size_t position = index;
+        for (; position > offset && _properties[position - 1].key > property.key; --position)
+            _properties[position] = _properties[position - 1];
+        _properties[position] = property;
+    }
+
+    // Keep the last occurrence of each key, matching Python dict assignment
+    std::size_t write = offset;
+    for (std::size_t read = offset; read < _properties.size(); ++read)
+    {
+        if (read + 1 < _properties.size() && _properties[read + 1].key == _properties[read].key)
+            continue;
+        _properties[write++] = _properties[read];
+    }
+    _properties.truncate(write);
+
+    _property_slices[node].count = static_cast<std::uint32_t>(write - offset);
+    return node;
+}
+
+vdom::NodeId vdom::Tree::create_text(std::string_view text)
+{
+    return push_node(NodeKind::Text, null_atom, Value(), Value::string(text));
+}
+
+void vdom::Tree::append_child(NodeId parent, NodeId child)
+{
+    own();
+    if (_parents[child] != null_node)
+        throw std::logic_error("Node already has a parent");
+
+    _parents[child] = parent;
+    if (_last_children[parent] == null_node)
+        _first_children[parent] = child;
+    else
+        _next_siblings[_last_children[parent]] = child;
+    _last_children[parent] = child;
+}
+
+vdom::NodeId vdom::Tree::copy_block(const StaticBlock &block)
+{
+    const Tree &source = block.tree();
+    own();
+    if (_kinds.size() + source.size() >= null_node)
+        throw std::length_error("Too many nodes in virtual DOM tree");
+
+    const NodeId base = static_cast<NodeId>(_kinds.size());
+    const std::uint32_t properties = static_cast<std::uint32_t>(_properties.size());
+    auto offset = [base](NodeId node)
+    { return node == null_node ? null_node : node + base; };
+
+    // Values keep pointing into the block, which the tree retains
+    _kinds.append(source._kinds.items());
+    _tags.append(source._tags.items());
+    _keys.append(source._keys.items());
+    _texts.append(source._texts.items());
+    _properties.append(source._properties.items());
+    for (NodeId node = 0; node < source.size(); ++node)
+    {
+        _parents.push_back(offset(source._parents[node]));
+        _first_children.push_back(offset(source._first_children[node]));
+        _last_children.push_back(offset(source._last_children[node]));
+        _next_siblings.push_back(offset(source._next_siblings[node]));
+        _handles.push_back(null_handle);
+        _property_slices.push_back({source._property_slices[node].offset + properties, source._property_slices[node].count});
+    }
+
+    mark_block(base, block);
+    return base;
+}
+
+vdom::NodeId vdom::Tree::copy_nodes(const Tree &source, NodeId first, NodeId count)
+{
+    if (first > source.size() || count > source.size() - first)
+        throw std::out_of_range("Copied nodes out of the source tree");
+    own();
+    if (_kinds.size() + count >= null_node)
+        throw std::length_error("Too many nodes in virtual DOM tree");
+
+    const NodeId base = static_cast<NodeId>(_kinds.size());
+    const NodeId end = first + count;
+    auto offset = [first, end, base](NodeId node)
+    { return node >= first && node < end ? node - first + base : null_node; };
+
+    for (NodeId node = first; node < end; ++node)
+    {
+        _kinds.push_back(source._kinds[node]);
+        _tags.push_back(source._tags[node]);
+        _keys.push_back(store(source._keys[node]));
+        _texts.push_back(store(source._texts[node]));
+        _parents.push_back(offset(source._parents[node]));
+        _first_children.push_back(offset(source._first_children[node]));
+        _last_children.push_back(offset(source._last_children[node]));
+        _next_siblings.push_back(offset(source._next_siblings[node]));
+        _handles.push_back(source._handles[node]);
+
+        // Already sorted and without duplicates
+        const PropertySlice &slice = source._property_slices[node];
+        _property_slices.push_back({static_cast<std::uint32_t>(_properties.size()), slice.count});
+        for (std::uint32_t index = slice.offset; index < slice.offset + slice.count; ++index)
+            _properties.push_back({source._properties[index].key, store(source._properties[index].value)});
+    }
+
+    auto mark = std::lower_bound(source._blocks.begin(), source._blocks.end(), first,
+                                 [](const BlockMark &mark, NodeId node)
+                                 { return mark.root < node; });
+    for (; mark != source._blocks.end() && mark->root < end; ++mark)
+        mark_block(mark->root - first + base, *mark->block);
+
+    // The handles of a tree not diffed yet are those of its own origin; copies of two origins are never skipped
+    const std::uint64_t origin = source._origin != 0 ? source._origin : source._serial;
+    _origin = _origin == 0 || _origin == origin ? origin : std::numeric_limits<std::uint64_t>::max();
+    return base;
+}
+
+vdom::NodeId vdom::Tree::copy_node(const Tree &source, NodeId node)
+{
+    if (node >= source.size())
+        throw std::out_of_range("Copied node out of the source tree");
+
+    const NodeId copy = push_node(source._kinds[node], source._tags[node], source._keys[node], source._texts[node]);
+    const PropertySlice &slice = source._property_slices[node];
+    for (std::uint32_t index = slice.offset; index < slice.offset + slice.count; ++index)
+        _properties.push_back({source._properties[index].key, store(source._properties[index].value)});
+    _property_slices[copy].count = slice.count;
+    return copy;
+}
+
+void vdom::Tree::view(const Columns &columns, const Shared &owner)
+{
+    const std::size_t nodes = columns.kinds.size();
+    for (std::size_t size : {columns.tags.size(), columns.keys.size(), columns.texts.size(), columns.parents.size(),
+                             columns.first_children.size(), columns.last_children.size(), columns.next_siblings.size(),
+                             columns.property_slices.size(), columns.handles.size()})
+    {
+        if (size != nodes)
+            throw std::invalid_argument("Viewed tree columns differ in size");
+    }
+    if (nodes >= null_node)
+        throw std::length_error("Too many nodes in virtual DOM tree");
+
+    clear();
+    _kinds.borrow(columns.kinds);
+    _tags.borrow(columns.tags);
+    _keys.borrow(columns.keys);
+    _texts.borrow(columns.texts);
+    _parents.borrow(columns.parents);
+    _first_children.borrow(columns.first_children);
+    _last_children.borrow(columns.last_children);
+    _next_siblings.borrow(columns.next_siblings);
+    _property_slices.borrow(columns.property_slices);
+    _handles.borrow(columns.handles);
+    _properties.borrow(columns.properties);
+    _shared.emplace_back(&owner);
+}
+
+void vdom::Tree::own_columns()
+{
+    // Values keep pointing into the owner, which the tree still retains; kinds go last, as own() checks them
+    _tags.own();
+    _keys.own();
+    _texts.own();
+    _parents.own();
+    _first_children.own();
+    _last_children.own();
+    _next_siblings.own();
+    _property_slices.own();
+    _handles.own();
+    _properties.own();
+    _kinds.own();
+}
+
+void vdom::Tree::mark_block(NodeId root, const StaticBlock &block)
+{
+    _shared.emplace_back(&block);
+    auto position = std::upper_bound(_blocks.begin(), _blocks.end(), root,
+                                     [](NodeId node, const BlockMark &mark)
+                                     { return node < mark.root; });
+    _blocks.insert(position, {root, &block});
+}
+
+const vdom::StaticBlock *vdom::Tree::block(NodeId root) const noexcept
+{
+    if (_blocks.empty())
+        return nullptr;
+    auto position = std::lower_bound(_blocks.begin(), _blocks.end(), root,
+                                     [](const BlockMark &mark, NodeId node)
+                                     { return mark.root < node; });
+    return position != _blocks.end() && position->root == root ? position->block : nullptr;
+}
+
+vdom::Value vdom::Tree::store(Value value)
+{
+    if (const Shared *shared = shared_of(value))
+        _shared.emplace_back(shared);
+    if (value.type() != Value::Type::String)
+        return value;
+    return Value::string(_strings.store(value.as_string()));
+}
+
+void vdom::Tree::reserve(std::size_t nodes, std::size_t properties)
+{
+    own();
+    _kinds.reserve(nodes);
+    _tags.reserve(nodes);
+    _keys.reserve(nodes);
+    _texts.reserve(nodes);
+    _parents.reserve(nodes);
+    _first_children.reserve(nodes);
+    _last_children.reserve(nodes);
+    _next_siblings.reserve(nodes);
+    _handles.reserve(nodes);
+    _property_slices.reserve(nodes);
+    _properties.reserve(properties);
+}
+
+void vdom::Tree::rollback(const Checkpoint &checkpoint) noexcept
+{
+    _kinds.truncate(checkpoint.nodes);
+    _tags.truncate(checkpoint.nodes);
+    _keys.truncate(checkpoint.nodes);
+    _texts.truncate(checkpoint.nodes);
+    _parents.truncate(checkpoint.nodes);
+    _first_children.truncate(checkpoint.nodes);
+    _last_children.truncate(checkpoint.nodes);
+    _next_siblings.truncate(checkpoint.nodes);
+    _handles.truncate(checkpoint.nodes);
+    _property_slices.truncate(checkpoint.nodes);
+    _properties.truncate(checkpoint.properties);
+    _strings.rewind(checkpoint.strings);
+    _shared.resize(checkpoint.shared);
+    _blocks.resize(checkpoint.blocks);
+    if (_root != null_node && _root >= checkpoint.nodes)
+        _root = null_node;
+}
+
+void vdom::Tree::clear() noexcept
+{
+    _kinds.clear();
+    _tags.clear();
+    _keys.clear();
+    _texts.clear();
+    _parents.clear();
+    _first_children.clear();
+    _last_children.clear();
+    _next_siblings.clear();
+    _handles.clear();
+    _property_slices.clear();
+    _properties.clear();
+    _strings.clear();
+    _shared.clear();
+    _blocks.clear();
+    _root = null_node;
+    _serial = next_serial();
+    _origin = 0;
+}
@@ -0,0 +1,10 @@
+#include "backend/memory_backend.hpp"
+
+/**
+ * @brief Entry point of the in-memory reference backend, built as a library for backend::Library
+ *
+ */
+extern "C" CE_BACKEND_EXPORT const ce_backend_api *ce_backend_entry(std::uint32_t abi_version)
+{
+    return abi_version == CE_BACKEND_ABI_VERSION ? &backend::memory_backend_api() : nullptr;
+}
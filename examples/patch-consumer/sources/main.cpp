@@ -0,0 +1,142 @@
+#include <array>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "argument_parser.hpp"
+#include "stream/patch_stream.hpp"
+#include "stream/shared_memory.hpp"
+#include "vdom/reconciler.hpp"
+
+namespace
+{
+    /**
+     * @brief Reference consumer: follows the structure of the streamed tree and reports each frame
+     *
+     * A renderer would create, move and update its own widgets here instead.
+     * Strings are read in place: they must be copied to outlive apply().
+     */
+    class Consumer
+    {
+    private:
+        vdom::AtomTable &_atoms;
+        std::array<std::size_t, 6> _counts{};
+        std::size_t _nodes = 0;
+
+    public:
+        explicit Consumer(vdom::AtomTable &atoms) : _atoms(atoms) {}
+
+        void apply(const vdom::PatchList &patches)
+        {
+            for (const vdom::Patch &patch : patches)
+            {
+                _counts[static_cast<std::size_t>(patch.type)]++;
+                if (patch.type == vdom::PatchType::Create)
+                {
+                    _nodes++;
+                    if (patch.kind == vdom::NodeKind::Text)
+                        std::cout << "  text " << patch.node << ": " << patch.value.as_string() << "\n";
+                    else
+                        std::cout << "  <" << _atoms.name(patch.name) << "> " << patch.node << "\n";
+                }
+            }
+        }
+
+        void commit(std::uint32_t generation)
+        {
+            static constexpr const char *names[] = {"create", "remove", "move", "set property", "remove property", "set text"};
+            std::cout << "frame " << generation << ":";
+            for (std::size_t type = 0; type < _counts.size(); ++type)
+            {
+                if (_counts[type])
+                    std::cout << " " << _counts[type] << " " << names[type];
+            }
+            std::cout << std::endl;
+            _counts.fill(0);
+        }
+
+        std::size_t created() const noexcept { return _nodes; }
+    };
+
+    /**
+     * @brief Stream a few frames of a list, standing in for the engine process
+     *
+     */
+    void produce(stream::PatchWriter &writer, std::int64_t frames)
+    {
+        vdom::AtomTable &atoms = vdom::AtomTable::global();
+        vdom::Reconciler reconciler;
+        vdom::PatchList patches;
+        std::vector<vdom::Tree> trees(2);
+
+        for (std::int64_t frame = 0; frame <= frames; ++frame)
+        {
+            vdom::Tree &mounted = trees[frame % 2];
+            vdom::Tree &next = trees[(frame + 1) % 2];
+            next.clear();
+            vdom::NodeId list = next.create_element(atoms.intern("ul"));
+            next.set_root(list);
+            for (std::int64_t key = 0; key < 3; ++key)
+            {
+                vdom::NodeId item = next.create_element(atoms.intern("li"), vdom::Value::integer((key + frame) % 3));
+                next.append_child(list, item);
+                next.append_child(item, next.create_text("item " + std::to_string(key) + " of frame " + std::to_string(frame)));
+            }
+
+            patches.clear();
+            reconciler.diff(mounted, next, patches);
+            writer.write(patches, next.generation());
+        }
+        writer.close();
+    }
+} // namespace
+
+int main(int argc, const char *const argv[])
+{
+    argument_parser::ArgumentParser argument_parser(argc, argv,
+                                                    "Read the patches of a component-engine patch stream and report them, "
+                                                    "or stream a demo list to itself when no name is given");
+    argument_parser.add_argument(std::vector<std::string>{"-n", "--name"}, "store", "", "", "",
+                                 "the shared memory holding the stream, created by the engine process", "NAME");
+    argument_parser.add_argument(std::vector<std::string>{"-f", "--frames"}, "store", "", "", "3",
+                                 "number of updates of the demo list", "COUNT", false, {}, argument_parser::ValueType::Integer);
+    argument_parser::Namespace arguments = argument_parser.parse_args();
+
+    try
+    {
+        vdom::AtomTable atoms;
+        Consumer consumer(atoms);
+        stream::SharedMemory memory;
+        std::optional<stream::PatchWriter> writer;
+        std::thread producer;
+        if (arguments.has("name"))
+            memory = stream::SharedMemory(arguments.get<std::string>("name"));
+        else
+        {
+            // The stream must be laid out before the reader attaches
+            memory = stream::SharedMemory("component-engine-patch-consumer", stream::PatchWriter::memory_size(1 << 16));
+            writer.emplace(memory.bytes());
+            producer = std::thread(produce, std::ref(*writer), arguments.get<std::int64_t>("frames"));
+        }
+
+        stream::PatchReader reader(memory.bytes(), atoms);
+        while (!reader.finished())
+        {
+            if (!reader.read(consumer))
+                std::this_thread::yield();
+        }
+        if (producer.joinable())
+            producer.join();
+        std::cout << "patch-consumer: " << consumer.created() << " nodes created" << std::endl;
+    }
+    catch (const std::exception &exception)
+    {
+        std::cerr << "Error: " << exception.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
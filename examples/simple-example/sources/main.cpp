@@ -1,21 +1,27 @@
 #include <cstdlib>
+#include <fstream>
 #include <iostream>
 #include <vector>
 
 #include "argument_parser.hpp"
+#include "python/gil.hpp"
 #include "python/object.hpp"
+#include "python/runtime.hpp"
+#include "trace/tracer.hpp"
+#include "vdom/reconciler.hpp"
 
 int main(int argc, const char *const argv[], const char *const envp[])
 {
     std::shared_ptr<argument_parser::ArgumentParser> argument_parser = nullptr;
     std::shared_ptr<argument_parser::Namespace> arguement_namespace = nullptr;
-    std::unique_ptr<python::Object> python_object = nullptr;
 
     try
     {
         // Create ArgumentParser with description
         argument_parser = std::make_shared<argument_parser::ArgumentParser>(argc, argv,
                                                                             "A simple example demonstrating the component-engine functionality");
+        argument_parser->add_argument(std::vector<std::string>{"-t", "--trace"}, "store", "", "", "",
+                                      "record the render pipeline and write it as Chrome trace JSON to FILE", "FILE");
     }
     catch (const argument_parser::ArgumentError &exception)
     {
@@ -38,9 +44,39 @@ int main(int argc, const char *const argv[], const char *const envp[])
         return EXIT_FAILURE;
     }
 
+    std::string trace_path = arguement_namespace->has("trace") ? arguement_namespace->get<std::string>("trace") : "";
+    trace::Tracer::enable(!trace_path.empty());
+
     try
     {
-        python_object = std::make_unique<python::Object>();
+        python::RuntimeConfig runtime_config;
+        runtime_config.program_name = argc > 0 ? argv[0] : "simple-example";
+        python::Runtime::initialize(runtime_config);
+
+        python::GIL gil;
+        python::Object python_object(PyUnicode_FromString("component-engine"));
+
+        // Mount a small list, then update it
+        vdom::AtomTable &atoms = vdom::AtomTable::global();
+        vdom::Tree empty;
+        vdom::Tree mounted;
+        vdom::Tree next;
+        vdom::Reconciler reconciler;
+        vdom::PatchList patches;
+        for (vdom::Tree *tree : {&mounted, &next})
+        {
+            vdom::NodeId list = tree->create_element(atoms.intern("ul"));
+            tree->set_root(list);
+            for (std::int64_t key = 0; key < 3; ++key)
+            {
+                vdom::NodeId item = tree->create_element(atoms.intern("li"), vdom::Value::integer(tree == &next ? 2 - key : key));
+                tree->append_child(list, item);
+                tree->append_child(item, tree->create_text(tree == &next ? "updated" : "item"));
+            }
+        }
+        reconciler.diff(empty, mounted, patches);
+        reconciler.diff(mounted, next, patches);
+        std::cout << "component-engine: " << patches.size() << " patches" << std::endl;
     }
     catch (const std::exception &exception)
     {
@@ -48,5 +84,16 @@ int main(int argc, const char *const argv[], const char *const envp[])
         return EXIT_FAILURE;
     }
 
+    if (!trace_path.empty())
+    {
+        std::ofstream file(trace_path);
+        trace::Tracer::write_chrome_trace(file);
+        if (!file)
+        {
+            std::cerr << "Error: cannot write " << trace_path << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
     return EXIT_SUCCESS;
 }
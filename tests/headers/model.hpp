@@ -0,0 +1,239 @@
+#pragma once
+
+#include <algorithm>
+#include <map>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "vdom/patch.hpp"
+#include "vdom/tree.hpp"
+
+namespace test
+{
+    /**
+     * @brief Naive document applying patches as literally as possible, to check them against trees
+     *
+     * Unlike a real backend it rejects anything a correct patch list never
+     * does: creating an existing handle, inserting before a node of another
+     * parent, removing a property that is not set.
+     */
+    class Model
+    {
+    private:
+        struct Property
+        {
+            vdom::Value value;
+            std::string string; ///< Owned copy of a string value
+        };
+
+        struct Node
+        {
+            vdom::NodeKind kind;
+            vdom::Atom tag;
+            std::string text;
+            std::map<vdom::Atom, Property> properties;
+            std::vector<vdom::Handle> children;
+            vdom::Handle parent = vdom::null_handle;
+        };
+
+        std::map<vdom::Handle, Node> _nodes;
+        vdom::Handle _root = vdom::null_handle;
+
+        Node &at(vdom::Handle handle)
+        {
+            auto it = _nodes.find(handle);
+            if (it == _nodes.end())
+                throw std::runtime_error("Unknown node " + std::to_string(handle));
+            return it->second;
+        }
+
+        void detach(vdom::Handle handle)
+        {
+            Node &node = at(handle);
+            if (node.parent == vdom::null_handle)
+            {
+                if (_root != handle)
+                    throw std::runtime_error("Node " + std::to_string(handle) + " is detached");
+                _root = vdom::null_handle;
+                return;
+            }
+            std::vector<vdom::Handle> &siblings = at(node.parent).children;
+            siblings.erase(std::find(siblings.begin(), siblings.end(), handle));
+            node.parent = vdom::null_handle;
+        }
+
+        void attach(vdom::Handle handle, vdom::Handle parent, vdom::Handle before)
+        {
+            if (parent == vdom::null_handle)
+            {
+                if (_root != vdom::null_handle)
+                    throw std::runtime_error("Second root " + std::to_string(handle));
+                _root = handle;
+                return;
+            }
+            std::vector<vdom::Handle> &siblings = at(parent).children;
+            auto position = before == vdom::null_handle ? siblings.end() : std::find(siblings.begin(), siblings.end(), before);
+            if (before != vdom::null_handle && position == siblings.end())
+                throw std::runtime_error("Node " + std::to_string(before) + " is not a child of " + std::to_string(parent));
+            siblings.insert(position, handle);
+            at(handle).parent = parent;
+        }
+
+        void erase(vdom::Handle handle)
+        {
+            for (vdom::Handle child : at(handle).children)
+                erase(child);
+            _nodes.erase(handle);
+        }
+
+        static std::string text_of(const vdom::Value &value)
+        {
+            return value.type() == vdom::Value::Type::String ? std::string(value.as_string()) : std::string();
+        }
+
+        static bool same(const Property &property, const vdom::Value &expected)
+        {
+            if (expected.type() == vdom::Value::Type::String)
+                return property.value.type() == vdom::Value::Type::String && property.string == expected.as_string();
+            return property.value == expected;
+        }
+
+        std::string compare(const vdom::Tree &tree, vdom::NodeId node, vdom::Handle handle) const
+        {
+            const std::string where = "node " + std::to_string(handle);
+            if (tree.handle(node) != handle)
+                return where + ": tree handle is " + std::to_string(tree.handle(node));
+            const Node &model = _nodes.at(handle);
+            if (model.kind != tree.kind(node) || model.tag != tree.tag(node))
+                return where + ": kind or tag differs";
+            if (model.kind == vdom::NodeKind::Text)
+                return model.text == tree.text(node) ? std::string() : where + ": text \"" + model.text + "\" differs";
+
+            std::span<const vdom::Property> properties = tree.properties(node);
+            if (properties.size() != model.properties.size())
+                return where + ": " + std::to_string(model.properties.size()) + " properties instead of " +
+                       std::to_string(properties.size());
+            for (const vdom::Property &property : properties)
+            {
+                auto it = model.properties.find(property.key);
+                if (it == model.properties.end() || !same(it->second, property.value))
+                    return where + ": property " + std::string(vdom::AtomTable::global().name(property.key)) + " differs";
+            }
+
+            std::size_t index = 0;
+            for (vdom::NodeId child : tree.children(node))
+            {
+                if (index >= model.children.size())
+                    return where + ": missing children";
+                std::string difference = compare(tree, child, model.children[index++]);
+                if (!difference.empty())
+                    return difference;
+            }
+            return index == model.children.size() ? std::string() : where + ": extra children";
+        }
+
+        void html(std::string &output, vdom::Handle handle) const
+        {
+            const Node &node = _nodes.at(handle);
+            if (node.kind == vdom::NodeKind::Text)
+            {
+                output += node.text;
+                return;
+            }
+            const std::string_view tag = vdom::AtomTable::global().name(node.tag);
+            output += '<';
+            output += tag;
+            for (const auto &[key, property] : node.properties)
+            {
+                output += ' ';
+                output += vdom::AtomTable::global().name(key);
+                output += "=\"" + property.string + '"';
+            }
+            output += '>';
+            for (vdom::Handle child : node.children)
+                html(output, child);
+            output += "</";
+            output += tag;
+            output += '>';
+        }
+
+    protected:
+    public:
+        /**
+         * @brief Apply a patch list, front to back
+         *
+         * String property values are copied, so the patches may be dropped afterwards.
+         *
+         * @throw std::runtime_error If a patch cannot apply to the current document
+         */
+        void apply(std::span<const vdom::Patch> patches)
+        {
+            for (const vdom::Patch &patch : patches)
+            {
+                switch (patch.type)
+                {
+                case vdom::PatchType::Create:
+                    if (_nodes.contains(patch.node))
+                        throw std::runtime_error("Node " + std::to_string(patch.node) + " created twice");
+                    _nodes[patch.node] = {patch.kind, patch.name, patch.kind == vdom::NodeKind::Text ? text_of(patch.value) : std::string()};
+                    attach(patch.node, patch.parent, patch.before);
+                    break;
+                case vdom::PatchType::Remove:
+                    detach(patch.node);
+                    erase(patch.node);
+                    break;
+                case vdom::PatchType::Move:
+                    detach(patch.node);
+                    attach(patch.node, patch.parent, patch.before);
+                    break;
+                case vdom::PatchType::SetProperty:
+                    at(patch.node).properties[patch.name] = {patch.value, text_of(patch.value)};
+                    break;
+                case vdom::PatchType::RemoveProperty:
+                    if (at(patch.node).properties.erase(patch.name) == 0)
+                        throw std::runtime_error("Removing an unset property from " + std::to_string(patch.node));
+                    break;
+                case vdom::PatchType::SetText:
+                    at(patch.node).text = text_of(patch.value);
+                    break;
+                }
+            }
+        }
+
+        /**
+         * @brief Compare the document with a tree, handles included
+         *
+         * @return std::string The first difference found, empty if there is none
+         */
+        std::string compare(const vdom::Tree &tree) const
+        {
+            if (tree.empty() || tree.root() == vdom::null_node)
+                return _root == vdom::null_handle ? std::string() : "document is not empty";
+            if (_root == vdom::null_handle)
+                return "document is empty";
+            std::string difference = compare(tree, tree.root(), _root);
+            if (difference.empty() && _nodes.size() != tree.size())
+                return std::to_string(_nodes.size()) + " nodes instead of " + std::to_string(tree.size());
+            return difference;
+        }
+
+        /**
+         * @brief Write the document as markup, like backend::MemoryBackend::html()
+         *
+         * Properties are written in atom order and nothing is escaped, so the
+         * outputs only agree on documents of plain strings set in atom order.
+         */
+        std::string html() const
+        {
+            std::string output;
+            if (_root != vdom::null_handle)
+                html(output, _root);
+            return output;
+        }
+
+        vdom::Handle root() const noexcept { return _root; }
+        std::size_t size() const noexcept { return _nodes.size(); }
+    };
+} // namespace test
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <exception>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace test
+{
+    /**
+     * @brief Thrown by a failed check, ending the test it belongs to
+     *
+     */
+    class Failure : public std::exception
+    {
+    private:
+        std::string _message;
+
+    protected:
+    public:
+        /**
+         * @brief Construct a new Failure
+         *
+         * @param file The file of the check
+         * @param line The line of the check
+         * @param message What was checked, and the values involved
+         */
+        Failure(const char *file, int line, const std::string &message)
+            : _message(std::string(file) + ":" + std::to_string(line) + ": " + message)
+        {
+        }
+
+        const char *what() const noexcept override { return _message.c_str(); }
+    };
+
+    using Function = void (*)();
+
+    struct Test
+    {
+        std::string name;
+        Function function;
+    };
+
+    /**
+     * @brief Get every test registered with TEST
+     *
+     * @return std::vector<Test>& The registered tests, in registration order per file
+     */
+    inline std::vector<Test> &registry()
+    {
+        static std::vector<Test> tests;
+        return tests;
+    }
+
+    struct Registration
+    {
+        Registration(const std::string &name, Function function) { registry().push_back({name, function}); }
+    };
+
+    /**
+     * @brief Describe the two sides of a failed equality check
+     *
+     */
+    template <typename Left, typename Right>
+    std::string describe(const char *expression, const Left &left, const Right &right)
+    {
+        std::ostringstream stream;
+        stream << expression << " (" << left << " != " << right << ")";
+        return stream.str();
+    }
+} // namespace test
+
+/**
+ * @brief Define and register a test function
+ *
+ */
+#define TEST(function)                                                         \
+    static void function();                                                    \
+    static const test::Registration function##_registration(#function, function); \
+    static void function()
+
+/**
+ * @brief Fail the running test unless condition holds
+ *
+ */
+#define CHECK(condition)                                        \
+    do                                                          \
+    {                                                           \
+        if (!(condition))                                       \
+            throw test::Failure(__FILE__, __LINE__, #condition); \
+    } while (false)
+
+/**
+ * @brief Fail the running test unless both values compare equal, printing them otherwise
+ *
+ */
+#define CHECK_EQUAL(left, right)                                                                        \
+    do                                                                                                  \
+    {                                                                                                   \
+        const auto &check_left = (left);                                                                \
+        const auto &check_right = (right);                                                              \
+        if (!(check_left == check_right))                                                               \
+            throw test::Failure(__FILE__, __LINE__, test::describe(#left " == " #right, check_left, check_right)); \
+    } while (false)
+
+/**
+ * @brief Fail the running test unless expression throws an exception of the given type
+ *
+ */
+#define CHECK_THROWS(expression, exception)                                                   \
+    do                                                                                        \
+    {                                                                                         \
+        bool check_thrown = false;                                                            \
+        try                                                                                   \
+        {                                                                                     \
+            (void)(expression);                                                               \
+        }                                                                                     \
+        catch (const exception &)                                                             \
+        {                                                                                     \
+            check_thrown = true;                                                              \
+        }                                                                                     \
+        if (!check_thrown)                                                                    \
+            throw test::Failure(__FILE__, __LINE__, #expression " does not throw " #exception); \
+    } while (false)
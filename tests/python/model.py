@@ -0,0 +1,73 @@
+"""
+Naive document applying patch lists from Python, to check them against fresh renders.
+"""
+
+from component_engine import CREATE, MOVE, REMOVE, REMOVE_PROPERTY, SET_PROPERTY, SET_TEXT, diff, render
+
+
+class Model:
+    def __init__(self):
+        self.nodes = {}
+        self.root = None
+
+    def apply(self, patches):
+        for patch in patches:
+            kind, node, parent, before, name, value = patch
+            if kind == CREATE:
+                assert node not in self.nodes, "node %d created twice" % node
+                self.nodes[node] = {"tag": name, "text": value if name is None else None, "properties": {}, "children": []}
+                self._attach(node, parent, before)
+            elif kind == REMOVE:
+                self._detach(node)
+                self._drop(node)
+            elif kind == MOVE:
+                self._detach(node)
+                self._attach(node, parent, before)
+            elif kind == SET_PROPERTY:
+                self.nodes[node]["properties"][name] = value
+            elif kind == REMOVE_PROPERTY:
+                del self.nodes[node]["properties"][name]
+            elif kind == SET_TEXT:
+                self.nodes[node]["text"] = value
+        return self
+
+    def _attach(self, node, parent, before):
+        self.nodes[node]["parent"] = parent
+        if not parent:
+            assert self.root is None, "second root %d" % node
+            self.root = node
+            return
+        children = self.nodes[parent]["children"]
+        children.insert(children.index(before) if before else len(children), node)
+
+    def _detach(self, node):
+        parent = self.nodes[node]["parent"]
+        if not parent:
+            self.root = None
+        else:
+            self.nodes[parent]["children"].remove(node)
+
+    def _drop(self, node):
+        for child in self.nodes[node]["children"]:
+            self._drop(child)
+        del self.nodes[node]
+
+    def dump(self, node=None):
+        """
+        The document as nested (tag, properties, children) tuples and texts, without handles.
+        """
+        node = self.root if node is None else node
+        if node is None:
+            return None
+        entry = self.nodes[node]
+        if entry["tag"] is None:
+            return entry["text"]
+        properties = tuple(sorted((name, value) for name, value in entry["properties"].items()))
+        return (entry["tag"], properties, tuple(self.dump(child) for child in entry["children"]))
+
+
+def fresh(component):
+    """
+    Dump what component renders from scratch, with no cache or mounted tree involved.
+    """
+    return Model().apply(diff(None, render(component))).dump()
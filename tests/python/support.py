@@ -0,0 +1,24 @@
+"""
+Import component_engine from the source tree, where the build puts the _core module.
+
+The package directory is named component-engine, so it cannot be imported by
+name; tests import this module first, then component_engine as usual.
+COMPONENT_ENGINE_PACKAGE overrides the directory.
+"""
+
+import importlib.util
+import os
+import sys
+
+PACKAGE_DIR = os.environ.get(
+    "COMPONENT_ENGINE_PACKAGE",
+    os.path.join(os.path.dirname(os.path.abspath(__file__)), os.pardir, os.pardir, "component-engine"),
+)
+
+if "component_engine" not in sys.modules:
+    _spec = importlib.util.spec_from_file_location(
+        "component_engine", os.path.join(PACKAGE_DIR, "__init__.py"), submodule_search_locations=[PACKAGE_DIR]
+    )
+    _module = importlib.util.module_from_spec(_spec)
+    sys.modules["component_engine"] = _module
+    _spec.loader.exec_module(_module)
@@ -0,0 +1,57 @@
+import unittest
+
+import support  # noqa: F401
+from component_engine import Component, Element, Properties, Root
+from model import Model, fresh
+
+
+class Rows(Component):
+    memoize = False
+
+    def render(self):
+        count = self.state.get("count", 0)
+        return Element("ul", {}, [Element("li", {"index": index}, ["row %d" % index], key=index) for index in range(count)])
+
+
+class ArenaTest(unittest.TestCase):
+    def test_frames_stop_allocating_once_warm(self):
+        component = Rows(Properties())
+        component.state["count"] = 500
+        root = Root(component)
+        model = Model()
+        model.apply(root.flush())
+        self.assertGreater(root.arena_bytes, 0)
+
+        for frame in range(6):
+            component.set_state({"count": 500 - frame % 2})
+            model.apply(root.flush())
+        chunks = root.arena_chunks
+        for frame in range(20):
+            component.set_state({"count": 500 - frame % 2})
+            model.apply(root.flush())
+        self.assertEqual(root.arena_chunks, chunks)
+        self.assertEqual(root.detached_arenas, 0)
+        self.assertEqual(model.dump(), fresh(component))
+
+    def test_kept_trees_and_patch_lists_outlive_their_arena_reuse(self):
+        component = Rows(Properties())
+        component.state["count"] = 100
+        root = Root(component)
+        kept = [root.flush()]
+        trees = [root.tree]
+        for count in (50, 100, 20):
+            component.set_state({"count": count})
+            kept.append(root.flush())
+            trees.append(root.tree)
+        self.assertGreater(root.detached_arenas, 0)
+
+        # Every kept frame still reads as it was built
+        self.assertEqual([len(tree) for tree in trees], [201, 101, 201, 41])
+        model = Model()
+        for patches in kept:
+            model.apply(list(patches))
+        self.assertEqual(model.dump(), fresh(component))
+
+
+if __name__ == "__main__":
+    unittest.main()
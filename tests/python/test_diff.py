@@ -0,0 +1,76 @@
+import random
+import threading
+import unittest
+
+import support  # noqa: F401
+from component_engine import Component, Element, Properties, Root, diff, render
+from model import Model, fresh
+
+
+class Rows(Component):
+    memoize = False
+
+    def render(self):
+        keys = self.state.get("keys", [])
+        return Element("ul", {}, [Element("li", {"class": "row"}, ["row %d" % key], key=key) for key in keys])
+
+
+def rows(keys):
+    component = Rows(Properties())
+    component.state["keys"] = keys
+    return component
+
+
+class DiffTest(unittest.TestCase):
+    def test_diff_matches_model(self):
+        model = Model()
+        old = None
+        generator = random.Random(7)
+        for _ in range(20):
+            keys = generator.sample(range(50), generator.randrange(1, 30))
+            new = render(rows(keys))
+            model.apply(diff(old, new))
+            self.assertEqual(model.dump(), fresh(rows(keys)))
+            old = new
+
+    def test_tree_in_use_by_a_sliced_frame_cannot_be_diffed_into(self):
+        component = rows(list(range(2000)))
+        root = Root(component)
+        root.flush()
+        component.set_state({"keys": list(range(1999, -1, -1))})
+        self.assertIsNone(root.render_slice(1e-9))
+        self.assertTrue(root.rendering)
+
+        # The frame reads the mounted tree between its slices: reading it too is fine, writing it is not
+        with self.assertRaisesRegex(RuntimeError, "another thread"):
+            diff(render(rows([1])), root.tree)
+        self.assertEqual(len(root.tree), 4001)
+        diff(root.tree, render(rows([1])))
+
+        while root.render_slice() is None:
+            pass
+        diff(render(rows([1])), root.tree)
+
+    def test_concurrent_diffs_of_one_tree(self):
+        old = render(rows(list(range(20000))))
+        new = render(rows(list(range(19999, -1, -1))))
+        errors = []
+
+        def run():
+            try:
+                diff(old, new)
+            except RuntimeError as error:
+                errors.append(error)
+
+        threads = [threading.Thread(target=run) for _ in range(4)]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        # Diffs into the same tree either run one at a time or are refused, never race
+        for error in errors:
+            self.assertIn("another thread", str(error))
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,52 @@
+import traceback
+import unittest
+
+import support  # noqa: F401
+from component_engine import Component, Element, Properties, render, render_html
+
+
+class Failing(Component):
+    def render(self):
+        raise KeyError("boom")
+
+
+class Wrapper(Component):
+    def render(self):
+        return Element("div", {}, [Failing(Properties())])
+
+
+class Hello(Component):
+    def render(self):
+        return Element("p", {}, ["hello"])
+
+
+class ErrorsTest(unittest.TestCase):
+    def test_render_keeps_the_exception_raised_by_a_component(self):
+        try:
+            render(Wrapper(Properties()))
+        except KeyError as error:
+            self.assertEqual(error.args, ("boom",))
+            frames = [frame.name for frame in traceback.extract_tb(error.__traceback__)]
+            self.assertEqual(frames[-1], "render")
+        else:
+            self.fail("KeyError not raised")
+
+    def test_render_html_keeps_the_exception_raised_by_the_writer(self):
+        def write(chunk):
+            raise IOError("disk full")
+
+        with self.assertRaises(OSError) as context:
+            render_html(Hello(Properties()), write)
+        self.assertEqual(str(context.exception), "disk full")
+
+    def test_cpp_failures_keep_their_message(self):
+        class Bad(Component):
+            def render(self):
+                return object()
+
+        with self.assertRaisesRegex(RuntimeError, "Cannot render object of type 'object'"):
+            render(Bad(Properties()))
+
+
+if __name__ == "__main__":
+    unittest.main()
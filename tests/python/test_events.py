@@ -0,0 +1,97 @@
+import unittest
+
+import support  # noqa: F401
+from component_engine import Component, Element, Properties, Root
+from model import Model
+
+
+class Panel(Component):
+    memoize = False
+
+    def render(self):
+        log = self.state["log"]
+
+        def outer(event):
+            log.append(("outer", event.type, event.target, event.current_target))
+
+        def inner(event):
+            log.append(("inner", event.type, event.x, event.y, event.detail))
+            return self.state["stop"]
+
+        button = Element("button", {"on_click": inner, "on_pointermove": inner, "on_scroll": inner}, ["go"])
+        return Element("div", {"on_click": outer, "on_pointermove": outer}, [button])
+
+
+def mounted(stop=None):
+    component = Panel(Properties())
+    component.state["log"] = []
+    component.state["stop"] = stop
+    root = Root(component)
+    model = Model().apply(root.flush())
+    return component.state["log"], root, model.root, model.nodes[model.root]["children"][0]
+
+
+class EventsTest(unittest.TestCase):
+    def test_events_bubble_to_the_root(self):
+        log, root, outer, button = mounted()
+        self.assertTrue(root.post("click", button, 1.0, 2.0, 3))
+        self.assertEqual(root.dispatch(), 2)
+        self.assertEqual(log, [("inner", "click", 1.0, 2.0, 3), ("outer", "click", button, outer)])
+        self.assertEqual(root.dispatch(), 0)
+
+        # Events posted on the outer node never reach the inner handler
+        root.post("click", outer)
+        root.flush()
+        self.assertEqual(log[2:], [("outer", "click", outer, outer)])
+        self.assertEqual(root.dispatched_events, 2)
+
+    def test_handlers_returning_true_stop_bubbling(self):
+        log, root, outer, button = mounted(stop=True)
+        root.post("click", button)
+        self.assertEqual(root.dispatch(), 1)
+        self.assertEqual([entry[0] for entry in log], ["inner"])
+
+    def test_high_frequency_events_coalesce(self):
+        log, root, outer, button = mounted()
+        for x in range(5):
+            root.post("pointermove", button, float(x), 0.0)
+        root.post("scroll", button, 0.0, 10.0)
+        root.post("scroll", button, 0.0, 20.0)
+        root.post("pointermove", outer, 7.0, 0.0)
+        root.post("pointermove", outer, 8.0, 0.0)
+        root.dispatch()
+        self.assertEqual(
+            log,
+            [
+                ("inner", "pointermove", 4.0, 0.0, 0),
+                ("outer", "pointermove", button, outer),
+                ("inner", "scroll", 0.0, 20.0, 0),
+                ("outer", "pointermove", outer, outer),
+            ],
+        )
+        self.assertEqual(root.coalesced_events, 6)
+
+        # A discrete event ends the run, so moves on either side of it both arrive
+        del log[:]
+        root.post("pointermove", button, 1.0, 0.0)
+        root.post("click", button)
+        root.post("pointermove", button, 2.0, 0.0)
+        root.dispatch()
+        self.assertEqual([entry[1:3] for entry in log if entry[0] == "inner"], [("pointermove", 1.0), ("click", 0.0), ("pointermove", 2.0)])
+
+    def test_events_posted_to_a_full_queue_are_dropped(self):
+        log, root, outer, button = mounted()
+        posted = [root.post("click", button, float(index)) for index in range(5000)]
+        self.assertIn(False, posted)
+        accepted = posted.index(False)
+        self.assertTrue(all(posted[:accepted]) and not any(posted[accepted:]))
+        self.assertEqual(root.dropped_events, 5000 - accepted)
+
+        # Dispatching makes room again
+        root.dispatch()
+        self.assertEqual(len(log), 2 * accepted)
+        self.assertTrue(root.post("click", button))
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,61 @@
+import os
+import tempfile
+import unittest
+
+import support  # noqa: F401
+from component_engine import Component, Element, Properties, Root, load_snapshot, save_snapshot
+from model import Model
+
+
+class Column(Component):
+    memoize = False
+
+    def render(self):
+        heights = self.state["heights"]
+        rows = [Element("div", {"height": height}, key=index) for index, height in enumerate(heights)]
+        return Element("div", {"flex-direction": "column"}, rows)
+
+
+def column(heights):
+    component = Column(Properties())
+    component.state["heights"] = heights
+    return component
+
+
+class LayoutTest(unittest.TestCase):
+    def boxes(self, root, model):
+        return [root.box(child) for child in model.nodes[model.root]["children"]]
+
+    def test_boxes_follow_frames(self):
+        component = column([10, 20, 30])
+        root = Root(component)
+        model = Model().apply(root.flush())
+        root.compute_layout(100, 200)
+        self.assertEqual(root.box(model.root), (0.0, 0.0, 100.0, 200.0))
+        self.assertEqual(self.boxes(root, model), [(0.0, 0.0, 100.0, 10.0), (0.0, 10.0, 100.0, 20.0), (0.0, 30.0, 100.0, 30.0)])
+        self.assertIsNone(root.box(123456))
+
+        component.set_state({"heights": [10, 25, 30, 5]})
+        model.apply(root.flush())
+        layouts = root.layouts
+        root.compute_layout(100, 200)
+        self.assertEqual([box[1] for box in self.boxes(root, model)], [0.0, 10.0, 35.0, 65.0])
+        self.assertLessEqual(root.layouts - layouts, 5)
+
+    def test_layout_of_a_hydrated_tree(self):
+        source = Root(column([10, 20]))
+        model = Model().apply(source.flush())
+        with tempfile.TemporaryDirectory() as directory:
+            path = os.path.join(directory, "snapshot")
+            save_snapshot(source.tree, path)
+            tree = load_snapshot(path)
+
+        root = Root(column([10, 20]))
+        root.compute_layout(50, 50)
+        root.hydrate(tree)
+        root.compute_layout(50, 50)
+        self.assertEqual(self.boxes(root, model), [(0.0, 0.0, 50.0, 10.0), (0.0, 10.0, 50.0, 20.0)])
+
+
+if __name__ == "__main__":
+    unittest.main()
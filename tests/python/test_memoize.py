@@ -0,0 +1,118 @@
+import unittest
+
+import support  # noqa: F401
+from component_engine import Component, Element, Properties, Root
+from model import Model, fresh
+
+
+class Line(Component):
+    def __init__(self, text):
+        super().__init__(Properties())
+        self.text = text
+
+    def render(self):
+        return Element("p", {}, [self.text])
+
+
+class Label(Component):
+    pure = True
+
+    def render(self):
+        return Element("p", {}, [self.properties.get_property("text")])
+
+
+def label(text):
+    properties = Properties()
+    properties.set_property("text", text)
+    return Label(properties)
+
+
+class Page(Component):
+    memoize = False
+
+    def render(self):
+        offset = self.state.get("offset", 0)
+        return Element("div", {}, [self.state["make"](offset + index) for index in range(5)])
+
+
+clicks = []
+
+
+class Button(Component):
+    pure = True
+
+    def render(self):
+        text = self.properties.get_property("text")
+        return Element("button", {"on_click": lambda event: clicks.append(text)}, [text])
+
+
+def button(text):
+    properties = Properties()
+    properties.set_property("text", text)
+    return Button(properties)
+
+
+def page(make):
+    component = Page(Properties())
+    component.state["make"] = make
+    return component
+
+
+class MemoizeTest(unittest.TestCase):
+    def test_new_instances_render_unless_pure(self):
+        component = page(lambda index: Line("line %d" % index))
+        root = Root(component)
+        model = Model().apply(root.flush())
+        component.set_state({"offset": 100})
+        model.apply(root.flush())
+        self.assertEqual(model.dump(), fresh(component))
+        self.assertEqual(root.skipped_renders, 0)
+
+    def test_pure_instances_reuse_equal_predecessors(self):
+        component = page(lambda index: label("row %d" % (index % 2)))
+        root = Root(component)
+        model = Model().apply(root.flush())
+        renders = root.renders
+        component.set_state({"offset": 2})
+        model.apply(root.flush())
+        self.assertEqual(root.renders - renders, 1)
+        self.assertEqual(root.skipped_renders, 5)
+
+        # Different properties at the same position render again
+        component.set_state({"offset": 1})
+        model.apply(root.flush())
+        self.assertEqual(model.dump(), fresh(component))
+        self.assertEqual(root.skipped_renders, 5)
+
+    def test_same_instance_renders_when_its_properties_change(self):
+        child = label("first")
+        component = page(lambda index: child if index == 0 else label("other"))
+        root = Root(component)
+        model = Model().apply(root.flush())
+        child.properties.set_property("text", "second")
+        component.set_state({"offset": 0})
+        model.apply(root.flush())
+        self.assertEqual(model.dump(), fresh(component))
+
+    def test_skipped_outputs_keep_their_nodes_and_handlers(self):
+        component = page(lambda index: button("row %d" % (index % 2)))
+        root = Root(component)
+        model = Model().apply(root.flush())
+        items = model.nodes[model.root]["children"]
+        component.set_state({"offset": 2})
+        self.assertEqual(len(root.flush()), 0)
+        self.assertEqual(root.skipped_renders, 5)
+
+        # The handlers of the copied nodes still dispatch
+        del clicks[:]
+        root.post("click", items[1])
+        self.assertEqual(root.dispatch(), 1)
+        self.assertEqual(clicks, ["row 1"])
+
+        component.set_state({"offset": 1})
+        model.apply(root.flush())
+        self.assertEqual(model.dump(), fresh(component))
+
+
+if __name__ == "__main__":
+    unittest.main()
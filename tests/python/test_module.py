@@ -0,0 +1,68 @@
+import importlib.util
+import os
+import tempfile
+import textwrap
+import unittest
+
+import support
+import component_engine
+from component_engine import Element, Properties, Tree, _core, diff, render
+from model import Model
+
+try:
+    import _interpreters as interpreters
+except ImportError:
+    try:
+        import _xxsubinterpreters as interpreters
+    except ImportError:
+        interpreters = None
+
+
+class ModuleTest(unittest.TestCase):
+    def test_types_are_heap_types(self):
+        for type in (Properties, Tree, component_engine.Root, component_engine.PersistentMap):
+            self.assertTrue(type.__flags__ & (1 << 9), type)
+            with self.assertRaises(TypeError):
+                type.extra = 1
+
+    def test_module_objects_share_the_interpreter_types(self):
+        # Multi-phase init builds a new module object per load, single-phase init would return the cached one
+        spec = importlib.util.spec_from_file_location(_core.__name__, _core.__file__)
+        copy = importlib.util.module_from_spec(spec)
+        spec.loader.exec_module(copy)
+        self.assertIsNot(copy, _core)
+        self.assertIs(copy.Tree, Tree)
+        self.assertIs(copy.Properties, Properties)
+
+        tree = copy.render(Element("p", {"class": "copy"}, ["text"]))
+        self.assertEqual(Model().apply(diff(None, tree)).dump(), ("p", (("class", "copy"),), ("text",)))
+
+    @unittest.skipIf(interpreters is None, "no subinterpreter module")
+    def test_render_in_a_subinterpreter(self):
+        with tempfile.TemporaryDirectory() as directory:
+            path = os.path.join(directory, "result")
+            code = textwrap.dedent(
+                """
+                import sys
+                sys.path.insert(0, {tests!r})
+                import support
+                from component_engine import Element, diff, render
+                patches = diff(None, render(Element("p", {{}}, ["inside"])))
+                with open({path!r}, "w") as file:
+                    file.write(repr([patch[4:] for patch in patches]))
+                """
+            ).format(tests=os.path.dirname(os.path.abspath(support.__file__)), path=path)
+            interpreter = interpreters.create()
+            try:
+                interpreters.run_string(interpreter, code)
+            finally:
+                interpreters.destroy(interpreter)
+            with open(path) as file:
+                self.assertEqual(file.read(), repr([("p", None), (None, "inside")]))
+
+        # The main interpreter's types are unaffected by the subinterpreter's finalization
+        self.assertEqual(len(render(Element("p", {}, ["after"]))), 2)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,64 @@
+import unittest
+from collections.abc import MutableMapping
+
+import support  # noqa: F401
+from component_engine import Properties
+
+
+class PropertiesTest(unittest.TestCase):
+    def test_set_get_remove(self):
+        properties = Properties()
+        properties.set_property("a", 1)
+        properties.set_property("b", "text")
+        self.assertEqual(properties.get_property("a"), 1)
+        self.assertEqual(properties.get_property("b"), "text")
+        self.assertIsNone(properties.get_property("missing"))
+        properties.remove_property("a")
+        self.assertNotIn("a", properties)
+        self.assertEqual(len(properties), 1)
+
+    def test_equality_compares_values(self):
+        first = Properties()
+        second = Properties()
+        first.set_property("a", 1.5)
+        second.set_property("a", 1.5)
+        self.assertEqual(first, second)
+        second.set_property("a", True)
+        self.assertNotEqual(first, second)
+
+    def test_properties_view_writes_through(self):
+        properties = Properties()
+        properties.set_property("a", 1)
+        view = properties.properties
+        self.assertIsInstance(view, MutableMapping)
+
+        view["b"] = 2
+        self.assertEqual(properties.get_property("b"), 2)
+        del view["a"]
+        self.assertNotIn("a", properties)
+        with self.assertRaises(KeyError):
+            del view["a"]
+        with self.assertRaises(KeyError):
+            view["a"]
+
+        view.update({"c": "x"})
+        view.update([("d", None)])
+        self.assertEqual(view, {"b": 2, "c": "x", "d": None})
+        self.assertEqual(view.pop("c"), "x")
+        self.assertEqual(view.pop("c", 0), 0)
+        self.assertEqual(sorted(view), ["b", "d"])
+
+        properties.set_property("e", 3.0)
+        self.assertEqual(view.get("e"), 3.0)
+        view.clear()
+        self.assertEqual(len(properties), 0)
+
+    def test_properties_view_rejects_unsupported_values(self):
+        with self.assertRaises(TypeError):
+            Properties().properties["a"] = object()
+        with self.assertRaises(TypeError):
+            Properties().properties[1] = 2
+
+
+if __name__ == "__main__":
+    unittest.main()
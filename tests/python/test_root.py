@@ -0,0 +1,123 @@
+import gc
+import random
+import unittest
+import weakref
+
+import support  # noqa: F401
+from component_engine import Component, Element, Properties, Root
+from model import Model, fresh
+
+
+class Label(Component):
+    def render(self):
+        return Element("p", {}, ["hello"])
+
+
+class Item(Component):
+    def __init__(self, name):
+        super().__init__(Properties())
+        self.state["lines"] = 1
+        self.state["clicks"] = []
+        self.name = name
+
+    def render(self):
+        lines = self.state["lines"]
+        clicks = self.state["clicks"]
+        if lines == 0:
+            return None
+        children = [Element("span", {}, ["%s %d" % (self.name, line)]) for line in range(lines)]
+        return Element("li", {"on_click": lambda event: clicks.append(self.name)}, children)
+
+
+class Group(Component):
+    def __init__(self, name, size):
+        super().__init__(Properties())
+        self.state["title"] = name
+        self.items = [Item("%s.%d" % (name, index)) for index in range(size)]
+
+    def render(self):
+        return Element("section", {}, [Element("h2", {}, [self.state["title"]]), Element("ul", {}, self.items)])
+
+
+class Footer(Component):
+    memoize = False
+
+    def render(self):
+        return Element("footer", {}, ["end"])
+
+
+class Page(Component):
+    def __init__(self):
+        super().__init__(Properties())
+        self.groups = [Group("g%d" % index, 3) for index in range(3)]
+        self.footer = Footer(Properties())
+
+    def render(self):
+        return Element("main", {}, self.groups + [self.footer])
+
+
+def mounted_page():
+    page = Page()
+    root = Root(page)
+    model = Model().apply(root.flush())
+    return page, root, model
+
+
+class RootTest(unittest.TestCase):
+    def test_weak_references(self):
+        root = Root(Label(Properties()))
+        root.flush()
+        reference = weakref.ref(root)
+        self.assertIs(reference(), root)
+        self.assertEqual(len(reference().tree), 2)
+
+        del root
+        gc.collect()
+        self.assertIsNone(reference())
+
+    def test_frames_render_the_dirty_components_alone(self):
+        page, root, model = mounted_page()
+        renders = root.renders
+        # Even the unmemoized footer is not rendered again
+        page.groups[1].items[2].set_state({"lines": 3})
+        model.apply(root.flush())
+        self.assertEqual(root.renders - renders, 1)
+        self.assertEqual(model.dump(), fresh(page))
+
+        # A parent and its child scheduled together render once each
+        renders = root.renders
+        page.groups[0].set_state({"title": "first"})
+        page.groups[0].items[1].set_state({"lines": 2})
+        page.groups[2].items[0].set_state({"lines": 0})
+        model.apply(root.flush())
+        self.assertEqual(root.renders - renders, 3)
+        self.assertEqual(model.dump(), fresh(page))
+
+    def test_dirty_frames_keep_the_handlers_and_the_node_ranges(self):
+        page, root, model = mounted_page()
+        generator = random.Random(7)
+        items = [item for group in page.groups for item in group.items]
+        for frame in range(40):
+            # Outputs grow, shrink and vanish, moving the nodes of every later component
+            for item in generator.sample(items, 3):
+                item.set_state({"lines": generator.randrange(4)})
+            if frame % 5 == 0:
+                group = generator.choice(page.groups)
+                group.set_state({"title": "frame %d" % frame})
+            model.apply(root.flush())
+            self.assertEqual(model.dump(), fresh(page))
+
+        item = next(item for item in items if item.state["lines"])
+        model.apply(root.flush())
+        group = next(group for group in page.groups if item in group.items)
+        section = model.nodes[model.root]["children"][page.groups.index(group)]
+        items_list = model.nodes[section]["children"][1]
+        visible = [candidate for candidate in group.items if candidate.state["lines"]]
+        node = model.nodes[items_list]["children"][visible.index(item)]
+        root.post("click", node)
+        self.assertEqual(root.dispatch(), 1)
+        self.assertEqual(item.state["clicks"], [item.name])
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,204 @@
+import os
+import random
+import tempfile
+import unittest
+
+import support  # noqa: F401
+from component_engine import SET_PROPERTY, Component, Element, Properties, Root, diff, load_snapshot, save_snapshot
+from model import Model, fresh
+
+
+class Column(Component):
+    memoize = False
+
+    def render(self):
+        rows = [Element("div", {"height": height}, ["row %d" % index], key=index) for index, height in enumerate(self.state["heights"])]
+        return Element("div", {"flex-direction": "column"}, rows)
+
+
+def column(heights):
+    component = Column(Properties())
+    component.state["heights"] = heights
+    return component
+
+
+class Row(Component):
+    pure = True
+
+    def render(self):
+        index = self.properties.get_property("index")
+        return Element("div", {"height": self.properties.get_property("height")}, ["row %d" % index])
+
+
+def row(index, height):
+    properties = Properties()
+    properties.set_property("index", index)
+    properties.set_property("height", height)
+    return Row(properties)
+
+
+class OtherRow(Row):
+    pass
+
+
+clicks = []
+
+
+class Button(Component):
+    pure = True
+
+    def render(self):
+        text = self.properties.get_property("text")
+        return Element("button", {"on_click": lambda event: clicks.append(text)}, [text])
+
+
+def button(text):
+    properties = Properties()
+    properties.set_property("text", text)
+    return Button(properties)
+
+
+class Table(Component):
+    memoize = False
+
+    def render(self):
+        rows = [self.state["make_row"](index, height) for index, height in enumerate(self.state["heights"])]
+        return Element("div", {"flex-direction": "column"}, rows + [button(text) for text in self.state["buttons"]])
+
+
+def table(heights, buttons=(), make_row=row):
+    component = Table(Properties())
+    component.state["heights"] = heights
+    component.state["buttons"] = list(buttons)
+    component.state["make_row"] = make_row
+    return component
+
+
+class SnapshotTest(unittest.TestCase):
+    def setUp(self):
+        self.directory = tempfile.TemporaryDirectory()
+        self.path = os.path.join(self.directory.name, "snapshot")
+
+    def tearDown(self):
+        self.directory.cleanup()
+
+    def test_hydrated_first_frame_patches_only_changes(self):
+        source = Root(column(list(range(50))))
+        source.flush()
+        save_snapshot(source.tree, self.path)
+        tree = load_snapshot(self.path)
+        model = Model().apply(diff(None, tree))
+
+        heights = list(range(50))
+        heights[7] = 1000
+        component = column(heights)
+        root = Root(component)
+        root.hydrate(tree)
+        patches = list(root.flush())
+        self.assertEqual([patch[0] for patch in patches], [SET_PROPERTY])
+        model.apply(patches)
+        self.assertEqual(model.dump(), fresh(component))
+        # A bare tree records no component to skip
+        self.assertEqual(root.renders, 1)
+
+    def test_hydrated_first_frame_skips_saved_pure_components(self):
+        source = Root(table(list(range(50))))
+        source.flush()
+        source.save_snapshot(self.path)
+        tree = load_snapshot(self.path)
+        model = Model().apply(diff(None, tree))
+
+        heights = list(range(50))
+        heights[7] = 1000
+        component = table(heights)
+        root = Root(component)
+        root.hydrate(tree)
+        patches = list(root.flush())
+        self.assertEqual([patch[0] for patch in patches], [SET_PROPERTY])
+        model.apply(patches)
+        self.assertEqual(model.dump(), fresh(component))
+        # The table and the changed row render, the other rows copy their saved nodes
+        self.assertEqual((root.renders, root.skipped_renders), (2, 49))
+        self.assertEqual(root.mounted, 51)
+
+        # The skipped rows stay mounted, and new instances reuse their nodes in later frames
+        component.state["heights"][3] = 500
+        root.schedule(component)
+        patches = list(root.flush())
+        self.assertEqual([patch[0] for patch in patches], [SET_PROPERTY])
+        model.apply(patches)
+        self.assertEqual(model.dump(), fresh(component))
+        self.assertEqual((root.renders, root.skipped_renders), (4, 98))
+
+    def test_hydrated_components_render_unless_saved_as_skippable(self):
+        source = Root(table([1, 2], ["save", "open"]))
+        source.flush()
+        source.save_snapshot(self.path)
+
+        # Buttons render to declare their handlers again, which a snapshot does not hold
+        tree = load_snapshot(self.path)
+        model = Model().apply(diff(None, tree))
+        component = table([1, 2], ["save", "open"])
+        root = Root(component)
+        root.hydrate(tree)
+        self.assertEqual(len(root.flush()), 0)
+        self.assertEqual((root.renders, root.skipped_renders), (3, 2))
+        clicks.clear()
+        root.post("click", model.nodes[model.root]["children"][3])
+        self.assertEqual(root.dispatch(), 1)
+        self.assertEqual(clicks, ["open"])
+
+        # Properties changed since the snapshot make a component render, as does another class
+        component = table([1, 3])
+        root = Root(component)
+        root.hydrate(load_snapshot(self.path))
+        model = Model().apply(diff(None, load_snapshot(self.path)))
+        model.apply(root.flush())
+        self.assertEqual(model.dump(), fresh(component))
+        self.assertEqual((root.renders, root.skipped_renders), (2, 1))
+
+        component = table([1, 2], make_row=lambda index, height: OtherRow(row(index, height).properties))
+        root = Root(component)
+        root.hydrate(load_snapshot(self.path))
+        model = Model().apply(diff(None, load_snapshot(self.path)))
+        model.apply(root.flush())
+        self.assertEqual(model.dump(), fresh(component))
+        self.assertEqual((root.renders, root.skipped_renders), (3, 0))
+
+    def test_corrupted_snapshots_are_rejected(self):
+        source = Root(table(list(range(20)), ["go"]))
+        source.flush()
+        source.save_snapshot(self.path)
+        with open(self.path, "rb") as file:
+            data = file.read()
+
+        generator = random.Random(11)
+        corruptions = [data[:length] for length in (0, 4, len(data) // 2, len(data) - 1)]
+        for _ in range(300):
+            corrupted = bytearray(data)
+            for _ in range(generator.randrange(1, 4)):
+                corrupted[generator.randrange(len(corrupted))] = generator.randrange(256)
+            corruptions.append(bytes(corrupted))
+
+        for corrupted in corruptions:
+            with open(self.path, "wb") as file:
+                file.write(corrupted)
+            # Either rejected as invalid, or loaded into a tree that can be diffed and hydrated
+            try:
+                tree = load_snapshot(self.path)
+            except ValueError:
+                continue
+            Model().apply(diff(None, tree))
+            root = Root(table(list(range(20)), ["go"]))
+            root.hydrate(tree)
+            root.flush()
+
+        for length in (0, 4, len(data) // 2):
+            with open(self.path, "wb") as file:
+                file.write(data[:length])
+            with self.assertRaises(ValueError):
+                load_snapshot(self.path)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,71 @@
+import random
+import unittest
+
+import support  # noqa: F401
+from component_engine import Component, Element, Properties, Root, VirtualList
+from model import Model, fresh
+
+
+class Line(Component):
+    def __init__(self, text):
+        super().__init__(Properties())
+        self.text = text
+
+    def render(self):
+        return Element("p", {}, [self.text])
+
+
+class Label(Component):
+    pure = True
+
+    def render(self):
+        return Element("p", {}, [self.properties.get_property("text")])
+
+
+def label(text):
+    properties = Properties()
+    properties.set_property("text", text)
+    return Label(properties)
+
+
+class Lines(VirtualList):
+    def __init__(self, make_row):
+        super().__init__(Properties())
+        self.make_row = make_row
+
+    def row_count(self):
+        return 100000
+
+    def render_row(self, index):
+        return self.make_row("line %d" % index)
+
+
+def texts(dump):
+    # Row wrappers sit between the two spacers, each holding one <p> with its text
+    return [row[2][0][2][0] for row in dump[2][1:-1]]
+
+
+class VirtualListTest(unittest.TestCase):
+    def check_scrolling(self, make_row):
+        component = Lines(make_row)
+        root = Root(component)
+        model = Model().apply(root.flush())
+        generator = random.Random(3)
+        offsets = [20000.0, 20020.0, 20400.0, 0.0] + [generator.uniform(0, 2000000) for _ in range(10)]
+        for offset in offsets:
+            component.scroll_to(offset)
+            model.apply(root.flush())
+            dump = model.dump()
+            self.assertEqual(dump, fresh(component))
+            first = component.window()[0]
+            self.assertEqual(texts(dump)[0], "line %d" % first)
+
+    def test_scrolled_rows_match_a_fresh_render(self):
+        self.check_scrolling(Line)
+
+    def test_scrolled_pure_rows_match_a_fresh_render(self):
+        self.check_scrolling(label)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,70 @@
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "argument_parser.hpp"
+#include "test.hpp"
+
+namespace
+{
+    argument_parser::ArgumentParser numbers_parser()
+    {
+        argument_parser::ArgumentParser parser("numbers");
+        parser.add_argument(std::vector<std::string>{"--big"}, "store", "", "", "", "", "", false, {},
+                            argument_parser::ValueType::Integer);
+        parser.add_argument(std::vector<std::string>{"--ratio"}, "store", "", "", "", "", "", false, {},
+                            argument_parser::ValueType::Float);
+        parser.add_argument(std::vector<std::string>{"--nums"}, "store", "*", "", "", "", "", false, {},
+                            argument_parser::ValueType::Integer);
+        parser.add_argument(std::vector<std::string>{"--name"});
+        return parser;
+    }
+} // namespace
+
+TEST(argument_parser_refuses_narrowing)
+{
+    argument_parser::ArgumentParser parser = numbers_parser();
+    argument_parser::Namespace arguments = parser.parse_args({"--big", "99999999999", "--ratio", "1e300"});
+    CHECK_EQUAL(arguments.get<std::int64_t>("big"), 99999999999);
+    CHECK_THROWS(arguments.get<int>("big"), argument_parser::ArgumentTypeError);
+    CHECK_THROWS(arguments.get<float>("ratio"), argument_parser::ArgumentTypeError);
+    CHECK_EQUAL(arguments.get<double>("ratio"), 1e300);
+
+    arguments = parser.parse_args({"--big", "-1"});
+    CHECK_EQUAL(arguments.get<int>("big"), -1);
+    CHECK_THROWS(arguments.get<unsigned>("big"), argument_parser::ArgumentTypeError);
+    CHECK_THROWS(arguments.get<std::uint64_t>("big"), argument_parser::ArgumentTypeError);
+}
+
+TEST(argument_parser_negative_numbers_are_values)
+{
+    argument_parser::ArgumentParser parser = numbers_parser();
+    argument_parser::Namespace arguments = parser.parse_args({"--nums", "-2", "3", "-4", "--ratio", "-.5", "--name", "-1.5"});
+    CHECK(arguments.get<argument_parser::Namespace::Integers>("nums") == (std::vector<std::int64_t>{-2, 3, -4}));
+    CHECK_EQUAL(arguments.get<double>("ratio"), -0.5);
+    CHECK_EQUAL(arguments.get<std::string>("name"), "-1.5");
+
+    // Anything else starting with '-' is still an option
+    CHECK_THROWS(parser.parse_args({"--nums", "-x"}), argument_parser::ArgumentError);
+    CHECK_THROWS(parser.parse_args({"--nums", "-2-"}), argument_parser::ArgumentError);
+}
+
+TEST(argument_parser_options_spelled_as_numbers_win)
+{
+    argument_parser::ArgumentParser parser("numbers");
+    parser.add_argument(std::vector<std::string>{"-1", "--one"}, "store_true");
+    parser.add_argument(std::vector<std::string>{"--nums"}, "store", "*", "", "", "", "", false, {},
+                        argument_parser::ValueType::Integer);
+    argument_parser::Namespace arguments = parser.parse_args({"--nums", "-2", "-1"});
+    CHECK(arguments.get<argument_parser::Namespace::Integers>("nums") == (std::vector<std::int64_t>{-2}));
+    CHECK(arguments.get<bool>("one"));
+}
+
+TEST(schema_negative_numbers_are_values)
+{
+    static constexpr auto schema = argument_parser::make_schema(
+        argument_parser::option("-o", "--offset", "offset", "OFFSET"));
+    const char *const argv[] = {"program", "--offset", "-12"};
+    auto arguments = argument_parser::parse(schema, 3, argv);
+    CHECK_EQUAL(arguments.get<int>("offset"), -12);
+}
@@ -0,0 +1,141 @@
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "backend/library.hpp"
+#include "backend/memory_backend.hpp"
+#include "backend/renderer.hpp"
+#include "model.hpp"
+#include "test.hpp"
+#include "vdom/reconciler.hpp"
+
+namespace
+{
+    struct Recording
+    {
+        int (*apply)(ce_backend *backend, const ce_frame *frame) = nullptr;
+        std::vector<ce_frame> frames;
+    };
+
+    Recording recording;
+
+    int record_frame(ce_backend *backend, const ce_frame *frame)
+    {
+        recording.frames.push_back(*frame);
+        return recording.apply(backend, frame);
+    }
+
+    /**
+     * @brief Fill a tree with a <ul> of keyed items, each with a class and a text, under a tag new to the atom table
+     *
+     */
+    void build_frame(vdom::Tree &tree, const std::vector<std::int64_t> &keys, int frame)
+    {
+        vdom::AtomTable &atoms = vdom::AtomTable::global();
+        tree.clear();
+        tree.set_generation(static_cast<std::uint32_t>(frame + 1));
+        vdom::NodeId list = tree.create_element(atoms.intern("ul"));
+        tree.set_root(list);
+        const vdom::Atom tag = atoms.intern("backend-frame-" + std::to_string(frame));
+        const vdom::Atom type = atoms.intern("class");
+        for (std::int64_t key : keys)
+        {
+            const vdom::Property properties[] = {{type, vdom::Value::string(key % 2 ? "odd" : "even")}};
+            vdom::NodeId item = tree.create_element(key % 3 ? atoms.intern("li") : tag, vdom::Value::integer(key), properties);
+            tree.append_child(list, item);
+            tree.append_child(item, tree.create_text("row " + std::to_string(key)));
+        }
+    }
+} // namespace
+
+TEST(backend_library_renders_frames_like_the_model)
+{
+    backend::Library library(MEMORY_BACKEND_PATH);
+    ce_backend_api api = library.api();
+    recording = {api.apply, {}};
+    api.apply = record_frame;
+    std::vector<std::int64_t> keys(40);
+    for (std::size_t index = 0; index < keys.size(); ++index)
+        keys[index] = static_cast<std::int64_t>(index);
+
+    {
+        backend::Renderer renderer(api);
+        const backend::MemoryBackend &document = backend::MemoryBackend::of(renderer.instance());
+        std::mt19937 random(3);
+        vdom::Reconciler reconciler;
+        test::Model model;
+        vdom::Tree old;
+        for (int frame = 0; frame < 20; ++frame)
+        {
+            // Mount, then shuffle, drop and add items
+            vdom::Tree next;
+            if (frame > 0)
+            {
+                std::shuffle(keys.begin(), keys.end(), random);
+                keys.resize(keys.size() - random() % 5);
+                for (unsigned added = random() % 5; added > 0; --added)
+                    keys.push_back(100 * frame + added);
+            }
+            build_frame(next, keys, frame);
+            vdom::PatchList patches;
+            reconciler.diff(old, next, patches);
+            model.apply(patches);
+            renderer.apply(patches);
+            CHECK_EQUAL(model.compare(next), "");
+            CHECK_EQUAL(document.html(), model.html());
+            CHECK_EQUAL(document.size(), model.size());
+            CHECK_EQUAL(document.root(), model.root());
+            old = std::move(next);
+        }
+        CHECK_EQUAL(renderer.frames(), 20u);
+    }
+
+    // Only the atoms interned since the previous frame are new, the table is never replaced
+    CHECK_EQUAL(recording.frames.size(), 20u);
+    CHECK_EQUAL(recording.frames[0].first_new_atom, 0u);
+    for (std::size_t frame = 1; frame < recording.frames.size(); ++frame)
+    {
+        CHECK_EQUAL(recording.frames[frame].sequence, frame);
+        CHECK_EQUAL(recording.frames[frame].first_new_atom, recording.frames[frame - 1].atom_count);
+        CHECK(recording.frames[frame].first_new_atom >= recording.frames[frame - 1].first_new_atom);
+        CHECK(recording.frames[frame].atom_count > recording.frames[frame].first_new_atom);
+    }
+}
+
+TEST(backend_renderer_loads_a_library)
+{
+    backend::Renderer renderer(std::filesystem::path(MEMORY_BACKEND_PATH));
+    vdom::Tree tree;
+    build_frame(tree, {1, 2}, 0);
+    vdom::PatchList patches;
+    vdom::Reconciler().diff(vdom::Tree(), tree, patches);
+    renderer.apply(patches);
+    CHECK_EQUAL(backend::MemoryBackend::of(renderer.instance()).html(),
+                "<ul><li class=\"odd\">row 1</li><li class=\"even\">row 2</li></ul>");
+    CHECK_THROWS(backend::Library("no-such-backend.so"), std::runtime_error);
+}
+
+TEST(backend_renderer_refuses_foreign_tables)
+{
+    const ce_backend_api &api = backend::memory_backend_api();
+
+    ce_backend_api newer = api;
+    newer.abi_version = CE_BACKEND_ABI_VERSION + 1;
+    CHECK_THROWS(backend::Renderer{newer}, std::runtime_error);
+
+    // A table built before the last function was appended, and one missing a function
+    ce_backend_api shorter = api;
+    shorter.size = static_cast<std::uint32_t>(offsetof(ce_backend_api, error));
+    CHECK_THROWS(backend::Renderer{shorter}, std::runtime_error);
+
+    ce_backend_api incomplete = api;
+    incomplete.apply = nullptr;
+    CHECK_THROWS(backend::Renderer{incomplete}, std::runtime_error);
+
+    backend::Renderer renderer(api);
+    CHECK_EQUAL(renderer.frames(), 0u);
+}
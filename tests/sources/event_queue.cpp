@@ -0,0 +1,67 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "engine/event_queue.hpp"
+#include "test.hpp"
+
+namespace
+{
+    constexpr vdom::Atom click = 1;
+    constexpr vdom::Atom move = 2;
+    constexpr std::size_t producers = 4;
+    constexpr std::int64_t per_producer = 20000;
+} // namespace
+
+TEST(event_queue_drains_each_producer_in_order)
+{
+    // A small queue keeps producers racing each other and the consumer for slots
+    engine::EventQueue queue(64);
+    queue.coalesce(move);
+    std::atomic<std::size_t> done(0);
+    std::vector<std::thread> threads;
+    for (std::size_t producer = 0; producer < producers; ++producer)
+    {
+        threads.emplace_back(
+            [&queue, &done, producer]
+            {
+                // Producer 0 only moves, so that its runs coalesce; the others interleave clicks
+                for (std::int64_t index = 0; index < per_producer; ++index)
+                {
+                    const vdom::Atom type = producer == 0 || index % 3 ? move : click;
+                    while (!queue.push({type, producer + 1, 0.0, 0.0, index}))
+                        std::this_thread::yield();
+                }
+                done.fetch_add(1, std::memory_order_release);
+            });
+    }
+
+    std::vector<std::int64_t> last(producers + 1, -1);
+    std::vector<std::int64_t> clicks(producers + 1, 0);
+    std::vector<engine::Event> events;
+    std::uint64_t delivered = 0;
+    bool ordered = true;
+    for (bool finished = false; !finished;)
+    {
+        finished = done.load(std::memory_order_acquire) == producers;
+        queue.drain(events);
+        delivered += events.size();
+        for (const engine::Event &event : events)
+        {
+            ordered = ordered && event.detail > last[event.target];
+            last[event.target] = event.detail;
+            clicks[event.target] += event.type == click;
+        }
+    }
+    for (std::thread &thread : threads)
+        thread.join();
+
+    CHECK(ordered);
+    for (std::size_t producer = 1; producer <= producers; ++producer)
+    {
+        // The last event of a run is kept, so every producer's final event arrives
+        CHECK_EQUAL(last[producer], per_producer - 1);
+        CHECK_EQUAL(clicks[producer], producer == 1 ? 0 : (per_producer + 2) / 3);
+    }
+    CHECK_EQUAL(delivered + queue.statistics().coalesced, producers * per_producer);
+}
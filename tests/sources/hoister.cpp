@@ -0,0 +1,64 @@
+#include <string>
+#include <vector>
+
+#include "model.hpp"
+#include "test.hpp"
+#include "vdom/hoister.hpp"
+#include "vdom/reconciler.hpp"
+
+namespace
+{
+    vdom::Atom atom(const char *name)
+    {
+        return vdom::AtomTable::global().intern(name);
+    }
+
+    /**
+     * @brief Fill a tree with a <div> holding a large constant <ul> and a <p> with a changing text
+     *
+     */
+    void build_page(vdom::Tree &tree, int frame, const std::string &item_suffix)
+    {
+        tree.clear();
+        vdom::NodeId page = tree.create_element(atom("div"));
+        tree.set_root(page);
+        vdom::NodeId list = tree.create_element(atom("ul"));
+        tree.append_child(page, list);
+        for (int index = 0; index < 20; ++index)
+        {
+            vdom::NodeId item = tree.create_element(atom("li"), vdom::Value::integer(index));
+            tree.append_child(list, item);
+            tree.append_child(item, tree.create_text("item " + std::to_string(index) + item_suffix));
+        }
+        vdom::NodeId status = tree.create_element(atom("p"));
+        tree.append_child(page, status);
+        tree.append_child(status, tree.create_text("frame " + std::to_string(frame)));
+    }
+} // namespace
+
+TEST(hoister_skips_unchanged_subtrees_and_keeps_patches_right)
+{
+    vdom::Hoister hoister;
+    vdom::Reconciler reconciler;
+    vdom::PatchList patches;
+    test::Model model;
+    vdom::Tree old;
+
+    for (int frame = 0; frame < 12; ++frame)
+    {
+        // The list changes once, after it was hoisted, then stays the same again
+        vdom::Tree next;
+        build_page(next, frame, frame < 6 ? "" : " changed");
+        hoister.hoist(next);
+        patches.clear();
+        reconciler.diff(old, next, patches);
+        model.apply(patches);
+        CHECK_EQUAL(model.compare(next), "");
+        if (frame == 4 || frame == 11)
+            CHECK(hoister.statistics().hoisted_nodes >= 41u);
+        if (frame > 0 && frame != 6)
+            CHECK_EQUAL(patches.size(), 1u);
+        old = std::move(next);
+    }
+    CHECK(hoister.statistics().frozen_blocks >= 2u);
+}
@@ -0,0 +1,47 @@
+#include <cstdlib>
+#include <iostream>
+
+#include "argument_parser.hpp"
+#include "test.hpp"
+
+int main(int argc, const char *const argv[])
+{
+    argument_parser::ArgumentParser argument_parser(argc, argv, "Check the behavior of the component-engine core");
+    argument_parser.add_argument(std::vector<std::string>{"-f", "--filter"}, "store", "", "", "", "only run tests whose name contains FILTER", "FILTER");
+
+    argument_parser::Namespace arguments;
+    try
+    {
+        arguments = argument_parser.parse_args();
+    }
+    catch (const std::exception &exception)
+    {
+        std::cerr << "Error: " << exception.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::string filter = arguments.has("filter") ? arguments.get<std::string>("filter") : "";
+    std::size_t run = 0;
+    std::size_t failed = 0;
+
+    for (const auto &test : test::registry())
+    {
+        if (test.name.find(filter) == std::string::npos)
+            continue;
+
+        run++;
+        try
+        {
+            test.function();
+            std::cout << "pass  " << test.name << std::endl;
+        }
+        catch (const std::exception &exception)
+        {
+            failed++;
+            std::cout << "FAIL  " << test.name << ": " << exception.what() << std::endl;
+        }
+    }
+
+    std::cout << run - failed << " of " << run << " tests passed" << std::endl;
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,118 @@
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "model.hpp"
+#include "stream/patch_stream.hpp"
+#include "test.hpp"
+#include "vdom/reconciler.hpp"
+
+namespace
+{
+    vdom::Atom atom(const char *name)
+    {
+        return vdom::AtomTable::global().intern(name);
+    }
+
+    /**
+     * @brief Memory for a stream, aligned as the writer requires
+     *
+     */
+    struct Memory
+    {
+        struct alignas(64) Line
+        {
+            std::byte bytes[64];
+        };
+
+        std::vector<Line> lines;
+
+        explicit Memory(std::size_t capacity) : lines(stream::PatchWriter::memory_size(capacity) / sizeof(Line) + 1) {}
+
+        std::span<std::byte> bytes() { return {lines.front().bytes, lines.size() * sizeof(Line)}; }
+    };
+
+    struct ModelSink
+    {
+        test::Model &model;
+        std::vector<std::uint32_t> generations;
+
+        void apply(const vdom::PatchList &patches) { model.apply(patches); }
+        void commit(std::uint32_t generation) { generations.push_back(generation); }
+    };
+
+    void build_random_list(vdom::Tree &tree, std::mt19937 &random)
+    {
+        tree.clear();
+        vdom::NodeId list = tree.create_element(atom("ul"), {}, std::vector<vdom::Property>{{atom("class"), vdom::Value::string("list")}});
+        tree.set_root(list);
+        std::vector<bool> used(60);
+        for (unsigned index = 0, count = random() % 40; index < count; ++index)
+        {
+            const std::int64_t key = random() % 60;
+            if (used[key])
+                continue;
+            used[key] = true;
+            const vdom::Property properties[] = {{atom("weight"), vdom::Value::floating(key / 3.0)}};
+            vdom::NodeId item = tree.create_element(atom("li"), vdom::Value::integer(key), properties);
+            tree.append_child(list, item);
+            tree.append_child(item, tree.create_text(std::string(random() % 20, 'x') + std::to_string(random() % 3)));
+        }
+    }
+} // namespace
+
+TEST(patch_stream_frames_decode_to_the_written_patches)
+{
+    // Frames fit in the ring, which a single thread cannot wait on, and wrap it many times
+    Memory memory(65536);
+    stream::PatchWriter writer(memory.bytes());
+    stream::PatchReader reader(memory.bytes());
+    test::Model model;
+    ModelSink sink{model, {}};
+    std::mt19937 random(9);
+    vdom::Reconciler reconciler;
+    vdom::Tree old;
+
+    for (std::uint32_t frame = 1; frame <= 300; ++frame)
+    {
+        vdom::Tree next;
+        build_random_list(next, random);
+        vdom::PatchList patches;
+        reconciler.diff(old, next, patches);
+        writer.write(patches, frame);
+        CHECK_EQUAL(reader.read(sink), patches.size());
+        CHECK(writer.drained());
+        CHECK_EQUAL(sink.generations.back(), frame);
+        CHECK_EQUAL(model.compare(next), "");
+        old = std::move(next);
+    }
+    CHECK_EQUAL(sink.generations.size(), 300u);
+
+    writer.close();
+    CHECK(reader.finished());
+}
+
+TEST(patch_stream_rejects_foreign_memory_and_malformed_records)
+{
+    Memory memory(4096);
+    CHECK_THROWS(stream::PatchReader(memory.bytes()), std::runtime_error);
+
+    stream::PatchWriter writer(memory.bytes());
+    stream::PatchReader reader(memory.bytes());
+    vdom::Tree tree;
+    tree.set_root(tree.create_element(atom("div")));
+    vdom::PatchList patches;
+    vdom::Reconciler().diff(vdom::Tree(), tree, patches);
+    writer.write(patches, 1);
+
+    // The first record names the atom "div"; a size that is not a multiple of 8 cannot be a record
+    std::uint32_t size = 0;
+    std::byte *record = memory.bytes().data() + sizeof(stream::format::RingHeader);
+    std::memcpy(&size, record, sizeof(size));
+    size += 3;
+    std::memcpy(record, &size, sizeof(size));
+    test::Model model;
+    ModelSink sink{model, {}};
+    CHECK_THROWS(reader.read(sink), std::runtime_error);
+}
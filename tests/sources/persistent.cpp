@@ -0,0 +1,102 @@
+#include <map>
+#include <random>
+#include <vector>
+
+#include "test.hpp"
+#include "vdom/persistent.hpp"
+
+namespace
+{
+    bool matches(const vdom::PersistentMap &map, const std::map<std::int64_t, std::int64_t> &expected)
+    {
+        if (map.size() != expected.size())
+            return false;
+        for (const auto &[key, value] : expected)
+        {
+            const vdom::Value *found = map.find(vdom::Value::integer(key));
+            if (!found || !(*found == vdom::Value::integer(value)))
+                return false;
+        }
+        return true;
+    }
+
+    bool matches(const vdom::PersistentVector &vector, const std::vector<std::int64_t> &expected)
+    {
+        if (vector.size() != expected.size())
+            return false;
+        for (std::size_t index = 0; index < expected.size(); ++index)
+        {
+            if (!(vector[index] == vdom::Value::integer(expected[index])))
+                return false;
+        }
+        return true;
+    }
+} // namespace
+
+TEST(persistent_map_versions_match_std_map)
+{
+    // Colliding hash prefixes come from many keys in a small range, old versions must not change
+    std::mt19937 random(5);
+    std::vector<vdom::Ref<const vdom::PersistentMap>> versions{vdom::PersistentMap::empty()};
+    std::vector<std::map<std::int64_t, std::int64_t>> expected{{}};
+    for (int step = 0; step < 3000; ++step)
+    {
+        const std::size_t from = random() % versions.size();
+        const std::int64_t key = random() % 500;
+        std::map<std::int64_t, std::int64_t> next = expected[from];
+        vdom::Ref<const vdom::PersistentMap> version;
+        if (random() % 4 == 0)
+        {
+            next.erase(key);
+            version = versions[from]->erase(vdom::Value::integer(key));
+        }
+        else
+        {
+            const std::int64_t value = random() % 7;
+            next[key] = value;
+            version = versions[from]->set(vdom::Value::integer(key), vdom::Value::integer(value));
+        }
+        CHECK(matches(*version, next));
+        CHECK_EQUAL(version->equals(*versions[from]), next == expected[from]);
+        versions.push_back(std::move(version));
+        expected.push_back(std::move(next));
+    }
+    for (std::size_t index = 0; index < versions.size(); ++index)
+        CHECK(matches(*versions[index], expected[index]));
+}
+
+TEST(persistent_vector_versions_match_std_vector)
+{
+    // Sizes cross the tail and several tree levels, 32 and 1024 elements
+    std::mt19937 random(6);
+    std::vector<vdom::Ref<const vdom::PersistentVector>> versions{vdom::PersistentVector::empty()};
+    std::vector<std::vector<std::int64_t>> expected{{}};
+    for (int step = 0; step < 4000; ++step)
+    {
+        const std::size_t from = step % 10 == 0 ? random() % versions.size() : versions.size() - 1;
+        std::vector<std::int64_t> next = expected[from];
+        vdom::Ref<const vdom::PersistentVector> version;
+        const unsigned operation = random() % 8;
+        if (operation == 0 && !next.empty())
+        {
+            next.pop_back();
+            version = versions[from]->pop_back();
+        }
+        else if (operation == 1 && !next.empty())
+        {
+            const std::size_t index = random() % next.size();
+            next[index] = step;
+            version = versions[from]->set(index, vdom::Value::integer(step));
+        }
+        else
+        {
+            next.push_back(step);
+            version = versions[from]->push_back(vdom::Value::integer(step));
+        }
+        CHECK(matches(*version, next));
+        versions.push_back(std::move(version));
+        expected.push_back(std::move(next));
+    }
+    for (std::size_t index = 0; index < versions.size(); ++index)
+        CHECK(matches(*versions[index], expected[index]));
+}
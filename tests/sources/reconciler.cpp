@@ -0,0 +1,476 @@
+#include <algorithm>
+#include <filesystem>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "engine/parallel_reconciler.hpp"
+#include "engine/thread_pool.hpp"
+#include "model.hpp"
+#include "snapshot/snapshot.hpp"
+#include "test.hpp"
+#include "vdom/reconciler.hpp"
+
+namespace
+{
+    vdom::Atom atom(const char *name)
+    {
+        return vdom::AtomTable::global().intern(name);
+    }
+
+    /**
+     * @brief Fill a tree with <ul> holding one keyed <li> per key, each with a text child
+     *
+     */
+    void build_list(vdom::Tree &tree, const std::vector<std::int64_t> &keys, const std::string &suffix = "")
+    {
+        tree.clear();
+        vdom::NodeId list = tree.create_element(atom("ul"));
+        tree.set_root(list);
+        for (std::int64_t key : keys)
+        {
+            vdom::NodeId item = tree.create_element(atom("li"), vdom::Value::integer(key));
+            tree.append_child(list, item);
+            tree.append_child(item, tree.create_text("row " + std::to_string(key) + suffix));
+        }
+    }
+
+    std::size_t count(const vdom::PatchList &patches, vdom::PatchType type)
+    {
+        return std::count_if(patches.begin(), patches.end(), [&](const vdom::Patch &patch)
+                             { return patch.type == type; });
+    }
+
+    /**
+     * @brief Append random children to a node: keyed and unkeyed elements, texts, colliding keys and tags
+     *
+     */
+    void build_random(vdom::Tree &tree, vdom::NodeId parent, std::mt19937 &random, int depth)
+    {
+        static const char *const names[] = {"a", "b", "c"};
+        const int children = static_cast<int>(random() % 6);
+        for (int index = 0; index < children; ++index)
+        {
+            const unsigned kind = random() % 10;
+            if (kind < 2)
+            {
+                tree.append_child(parent, tree.create_text(std::to_string(random() % 3)));
+                continue;
+            }
+
+            std::vector<vdom::Property> properties;
+            for (unsigned property = random() % 3; property > 0; --property)
+                properties.push_back({atom(names[random() % 3]), random() % 2 ? vdom::Value::integer(random() % 3) : vdom::Value::string(names[random() % 3])});
+            vdom::Value key = kind < 7 ? vdom::Value::integer(random() % 8) : vdom::Value();
+            vdom::NodeId child = tree.create_element(atom(random() % 4 ? "div" : "span"), key, properties);
+            tree.append_child(parent, child);
+            if (depth < 3)
+                build_random(tree, child, random, depth + 1);
+        }
+    }
+
+    /**
+     * @brief Append the random children of a seed, replacing the subtrees whose seed a change selects
+     *
+     * Equal seeds and changes give equal trees; successive changes of one seed keep most subtrees, so
+     * that the reconciler matches them.
+     */
+    void build_seeded(vdom::Tree &tree, vdom::NodeId parent, std::uint32_t seed, std::uint32_t change, int depth)
+    {
+        static const char *const names[] = {"a", "b", "c"};
+        std::mt19937 random(seed);
+        const int children = static_cast<int>(random() % (depth == 0 ? 12 : 6));
+        for (int index = 0; index < children; ++index)
+        {
+            std::uint32_t child_seed = static_cast<std::uint32_t>(random());
+            if (change && (child_seed ^ change) % 6 == 0)
+                child_seed ^= change;
+
+            std::mt19937 child_random(child_seed);
+            const unsigned kind = child_random() % 10;
+            if (kind < 2)
+            {
+                tree.append_child(parent, tree.create_text(std::to_string(child_random() % 3)));
+                continue;
+            }
+
+            std::vector<vdom::Property> properties;
+            for (unsigned property = child_random() % 3; property > 0; --property)
+                properties.push_back({atom(names[child_random() % 3]), child_random() % 2 ? vdom::Value::integer(child_random() % 3) : vdom::Value::string(names[child_random() % 3])});
+            vdom::Value key = kind < 7 ? vdom::Value::integer(child_random() % 8) : vdom::Value();
+            vdom::NodeId child = tree.create_element(atom(child_random() % 4 ? "div" : "span"), key, properties);
+            tree.append_child(parent, child);
+            if (depth < 3)
+                build_seeded(tree, child, static_cast<std::uint32_t>(child_random()), change, depth + 1);
+        }
+    }
+
+    void build_seeded(vdom::Tree &tree, std::uint32_t seed, std::uint32_t change, std::uint32_t generation)
+    {
+        tree.clear();
+        tree.set_generation(generation);
+        tree.set_root(tree.create_element(atom(change % 20 == 19 ? "other" : "root")));
+        build_seeded(tree, tree.root(), seed, change, 0);
+    }
+
+    std::string compare_patches(const vdom::PatchList &expected, const vdom::PatchList &actual)
+    {
+        if (expected.size() != actual.size())
+            return "expected " + std::to_string(expected.size()) + " patches, got " + std::to_string(actual.size());
+        for (std::size_t index = 0; index < expected.size(); ++index)
+        {
+            const vdom::Patch &left = expected[index];
+            const vdom::Patch &right = actual[index];
+            if (left.type != right.type || left.kind != right.kind || left.name != right.name || left.node != right.node ||
+                left.parent != right.parent || left.before != right.before || !(left.value == right.value))
+                return "patch " + std::to_string(index) + " differs";
+        }
+        return "";
+    }
+
+    std::string compare_handles(const vdom::Tree &expected, const vdom::Tree &actual)
+    {
+        if (expected.size() != actual.size())
+            return "trees differ in size";
+        for (vdom::NodeId node = 0; node < expected.size(); ++node)
+        {
+            if (expected.handle(node) != actual.handle(node))
+                return "handle of node " + std::to_string(node) + " differs";
+        }
+        return "";
+    }
+} // namespace
+
+TEST(reconciler_mount_creates_every_node)
+{
+    vdom::Tree empty;
+    vdom::Tree tree;
+    vdom::Reconciler reconciler;
+    vdom::PatchList patches;
+    build_list(tree, {1, 2, 3});
+
+    reconciler.diff(empty, tree, patches);
+    CHECK_EQUAL(count(patches, vdom::PatchType::Create), tree.size());
+    CHECK_EQUAL(patches.size(), tree.size());
+
+    test::Model model;
+    model.apply(patches);
+    CHECK_EQUAL(model.compare(tree), "");
+}
+
+TEST(reconciler_equal_trees_emit_nothing)
+{
+    vdom::Tree empty;
+    vdom::Tree old;
+    vdom::Tree next;
+    vdom::Reconciler reconciler;
+    vdom::PatchList patches;
+    build_list(old, {1, 2, 3});
+    build_list(next, {1, 2, 3});
+    reconciler.diff(empty, old, patches);
+
+    patches.clear();
+    reconciler.diff(old, next, patches);
+    CHECK(patches.empty());
+    for (vdom::NodeId node = 0; node < next.size(); ++node)
+        CHECK_EQUAL(next.handle(node), old.handle(node));
+}
+
+TEST(reconciler_reverse_moves_all_but_one)
+{
+    vdom::Tree empty;
+    vdom::Tree old;
+    vdom::Tree next;
+    vdom::Reconciler reconciler;
+    vdom::PatchList patches;
+    build_list(old, {1, 2, 3, 4, 5});
+    build_list(next, {5, 4, 3, 2, 1});
+    reconciler.diff(empty, old, patches);
+    test::Model model;
+    model.apply(patches);
+
+    patches.clear();
+    reconciler.diff(old, next, patches);
+    CHECK_EQUAL(patches.size(), 4u);
+    CHECK_EQUAL(count(patches, vdom::PatchType::Move), 4u);
+    model.apply(patches);
+    CHECK_EQUAL(model.compare(next), "");
+}
+
+TEST(reconciler_keyed_insert_and_remove)
+{
+    vdom::Tree empty;
+    vdom::Tree old;
+    vdom::Tree next;
+    vdom::Reconciler reconciler;
+    vdom::PatchList patches;
+    build_list(old, {1, 2, 3, 4});
+    build_list(next, {1, 5, 3, 4});
+    reconciler.diff(empty, old, patches);
+    test::Model model;
+    model.apply(patches);
+
+    patches.clear();
+    reconciler.diff(old, next, patches);
+    CHECK_EQUAL(count(patches, vdom::PatchType::Remove), 1u);
+    CHECK_EQUAL(count(patches, vdom::PatchType::Create), 2u);
+    CHECK_EQUAL(count(patches, vdom::PatchType::Move), 0u);
+    model.apply(patches);
+    CHECK_EQUAL(model.compare(next), "");
+}
+
+TEST(reconciler_texts_and_properties)
+{
+    vdom::Tree empty;
+    vdom::Tree old;
+    vdom::Tree next;
+    vdom::Reconciler reconciler;
+    vdom::PatchList patches;
+
+    const vdom::Property old_properties[] = {{atom("a"), vdom::Value::integer(1)}, {atom("b"), vdom::Value::string("x")}};
+    const vdom::Property new_properties[] = {{atom("b"), vdom::Value::string("y")}, {atom("c"), vdom::Value::boolean(true)}};
+    old.set_root(old.create_element(atom("div"), {}, old_properties));
+    old.append_child(old.root(), old.create_text("before"));
+    next.set_root(next.create_element(atom("div"), {}, new_properties));
+    next.append_child(next.root(), next.create_text("after"));
+    reconciler.diff(empty, old, patches);
+    test::Model model;
+    model.apply(patches);
+
+    patches.clear();
+    reconciler.diff(old, next, patches);
+    CHECK_EQUAL(count(patches, vdom::PatchType::SetProperty), 2u);
+    CHECK_EQUAL(count(patches, vdom::PatchType::RemoveProperty), 1u);
+    CHECK_EQUAL(count(patches, vdom::PatchType::SetText), 1u);
+    CHECK_EQUAL(patches.size(), 4u);
+    model.apply(patches);
+    CHECK_EQUAL(model.compare(next), "");
+}
+
+TEST(reconciler_changed_tag_replaces_node)
+{
+    vdom::Tree empty;
+    vdom::Tree old;
+    vdom::Tree next;
+    vdom::Reconciler reconciler;
+    vdom::PatchList patches;
+    old.set_root(old.create_element(atom("div")));
+    next.set_root(next.create_element(atom("span")));
+    reconciler.diff(empty, old, patches);
+
+    patches.clear();
+    reconciler.diff(old, next, patches);
+    CHECK_EQUAL(patches.size(), 2u);
+    CHECK(patches[0].type == vdom::PatchType::Remove);
+    CHECK(patches[1].type == vdom::PatchType::Create);
+    CHECK(next.handle(next.root()) != old.handle(old.root()));
+}
+
+TEST(reconciler_skips_nodes_copied_from_old)
+{
+    vdom::Tree empty;
+    vdom::Tree old;
+    vdom::Tree next;
+    vdom::Tree expected;
+    vdom::Reconciler reconciler;
+    vdom::PatchList patches;
+    test::Model model;
+    build_list(old, {1, 2, 3, 4});
+    reconciler.diff(empty, old, patches);
+    model.apply(patches);
+
+    // Items 2 and 3 are copied, two subtrees of two nodes each, between a changed item 1 and a new item 9
+    auto build_next = [](vdom::Tree &tree, const vdom::Tree *source)
+    {
+        vdom::NodeId list = tree.create_element(atom("ul"));
+        tree.set_root(list);
+        vdom::NodeId first = tree.create_element(atom("li"), vdom::Value::integer(1));
+        tree.append_child(list, first);
+        tree.append_child(first, tree.create_text("row 1 changed"));
+        for (std::int64_t key : {2, 3})
+        {
+            vdom::NodeId item = source ? tree.copy_nodes(*source, static_cast<vdom::NodeId>(2 * key - 1), 2)
+                                       : tree.create_element(atom("li"), vdom::Value::integer(key));
+            tree.append_child(list, item);
+            if (!source)
+                tree.append_child(item, tree.create_text("row " + std::to_string(key)));
+        }
+        vdom::NodeId last = tree.create_element(atom("li"), vdom::Value::integer(9));
+        tree.append_child(list, last);
+        tree.append_child(last, tree.create_text("row 9"));
+    };
+    build_next(expected, nullptr);
+    build_next(next, &old);
+    const vdom::NodeId copy = 3;
+    CHECK_EQUAL(next.origin(), old.serial());
+    CHECK_EQUAL(next.handle(copy), old.handle(3));
+
+    vdom::PatchList expected_patches;
+    reconciler.diff(old, expected, expected_patches);
+    patches.clear();
+    reconciler.diff(old, next, patches);
+    CHECK_EQUAL(compare_patches(expected_patches, patches), "");
+    CHECK_EQUAL(compare_handles(expected, next), "");
+    CHECK_EQUAL(next.origin(), 0u);
+    model.apply(patches);
+    CHECK_EQUAL(model.compare(next), "");
+
+    // Out of range copies are refused
+    CHECK_THROWS(next.copy_nodes(old, 3, old.size()), std::out_of_range);
+}
+
+TEST(reconciler_diffs_trees_mounted_from_snapshots)
+{
+    vdom::Tree empty;
+    vdom::Tree old;
+    vdom::Reconciler reconciler;
+    vdom::PatchList patches;
+    build_list(old, {1, 2, 3});
+    reconciler.diff(empty, old, patches);
+
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "reconciler-test.snapshot";
+    snapshot::write(old, path);
+    vdom::Tree mounted;
+    snapshot::Snapshot(path).mount(mounted);
+    std::filesystem::remove(path);
+    CHECK(mounted.viewing());
+    CHECK_EQUAL(mounted.size(), old.size());
+
+    // Read in place, the mounted tree diffs like the saved one
+    for (std::vector<std::int64_t> keys : {std::vector<std::int64_t>{1, 2, 3}, std::vector<std::int64_t>{3, 1, 4}})
+    {
+        vdom::Tree next;
+        vdom::PatchList expected;
+        build_list(next, keys);
+        reconciler.diff(old, next, expected);
+        build_list(next, keys);
+        patches.clear();
+        reconciler.diff(mounted, next, patches);
+        CHECK_EQUAL(patches.size(), expected.size());
+    }
+
+    // Its first change copies the columns, and keeps the strings readable
+    const vdom::NodeId item = mounted.first_child(mounted.root());
+    mounted.append_child(item, mounted.create_text("more"));
+    CHECK(!mounted.viewing());
+    CHECK_EQUAL(mounted.text(mounted.first_child(item)), "row 1");
+    CHECK_EQUAL(mounted.text(mounted.last_child(item)), "more");
+    CHECK_EQUAL(mounted.handle(item), old.handle(old.first_child(old.root())));
+}
+
+TEST(reconciler_random_trees_match_model)
+{
+    // Successive random trees with colliding keys, unkeyed runs, texts and tag changes
+    std::mt19937 random(42);
+    for (int iteration = 0; iteration < 2000; ++iteration)
+    {
+        vdom::Tree empty;
+        vdom::Tree old;
+        vdom::Reconciler reconciler;
+        vdom::PatchList patches;
+        test::Model model;
+        old.set_root(old.create_element(atom("root")));
+        build_random(old, old.root(), random, 0);
+        reconciler.diff(empty, old, patches);
+        model.apply(patches);
+        CHECK_EQUAL(model.compare(old), "");
+
+        for (int step = 0; step < 3; ++step)
+        {
+            vdom::Tree next;
+            next.set_root(next.create_element(atom(random() % 20 ? "root" : "other")));
+            build_random(next, next.root(), random, 0);
+            patches.clear();
+            reconciler.diff(old, next, patches);
+            model.apply(patches);
+            CHECK_EQUAL(model.compare(next), "");
+            old = std::move(next);
+        }
+    }
+}
+
+TEST(parallel_reconciler_matches_sequential_phases)
+{
+    // Grains of a few nodes split even small trees into many groups, diffed out of order
+    std::mt19937 seeds(7);
+    std::size_t split = 0;
+    for (int iteration = 0; iteration < 500; ++iteration)
+    {
+        const std::size_t grain = 1 + iteration % 5;
+        vdom::Tree empty;
+        vdom::Tree sequential_old;
+        vdom::Tree parallel_old;
+        vdom::Reconciler reconciler;
+        engine::ParallelReconciler parallel(grain);
+        const std::uint32_t seed = seeds();
+        build_seeded(sequential_old, seed, 0, 1);
+        build_seeded(parallel_old, seed, 0, 1);
+        vdom::PatchList expected;
+        vdom::PatchList actual;
+        reconciler.diff(empty, sequential_old, expected);
+        parallel.diff(empty, parallel_old, actual, nullptr);
+        CHECK_EQUAL(compare_patches(expected, actual), "");
+
+        for (std::uint32_t step = 0; step < 3; ++step)
+        {
+            vdom::Tree sequential_next;
+            vdom::Tree parallel_next;
+            const std::uint32_t change = seeds();
+            build_seeded(sequential_next, seed, change, step + 2);
+            build_seeded(parallel_next, seed, change, step + 2);
+            expected.clear();
+            actual.clear();
+            reconciler.diff(sequential_old, sequential_next, expected);
+
+            const std::size_t groups = parallel.split(parallel_old, parallel_next, 1 + seeds() % 8);
+            split += groups > 1;
+            for (std::size_t group = groups; group > 0; --group)
+                parallel.diff_group(group - 1);
+            parallel.merge(actual);
+            CHECK_EQUAL(compare_patches(expected, actual), "");
+            CHECK_EQUAL(compare_handles(sequential_next, parallel_next), "");
+            sequential_old = std::move(sequential_next);
+            parallel_old = std::move(parallel_next);
+        }
+    }
+    CHECK(split > 500);
+}
+
+TEST(parallel_reconciler_matches_sequential_on_a_pool)
+{
+    engine::ThreadPool pool(3);
+    std::mt19937 seeds(11);
+    for (int iteration = 0; iteration < 300; ++iteration)
+    {
+        vdom::Tree empty;
+        vdom::Tree sequential_old;
+        vdom::Tree parallel_old;
+        vdom::Reconciler reconciler;
+        engine::ParallelReconciler parallel(1 + iteration % 5);
+        const std::uint32_t seed = seeds();
+        build_seeded(sequential_old, seed, 0, 1);
+        build_seeded(parallel_old, seed, 0, 1);
+        vdom::PatchList expected;
+        vdom::PatchList actual;
+        reconciler.diff(empty, sequential_old, expected);
+        parallel.diff(empty, parallel_old, actual, &pool);
+
+        for (std::uint32_t step = 0; step < 3; ++step)
+        {
+            vdom::Tree sequential_next;
+            vdom::Tree parallel_next;
+            const std::uint32_t change = seeds();
+            build_seeded(sequential_next, seed, change, step + 2);
+            build_seeded(parallel_next, seed, change, step + 2);
+            expected.clear();
+            actual.clear();
+            reconciler.diff(sequential_old, sequential_next, expected);
+            parallel.diff(parallel_old, parallel_next, actual, &pool);
+            CHECK_EQUAL(compare_patches(expected, actual), "");
+            CHECK_EQUAL(compare_handles(sequential_next, parallel_next), "");
+            sequential_old = std::move(sequential_next);
+            parallel_old = std::move(parallel_next);
+        }
+    }
+}
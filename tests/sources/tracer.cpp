@@ -0,0 +1,48 @@
+#include <sstream>
+#include <string>
+
+#include "test.hpp"
+#include "trace/tracer.hpp"
+
+namespace
+{
+    bool valid_utf8(const std::string &text)
+    {
+        for (std::size_t index = 0; index < text.size();)
+        {
+            const unsigned char lead = static_cast<unsigned char>(text[index]);
+            const std::size_t length = lead < 0x80 ? 1 : lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : lead >= 0xC2 ? 2 : 0;
+            if (length == 0 || index + length > text.size())
+                return false;
+            for (std::size_t continuation = 1; continuation < length; ++continuation)
+            {
+                if ((static_cast<unsigned char>(text[index + continuation]) & 0xC0) != 0x80)
+                    return false;
+            }
+            index += length;
+        }
+        return true;
+    }
+} // namespace
+
+TEST(tracer_cuts_details_between_code_points)
+{
+    // 2, 3 and 4-byte sequences straddling the 39-byte cut; spans view their detail until they end
+    const std::string two_bytes = std::string(26, 'a') + "ééééééééé";
+    const std::string three_bytes = std::string(37, 'a') + "€€";
+    const std::string four_bytes = std::string(36, 'a') + "😀😀";
+    trace::Tracer::clear();
+    trace::Tracer::enable(true);
+    {
+        trace::Span two("two", two_bytes);
+        trace::Span three("three", three_bytes);
+        trace::Span four("four", four_bytes);
+    }
+    trace::Tracer::enable(false);
+
+    std::ostringstream output;
+    trace::Tracer::write_chrome_trace(output);
+    trace::Tracer::clear();
+    CHECK(output.str().find("\"four\"") != std::string::npos);
+    CHECK(valid_utf8(output.str()));
+}